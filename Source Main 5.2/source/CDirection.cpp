@@ -173,7 +173,7 @@ void CDirection::SummonCreateMonster(EMonsterType Type, int x, int y, float Angl
     stl_Monster.push_back(DMonster);
 
     c = CreateMonster(Type, x, y, DMonster.m_Index + NUMOFMON);
-    c->Key = NUMOFMON + DMonster.m_Index++;
+    SetCharacterKey(c, NUMOFMON + DMonster.m_Index++);
     c->Object.Angle[2] = Angle;
     c->Weapon[0].Type = -1;
     c->Weapon[1].Type = -1;
@@ -15,6 +15,7 @@
 #include "zzzinventory.h"
 #include "zzzLodTerrain.h"
 #include "CSWaterTerrain.h"
+#include "TerrainLightBatch.h"
 #include "MapManager.h"
 #include <algorithm>
 
@@ -390,6 +391,7 @@ void    CSWaterTerrain::RenderWaterBitmapTile(float xf, float yf, float lodf, in
     vec3_t Light[4];
     if (LightEnable)
     {
+        FlushTerrainLights();
         VectorCopy(PrimaryTerrainLight[TerrainIndex1], Light[0]);
         VectorCopy(PrimaryTerrainLight[TerrainIndex2], Light[1]);
         VectorCopy(PrimaryTerrainLight[TerrainIndex3], Light[2]);
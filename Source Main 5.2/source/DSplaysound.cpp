@@ -1,447 +1,219 @@
 ///////////////////////////////////////////////////////////////////////////////
-// DirectX Sound
+// Sound effects
 ///////////////////////////////////////////////////////////////////////////////
 
 //-----------------------------------------------------------------------------
-// File: PlaySound.cpp
+// File: DSplaysound.cpp
 //
-// Desc: DirectSound support for how to load a wave file and play it using a
-//       static DirectSound buffer.
-//
-// Copyright (c) 1999 Microsoft Corp. All rights reserved.
+// Desc: Plays the ESound table through the software mixer in
+//       Platform/PlatformAudio.cpp. Every sound owns up to MAX_CHANNEL sources
+//       so the same effect can overlap itself; the mixer decides which of the
+//       playing sources get one of its voices.
 //-----------------------------------------------------------------------------
 #include "stdafx.h"
-#include <objbase.h>
-#include <dsound.h>
-#include "DSwaveio.h"
 #include "ZzzInfomation.h"
 #include "ZzzCharacter.h"
 #include "DSPlaySound.h"
+#include "Platform/PlatformAudio.h"
 
+using namespace Platform;
 
-
-bool                    g_EnableSound = false;
-bool                    g_Enable3DSound = false;
-int                  	SoundLoadCount = 0;
-
-LPDIRECTSOUND           g_lpDS = NULL;
-LPDIRECTSOUNDNOTIFY     g_lpDSNotify = NULL;
-LPDIRECTSOUND3DLISTENER g_lpDS3DListener;
-
-LPDIRECTSOUNDBUFFER     g_lpDSBuffer[MAX_BUFFER][MAX_CHANNEL];
-LPDIRECTSOUND3DBUFFER   g_lpDS3DBuffer[MAX_BUFFER][MAX_CHANNEL];
-
-DWORD                   g_dwBufferBytes;
-
-OBJECT* Object3DSound[MAX_BUFFER][MAX_CHANNEL];
-wchar_t                 BufferName[MAX_BUFFER][64];
-int                     BufferChannel[MAX_BUFFER];
-int                     MaxBufferChannel[MAX_BUFFER];
-bool                    Enable3DSound[MAX_BUFFER];
-
-//LPEAXMANAGER			lpEAXManager = NULL;
-LPKSPROPERTYSET		    g_lpPropertySet[MAX_BUFFER];			// Property Set Interfaces
-
-waveIO* wavefile = NULL;					// WAVE IO class instances
-
-//. master volume
-long g_MasterVolume = 0L;
-
-//-----------------------------------------------------------------------------
-// Name: InitDirectSound()
-// Desc: Initilizes DirectSound
-//-----------------------------------------------------------------------------
-HRESULT InitDirectSound(HWND hDlg)
+namespace
 {
-    HRESULT             hr;
-    DSBUFFERDESC        dsbdesc;
-    LPDIRECTSOUNDBUFFER lpDSBPrimary = NULL;
-    WAVEFORMATEX        wfx;
-
-    if (g_Enable3DSound)
+    enum
     {
-    }
-    else
-    {
-        // Initialize COM
-        CoInitialize(NULL);
+        SOUND_PRIORITY_EFFECT = 0,      // sounds of other objects
+        SOUND_PRIORITY_LOOP = 1,        // looped ambience and events
+        SOUND_PRIORITY_HERO = 2,        // the hero's own sounds and the interface
+    };
 
-        // Create IDirectSound using the primary sound device
-        if (FAILED(hr = DirectSoundCreate(NULL, &g_lpDS, NULL)))
-        {
-            g_ErrorReport.Write(L"Init - DirectSoundCreate Error\r\n");
-            return hr;
-        }
+    constexpr long SOUND_VOLUME_MIN = -10000;   // DSBVOLUME_MIN, in hundredths of a decibel
+    constexpr long SOUND_VOLUME_MAX = 0;
 
-        // Set coop level to DSSCL_PRIORITY
-        if (FAILED(hr = g_lpDS->SetCooperativeLevel(hDlg, DSSCL_PRIORITY)))
-        {
-            g_ErrorReport.Write(L"Init - DS SetCooperativeLevel Error\r\n");
-            return hr;
-        }
-        //if( FAILED( hr = g_lpDS->SetCooperativeLevel( hDlg, DSSCL_NORMAL ) ) )
-        //    return hr;
-
-        // Obtain primary buffer, asking it for 3D control
-        ZeroMemory(&dsbdesc, sizeof(DSBUFFERDESC));
-        dsbdesc.dwSize = sizeof(DSBUFFERDESC);
-        dsbdesc.dwFlags = DSBCAPS_CTRL3D | DSBCAPS_PRIMARYBUFFER;
-        if (FAILED(hr = g_lpDS->CreateSoundBuffer(&dsbdesc, &lpDSBPrimary, NULL)))
-        {
-            g_ErrorReport.Write(L"Init - DS CreateSoundBuffer Error\r\n");
-            return hr;
-        }
-
-        if (FAILED(hr = lpDSBPrimary->QueryInterface(IID_IDirectSound3DListener,
-            (VOID**)&g_lpDS3DListener)))
-        {
-            g_ErrorReport.Write(L"Init DS QueryInterface Error\r\n");
-            return hr;
-        }
-
-        // Get listener parameters
-        //g_dsListenerParams.dwSize = sizeof(DS3DLISTENER);
-        //m_pDirectSound3DListener->GetAllParameters( &g_dsListenerParams );
+    struct SOUND_SLOT
+    {
+        AudioBufferHandle Buffer;
+        AudioSourceHandle Sources[MAX_CHANNEL];
+        OBJECT*           Objects[MAX_CHANNEL];
+        int               Channels;
+        float             Volume;
+    };
 
-        // Set primary buffer format to 22kHz and 16-bit output.
-        ZeroMemory(&wfx, sizeof(WAVEFORMATEX));
-        wfx.wFormatTag = WAVE_FORMAT_PCM;
-        wfx.nChannels = 2;
-        wfx.nSamplesPerSec = 22050;
-        wfx.wBitsPerSample = 16;
-        wfx.nBlockAlign = wfx.wBitsPerSample / 8 * wfx.nChannels;
-        wfx.nAvgBytesPerSec = wfx.nSamplesPerSec * wfx.nBlockAlign;
+    SOUND_SLOT s_Sounds[MAX_BUFFER];
 
-        if (FAILED(hr = lpDSBPrimary->SetFormat(&wfx)))
-        {
-            g_ErrorReport.Write(L"Init DS SetFormat Error\r\n");
-            return hr;
-        }
+    bool s_bEnableSound = false;
 
-        // Release the primary buffer, since it is not need anymore
+    float MillibelToGain(long vol)
+    {
+        if (vol <= SOUND_VOLUME_MIN)
+            return 0.f;
+        if (vol >= SOUND_VOLUME_MAX)
+            return 1.f;
+        return powf(10.f, vol / 2000.f);
+    }
 
-        //  LPDIRECTSOUNDBUFFER ʱȭ.
-        for (int i = 0; i < MAX_BUFFER; ++i)
-        {
-            g_lpDSBuffer[i][0] = NULL;
-            g_lpDSBuffer[i][1] = NULL;
-            g_lpDSBuffer[i][2] = NULL;
-            g_lpDSBuffer[i][3] = NULL;
-        }
+    bool IsValidSound(int Buffer)
+    {
+        return s_bEnableSound && Buffer >= 0 && Buffer < MAX_BUFFER && s_Sounds[Buffer].Channels > 0;
     }
-    SAFE_RELEASE(lpDSBPrimary);
-    g_EnableSound = true;
-    return S_OK;
-}
 
-void    SetEnableSound(bool b)
-{
-    g_EnableSound = b;
+    int GetSoundPriority(const OBJECT* Object, BOOL bLooped)
+    {
+        if (Object == NULL || (Hero != NULL && Object == &Hero->Object))
+            return SOUND_PRIORITY_HERO;
+        return bLooped ? SOUND_PRIORITY_LOOP : SOUND_PRIORITY_EFFECT;
+    }
 }
 
 //-----------------------------------------------------------------------------
-// Name: CreateStaticBuffer()
-// Desc: Creates a wave file, sound buffer and notification events
+// Name: InitDirectSound()
+// Desc: Opens the sound output
 //-----------------------------------------------------------------------------
-HRESULT CreateStaticBuffer(int Buffer, TCHAR* strFileName, int MaxChannel, bool Enable)
+HRESULT InitDirectSound(HWND hDlg)
 {
-    HRESULT             hr;
-    WAVEFORMATEX		wfx;						// WAVE structure
-    DSBUFFERDESC		dsbdSecondary;				// Secondary buffer description
-    DWORD	         	datasize;
-
-    //Create a new instance of our WaveIO Object to load in a wavefile later
-    wavefile = new waveIO(INPUT);
-
-    // Load in our test wave file
-    if (wavefile->LoadWaveHeader(strFileName) == false) {
-        delete wavefile;
-        return 0;
-    }
-
-    wfx = wavefile->GetWaveFormatEx();
-    datasize = wavefile->GetDataSize();
-    g_dwBufferBytes = datasize;
-
-    memset(&dsbdSecondary, 0, sizeof(DSBUFFERDESC));
-
-    // Fill in our DS Secondary buffer description
-    dsbdSecondary.dwSize = sizeof(DSBUFFERDESC);
-    dsbdSecondary.dwBufferBytes = datasize;
+    if (s_bEnableSound)
+        return S_OK;
 
-    // Don't set DSBCAPS_CTRLPOSITIONNOTIFY or DSBCAPS_CTRLALL - you won't get a hardware buffer
-    if (Enable)
-        dsbdSecondary.dwFlags = DSBCAPS_LOCHARDWARE | DSBCAPS_CTRL3D | DSBCAPS_STATIC;
-    //dsbdSecondary.dwFlags = DSBCAPS_LOCSOFTWARE | DSBCAPS_CTRL3D | DSBCAPS_STATIC;
-    else
-#if DIRECTSOUND_VERSION < 0x0800
-        dsbdSecondary.dwFlags = DSBCAPS_CTRLDEFAULT | DSBCAPS_STATIC;
+#ifdef MU_HEADLESS_REPLAY
+    // sounds are still mixed, so the replay pays for them, but nothing is played
+    const AudioDevice device = AudioDevice::Null;
 #else
-        dsbdSecondary.dwFlags = DSBCAPS_CTRLPAN | DSBCAPS_CTRLVOLUME | DSBCAPS_CTRLFREQUENCY | DSBCAPS_STATIC;
+    const AudioDevice device = AudioDevice::Default;
 #endif
-    dsbdSecondary.lpwfxFormat = &wfx;
-
-    if (FAILED(hr = g_lpDS->CreateSoundBuffer(&dsbdSecondary, &g_lpDSBuffer[Buffer][0], NULL)))
-    {
-        g_ErrorReport.Write(L"Failed to create Direct Sound buffer [%s]\r\n", strFileName);
-        delete  wavefile;
-        return 0;
-    }
 
-    if (Enable)
+    if (!Audio::Initialize(device))
     {
-        // Query for a 3D Interface for the buffer
-        if (FAILED(hr = g_lpDSBuffer[Buffer][0]->QueryInterface(IID_IDirectSound3DBuffer, (LPVOID*)&g_lpDS3DBuffer[Buffer][0])))
-        {
-            g_ErrorReport.Write(L"Failed to query for 3D Interface on Direct Sound buffer [%s]\r\n", strFileName);
-            MessageBox(g_hWnd, L"Failed to query for 3D Interface on Direct Sound buffer", NULL, MB_OK);
-            g_ErrorReport.Write(L"Failed to query for 3D Interface on Direct Sound buffer");
-            SendMessage(g_hWnd, WM_DESTROY, 0, 0);
-            delete  wavefile;
-            return 0;
-        }
-
-        // Set position to be to the front left of listener
-        if (FAILED(hr = g_lpDS3DBuffer[Buffer][0]->SetPosition(-2, 0, 2, DS3D_IMMEDIATE)))
-        {
-            g_ErrorReport.Write(L"Failed to set position of 3D buffer [%s]\r\n", strFileName);
-            MessageBox(g_hWnd, L"Failed to set position of 3D buffer", NULL, MB_OK);
-            g_ErrorReport.Write(L"Failed to set position of 3D buffer");
-            SendMessage(g_hWnd, WM_DESTROY, 0, 0);
-            delete  wavefile;
-            return 0;
-        }
-
-        // Query for a Property Set Interface for the buffer
-        if (FAILED(hr = g_lpDS3DBuffer[Buffer][0]->QueryInterface(IID_IKsPropertySet, (void**)&g_lpPropertySet[Buffer])))
-        {
-            g_ErrorReport.Write(L"Failed to get Property Set Interface [%s]\r\n", strFileName);
-            MessageBox(g_hWnd, L"Failed to get Property Set Interface", NULL, MB_OK);
-            g_ErrorReport.Write(L"Failed to get Property Set Interface");
-            SendMessage(g_hWnd, WM_DESTROY, 0, 0);
-            delete  wavefile;
-            return 0;
-        }
-    }
-
-    //HRESULT hr;
-    DWORD* lpPart1, * lpPart2;
-    DWORD	dwPart1Size, dwPart2Size;
-
-    // Next we need to load our audio data into our Secondary Buffer
-    if (FAILED(hr = g_lpDSBuffer[Buffer][0]->Lock(0, g_dwBufferBytes, (void**)&lpPart1, &dwPart1Size, (void**)&lpPart2, &dwPart2Size, 0)))
-    {
-        g_ErrorReport.Write(L"Failed to Lock Secondary buffer [%s]\r\n", strFileName);
-        wprintf(L"Failed to Lock Secondary buffer\n");
-        SAFE_RELEASE(g_lpDSBuffer[Buffer][0]);
-        delete  wavefile;
-        return 0;
-    }
-
-    if (dwPart1Size != g_dwBufferBytes)
-    {
-        g_ErrorReport.Write(L"Couldn't Lock the whole buffer for some reason ... [%s]\r\n", strFileName);
-        wprintf(L"Couldn't Lock the whole buffer for some reason ...\n");
-        SAFE_RELEASE(g_lpDSBuffer[Buffer][0]);
-        delete  wavefile;
-        return 0;
-    }
-
-    // Use the waveIO Class ReadWaveData method to load in the data to where lpPart1 points
-    if (FAILED(hr = wavefile->ReadWaveData((char*)lpPart1, g_dwBufferBytes)))
-    {
-        g_ErrorReport.Write(L"Failed to read audio data [%s]\r\n", strFileName);
-        wprintf(L"Failed to read audio data\n");
-        SAFE_RELEASE(g_lpDSBuffer[Buffer][0]);
-        delete  wavefile;
-        return 0;
-    }
-
-    // Unlock the buffer
-    if (FAILED(hr = g_lpDSBuffer[Buffer][0]->Unlock(lpPart1, g_dwBufferBytes, lpPart2, 0)))
-    {
-        g_ErrorReport.Write(L"Failed to UnLock Secondary buffer [%s]\r\n", strFileName);
-        wprintf(L"Failed to UnLock Secondary buffer\n");
-        SAFE_RELEASE(g_lpDSBuffer[Buffer][0]);
-        delete  wavefile;
-        return 0;
+        g_ErrorReport.Write(L"Init - Audio output Error\r\n");
+        return E_FAIL;
     }
-    delete wavefile;
 
+    memset(s_Sounds, 0, sizeof(s_Sounds));
+    s_bEnableSound = true;
     return S_OK;
 }
 
-//-----------------------------------------------------------------------------
-// Name: FillBuffer()
-// Desc: Fill the DirectSound buffer with data from the wav file
-//-----------------------------------------------------------------------------
-HRESULT FillBuffer(int Buffer, int MaxChannel, bool Enable)
+void    SetEnableSound(bool b)
 {
-    return S_OK;
+    s_bEnableSound = b;
 }
 
 //-----------------------------------------------------------------------------
 // Name: LoadWaveFile()
-// Desc: Loads the wave file into a secondary static DirectSound buffer
+// Desc: Registers the wave file of a sound. The samples are read on the mixer's
+//       loader thread the first time the sound is played.
 //-----------------------------------------------------------------------------
 VOID LoadWaveFile(ESound Buffer, wchar_t* strFileName, int MaxChannel, bool Enable)
 {
-    if (!g_EnableSound)
+    if (!s_bEnableSound)
         return;
-    if (Buffer < 0)
+    if (Buffer < 0 || Buffer >= MAX_BUFFER)
         return;
 
-    if (MaxBufferChannel[Buffer] > 0)
-    {
+    SOUND_SLOT& sound = s_Sounds[Buffer];
+    if (sound.Channels > 0)
         return;
-    }
 
-    if (!g_Enable3DSound)
-    {
-        Enable = false;
-    }
+    char fileName[MAX_PATH];
+    if (WideCharToMultiByte(CP_ACP, 0, strFileName, -1, fileName, sizeof(fileName), NULL, NULL) == 0)
+        return;
 
-    // Create the sound buffer object from the wave file data
-    if (FAILED(CreateStaticBuffer(Buffer, strFileName, MaxChannel, Enable)))
-    {
+    sound.Buffer = Audio::CreateBufferFromFile(fileName);
+    if (sound.Buffer == INVALID_AUDIO_BUFFER)
         return;
-    }
 
-    if (FAILED(FillBuffer(Buffer, MaxChannel, Enable)))  // The sound buffer was successfully created
+    // 'Enable' asked for DirectSound 3D buffers, which were never switched on. Positions
+    // are still passed to the mixer, where they only rank the sources.
+    sound.Channels = MaxChannel < 1 ? 1 : (MaxChannel > MAX_CHANNEL ? MAX_CHANNEL : MaxChannel);
+    sound.Volume = 1.f;
+    for (int i = 0; i < sound.Channels; ++i)
     {
-        return;
+        sound.Sources[i] = Audio::CreateSource();
+        sound.Objects[i] = NULL;
+        Audio::SetSourceBuffer(sound.Sources[i], sound.Buffer);
     }
-
-    BufferChannel[Buffer] = 0;
-    MaxBufferChannel[Buffer] = MaxChannel;
-    Enable3DSound[Buffer] = Enable;
-    wcscpy(BufferName[Buffer], strFileName);
-
-    SoundLoadCount++;
-
-    SetVolume(Buffer, g_MasterVolume);
 }
 
 //-----------------------------------------------------------------------------
-// Name: FreeDirectSound()
-// Desc: Releases DirectSound
+// Name: ReleaseBuffer()
+// Desc: Releases the sources of a sound; its samples go with the last of them
 //-----------------------------------------------------------------------------
 HRESULT ReleaseBuffer(int Buffer)
 {
-    if (!g_EnableSound) return false;
-    if (Buffer < 0) return false;
-    //SAFE_DELETE( g_pWaveSoundRead );
-
-    // Release DirectSound interfaces
-    for (int i = 0; i < MaxBufferChannel[Buffer]; i++)
-    {
-        SAFE_RELEASE(g_lpDSBuffer[Buffer][i]);
-        if (Enable3DSound[i])
-        {
-            SAFE_RELEASE(g_lpDS3DBuffer[Buffer][i]);
-            //SAFE_RELEASE( g_lpPropertySet[Buffer][i] );
-        }
-    }
-
-    for (int i = 0; i < MAX_CHANNEL; i++)
-        Object3DSound[Buffer][i] = 0;
-
-    MaxBufferChannel[Buffer] = 0;
-
-    SoundLoadCount--;
+    if (!IsValidSound(Buffer))
+        return false;
 
-    // Release COM
-    //CoUninitialize();
+    SOUND_SLOT& sound = s_Sounds[Buffer];
+    for (int i = 0; i < sound.Channels; i++)
+        Audio::DestroySource(sound.Sources[i]);
+    Audio::DestroyBuffer(sound.Buffer);
 
+    memset(&sound, 0, sizeof(sound));
     return S_OK;
 }
 
 void FreeDirectSound()
 {
-    if (!g_EnableSound) return;
-    SAFE_RELEASE(g_lpDS);
-    g_EnableSound = false;
+    if (!s_bEnableSound) return;
+
+    Audio::Shutdown();
+    memset(s_Sounds, 0, sizeof(s_Sounds));
+    s_bEnableSound = false;
 }
 
 //-----------------------------------------------------------------------------
 // Name: RestoreBuffers()
-// Desc: Restore lost buffers and fill them up with sound if possible
+// Desc: The mixer owns its samples, so there is nothing to restore
 //-----------------------------------------------------------------------------
 HRESULT RestoreBuffers(int Buffer, int Channel)
 {
-    if (!g_EnableSound) return false;
-    if (Buffer < 0) return false;
-
-    HRESULT hr;
-
-    if (NULL == g_lpDSBuffer[Buffer][Channel])
-        return S_OK;
-
-    DWORD dwStatus;
-    if (FAILED(hr = g_lpDSBuffer[Buffer][Channel]->GetStatus(&dwStatus)))
-        return hr;
-
-    if (dwStatus & DSBSTATUS_BUFFERLOST)
-    {
-        // Since the app could have just been activated, then
-        // DirectSound may not be giving us control yet, so
-        // the restoring the buffer may fail.
-        // If it does, sleep until DirectSound gives us control.
-        do
-        {
-            hr = g_lpDSBuffer[Buffer][Channel]->Restore();
-            if (hr == DSERR_BUFFERLOST)
-                Sleep(10);
-        } while (hr = g_lpDSBuffer[Buffer][Channel]->Restore());
-
-        if (FAILED(hr = FillBuffer(Buffer, Channel, Enable3DSound[Buffer])))
-            return hr;
-    }
-
     return S_OK;
 }
 
-HRESULT SetHall(int Buffer)
-{
-    return true;
-}
-
-DWORD Temp;
-
 //-----------------------------------------------------------------------------
 // Name: PlayBuffer()
-// Desc: User hit the "Play" button, so play the DirectSound buffer
+// Desc: Plays a sound on a free channel. As with the DirectSound buffers, a sound
+//       whose channels are all playing is not restarted.
 //-----------------------------------------------------------------------------
 HRESULT PlayBuffer(ESound Buffer, OBJECT* Object, BOOL bLooped)
 {
-    if (!g_EnableSound) return false;
-    if (Buffer < 0) return false;
+    if (!IsValidSound(Buffer))
+        return false;
 
-    HRESULT hr;
+    SOUND_SLOT& sound = s_Sounds[Buffer];
 
-    if (NULL == g_lpDSBuffer[Buffer][BufferChannel[Buffer]])
+    int channel = -1;
+    for (int i = 0; i < sound.Channels; ++i)
     {
-        return E_FAIL;
+        if (Audio::IsSourcePlaying(sound.Sources[i]))
+        {
+            // looped sounds are requested every frame while they should keep going
+            if (bLooped)
+                return S_OK;
+        }
+        else if (channel == -1)
+        {
+            channel = i;
+        }
     }
 
-    // Play buffer
-    DWORD dwLooped = bLooped ? DSBPLAY_LOOPING : 0L;
+    if (channel == -1)
+        return S_OK;
 
-    if (FAILED(hr = g_lpDSBuffer[Buffer][BufferChannel[Buffer]]->Play(0, 0, dwLooped)))
-    {
-        g_ConsoleDebug->Write(MCD_ERROR, L"Play Sound: %d, %d", Buffer, dwLooped);
-        return hr;
-    }
+    const AudioSourceHandle source = sound.Sources[channel];
+    Audio::SetSourceLooping(source, bLooped != FALSE);
+    Audio::SetSourceVolume(source, sound.Volume);
+    Audio::SetSourcePriority(source, GetSoundPriority(Object, bLooped));
 
-    if (Enable3DSound[Buffer])
-    {
-        Object3DSound[Buffer][BufferChannel[Buffer]] = Object;
-        SetHall(Buffer);
-    }
+    const OBJECT* origin = Object ? Object : (Hero ? &Hero->Object : NULL);
+    if (origin)
+        Audio::SetSourcePosition(source, origin->Position[0], origin->Position[1], origin->Position[2]);
+    sound.Objects[channel] = Object;
 
-    if (BufferChannel[Buffer] >= MaxBufferChannel[Buffer])
+    Audio::PlaySource(source);
+    if (!Audio::IsSourcePlaying(source))
     {
-        BufferChannel[Buffer] = 0;
+        g_ConsoleDebug->Write(MCD_ERROR, L"Play Sound: %d, %d", Buffer, bLooped);
+        return E_FAIL;
     }
     return S_OK;
 }
@@ -452,47 +224,41 @@ HRESULT PlayBuffer(ESound Buffer, OBJECT* Object, BOOL bLooped)
 //-----------------------------------------------------------------------------
 BOOL IsSoundPlaying(int Buffer, int Channel)
 {
-    if (!g_EnableSound)
+    if (!IsValidSound(Buffer))
         return false;
-    if (Buffer < 0)
+    if (Channel < 0 || Channel >= s_Sounds[Buffer].Channels)
         return false;
 
-    if (g_lpDSBuffer[Buffer][Channel])
-    {
-        DWORD dwStatus = 0;
-        g_lpDSBuffer[Buffer][Channel]->GetStatus(&dwStatus);
-        return((dwStatus & DSBSTATUS_PLAYING) != 0);
-    }
-    else
-    {
-        return FALSE;
-    }
+    return Audio::IsSourcePlaying(s_Sounds[Buffer].Sources[Channel]);
 }
 
 //-----------------------------------------------------------------------------
 // Name: StopBuffer()
-// Desc: Stop the DirectSound buffer from playing
+// Desc: Stops every channel of a sound
 //-----------------------------------------------------------------------------
 VOID StopBuffer(ESound Buffer, BOOL bResetPosition)
 {
-    //return;
-    if (!g_EnableSound)
-        return;
-    if (Buffer < 0)
+    if (!IsValidSound(Buffer))
         return;
 
-    if (NULL == g_lpDSBuffer[Buffer][0])
-        return;
-
-    g_lpDSBuffer[Buffer][0]->Stop();
-
-    if (bResetPosition)
-        g_lpDSBuffer[Buffer][0]->SetCurrentPosition(0L);
+    SOUND_SLOT& sound = s_Sounds[Buffer];
+    for (int i = 0; i < sound.Channels; ++i)
+    {
+        if (bResetPosition)
+        {
+            Audio::StopSource(sound.Sources[i]);
+            sound.Objects[i] = NULL;
+        }
+        else
+        {
+            Audio::PauseSource(sound.Sources[i]);
+        }
+    }
 }
 
 void AllStopSound(void)
 {
-    if (!g_EnableSound)
+    if (!s_bEnableSound)
         return;
 
     for (int i = 0; i < MAX_BUFFER; ++i)
@@ -503,64 +269,63 @@ void AllStopSound(void)
 
 void SetVolume(int Buffer, long vol)
 {
-    if (!g_EnableSound)
-        return;
-    if (Buffer < 0)
+    if (!IsValidSound(Buffer))
         return;
 
-    if (g_lpDSBuffer[Buffer][0])
-    {
-        if (vol > DSBVOLUME_MAX)
-            vol = DSBVOLUME_MAX;
-        if (vol < DSBVOLUME_MIN)
-            vol = DSBVOLUME_MIN;
-
-        g_lpDSBuffer[Buffer][0]->SetVolume(vol);
-    }
+    SOUND_SLOT& sound = s_Sounds[Buffer];
+    sound.Volume = MillibelToGain(vol);
+    for (int i = 0; i < sound.Channels; ++i)
+        Audio::SetSourceVolume(sound.Sources[i], sound.Volume);
 }
 
 void SetMasterVolume(long vol)
 {
-    if (!g_EnableSound)
+    if (!s_bEnableSound)
         return;
 
-    for (int i = 0; i < MAX_BUFFER; ++i)
-    {
-        SetVolume(i, vol);
-    }
-
-    g_MasterVolume = vol;
+    Audio::SetSFXVolume(MillibelToGain(vol));
 }
 
 extern vec3_t CameraAngle;
 
+//-----------------------------------------------------------------------------
+// Name: Set3DSoundPosition()
+// Desc: Called once a frame: moves the listener to the hero and the sounds with
+//       their objects, then lets the mixer catch up.
+//-----------------------------------------------------------------------------
 void Set3DSoundPosition()
 {
-    if (!g_EnableSound) return;
+    if (!s_bEnableSound) return;
 
-    if (g_Enable3DSound)
+    if (Hero)
     {
         vec3_t Angle;
         float Matrix[3][4];
         Vector(0.f, 0.f, CameraAngle[2], Angle);
         AngleMatrix(Angle, Matrix);
-        for (int i = 0; i < MAX_BUFFER; i++)
+
+        const vec3_t& Position = Hero->Object.Position;
+        Audio::SetListenerPosition(Position[0], Position[1], Position[2]);
+        Audio::SetListenerOrientation(Matrix[1][0], Matrix[1][1], Matrix[1][2], 0.f, 0.f, 1.f);
+    }
+
+    for (int i = 0; i < MAX_BUFFER; i++)
+    {
+        SOUND_SLOT& sound = s_Sounds[i];
+        for (int j = 0; j < sound.Channels; j++)
         {
-            if (Enable3DSound[i])
+            OBJECT* Object = sound.Objects[j];
+            if (Object == NULL)
+                continue;
+
+            if (!Object->Live || !Audio::IsSourcePlaying(sound.Sources[j]))
             {
-                for (int j = 0; j < MaxBufferChannel[i]; j++)
-                {
-                    if (Object3DSound[i][j])
-                    {
-                        vec3_t SoundPosition;
-                        VectorCopy(Object3DSound[i][j]->Position, SoundPosition);
-                        VectorSubtract(Hero->Object.Position, SoundPosition, SoundPosition);
-                        VectorRotate(SoundPosition, Matrix, SoundPosition);
-                        VectorScale(SoundPosition, 0.004f, SoundPosition);
-                        g_lpDS3DBuffer[i][j]->SetPosition(-SoundPosition[0], 0.f, -SoundPosition[1], DS3D_IMMEDIATE);
-                    }
-                }
+                sound.Objects[j] = NULL;
+                continue;
             }
+            Audio::SetSourcePosition(sound.Sources[j], Object->Position[0], Object->Position[1], Object->Position[2]);
         }
     }
-}
\ No newline at end of file
+
+    Audio::Update();
+}
@@ -50,6 +50,30 @@ void Connection::OnDisconnectedS(const int32_t handle)
 Connection::Connection(const wchar_t* host, int32_t port, bool isEncrypted, void(*packetHandler)(int32_t, const BYTE*, int32_t))
 {
     this->_packetHandler = packetHandler;
+    Open(host, port, isEncrypted);
+}
+
+Connection::Connection(const wchar_t* host, int32_t port, bool isEncrypted, PacketQueue* packetQueue)
+{
+    this->_packetQueue = packetQueue;
+    Open(host, port, isEncrypted);
+}
+
+Connection::Connection()
+{
+    this->_handle = 0;
+
+    _chatServer = new PacketFunctions_ChatServer();
+    _connectServer = new PacketFunctions_ConnectServer();
+    _gameServer = new PacketFunctions_ClientToServer();
+
+    _chatServer->SetHandle(this->_handle);
+    _connectServer->SetHandle(this->_handle);
+    _gameServer->SetHandle(this->_handle);
+}
+
+void Connection::Open(const wchar_t* host, int32_t port, bool isEncrypted)
+{
     this->_handle = dotnet_connect(host, port, isEncrypted ? 1 : 0, &OnPacketReceivedS, &OnDisconnectedS);
 
     if (IsConnected())
@@ -120,5 +144,12 @@ void Connection::OnDisconnected()
 void Connection::OnPacketReceived(const BYTE* data, const int32_t size)
 {
     wprintf(L"Received packet, size %d", size);
-    this->_packetHandler(this->_handle, data, size);
+    if (this->_packetQueue != nullptr)
+    {
+        this->_packetQueue->Push(this->_handle, data, size);
+    }
+    else
+    {
+        this->_packetHandler(this->_handle, data, size);
+    }
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "PacketFunctions_ChatServer.h"
 #include "PacketFunctions_ConnectServer.h"
 #include "PacketFunctions_ClientToServer.h"
+#include "PacketQueue.h"
 
 
 #ifdef _WIN32
@@ -35,13 +36,19 @@ private:
     PacketFunctions_ClientToServer* _gameServer = { };
 
     int32_t _handle;
-    void(*_packetHandler)(int32_t, const BYTE*, int32_t);
+    void(*_packetHandler)(int32_t, const BYTE*, int32_t) = { };
+    PacketQueue* _packetQueue = { };
 
+    void Open(const wchar_t* host, int32_t port, bool isEncrypted);
     void OnDisconnected();
     void OnPacketReceived(const BYTE* data, const int32_t length);
 
 public:
     Connection(const wchar_t* host, int32_t port, bool isEncrypted, void(*packetHandler)(int32_t, const BYTE*, int32_t));
+    // Received packets are copied into packetQueue on the receive thread instead of calling a handler there.
+    Connection(const wchar_t* host, int32_t port, bool isEncrypted, PacketQueue* packetQueue);
+    // Never connected; used while replaying a packet capture. Packet functions are bound to handle 0.
+    Connection();
     ~Connection();
 
     bool IsConnected();
@@ -0,0 +1,106 @@
+#include "stdafx.h"
+#include <thread>
+
+#include "PacketQueue.h"
+
+namespace
+{
+    constexpr int32_t WRAP_MARKER = -1;
+    constexpr size_t RECORD_ALIGNMENT = 8;
+}
+
+PacketQueue::PacketQueue(size_t capacity)
+    : m_head(0), m_tail(0)
+{
+    // power of two, so the monotonic positions wrap together with size_t
+    m_capacity = RECORD_ALIGNMENT;
+    while (m_capacity < capacity)
+        m_capacity <<= 1;
+
+    m_pArena = new BYTE[m_capacity];
+}
+
+PacketQueue::~PacketQueue()
+{
+    delete[] m_pArena;
+}
+
+size_t PacketQueue::RecordSize(int32_t size)
+{
+    return (sizeof(RecordHeader) + size + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+}
+
+bool PacketQueue::Push(int32_t handle, const BYTE* data, int32_t size)
+{
+    const size_t recordSize = RecordSize(size);
+    if (size < 0 || recordSize > m_capacity / 2)
+    {
+        g_ErrorReport.Write(L"PacketQueue: dropped packet of %d bytes.\r\n", size);
+        return false;
+    }
+
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    const size_t offset = tail & (m_capacity - 1);
+    const size_t padding = offset + recordSize > m_capacity ? m_capacity - offset : 0;
+
+    int spins = 0;
+    while (m_capacity - (tail - m_head.load(std::memory_order_acquire)) < padding + recordSize)
+    {
+        if (++spins < 64)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (padding > 0)
+    {
+        auto marker = reinterpret_cast<RecordHeader*>(m_pArena + offset);
+        marker->Handle = handle;
+        marker->Size = WRAP_MARKER;
+        tail += padding;
+    }
+
+    BYTE* record = m_pArena + (tail & (m_capacity - 1));
+    auto header = reinterpret_cast<RecordHeader*>(record);
+    header->Handle = handle;
+    header->Size = size;
+    memcpy(record + sizeof(RecordHeader), data, size);
+
+    m_tail.store(tail + recordSize, std::memory_order_release);
+    return true;
+}
+
+bool PacketQueue::Front(int32_t& handle, const BYTE*& data, int32_t& size)
+{
+    size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tail.load(std::memory_order_acquire))
+        return false;
+
+    const BYTE* record = m_pArena + (head & (m_capacity - 1));
+    auto header = reinterpret_cast<const RecordHeader*>(record);
+    if (header->Size == WRAP_MARKER)
+    {
+        // the producer publishes the marker together with the record behind it
+        head += m_capacity - (head & (m_capacity - 1));
+        m_head.store(head, std::memory_order_release);
+        record = m_pArena;
+        header = reinterpret_cast<const RecordHeader*>(record);
+    }
+
+    handle = header->Handle;
+    size = header->Size;
+    data = record + sizeof(RecordHeader);
+    return true;
+}
+
+void PacketQueue::Pop()
+{
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    auto header = reinterpret_cast<const RecordHeader*>(m_pArena + (head & (m_capacity - 1)));
+    m_head.store(head + RecordSize(header->Size), std::memory_order_release);
+}
+
+bool PacketQueue::IsEmpty() const
+{
+    return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+}
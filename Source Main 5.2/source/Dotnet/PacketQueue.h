@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+
+// Single-producer / single-consumer queue of received packets.
+//
+// The .NET receive thread copies every packet into a fixed arena (Push) and the game
+// loop processes them in place (Front/Pop), so receiving allocates nothing per packet.
+// A record is [handle][size][payload] padded to 8 bytes; a record that doesn't fit
+// before the end of the arena is preceded by a wrap marker and starts at offset 0.
+class PacketQueue
+{
+public:
+    explicit PacketQueue(size_t capacity = 1 << 20);
+    ~PacketQueue();
+
+    // Producer side. Waits while the arena is full, which throttles the socket
+    // instead of dropping packets while the game loop is busy (e.g. loading a map).
+    bool Push(int32_t handle, const BYTE* data, int32_t size);
+
+    // Consumer side. Front returns the oldest packet without removing it; the data
+    // stays valid until Pop.
+    bool Front(int32_t& handle, const BYTE*& data, int32_t& size);
+    void Pop();
+
+    bool IsEmpty() const;
+
+private:
+    PacketQueue(const PacketQueue&) = delete;
+    PacketQueue& operator=(const PacketQueue&) = delete;
+
+    struct RecordHeader
+    {
+        int32_t Handle;
+        int32_t Size;   // WRAP_MARKER: skip to the start of the arena
+    };
+
+    static size_t RecordSize(int32_t size);
+
+    BYTE* m_pArena;
+    size_t m_capacity;
+
+    // monotonically increasing byte positions; the arena offset is position % m_capacity
+    alignas(64) std::atomic<size_t> m_head; // written by the consumer
+    alignas(64) std::atomic<size_t> m_tail; // written by the producer
+};
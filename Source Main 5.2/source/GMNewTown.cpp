@@ -18,6 +18,7 @@
 #include "GOBoid.h"
 #include "GIPetManager.h"
 #include "MapManager.h"
+#include "MeshBuffer.h"
 #include "SkillManager.h"
 #include "_enum.h"
 
@@ -344,7 +345,7 @@ bool GMNewTown::RenderObjectVisual(OBJECT* pObject, BMD* pModel)
             OBJECT* pNewObject = &CharactersClient[icntIndex].Object;
             CreateCharacterPointer(pCharacter, MODEL_PLAYER, 0, 0, 0);
             Vector(0.3f, 0.3f, 0.3f, pNewObject->Light);
-            pCharacter->Key = icntIndex;
+            SetCharacterKey(pCharacter, icntIndex);
 
             int Level = 0;
             switch (pObject->Type)
@@ -720,7 +721,7 @@ bool GMNewTown::RenderObjectVisual(OBJECT* pObject, BMD* pModel)
     return true;
 }
 
-extern float  IntensityTransform[MAX_MESH][MAX_VERTICES];
+extern float* IntensityTransform[MAX_MESH];
 
 bool GMNewTown::RenderObject(OBJECT* pObject, BMD* pModel, bool ExtraMon)
 {
@@ -742,6 +743,7 @@ bool GMNewTown::RenderObject(OBJECT* pObject, BMD* pModel, bool ExtraMon)
                 IntensityTransform[i][j] = 2.0f;
             }
         }
+        InvalidateSkinningPalette();
         Vector(1.0f, 1.0f, 1.0f, pObject->Light);
     }
 
@@ -13,6 +13,7 @@
 
 #include "w_MapHeaders.h"
 #include "DSPlaySound.h"
+#include "MeshBuffer.h"
 
 using namespace SEASON4A;
 
@@ -1072,7 +1073,7 @@ bool CGM_Raklion::RenderObjectMesh(OBJECT* o, BMD* b, bool ExtraMon)
 
     if (o->Type >= 6 && o->Type <= 12)
     {
-        extern float IntensityTransform[MAX_MESH][MAX_VERTICES];
+        extern float* IntensityTransform[MAX_MESH];
         for (int i = 0; i < b->NumMeshs; i++)
         {
             Mesh_t* m = &b->Meshs[i];
@@ -1081,6 +1082,7 @@ bool CGM_Raklion::RenderObjectMesh(OBJECT* o, BMD* b, bool ExtraMon)
                 IntensityTransform[i][j] = 0.5f;
             }
         }
+        InvalidateSkinningPalette();
         Vector(1.0f, 1.0f, 1.0f, o->Light);
         b->RenderBody(RENDER_TEXTURE, o->Alpha, o->BlendMesh, o->BlendMeshLight, o->BlendMeshTexCoordU, o->BlendMeshTexCoordV);
 
@@ -225,12 +225,12 @@ bool M37Kanturu1st::RenderKanturu1stObjectVisual(OBJECT* pObject, BMD* pModel)
     break;
     case 96:
         pModel->StreamMesh = 0;
-        glAlphaFunc(GL_GREATER, 0.0f);
+        SetAlphaTestReference(0.0f);
         pModel->RenderMesh(
             0, RENDER_TEXTURE, 1.0f, pObject->BlendMesh,
             pObject->BlendMeshLight, pObject->BlendMeshTexCoordU,
             -(int)WorldTime % 20000 * 0.00005f);
-        glAlphaFunc(GL_GREATER, 0.25f);
+        SetAlphaTestReference(0.25f);
         pModel->StreamMesh = -1;
         break;
     case 98:
@@ -3,6 +3,7 @@
 // Include dependencies needed by this header
 #include <string>
 #include <map>
+#include <bitset>
 #include <cstdint>
 
 typedef float vec_t;
@@ -54,12 +55,15 @@ typedef std::wstring	WSTRING;
     #endif
 #endif
 
-// BuffStateMap depends on eBuffState which is defined elsewhere
+// BuffStateSet depends on eBuffState which is defined elsewhere
 // Only define it if eBuffState is available
 #ifdef __cplusplus
     // Forward declare eBuffState if not already declared
     #ifndef _BUFF_STATE_ENUM_DEFINED
         enum eBuffState;
     #endif
-    typedef std::map<eBuffState, DWORD>    BuffStateMap;
+    // One bit per eBuffState. Buff indices arrive from the server as a BYTE, so the set
+    // covers the whole byte range rather than just eBuff_Count.
+    const int MAX_BUFF_STATE = 256;
+    typedef std::bitset<MAX_BUFF_STATE>    BuffStateSet;
 #endif
@@ -3,9 +3,134 @@
 //////////////////////////////////////////////////////////////////////
 
 #include "stdafx.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include "turbojpeg.h"
 #include "GlobalBitmap.h"
+#include "./Utilities/JobSystem.h"
 
+namespace
+{
+    // One decompressor per thread, so the job system workers and the streaming threads
+    // never share a handle and none is created per image.
+    class CJpegDecompressor
+    {
+    public:
+        CJpegDecompressor() : m_Handle(tjInitDecompress()) {}
+        ~CJpegDecompressor() { tjDestroy(m_Handle); }
+
+        tjhandle Get() const { return m_Handle; }
+
+    private:
+        tjhandle m_Handle;
+    };
+
+    tjhandle GetJpegDecompressor()
+    {
+        thread_local CJpegDecompressor s_Decompressor;
+        return s_Decompressor.Get();
+    }
+}
+
+// Decodes queued files on its own threads and hands the results back to the render
+// thread, which uploads them from CGlobalBitmap::UpdateStreaming.
+class CGlobalBitmap::CTextureStreamer
+{
+public:
+    typedef struct
+    {
+        DWORD         Ticket;
+        GLuint        BitmapIndex;
+        std::wstring  FileName;
+        GLuint        Filter;
+        GLuint        Wrap;
+        DECODED_IMAGE Image;
+        bool          Decoded;
+    } REQUEST;
+
+    CTextureStreamer(CGlobalBitmap* pOwner, int workerCount) : m_pOwner(pOwner)
+    {
+        for (int i = 0; i < workerCount; ++i)
+        {
+            m_Workers.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    ~CTextureStreamer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_bShutdown = true;
+        }
+        m_Wake.notify_all();
+        for (auto& worker : m_Workers)
+        {
+            worker.join();
+        }
+        for (auto& request : m_Completed)
+        {
+            delete[] request.Image.Buffer;
+        }
+    }
+
+    void Push(DWORD dwTicket, GLuint uiBitmapIndex, const std::wstring& filename, GLuint uiFilter, GLuint uiWrapMode)
+    {
+        REQUEST request;
+        request.Ticket = dwTicket;
+        request.BitmapIndex = uiBitmapIndex;
+        request.FileName = filename;
+        request.Filter = uiFilter;
+        request.Wrap = uiWrapMode;
+        memset(&request.Image, 0, sizeof(DECODED_IMAGE));
+        request.Decoded = false;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Pending.push_back(std::move(request));
+        }
+        m_Wake.notify_one();
+    }
+
+    bool PopCompleted(REQUEST& request)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_Completed.empty())
+            return false;
+        request = std::move(m_Completed.front());
+        m_Completed.pop_front();
+        return true;
+    }
+
+private:
+    void WorkerLoop()
+    {
+        while (true)
+        {
+            REQUEST request;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Wake.wait(lock, [this] { return m_bShutdown || !m_Pending.empty(); });
+                if (m_bShutdown)
+                    return;
+                request = std::move(m_Pending.front());
+                m_Pending.pop_front();
+            }
+
+            request.Decoded = m_pOwner->DecodeImage(request.FileName, request.Image);
+
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Completed.push_back(std::move(request));
+        }
+    }
+
+    CGlobalBitmap*           m_pOwner;
+    std::vector<std::thread> m_Workers;
+    std::mutex               m_Mutex;
+    std::condition_variable  m_Wake;
+    std::deque<REQUEST>      m_Pending;
+    std::deque<REQUEST>      m_Completed;
+    bool                     m_bShutdown = false;
+};
 
 
 CBitmapCache::CBitmapCache()
@@ -318,8 +443,46 @@ bool CBitmapCache::Find(GLuint uiBitmapIndex, BITMAP_t** ppBitmap)
     return false;
 }
 
+int CBitmapCache::GetCategory(GLuint uiBitmapIndex) const
+{
+    for (int i = 0; i < NUMBER_OF_QUICK_CACHE; i++)
+    {
+        if (uiBitmapIndex > m_QuickCache[i].dwBitmapIndexMin && uiBitmapIndex < m_QuickCache[i].dwBitmapIndexMax)
+            return CATEGORY_MAPTILE + i;
+    }
+
+    if (BITMAP_PLAYER_TEXTURE_BEGIN <= uiBitmapIndex && BITMAP_PLAYER_TEXTURE_END >= uiBitmapIndex)
+        return CATEGORY_PLAYER;
+    else if (BITMAP_INTERFACE_TEXTURE_BEGIN <= uiBitmapIndex && BITMAP_INTERFACE_TEXTURE_END >= uiBitmapIndex)
+        return CATEGORY_INTERFACE;
+    else if (BITMAP_EFFECT_TEXTURE_BEGIN <= uiBitmapIndex && BITMAP_EFFECT_TEXTURE_END >= uiBitmapIndex)
+        return CATEGORY_EFFECT;
+
+    return CATEGORY_MAIN;
+}
+
+const wchar_t* CBitmapCache::GetCategoryName(int iCategory)
+{
+    static const wchar_t* s_Names[NUMBER_OF_CATEGORY] =
+    {
+        L"MapTile", L"MapGrass", L"Water", L"Cursor", L"Font", L"MainFrame",
+        L"SkillIcon", L"Player", L"Interface", L"Effect", L"Main",
+    };
+    return (iCategory >= 0 && iCategory < NUMBER_OF_CATEGORY) ? s_Names[iCategory] : L"Unknown";
+}
+
 CGlobalBitmap::CGlobalBitmap()
 {
+    m_dwStreamTicket = 0;
+    m_uiPlaceholderTexture = 0;
+    m_dwUploadBudget = DEFAULT_UPLOAD_BUDGET;
+    m_dwUploadedBytes = 0;
+    m_bReleaseBuffers = false;
+
+    KeepBuffer(BITMAP_FONT);
+    KeepBuffer(BITMAP_GUILD);
+    KeepBuffer(BITMAP_INTERFACE_MAP);
+
     Init();
     m_BitmapCache.Create();
 
@@ -329,6 +492,8 @@ CGlobalBitmap::CGlobalBitmap()
 }
 CGlobalBitmap::~CGlobalBitmap()
 {
+    m_pStreamer.reset();
+    ClearPrefetchedImages();
     UnloadAllImages();
 }
 void CGlobalBitmap::Init()
@@ -336,6 +501,7 @@ void CGlobalBitmap::Init()
     m_uiAlternate = 0;
     m_uiTextureIndexStream = BITMAP_NONAMED_TEXTURES_BEGIN;
     m_dwUsedTextureMemory = 0;
+    m_dwUsedBufferMemory = 0;
 }
 
 GLuint CGlobalBitmap::LoadImage(const std::wstring& filename, GLuint uiFilter, GLuint uiWrapMode)
@@ -402,6 +568,13 @@ bool CGlobalBitmap::LoadImage(GLuint uiBitmapIndex, const std::wstring& filename
         }
     }
 
+    DECODED_IMAGE prefetched;
+    if (TakePrefetchedImage(filename, prefetched))
+    {
+        UploadImage(uiBitmapIndex, filename, prefetched, uiFilter, uiWrapMode);
+        return true;
+    }
+
     std::wstring ext;
     SplitExt(filename, ext, false);
 
@@ -421,9 +594,17 @@ void CGlobalBitmap::UnloadImage(GLuint uiBitmapIndex, bool bForce)
 
         if (--pBitmap->Ref == 0 || bForce)
         {
-            glDeleteTextures(1, &(pBitmap->TextureNumber));
+            m_mapStreaming.erase(uiBitmapIndex);
+            if (pBitmap->TextureNumber != m_uiPlaceholderTexture)
+            {
+                glDeleteTextures(1, &(pBitmap->TextureNumber));
+            }
 
-            m_dwUsedTextureMemory -= (DWORD)(pBitmap->Width * pBitmap->Height * pBitmap->Components);
+            m_dwUsedTextureMemory -= pBitmap->dwTextureBytes;
+            if (pBitmap->Buffer != nullptr)
+            {
+                m_dwUsedBufferMemory -= (DWORD)(pBitmap->Width * pBitmap->Height * pBitmap->Components);
+            }
 
             delete[] pBitmap->Buffer;
             delete pBitmap;
@@ -461,11 +642,162 @@ void CGlobalBitmap::UnloadAllImages()
 
     m_mapBitmap.clear();
     m_listNonamedIndex.clear();
+    m_mapStreaming.clear();
     m_BitmapCache.RemoveAll();
 
     Init();
 }
 
+GLuint CGlobalBitmap::LoadImageAsync(const std::wstring& filename, GLuint uiFilter, GLuint uiWrapMode)
+{
+    BITMAP_t* pBitmap = FindTexture(filename);
+    if (pBitmap)
+    {
+        if (pBitmap->Ref > 0)
+        {
+            if (0 == _wcsicmp(pBitmap->FileName, filename.c_str()))
+            {
+                pBitmap->Ref++;
+
+                return pBitmap->BitmapIndex;
+            }
+        }
+        return BITMAP_UNKNOWN;
+    }
+
+    // Fail up front like LoadImage does for a missing file, so callers keep their fallbacks.
+    std::wstring ext, packed;
+    SplitExt(filename, ext, false);
+    if (0 == _wcsicmp(ext.c_str(), L"jpg"))
+        ExchangeExt(filename, L"OZJ", packed);
+    else if (0 == _wcsicmp(ext.c_str(), L"tga"))
+        ExchangeExt(filename, L"OZT", packed);
+    else
+        return BITMAP_UNKNOWN;
+
+    if (GetFileAttributesW(packed.c_str()) == INVALID_FILE_ATTRIBUTES)
+    {
+        return BITMAP_UNKNOWN;
+    }
+
+    GLuint uiNewTextureIndex = GenerateTextureIndex();
+
+    auto* pNewBitmap = new BITMAP_t;
+    memset(pNewBitmap, 0, sizeof(BITMAP_t));
+
+    pNewBitmap->BitmapIndex = uiNewTextureIndex;
+    wstring_copy_to_buffer(filename, pNewBitmap->FileName, MAX_BITMAP_FILE_NAME);
+    pNewBitmap->Width = 1.f;
+    pNewBitmap->Height = 1.f;
+    pNewBitmap->TextureNumber = GetPlaceholderTexture();
+    pNewBitmap->Ref = 1;
+
+    m_mapBitmap.insert(type_bitmap_map::value_type(uiNewTextureIndex, pNewBitmap));
+    m_listNonamedIndex.push_back(uiNewTextureIndex);
+
+    if (m_pStreamer == nullptr)
+    {
+        m_pStreamer = std::make_unique<CTextureStreamer>(this, STREAMING_WORKER_COUNT);
+    }
+
+    const DWORD dwTicket = ++m_dwStreamTicket;
+    m_mapStreaming[uiNewTextureIndex] = dwTicket;
+    m_pStreamer->Push(dwTicket, uiNewTextureIndex, filename, uiFilter, uiWrapMode);
+
+    return uiNewTextureIndex;
+}
+
+bool CGlobalBitmap::IsImageReady(GLuint uiBitmapIndex) const
+{
+    return m_mapBitmap.find(uiBitmapIndex) != m_mapBitmap.end() && m_mapStreaming.find(uiBitmapIndex) == m_mapStreaming.end();
+}
+
+void CGlobalBitmap::SetUploadBudget(DWORD dwBytesPerFrame)
+{
+    m_dwUploadBudget = dwBytesPerFrame;
+}
+
+size_t CGlobalBitmap::GetStreamingQueueDepth() const
+{
+    return m_mapStreaming.size();
+}
+
+DWORD CGlobalBitmap::GetUploadedBytesLastFrame() const
+{
+    return m_dwUploadedBytes;
+}
+
+void CGlobalBitmap::UpdateStreaming()
+{
+    m_dwUploadedBytes = 0;
+
+    if (m_pStreamer == nullptr)
+        return;
+
+    GLint iBoundTexture = 0;
+    bool bUploaded = false;
+
+    // The budget is checked before each upload, so one texture always gets through.
+    CTextureStreamer::REQUEST request;
+    while (m_dwUploadedBytes < m_dwUploadBudget && m_pStreamer->PopCompleted(request))
+    {
+        auto si = m_mapStreaming.find(request.BitmapIndex);
+        if (si == m_mapStreaming.end() || si->second != request.Ticket)
+        {
+            delete[] request.Image.Buffer;
+            continue;
+        }
+        m_mapStreaming.erase(si);
+
+        if (!request.Decoded)
+        {
+            // The worker can lose a race with a file still being patched or scanned; retry
+            // here once like LoadImage would, so the bitmap does not keep the placeholder.
+            delete[] request.Image.Buffer;
+            memset(&request.Image, 0, sizeof(DECODED_IMAGE));
+            if (!DecodeImage(request.FileName, request.Image))
+            {
+                g_ErrorReport.Write(L"Texture streaming failed: %s\r\n", request.FileName.c_str());
+                continue;
+            }
+        }
+
+        if (!bUploaded)
+        {
+            glGetIntegerv(GL_TEXTURE_BINDING_2D, &iBoundTexture);
+            bUploaded = true;
+        }
+
+        m_dwUploadedBytes += request.Image.Width * request.Image.Height * request.Image.Components;
+        UploadTexture(m_mapBitmap[request.BitmapIndex], request.Image, request.Filter, request.Wrap);
+    }
+
+    if (bUploaded)
+    {
+        glBindTexture(GL_TEXTURE_2D, iBoundTexture);
+    }
+}
+
+GLuint CGlobalBitmap::GetPlaceholderTexture()
+{
+    if (m_uiPlaceholderTexture == 0)
+    {
+        const BYTE Grey[4] = { 128, 128, 128, 255 };
+
+        GLint iBoundTexture = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &iBoundTexture);
+
+        glGenTextures(1, &m_uiPlaceholderTexture);
+        glBindTexture(GL_TEXTURE_2D, m_uiPlaceholderTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, 4, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, Grey);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+        glBindTexture(GL_TEXTURE_2D, iBoundTexture);
+    }
+    return m_uiPlaceholderTexture;
+}
+
 BITMAP_t* CGlobalBitmap::GetTexture(GLuint uiBitmapIndex)
 {
     BITMAP_t* pBitmap = NULL;
@@ -525,15 +857,62 @@ BITMAP_t* CGlobalBitmap::FindTextureByName(const std::wstring& name)
     return NULL;
 }
 
+void CGlobalBitmap::SetReleaseUploadedBuffers(bool bRelease)
+{
+    m_bReleaseBuffers = bRelease;
+}
+
+void CGlobalBitmap::KeepBuffer(GLuint uiBitmapIndex)
+{
+    m_setKeepBuffer.insert(uiBitmapIndex);
+}
+
 DWORD CGlobalBitmap::GetUsedTextureMemory() const
 {
     return m_dwUsedTextureMemory;
 }
+DWORD CGlobalBitmap::GetUsedBufferMemory() const
+{
+    return m_dwUsedBufferMemory;
+}
 size_t CGlobalBitmap::GetNumberOfTexture() const
 {
     return m_mapBitmap.size();
 }
 
+void CGlobalBitmap::GetMemoryUsage(CBitmapCache::MEMORY_USAGE (&Usage)[CBitmapCache::NUMBER_OF_CATEGORY]) const
+{
+    memset(Usage, 0, sizeof(Usage));
+
+    for (const auto& bitmap : m_mapBitmap)
+    {
+        const BITMAP_t* pBitmap = bitmap.second;
+        CBitmapCache::MEMORY_USAGE& usage = Usage[m_BitmapCache.GetCategory(bitmap.first)];
+
+        usage.dwCount++;
+        usage.dwGpuBytes += pBitmap->dwTextureBytes;
+        if (pBitmap->Buffer != nullptr)
+        {
+            usage.dwCpuBytes += (DWORD)(pBitmap->Width * pBitmap->Height * pBitmap->Components);
+        }
+    }
+}
+
+void CGlobalBitmap::WriteMemoryReport() const
+{
+    CBitmapCache::MEMORY_USAGE Usage[CBitmapCache::NUMBER_OF_CATEGORY];
+    GetMemoryUsage(Usage);
+
+    g_ErrorReport.Write(L"Texture memory: GPU %u KB, CPU %u KB, %d textures\r\n", m_dwUsedTextureMemory / 1024, m_dwUsedBufferMemory / 1024, (int)GetNumberOfTexture());
+    for (int i = 0; i < CBitmapCache::NUMBER_OF_CATEGORY; i++)
+    {
+        if (Usage[i].dwCount == 0)
+            continue;
+
+        g_ErrorReport.Write(L"  %-10s %5u textures, GPU %7u KB, CPU %7u KB\r\n", CBitmapCache::GetCategoryName(i), Usage[i].dwCount, Usage[i].dwGpuBytes / 1024, Usage[i].dwCpuBytes / 1024);
+    }
+}
+
 void CGlobalBitmap::Manage()
 {
 #ifdef DEBUG_BITMAP_CACHE
@@ -541,8 +920,11 @@ void CGlobalBitmap::Manage()
     if (m_DebugOutputTimer.IsTime())
     {
         g_ConsoleDebug->Write(MCD_NORMAL, L"CacheSize=%d(NumberOfTexture=%d)", m_BitmapCache.GetCacheSize(), GetNumberOfTexture());
+        g_ConsoleDebug->Write(MCD_NORMAL, L"Streaming=%d(UploadedBytes=%d)", GetStreamingQueueDepth(), GetUploadedBytesLastFrame());
+        g_ConsoleDebug->Write(MCD_NORMAL, L"TextureMemory=%dKB(BufferMemory=%dKB)", m_dwUsedTextureMemory / 1024, m_dwUsedBufferMemory / 1024);
     }
 #endif // DEBUG_BITMAP_CACHE
+    UpdateStreaming();
     m_BitmapCache.Update();
 }
 
@@ -570,9 +952,53 @@ GLuint CGlobalBitmap::FindAvailableTextureIndex(GLuint uiSeed)
 
 bool CGlobalBitmap::OpenJpegTurbo(GLuint uiBitmapIndex, const std::wstring& filename, GLuint uiFilter, GLuint uiWrapMode)
 {
-    // create a reuseable buffer with the maximum size of the uncompressed image
-    static unsigned char buffer[MAX_WIDTH * MAX_HEIGHT * 3];
+    DECODED_IMAGE image;
+    if (!DecodeJpeg(filename, image))
+    {
+        return false;
+    }
+    UploadImage(uiBitmapIndex, filename, image, uiFilter, uiWrapMode);
+    return true;
+}
+
+bool CGlobalBitmap::OpenTga(GLuint uiBitmapIndex, const std::wstring& filename, GLuint uiFilter, GLuint uiWrapMode)
+{
+    DECODED_IMAGE image;
+    if (!DecodeTga(filename, image))
+    {
+        return false;
+    }
+    UploadImage(uiBitmapIndex, filename, image, uiFilter, uiWrapMode);
+    return true;
+}
+
+int CGlobalBitmap::RoundUpTextureSize(int size, int maxSize)
+{
+    // rounds up to the next n^2 value, because that's what OpenGL supports
+    int textureSize = 0;
+    for (int i = 1; i <= maxSize; i <<= 1)
+    {
+        textureSize = i;
+        if (i >= size) break;
+    }
+    return textureSize;
+}
+
+bool CGlobalBitmap::DecodeImage(const std::wstring& filename, DECODED_IMAGE& image)
+{
+    std::wstring ext;
+    SplitExt(filename, ext, false);
+
+    if (0 == _wcsicmp(ext.c_str(), L"jpg"))
+        return DecodeJpeg(filename, image);
+    else if (0 == _wcsicmp(ext.c_str(), L"tga"))
+        return DecodeTga(filename, image);
+
+    return false;
+}
 
+bool CGlobalBitmap::DecodeJpeg(const std::wstring& filename, DECODED_IMAGE& image)
+{
     std::wstring filename_ozj;
     ExchangeExt(filename, L"OZJ", filename_ozj);
 
@@ -584,7 +1010,11 @@ bool CGlobalBitmap::OpenJpegTurbo(GLuint uiBitmapIndex, const std::wstring& file
 
     fseek(compressedFile, 0, SEEK_END);
     const auto fileSize = ftell(compressedFile);
-    assert(fileSize > 24);
+    if (fileSize <= 24)
+    {
+        fclose(compressedFile);
+        return false;
+    }
 
     // Skip first 24 bytes, because these are added by the OZJ format
     fseek(compressedFile, 24, SEEK_SET);
@@ -594,110 +1024,38 @@ bool CGlobalBitmap::OpenJpegTurbo(GLuint uiBitmapIndex, const std::wstring& file
     int jpegSubsamp = TJSAMP_444;
     int jpegColorspace = TJCS_RGB;
 
-    auto tjhandle = tjInitDecompress();
-
     auto* jpegBuf = new unsigned char[jpegSize];
     fread(jpegBuf, 1, jpegSize, compressedFile);
     fclose(compressedFile);
 
+    auto tjhandle = GetJpegDecompressor();
+
     // First reading the header with the size information
     auto result = tjDecompressHeader3(tjhandle, jpegBuf, jpegSize, &jpegWidth, &jpegHeight, &jpegSubsamp, &jpegColorspace);
-    if (result != 0)
-    {
-        auto errorstr = tjGetErrorStr();
-        auto errorCode = tjGetErrorCode(compressedFile);
-        assert(false);
-    }
-    //assert(jpegColorspace == TJCS_RGB);
-    assert(jpegWidth <= MAX_WIDTH);
-    assert(jpegHeight <= MAX_HEIGHT);
-
-    // decompress into the buffer
-    result = tjDecompress2(tjhandle, jpegBuf, jpegSize, buffer, jpegWidth, 0, jpegHeight, TJPF_RGB, TJFLAG_FASTDCT);
-    if (result != 0)
+    if (result != 0 || jpegWidth > MAX_WIDTH || jpegHeight > MAX_HEIGHT)
     {
-        auto errorstr = tjGetErrorStr();
-        auto errorCode = tjGetErrorCode(compressedFile);
-        assert(false);
+        delete[] jpegBuf;
+        return false;
     }
-    delete[] jpegBuf;
-    jpegBuf = nullptr;
 
-    // now we can cleanup already
-    tjDestroy(tjhandle);
+    image.Width = RoundUpTextureSize(jpegWidth, MAX_WIDTH);
+    image.Height = RoundUpTextureSize(jpegHeight, MAX_HEIGHT);
+    image.Components = 3;
+    image.Buffer = new BYTE[image.Width * image.Height * image.Components];
 
+    // decompress straight into the texture buffer; the pitch pads each row up to the texture width
+    result = tjDecompress2(tjhandle, jpegBuf, jpegSize, image.Buffer, jpegWidth, image.Width * image.Components, jpegHeight, TJPF_RGB, TJFLAG_FASTDCT);
+    delete[] jpegBuf;
 
-    if (jpegWidth <= MAX_WIDTH && jpegHeight <= MAX_HEIGHT)
+    if (result != 0)
     {
-        // rounds up to the next n^2 value, because that's what OpenGL supports
-        int textureWidth = 0, textureHeight = 0;
-        for (int i = 1; i <= MAX_WIDTH; i <<= 1)
-        {
-            textureWidth = i;
-            if (i >= jpegWidth) break;
-        }
-        for (int i = 1; i <= MAX_HEIGHT; i <<= 1)
-        {
-            textureHeight = i;
-            if (i >= jpegHeight) break;
-        }
-
-        auto* pNewBitmap = new BITMAP_t;
-        memset(pNewBitmap, 0, sizeof(BITMAP_t));
-
-        pNewBitmap->BitmapIndex = uiBitmapIndex;
-
-        wstring_copy_to_buffer(filename, pNewBitmap->FileName, MAX_BITMAP_FILE_NAME);
-
-        pNewBitmap->Width = static_cast<float>(textureWidth);
-        pNewBitmap->Height = static_cast<float>(textureHeight);
-        pNewBitmap->Components = 3;
-        pNewBitmap->Ref = 1;
-
-        const auto textureBufferSize = textureWidth * textureHeight * pNewBitmap->Components;
-        pNewBitmap->Buffer = new BYTE[textureBufferSize];
-        m_dwUsedTextureMemory += textureBufferSize;
-
-        int offset = 0;
-        int jpeg_row_size = jpegWidth * 3;
-        int texture_row_size = textureWidth * 3;
-        int rows = min(jpegHeight, textureHeight);
-        if (jpegWidth != textureWidth)
-        {
-            // we need copy it line by line
-            for (int row = 0; row < rows; row++)
-            {
-                memcpy(&pNewBitmap->Buffer[offset], &buffer[row * jpeg_row_size], jpeg_row_size);
-                offset += texture_row_size;
-            }
-        }
-        else
-        {
-            // we can copy it 1:1
-            memcpy(pNewBitmap->Buffer, buffer, jpegHeight * jpegWidth * 3);
-        }
-
-        m_mapBitmap.insert(type_bitmap_map::value_type(uiBitmapIndex, pNewBitmap));
-
-        glGenTextures(1, &(pNewBitmap->TextureNumber));
-
-        glBindTexture(GL_TEXTURE_2D, pNewBitmap->TextureNumber);
-
-        glTexImage2D(GL_TEXTURE_2D, 0, 3, textureWidth, textureHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, pNewBitmap->Buffer);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, uiFilter);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, uiFilter);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, uiWrapMode);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, uiWrapMode);
+        SAFE_DELETE_ARRAY(image.Buffer);
+        return false;
     }
-
     return true;
 }
 
-bool CGlobalBitmap::OpenTga(GLuint uiBitmapIndex, const std::wstring& filename, GLuint uiFilter, GLuint uiWrapMode)
+bool CGlobalBitmap::DecodeTga(const std::wstring& filename, DECODED_IMAGE& image)
 {
     std::wstring filename_ozt;
     ExchangeExt(filename, L"OZT", filename_ozt);
@@ -729,40 +1087,16 @@ bool CGlobalBitmap::OpenTga(GLuint uiBitmapIndex, const std::wstring& filename,
         return false;
     }
 
-    int Width = 0, Height = 0;
-    for (int i = 1; i <= MAX_WIDTH; i <<= 1)
-    {
-        Width = i;
-        if (i >= nx) break;
-    }
-    for (int i = 1; i <= MAX_HEIGHT; i <<= 1)
-    {
-        Height = i;
-        if (i >= ny) break;
-    }
-
-    auto* pNewBitmap = new BITMAP_t;
-    memset(pNewBitmap, 0, sizeof(BITMAP_t));
-
-    pNewBitmap->BitmapIndex = uiBitmapIndex;
-
-    wstring_copy_to_buffer(filename, pNewBitmap->FileName, MAX_BITMAP_FILE_NAME);
-
-    pNewBitmap->Width = (float)Width;
-    pNewBitmap->Height = (float)Height;
-    pNewBitmap->Components = 4;
-    pNewBitmap->Ref = 1;
-
-    size_t BufferSize = Width * Height * pNewBitmap->Components;
-    pNewBitmap->Buffer = (unsigned char*)new BYTE[BufferSize];
-
-    m_dwUsedTextureMemory += BufferSize;
+    image.Width = RoundUpTextureSize(nx, MAX_WIDTH);
+    image.Height = RoundUpTextureSize(ny, MAX_HEIGHT);
+    image.Components = 4;
+    image.Buffer = new BYTE[image.Width * image.Height * image.Components];
 
     for (int y = 0; y < ny; y++)
     {
         unsigned char* src = &PakBuffer[index];
         index += nx * 4;
-        unsigned char* dst = &pNewBitmap->Buffer[(ny - 1 - y) * Width * pNewBitmap->Components];
+        unsigned char* dst = &image.Buffer[(ny - 1 - y) * image.Width * image.Components];
 
         for (int x = 0; x < nx; x++)
         {
@@ -771,20 +1105,52 @@ bool CGlobalBitmap::OpenTga(GLuint uiBitmapIndex, const std::wstring& filename,
             dst[2] = src[0];
             dst[3] = src[3];
             src += 4;
-            dst += pNewBitmap->Components;
+            dst += image.Components;
         }
     }
     SAFE_DELETE_ARRAY(PakBuffer);
 
+    return true;
+}
+
+void CGlobalBitmap::UploadImage(GLuint uiBitmapIndex, const std::wstring& filename, DECODED_IMAGE& image, GLuint uiFilter, GLuint uiWrapMode)
+{
+    auto* pNewBitmap = new BITMAP_t;
+    memset(pNewBitmap, 0, sizeof(BITMAP_t));
+
+    pNewBitmap->BitmapIndex = uiBitmapIndex;
+
+    wstring_copy_to_buffer(filename, pNewBitmap->FileName, MAX_BITMAP_FILE_NAME);
+
+    pNewBitmap->Ref = 1;
+
     m_mapBitmap.insert(type_bitmap_map::value_type(uiBitmapIndex, pNewBitmap));
 
-    glGenTextures(1, &(pNewBitmap->TextureNumber));
+    UploadTexture(pNewBitmap, image, uiFilter, uiWrapMode);
+}
+
+void CGlobalBitmap::UploadTexture(BITMAP_t* pBitmap, DECODED_IMAGE& image, GLuint uiFilter, GLuint uiWrapMode)
+{
+    pBitmap->Width = static_cast<float>(image.Width);
+    pBitmap->Height = static_cast<float>(image.Height);
+    pBitmap->Components = image.Components;
+    pBitmap->Buffer = image.Buffer;
+    image.Buffer = nullptr;
+
+    glGenTextures(1, &(pBitmap->TextureNumber));
 
-    glBindTexture(GL_TEXTURE_2D, pNewBitmap->TextureNumber);
+    glBindTexture(GL_TEXTURE_2D, pBitmap->TextureNumber);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, 4, Width, Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pNewBitmap->Buffer);
+    if (image.Components == 4)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, 4, image.Width, image.Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pBitmap->Buffer);
 
-    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+        glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    }
+    else
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, 3, image.Width, image.Height, 0, GL_RGB, GL_UNSIGNED_BYTE, pBitmap->Buffer);
+    }
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, uiFilter);
 
@@ -794,6 +1160,91 @@ bool CGlobalBitmap::OpenTga(GLuint uiBitmapIndex, const std::wstring& filename,
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, uiWrapMode);
 
+    pBitmap->dwTextureBytes = GetTextureBytes(image.Width, image.Height);
+    m_dwUsedTextureMemory += pBitmap->dwTextureBytes;
+
+    if (m_bReleaseBuffers && m_setKeepBuffer.find(pBitmap->BitmapIndex) == m_setKeepBuffer.end())
+    {
+        SAFE_DELETE_ARRAY(pBitmap->Buffer);
+    }
+    else
+    {
+        m_dwUsedBufferMemory += image.Width * image.Height * image.Components;
+    }
+}
+
+// Size of the bound texture as the driver stores it. Texels are rounded up to a power
+// of two bytes because RGB8 is laid out as RGBX in video memory.
+DWORD CGlobalBitmap::GetTextureBytes(int Width, int Height)
+{
+    GLint Bits[4] = { 0, 0, 0, 0 };
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_RED_SIZE, &Bits[0]);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_GREEN_SIZE, &Bits[1]);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_BLUE_SIZE, &Bits[2]);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_ALPHA_SIZE, &Bits[3]);
+
+    DWORD dwTexelBytes = (Bits[0] + Bits[1] + Bits[2] + Bits[3] + 7) / 8;
+    if (dwTexelBytes == 0 || dwTexelBytes == 3)
+        dwTexelBytes = 4;
+
+    return dwTexelBytes * Width * Height;
+}
+
+void CGlobalBitmap::PrefetchImages(const std::vector<std::wstring>& filenames)
+{
+    const int count = static_cast<int>(filenames.size());
+    std::vector<DECODED_IMAGE> images(count);
+    std::vector<char> decoded(count, 0);
+
+    JobSystem::Instance()->ParallelFor(count, [&](int i)
+    {
+        decoded[i] = DecodeImage(filenames[i], images[i]) ? 1 : 0;
+    });
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (!decoded[i])
+            continue;
+
+        std::wstring key = filenames[i];
+        std::transform(key.begin(), key.end(), key.begin(), towlower);
+
+        auto mi = m_mapPrefetched.find(key);
+        if (mi != m_mapPrefetched.end())
+        {
+            delete[] mi->second.Buffer;
+            mi->second = images[i];
+        }
+        else
+        {
+            m_mapPrefetched.insert(type_prefetch_map::value_type(key, images[i]));
+        }
+    }
+}
+
+void CGlobalBitmap::ClearPrefetchedImages()
+{
+    for (auto& prefetched : m_mapPrefetched)
+    {
+        delete[] prefetched.second.Buffer;
+    }
+    m_mapPrefetched.clear();
+}
+
+bool CGlobalBitmap::TakePrefetchedImage(const std::wstring& filename, DECODED_IMAGE& image)
+{
+    if (m_mapPrefetched.empty())
+        return false;
+
+    std::wstring key = filename;
+    std::transform(key.begin(), key.end(), key.begin(), towlower);
+
+    auto mi = m_mapPrefetched.find(key);
+    if (mi == m_mapPrefetched.end())
+        return false;
+
+    image = mi->second;
+    m_mapPrefetched.erase(mi);
     return true;
 }
 
@@ -6,7 +6,9 @@
 #pragma warning(disable : 4786)
 
 #include <map>
+#include <set>
 #include <deque>
+#include <memory>
 #include <string>
 #include <setjmp.h>
 #include "./Time/Timer.h"
@@ -29,12 +31,41 @@ typedef struct
 
 private:
     friend class CBitmapCache;
+    friend class CGlobalBitmap;
     DWORD	dwCallCount;
+    DWORD	dwTextureBytes;
 } BITMAP_t;
 #pragma pack(pop)
 
 class CBitmapCache
 {
+public:
+    // Memory report categories: the quick cache ranges followed by the cache maps.
+    enum
+    {
+        CATEGORY_MAPTILE = 0,
+        CATEGORY_MAPGRASS,
+        CATEGORY_WATER,
+        CATEGORY_CURSOR,
+        CATEGORY_FONT,
+        CATEGORY_MAINFRAME,
+        CATEGORY_SKILLICON,
+        CATEGORY_PLAYER,
+        CATEGORY_INTERFACE,
+        CATEGORY_EFFECT,
+        CATEGORY_MAIN,
+
+        NUMBER_OF_CATEGORY,
+    };
+
+    typedef struct
+    {
+        DWORD	dwCount;
+        DWORD	dwCpuBytes;
+        DWORD	dwGpuBytes;
+    } MEMORY_USAGE;
+
+private:
     enum
     {
         QUICK_CACHE_MAPTILE = 0,
@@ -84,6 +115,9 @@ public:
     void Update();
 
     bool Find(GLuint uiBitmapIndex, BITMAP_t** ppBitmap);
+
+    int GetCategory(GLuint uiBitmapIndex) const;
+    static const wchar_t* GetCategoryName(int iCategory);
 };
 
 class CGlobalBitmap
@@ -92,16 +126,49 @@ class CGlobalBitmap
     {
         MAX_WIDTH = 1024,
         MAX_HEIGHT = 1024,
+
+        STREAMING_WORKER_COUNT = 2,
+        DEFAULT_UPLOAD_BUDGET = 2 * 1024 * 1024,
     };
 
+    // CPU side of a texture load. Decoding only touches the file and this struct, so it
+    // may run on a worker; the GL upload (UploadImage) stays on the render thread.
+    typedef struct
+    {
+        int   Width;
+        int   Height;
+        char  Components;
+        BYTE* Buffer;
+    } DECODED_IMAGE;
+
     typedef std::map<GLuint, BITMAP_t*, std::less<GLuint> >	type_bitmap_map;
     typedef std::list<GLuint> type_index_list;
+    typedef std::map<std::wstring, DECODED_IMAGE> type_prefetch_map;
+    typedef std::map<GLuint, DWORD> type_streaming_map;
+
+    class CTextureStreamer;
 
     type_bitmap_map	m_mapBitmap;
     type_index_list m_listNonamedIndex;
+    type_prefetch_map m_mapPrefetched;
+
+    // Bitmaps still showing the placeholder, keyed to the ticket of their decode request.
+    // A result whose ticket no longer matches was unloaded meanwhile and is dropped.
+    std::unique_ptr<CTextureStreamer> m_pStreamer;
+    type_streaming_map m_mapStreaming;
+    DWORD	m_dwStreamTicket;
+    GLuint	m_uiPlaceholderTexture;
+    DWORD	m_dwUploadBudget;
+    DWORD	m_dwUploadedBytes;
+
+    // Bitmaps whose pixels are read or patched after upload (font, guild and castle
+    // marks); their Buffer is kept even when uploaded buffers are released.
+    std::set<GLuint> m_setKeepBuffer;
+    bool	m_bReleaseBuffers;
 
     GLuint	m_uiAlternate, m_uiTextureIndexStream;
     DWORD	m_dwUsedTextureMemory;
+    DWORD	m_dwUsedBufferMemory;
 
     CBitmapCache	m_BitmapCache;
 #ifdef DEBUG_BITMAP_CACHE
@@ -119,13 +186,36 @@ public:
     void UnloadImage(GLuint uiBitmapIndex, bool bForce = false);
     void UnloadAllImages();
 
+    // Like LoadImage(filename), but the file is decoded on a background thread and the
+    // bitmap shows a placeholder until Manage() uploads it. Uploads are capped at the
+    // upload budget per frame so a burst of first-seen textures is spread over frames.
+    GLuint LoadImageAsync(const std::wstring& filename, GLuint uiFilter = GL_NEAREST, GLuint uiWrapMode = GL_CLAMP_TO_EDGE);
+    bool IsImageReady(GLuint uiBitmapIndex) const;
+    void SetUploadBudget(DWORD dwBytesPerFrame);
+    size_t GetStreamingQueueDepth() const;
+    DWORD GetUploadedBytesLastFrame() const;
+
+    // Decodes the files in parallel on the job system. A later LoadImage of one of
+    // them only uploads the decoded pixels; entries nobody asked for are dropped by
+    // ClearPrefetchedImages.
+    void PrefetchImages(const std::vector<std::wstring>& filenames);
+    void ClearPrefetchedImages();
+
     BITMAP_t* GetTexture(GLuint uiBitmapIndex);
     BITMAP_t* FindTexture(GLuint uiBitmapIndex);
     BITMAP_t* FindTexture(const std::wstring& filename);
     BITMAP_t* FindTextureByName(const std::wstring& name);
 
+    // When set, the decoded Buffer of a texture is freed once it is on the GPU, except
+    // for the bitmaps registered with KeepBuffer. Off by default.
+    void SetReleaseUploadedBuffers(bool bRelease);
+    void KeepBuffer(GLuint uiBitmapIndex);
+
     DWORD GetUsedTextureMemory() const;
+    DWORD GetUsedBufferMemory() const;
     size_t GetNumberOfTexture() const;
+    void GetMemoryUsage(CBitmapCache::MEMORY_USAGE (&Usage)[CBitmapCache::NUMBER_OF_CATEGORY]) const;
+    void WriteMemoryReport() const;
 
     bool Convert_Format(const std::wstring& filename);
 
@@ -139,6 +229,16 @@ protected:
 
     bool OpenJpegTurbo(GLuint uiBitmapIndex, const std::wstring& filename, GLuint uiFilter = GL_NEAREST, GLuint uiWrapMode = GL_CLAMP_TO_EDGE);
     bool OpenTga(GLuint uiBitmapIndex, const std::wstring& filename, GLuint uiFilter = GL_NEAREST, GLuint uiWrapMode = GL_CLAMP_TO_EDGE);
+    bool DecodeImage(const std::wstring& filename, DECODED_IMAGE& image);
+    bool DecodeJpeg(const std::wstring& filename, DECODED_IMAGE& image);
+    bool DecodeTga(const std::wstring& filename, DECODED_IMAGE& image);
+    void UploadImage(GLuint uiBitmapIndex, const std::wstring& filename, DECODED_IMAGE& image, GLuint uiFilter, GLuint uiWrapMode);
+    void UploadTexture(BITMAP_t* pBitmap, DECODED_IMAGE& image, GLuint uiFilter, GLuint uiWrapMode);
+    static DWORD GetTextureBytes(int Width, int Height);
+    void UpdateStreaming();
+    GLuint GetPlaceholderTexture();
+    bool TakePrefetchedImage(const std::wstring& filename, DECODED_IMAGE& image);
+    static int RoundUpTextureSize(int size, int maxSize);
     void SplitFileName(IN const std::wstring& filepath, OUT std::wstring& filename, bool bIncludeExt);
     void SplitExt(IN const std::wstring& filepath, OUT std::wstring& ext, bool bIncludeDot);
     void ExchangeExt(IN const std::wstring& in_filepath, IN const std::wstring& ext, OUT std::wstring& out_filepath);
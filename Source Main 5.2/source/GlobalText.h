@@ -1,6 +1,8 @@
 #pragma once
 
-#include "stringset.h"
+#include <map>
+#include <string>
+#include <vector>
 
 template <class T>
 class TGlobalText
@@ -54,11 +56,26 @@ class TGlobalText
         }
     };
 
-    leaf::TStringSet<T>		m_StringSet;
+    typedef std::basic_string<T> string_type;
+
+    struct TEXT_ENTRY
+    {
+        const T*	pszText;
+        DWORD		dwLength;
+    };
+
+    //. Keys below MAX_NUMBER_OF_TEXTS are looked up directly in m_Table. Each Load()
+    //. converts its texts back to back into one pool; texts added at runtime and keys
+    //. outside the table range live in m_mapExtra, whose nodes do not move. Pointers
+    //. handed out by Get() therefore stay valid until that key is removed or replaced.
+    std::vector<TEXT_ENTRY>		m_Table;
+    std::vector<std::vector<T> >	m_Pools;
+    std::map<int, string_type>	m_mapExtra;
+    T							m_szNone[1];
 
 public:
 
-    TGlobalText() {}
+    TGlobalText() { m_szNone[0] = 0; RemoveAll(); }
     ~TGlobalText() { RemoveAll(); }
 
     enum
@@ -84,40 +101,32 @@ public:
 
     bool Load(const std::wstring& strFilePath, DWORD dwLoadDisposition)
     {
-        FILE* fp = _wfopen(strFilePath.c_str(), L"rb");
-        if (NULL == fp)
-            return false;
-
-        GLOBALTEXT_HEADER GTHeader;
-        fread(&GTHeader, sizeof(GLOBALTEXT_HEADER), 1, fp);
-
-        if (GTHeader.wSignature != 0x5447)
+        HANDLE hFile = CreateFileW(strFilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (INVALID_HANDLE_VALUE == hFile)
             return false;
 
-        for (int i = 0; i < (int)(GTHeader.dwNumberOfText); i++)
+        LARGE_INTEGER liFileSize;
+        if (!GetFileSizeEx(hFile, &liFileSize) || liFileSize.QuadPart < (LONGLONG)sizeof(GLOBALTEXT_HEADER))
         {
-            GLOBALTEXT_STRING_HEADER GTStringHeader;
-            fread(&GTStringHeader, sizeof(GLOBALTEXT_STRING_HEADER), 1, fp);
-
-            char* pStringBuffer = new char[GTStringHeader.dwSizeOfString + 1];
-            fread(pStringBuffer, sizeof(char), GTStringHeader.dwSizeOfString, fp);
+            CloseHandle(hFile);
+            return false;
+        }
 
-            if (CheckLoadDisposition(GTStringHeader.dwKey, dwLoadDisposition) || GTStringHeader.dwKey < MAX_NUMBER_OF_TEXTS)
-            {
-                BuxConvert(pStringBuffer, sizeof(char) * GTStringHeader.dwSizeOfString);		//. decoding
-                pStringBuffer[GTStringHeader.dwSizeOfString] = '\0';
+        HANDLE hMapping = CreateFileMappingW(hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+        CloseHandle(hFile);
+        if (NULL == hMapping)
+            return false;
 
-                int wchars_num = MultiByteToWideChar(CP_UTF8, 0, pStringBuffer, -1, NULL, 0);
-                auto* text = new wchar_t[wchars_num];
-                MultiByteToWideChar(CP_UTF8, 0, pStringBuffer, -1, text, wchars_num);
+        //. copy-on-write view: the strings are decoded in place without touching the file
+        PBYTE pbyView = (PBYTE)MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, 0);
+        CloseHandle(hMapping);
+        if (NULL == pbyView)
+            return false;
 
-                m_StringSet.Add(GTStringHeader.dwKey, text);
-            }
+        bool bResult = LoadFromMemory(pbyView, (size_t)liFileSize.QuadPart, dwLoadDisposition);
 
-            delete[] pStringBuffer;
-        }
-        fclose(fp);
-        return true;
+        UnmapViewOfFile(pbyView);
+        return bResult;
     }
     bool Save(const std::wstring& strFilePath)
     {
@@ -127,42 +136,91 @@ public:
 
         GLOBALTEXT_HEADER GTHeader;
         GTHeader.wSignature = 0x5447;
-        GTHeader.dwNumberOfText = m_StringSet.GetCount();
+        GTHeader.dwNumberOfText = (DWORD)GetCount();
         fwrite(&GTHeader, sizeof(GLOBALTEXT_HEADER), 1, fp);
 
-        for (int i = 0; i < GTHeader.dwNumberOfText; i++)
+        for (int key = 0; key < MAX_NUMBER_OF_TEXTS; key++)
         {
-            int key = m_StringSet.GetKey(i);
-            if (-1 == key)
-            {
-                fclose(fp);
-                return false;
-            }
-
-            GLOBALTEXT_STRING_HEADER GTStringHeader;
-            GTStringHeader.dwKey = key;
-            GTStringHeader.dwSizeOfString = m_StringSet.FindObj(key).size();
-
-            fwrite(&GTStringHeader, sizeof(GLOBALTEXT_STRING_HEADER), 1, fp);
+            if (m_Table[key].pszText)
+                SaveString(fp, key, m_Table[key].pszText, m_Table[key].dwLength);
+        }
+        for (auto mi = m_mapExtra.begin(); mi != m_mapExtra.end(); ++mi)
+        {
+            if (!IsTableKey(mi->first))
+                SaveString(fp, mi->first, mi->second.c_str(), (DWORD)mi->second.size());
+        }
+        fclose(fp);
+        return true;
+    }
 
-            T* pStringBuffer = new T[GTStringHeader.dwSizeOfString];
-            memcpy(pStringBuffer, m_StringSet[key], sizeof(T) * GTStringHeader.dwSizeOfString);
+    bool Add(int key, const T* szString)
+    {
+        if (IsTableKey(key) && m_Table[key].pszText)
+            return false;
 
-            BuxConvert(pStringBuffer, sizeof(T) * GTStringHeader.dwSizeOfString);		//. encoding
-            fwrite(pStringBuffer, sizeof(T), GTStringHeader.dwSizeOfString, fp);
+        auto result = m_mapExtra.insert(std::make_pair(key, string_type(szString)));
+        if (!result.second)
+            return false;
 
-            delete[] pStringBuffer;
+        if (IsTableKey(key))
+        {
+            m_Table[key].pszText = result.first->second.c_str();
+            m_Table[key].dwLength = (DWORD)result.first->second.size();
         }
-        fclose(fp);
         return true;
     }
+    bool Remove(int key)
+    {
+        bool bRemoved = false;
+        if (IsTableKey(key) && m_Table[key].pszText)
+        {
+            m_Table[key].pszText = NULL;
+            m_Table[key].dwLength = 0;
+            bRemoved = true;
+        }
+        if (m_mapExtra.erase(key) > 0)
+            bRemoved = true;
+        return bRemoved;
+    }
+    void RemoveAll()
+    {
+        TEXT_ENTRY EmptyEntry = { NULL, 0 };
+        m_Table.assign(MAX_NUMBER_OF_TEXTS, EmptyEntry);
+        m_Pools.clear();
+        m_mapExtra.clear();
+    }
 
-    bool Add(int key, const T* szString) { return m_StringSet.Add(key, szString); }
-    bool Remove(int key) { return m_StringSet.Remove(key); }
-    void RemoveAll() { m_StringSet.RemoveAll(); }
+    const T* Get(int key)
+    {
+        if (IsTableKey(key))
+            return m_Table[key].pszText ? m_Table[key].pszText : m_szNone;
 
-    const T* Get(int key) { return m_StringSet[key]; }
-    size_t GetStringSize(int key) { return m_StringSet.FindObj(key).size(); }
+        auto mi = m_mapExtra.find(key);
+        return (mi != m_mapExtra.end()) ? mi->second.c_str() : m_szNone;
+    }
+    size_t GetStringSize(int key)
+    {
+        if (IsTableKey(key))
+            return m_Table[key].dwLength;
+
+        auto mi = m_mapExtra.find(key);
+        return (mi != m_mapExtra.end()) ? mi->second.size() : 0;
+    }
+    size_t GetCount()
+    {
+        size_t count = 0;
+        for (int key = 0; key < MAX_NUMBER_OF_TEXTS; key++)
+        {
+            if (m_Table[key].pszText)
+                count++;
+        }
+        for (auto mi = m_mapExtra.begin(); mi != m_mapExtra.end(); ++mi)
+        {
+            if (!IsTableKey(mi->first))
+                count++;
+        }
+        return count;
+    }
 
     WORD GetNumCountryCode(const std::wstring& strAlpha3Code)
     {	//. strAlpha3Code: Official Alpha-3 Code
@@ -186,6 +244,120 @@ public:
     }
 
 protected:
+    static bool IsTableKey(int key) { return (key >= 0 && key < MAX_NUMBER_OF_TEXTS); }
+
+    bool LoadFromMemory(PBYTE pbyData, size_t uiSize, DWORD dwLoadDisposition)
+    {
+        const GLOBALTEXT_HEADER* pGTHeader = (const GLOBALTEXT_HEADER*)pbyData;
+        if (pGTHeader->wSignature != 0x5447)
+            return false;
+
+        struct LOADED_TEXT
+        {
+            int		iKey;
+            char*	pszSource;
+            int		iSourceLength;
+            size_t	uiOffset;
+            int		iLength;
+        };
+        std::vector<LOADED_TEXT> vecTexts;
+        vecTexts.reserve(pGTHeader->dwNumberOfText);
+
+        //. first pass: decode each accepted string in place and measure it
+        bool bResult = true;
+        size_t uiPos = sizeof(GLOBALTEXT_HEADER);
+        size_t uiPoolSize = 0;
+        for (DWORD i = 0; i < pGTHeader->dwNumberOfText; i++)
+        {
+            if (uiSize - uiPos < sizeof(GLOBALTEXT_STRING_HEADER))
+            {
+                bResult = false;
+                break;
+            }
+            const GLOBALTEXT_STRING_HEADER* pGTStringHeader = (const GLOBALTEXT_STRING_HEADER*)(pbyData + uiPos);
+            uiPos += sizeof(GLOBALTEXT_STRING_HEADER);
+
+            if (uiSize - uiPos < pGTStringHeader->dwSizeOfString)
+            {
+                bResult = false;
+                break;
+            }
+            char* pszSource = (char*)(pbyData + uiPos);
+            uiPos += pGTStringHeader->dwSizeOfString;
+
+            int key = (int)pGTStringHeader->dwKey;
+            if (pGTStringHeader->dwKey >= MAX_NUMBER_OF_TEXTS && !CheckLoadDisposition(key, dwLoadDisposition))
+                continue;
+
+            //. the first text with a given key wins; reserve the key until the pool is built
+            if (IsTableKey(key))
+            {
+                if (m_Table[key].pszText)
+                    continue;
+                m_Table[key].pszText = m_szNone;
+            }
+            else if (!m_mapExtra.insert(std::make_pair(key, string_type())).second)
+            {
+                continue;
+            }
+
+            BuxConvert(pszSource, pGTStringHeader->dwSizeOfString);		//. decoding
+
+            LOADED_TEXT Text;
+            Text.iKey = key;
+            Text.pszSource = pszSource;
+            Text.iSourceLength = (int)strnlen(pszSource, pGTStringHeader->dwSizeOfString);
+            Text.uiOffset = uiPoolSize;
+            Text.iLength = (Text.iSourceLength > 0) ? MultiByteToWideChar(CP_UTF8, 0, pszSource, Text.iSourceLength, NULL, 0) : 0;
+            uiPoolSize += Text.iLength + 1;
+            vecTexts.push_back(Text);
+        }
+
+        //. second pass: convert everything into one pool, then publish the pointers
+        std::vector<T> vecPool(uiPoolSize);
+        for (size_t i = 0; i < vecTexts.size(); i++)
+        {
+            LOADED_TEXT& Text = vecTexts[i];
+            if (Text.iLength > 0)
+                MultiByteToWideChar(CP_UTF8, 0, Text.pszSource, Text.iSourceLength, &vecPool[Text.uiOffset], Text.iLength);
+            vecPool[Text.uiOffset + Text.iLength] = 0;
+        }
+
+        for (size_t i = 0; i < vecTexts.size(); i++)
+        {
+            const LOADED_TEXT& Text = vecTexts[i];
+            const T* pszText = &vecPool[Text.uiOffset];
+            if (IsTableKey(Text.iKey))
+            {
+                m_Table[Text.iKey].pszText = pszText;
+                m_Table[Text.iKey].dwLength = (DWORD)Text.iLength;
+            }
+            else
+            {
+                m_mapExtra[Text.iKey].assign(pszText, Text.iLength);
+            }
+        }
+        if (!vecPool.empty())
+            m_Pools.push_back(std::move(vecPool));
+
+        return bResult;
+    }
+    void SaveString(FILE* fp, int key, const T* pszText, DWORD dwLength)
+    {
+        GLOBALTEXT_STRING_HEADER GTStringHeader;
+        GTStringHeader.dwKey = key;
+        GTStringHeader.dwSizeOfString = dwLength;
+
+        fwrite(&GTStringHeader, sizeof(GLOBALTEXT_STRING_HEADER), 1, fp);
+
+        T* pStringBuffer = new T[GTStringHeader.dwSizeOfString];
+        memcpy(pStringBuffer, pszText, sizeof(T) * GTStringHeader.dwSizeOfString);
+
+        BuxConvert(pStringBuffer, sizeof(T) * GTStringHeader.dwSizeOfString);		//. encoding
+        fwrite(pStringBuffer, sizeof(T), GTStringHeader.dwSizeOfString, fp);
+
+        delete[] pStringBuffer;
+    }
     void BuxConvert(PVOID pvBuffer, DWORD dwSize)
     {
         PBYTE pbyBuffer = (PBYTE)(pvBuffer);
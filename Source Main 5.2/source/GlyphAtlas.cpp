@@ -0,0 +1,275 @@
+///////////////////////////////////////////////////////////////////////////////
+// Glyph atlas for GDI-rasterized UI text
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GlyphAtlas.h"
+
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE 0x812F
+#endif
+
+namespace
+{
+    const int GLYPH_ATLAS_SIZE = 1024;
+    const size_t MAX_TEXT_LAYOUTS = 4096;
+
+    // Scripts whose glyphs combine or reorder can't be drawn one character at a time;
+    // such strings keep going through TextOut.
+    bool RequiresShaping(const wchar_t* pszText)
+    {
+        for (; *pszText != L'\0'; ++pszText)
+        {
+            const wchar_t ch = *pszText;
+            if ((ch >= 0x0300 && ch <= 0x036F)		// combining diacritics
+                || (ch >= 0x0590 && ch <= 0x08FF)	// hebrew, arabic, syriac
+                || (ch >= 0x0900 && ch <= 0x0EFF)	// indic, thai, lao
+                || (ch >= 0x1100 && ch <= 0x11FF)	// hangul jamo
+                || (ch >= 0xD800 && ch <= 0xDFFF)	// surrogate pairs
+                || (ch >= 0xFB1D && ch <= 0xFEFF))	// presentation forms
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+CGlyphAtlas::CGlyphAtlas()
+{
+    m_hFontDC = nullptr;
+    m_pFontBuffer = nullptr;
+    m_iPitch = 0;
+    m_pfnBind = nullptr;
+    m_uiTexture = 0;
+    m_bTextureFailed = false;
+    m_iAtlasX = m_iAtlasY = m_iAtlasRowHeight = 0;
+    m_uiTextLayoutCount = 0;
+}
+CGlyphAtlas::~CGlyphAtlas() { Release(); }
+
+void CGlyphAtlas::Create(HDC hFontDC, const BYTE* pFontBuffer, int iPitch, BindFunc pfnBind)
+{
+    m_hFontDC = hFontDC;
+    m_pFontBuffer = pFontBuffer;
+    m_iPitch = iPitch;
+    m_pfnBind = pfnBind;
+}
+
+void CGlyphAtlas::Release()
+{
+    if (m_uiTexture != 0)
+    {
+        if (wglGetCurrentContext() != nullptr)
+            glDeleteTextures(1, &m_uiTexture);
+        m_uiTexture = 0;
+    }
+    m_bTextureFailed = false;
+    Reset();
+
+    m_hFontDC = nullptr;
+    m_pFontBuffer = nullptr;
+}
+
+bool CGlyphAtlas::CreateTexture()
+{
+    if (m_uiTexture != 0)
+        return true;
+    if (m_hFontDC == nullptr || m_bTextureFailed)
+        return false;
+
+    std::vector<BYTE> Empty(GLYPH_ATLAS_SIZE * GLYPH_ATLAS_SIZE * 2, 0);
+
+    glGenTextures(1, &m_uiTexture);
+    m_pfnBind(m_uiTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE_ALPHA, GLYPH_ATLAS_SIZE, GLYPH_ATLAS_SIZE, 0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, Empty.data());
+
+    if (glGetError() != GL_NO_ERROR)
+    {
+        glDeleteTextures(1, &m_uiTexture);
+        m_uiTexture = 0;
+        m_bTextureFailed = true;
+        return false;
+    }
+    return true;
+}
+
+void CGlyphAtlas::Reset()
+{
+    m_iAtlasX = m_iAtlasY = m_iAtlasRowHeight = 0;
+    m_Glyphs.clear();
+    m_GlyphIndex.clear();
+    m_TextLayouts.clear();
+    m_uiTextLayoutCount = 0;
+}
+
+/// \brief Rasterizes one character of the current font into the glyph atlas. Returns -1 when the atlas is full.
+int CGlyphAtlas::CacheGlyph(HFONT hFont, wchar_t ch)
+{
+    const auto Key = std::make_pair(hFont, ch);
+    const auto it = m_GlyphIndex.find(Key);
+    if (it != m_GlyphIndex.end())
+        return it->second;
+
+    SIZE Size;
+    GetTextExtentPoint32W(m_hFontDC, &ch, 1, &Size);
+
+    GLYPH_INFO Glyph = { 0, 0, (short)Size.cx, (short)Size.cy };
+    if (Size.cx > 0 && Size.cy > 0)
+    {
+        if (m_iAtlasX + Size.cx > GLYPH_ATLAS_SIZE)
+        {
+            m_iAtlasX = 0;
+            m_iAtlasY += m_iAtlasRowHeight;
+            m_iAtlasRowHeight = 0;
+        }
+        if (Size.cx > GLYPH_ATLAS_SIZE || m_iAtlasY + Size.cy > GLYPH_ATLAS_SIZE)
+            return -1;
+
+        RECT rc = { 0, 0, Size.cx, Size.cy };
+        ::SetBkColor(m_hFontDC, RGB(0, 0, 0));
+        ::SetTextColor(m_hFontDC, RGB(255, 255, 255));
+        ExtTextOutW(m_hFontDC, 0, 0, ETO_OPAQUE, &rc, &ch, 1, nullptr);
+        GdiFlush();
+
+        // white luminance with the coverage in alpha, so the text color can be applied per vertex
+        std::vector<BYTE> Pixels(Size.cx * Size.cy * 2);
+        for (int y = 0; y < Size.cy; ++y)
+        {
+            const BYTE* pSrc = m_pFontBuffer + y * m_iPitch;
+            BYTE* pDst = &Pixels[y * Size.cx * 2];
+            for (int x = 0; x < Size.cx; ++x, pSrc += 3, pDst += 2)
+            {
+                pDst[0] = 255;
+                pDst[1] = (BYTE)((pSrc[0] + pSrc[1] + pSrc[2]) / 3);
+            }
+        }
+
+        Glyph.x = (short)m_iAtlasX;
+        Glyph.y = (short)m_iAtlasY;
+
+        m_pfnBind(m_uiTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, Glyph.x, Glyph.y, Size.cx, Size.cy, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, Pixels.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        m_iAtlasX += Size.cx;
+        if (Size.cy > m_iAtlasRowHeight)
+            m_iAtlasRowHeight = Size.cy;
+    }
+
+    m_Glyphs.push_back(Glyph);
+    m_GlyphIndex[Key] = (int)m_Glyphs.size() - 1;
+    return (int)m_Glyphs.size() - 1;
+}
+
+const CGlyphAtlas::TEXT_LAYOUT* CGlyphAtlas::GetTextLayout(const wchar_t* pszText)
+{
+    if (!CreateTexture() || RequiresShaping(pszText))
+        return nullptr;
+
+    const auto hFont = (HFONT)GetCurrentObject(m_hFontDC, OBJ_FONT);
+    TextLayoutMap& Layouts = m_TextLayouts[hFont];
+
+    const auto it = Layouts.find(pszText);
+    if (it != Layouts.end())
+        return &it->second;
+
+    const int iLength = (int)wcslen(pszText);
+    TEXT_LAYOUT Layout;
+
+    if (iLength == 0)
+    {
+        GetTextExtentPoint32W(m_hFontDC, L"0", 1, &Layout.Size);
+    }
+    else
+    {
+        // cumulative extents, so the pen positions match TextOut of the whole string
+        std::vector<int> Extents(iLength);
+        GetTextExtentExPointW(m_hFontDC, pszText, iLength, 0, nullptr, Extents.data(), &Layout.Size);
+
+        const bool bEmptyAtlas = m_Glyphs.empty();
+        Layout.Glyphs.reserve(iLength);
+        for (int i = 0; i < iLength; ++i)
+        {
+            const int iGlyph = CacheGlyph(hFont, pszText[i]);
+            if (iGlyph < 0)
+            {
+                // atlas is full: start over, which also drops every layout built so far
+                if (bEmptyAtlas)
+                    return nullptr;
+                Reset();
+                return GetTextLayout(pszText);
+            }
+
+            const GLYPH_PLACEMENT Placement = { i > 0 ? Extents[i - 1] : 0, iGlyph };
+            Layout.Glyphs.push_back(Placement);
+        }
+    }
+
+    if (m_uiTextLayoutCount >= MAX_TEXT_LAYOUTS)
+    {
+        for (auto& FontLayouts : m_TextLayouts)
+            FontLayouts.second.clear();
+        m_uiTextLayoutCount = 0;
+    }
+
+    ++m_uiTextLayoutCount;
+    return &(m_TextLayouts[hFont][pszText] = std::move(Layout));
+}
+
+void CGlyphAtlas::RenderGlyphs(const TEXT_LAYOUT* pLayout, float x, float Top, int iClipMove, int iWidth, int iHeight, DWORD dwTextColor)
+{
+    if (pLayout->Glyphs.empty())
+        return;
+
+    float CurrentColor[4];
+    glGetFloatv(GL_CURRENT_COLOR, CurrentColor);
+
+    m_pfnBind(m_uiTexture);
+    glColor4f(CurrentColor[0] * (dwTextColor & 0xFF) / 255.f, CurrentColor[1] * ((dwTextColor >> 8) & 0xFF) / 255.f,
+        CurrentColor[2] * ((dwTextColor >> 16) & 0xFF) / 255.f, CurrentColor[3] * ((dwTextColor >> 24) & 0xFF) / 255.f);
+
+    const float InvSize = 1.f / GLYPH_ATLAS_SIZE;
+
+    glBegin(GL_QUADS);
+    for (const GLYPH_PLACEMENT& Placement : pLayout->Glyphs)
+    {
+        const GLYPH_INFO& Glyph = m_Glyphs[Placement.Glyph];
+        if (Glyph.Width <= 0)
+            continue;
+
+        float x0 = (float)(Placement.PenX - iClipMove);
+        float x1 = x0 + Glyph.Width;
+        if (x1 <= 0.f || x0 >= iWidth)
+            continue;
+
+        float u0 = Glyph.x, u1 = (float)(Glyph.x + Glyph.Width);
+        if (x0 < 0.f)
+        {
+            u0 -= x0;
+            x0 = 0.f;
+        }
+        if (x1 > iWidth)
+        {
+            u1 -= x1 - iWidth;
+            x1 = (float)iWidth;
+        }
+
+        const int iGlyphHeight = Glyph.Height < iHeight ? Glyph.Height : iHeight;
+        const float v0 = Glyph.y * InvSize, v1 = (Glyph.y + iGlyphHeight) * InvSize;
+        u0 *= InvSize;
+        u1 *= InvSize;
+
+        glTexCoord2f(u0, v0); glVertex2f(x + x0, Top);
+        glTexCoord2f(u0, v1); glVertex2f(x + x0, Top - iGlyphHeight);
+        glTexCoord2f(u1, v1); glVertex2f(x + x1, Top - iGlyphHeight);
+        glTexCoord2f(u1, v0); glVertex2f(x + x1, Top);
+    }
+    glEnd();
+
+    glColor4fv(CurrentColor);
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+// Glyph atlas behind CUIRenderTextOriginal.
+//
+// Each character of a font is rasterized with GDI once into a shared 1024x1024
+// luminance/alpha texture; strings are laid out once per (font, text) and then drawn as
+// one batch of textured quads per call, so steady-state UI text uploads nothing.
+// Strings that need shaping (combining marks, RTL, Indic/Thai scripts, surrogate pairs)
+// get no layout and keep going through TextOut.
+//
+// Only GDI and OpenGL 1.1 are used here (no stdafx.h), so bench_text.cpp in the
+// repository root builds the same code on its own.
+
+#include <windows.h>
+#include <GL/gl.h>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class CGlyphAtlas
+{
+public:
+    struct GLYPH_INFO
+    {
+        short x, y;
+        short Width, Height;
+    };
+
+    struct GLYPH_PLACEMENT
+    {
+        int PenX;
+        int Glyph;
+    };
+
+    struct TEXT_LAYOUT
+    {
+        SIZE Size;
+        std::vector<GLYPH_PLACEMENT> Glyphs;
+    };
+
+    // Binds the atlas texture; the client goes through BindTexture so its cache stays valid.
+    typedef void (*BindFunc)(GLuint uiTexture);
+
+    CGlyphAtlas();
+    ~CGlyphAtlas();
+
+    // hFontDC renders into the 24 bit DIB pFontBuffer, iPitch bytes per row.
+    void Create(HDC hFontDC, const BYTE* pFontBuffer, int iPitch, BindFunc pfnBind);
+    void Release();
+
+    // Creates the texture on first use; false when the context refused it. A refusal sticks
+    // until Release, so later calls fail without touching GL again.
+    bool CreateTexture();
+    bool IsTextureFailed() const { return m_bTextureFailed; }
+    void Reset();
+
+    // The cached layout of pszText in the font selected into the DC, or nullptr when it
+    // has to go through TextOut.
+    const TEXT_LAYOUT* GetTextLayout(const wchar_t* pszText);
+
+    // Draws a layout as one batch of quads, clipped to [iClipMove, iClipMove + iWidth) like
+    // the TextOut path. Top is the GL y of the first row; dwTextColor (RGBA, red in the low
+    // byte) is multiplied with the current colour.
+    void RenderGlyphs(const TEXT_LAYOUT* pLayout, float x, float Top, int iClipMove, int iWidth, int iHeight, DWORD dwTextColor);
+
+    // Glyphs rasterized (and uploaded) since the last Reset.
+    size_t GetGlyphCount() const { return m_Glyphs.size(); }
+
+private:
+    typedef std::unordered_map<std::wstring, TEXT_LAYOUT> TextLayoutMap;
+
+    int CacheGlyph(HFONT hFont, wchar_t ch);
+
+    HDC m_hFontDC;
+    const BYTE* m_pFontBuffer;
+    int m_iPitch;
+    BindFunc m_pfnBind;
+
+    GLuint m_uiTexture;
+    bool m_bTextureFailed;
+    int m_iAtlasX, m_iAtlasY, m_iAtlasRowHeight;
+    std::vector<GLYPH_INFO> m_Glyphs;
+    std::map<std::pair<HFONT, wchar_t>, int> m_GlyphIndex;
+    std::map<HFONT, TextLayoutMap> m_TextLayouts;
+    size_t m_uiTextLayoutCount;
+};
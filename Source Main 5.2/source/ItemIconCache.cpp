@@ -0,0 +1,351 @@
+///////////////////////////////////////////////////////////////////////////////
+// Cached item icons
+///////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include <unordered_map>
+#include "ItemIconCache.h"
+#include "RenderQueue.h"
+#include "ZzzInventory.h"
+#include "ZzzOpenglUtil.h"
+#include "./Utilities/Profiler.h"
+
+bool g_bUseItemIconCache = true;
+
+namespace
+{
+    // Entry points are resolved by hand like the ones in MeshBuffer.cpp; the client does
+    // not initialise GLEW.
+    PFNGLGENFRAMEBUFFERSPROC         pglGenFramebuffers = nullptr;
+    PFNGLDELETEFRAMEBUFFERSPROC      pglDeleteFramebuffers = nullptr;
+    PFNGLBINDFRAMEBUFFERPROC         pglBindFramebuffer = nullptr;
+    PFNGLFRAMEBUFFERTEXTURE2DPROC    pglFramebufferTexture2D = nullptr;
+    PFNGLCHECKFRAMEBUFFERSTATUSPROC  pglCheckFramebufferStatus = nullptr;
+    PFNGLGENRENDERBUFFERSPROC        pglGenRenderbuffers = nullptr;
+    PFNGLDELETERENDERBUFFERSPROC     pglDeleteRenderbuffers = nullptr;
+    PFNGLBINDRENDERBUFFERPROC        pglBindRenderbuffer = nullptr;
+    PFNGLRENDERBUFFERSTORAGEPROC     pglRenderbufferStorage = nullptr;
+    PFNGLFRAMEBUFFERRENDERBUFFERPROC pglFramebufferRenderbuffer = nullptr;
+
+    enum
+    {
+        MAX_ATLAS_SIZE = 2048,
+    };
+
+    // room around the slot for models that reach past it, in 640x480 units
+    constexpr float ICON_PADDING = 10.f;
+
+    struct ITEM_ICON
+    {
+        int X, Y;           // cell in the atlas, bottom-left origin
+        int Width, Height;
+    };
+
+    struct ICON_SHELF
+    {
+        int Y;
+        int Height;
+        int Used;
+    };
+
+    struct ICON_QUAD
+    {
+        float X, Y;         // top-left corner in window pixels, bottom-left origin
+        float Width, Height;
+        float U0, V0, U1, V1;
+    };
+
+    bool   s_bAvailable = false;
+    GLuint s_Framebuffer = 0;
+    GLuint s_DepthBuffer = 0;
+    GLuint s_AtlasTexture = 0;
+    int    s_AtlasSize = 0;
+
+    // the icons were drawn for this window size
+    unsigned int s_AtlasWindowWidth = 0;
+    unsigned int s_AtlasWindowHeight = 0;
+
+    std::unordered_map<unsigned long long, ITEM_ICON> s_Icons;
+    std::vector<ICON_SHELF> s_Shelves;
+    int  s_ShelfTop = 0;
+    bool s_bAtlasFull = false;
+
+    std::vector<ICON_QUAD> s_Quads;
+
+    template <typename T>
+    bool LoadProc(T& proc, const char* name, const char* extName)
+    {
+        proc = reinterpret_cast<T>(wglGetProcAddress(name));
+        if (proc == nullptr)
+            proc = reinterpret_cast<T>(wglGetProcAddress(extName));
+        return proc != nullptr;
+    }
+
+    unsigned long long MakeIconKey(int Type, int Level, bool Excellent, bool Ancient, int Width, int Height)
+    {
+        unsigned long long key = static_cast<unsigned short>(Type);
+        key = (key << 8) | static_cast<unsigned char>(Level);
+        key = (key << 1) | (Excellent ? 1 : 0);
+        key = (key << 1) | (Ancient ? 1 : 0);
+        key = (key << 12) | (Width & 0xFFF);
+        key = (key << 12) | (Height & 0xFFF);
+        return key;
+    }
+
+    // RenderObjectScreen turns these even when they are not hovered
+    bool IsTurningItem(int Type)
+    {
+        return (Type >= ITEM_HELPER + 71 && Type <= ITEM_HELPER + 75) || Type == ITEM_POTION + 100;
+    }
+
+    void ResetAtlas()
+    {
+        s_Icons.clear();
+        s_Shelves.clear();
+        s_ShelfTop = 0;
+        s_bAtlasFull = false;
+        s_AtlasWindowWidth = WindowWidth;
+        s_AtlasWindowHeight = WindowHeight;
+    }
+
+    bool AllocateCell(int Width, int Height, ITEM_ICON& icon)
+    {
+        if (Width > s_AtlasSize || Height > s_AtlasSize)
+            return false;
+
+        // the lowest shelf that is tall enough without wasting more than a quarter of it
+        ICON_SHELF* best = nullptr;
+        for (ICON_SHELF& shelf : s_Shelves)
+        {
+            if (shelf.Height < Height || shelf.Height > Height + Height / 4 || shelf.Used + Width > s_AtlasSize)
+                continue;
+            if (best == nullptr || shelf.Height < best->Height)
+                best = &shelf;
+        }
+
+        if (best == nullptr)
+        {
+            if (s_ShelfTop + Height > s_AtlasSize)
+                return false;
+
+            s_Shelves.push_back({ s_ShelfTop, Height, 0 });
+            s_ShelfTop += Height;
+            best = &s_Shelves.back();
+        }
+
+        icon.X = best->Used;
+        icon.Y = best->Y;
+        icon.Width = Width;
+        icon.Height = Height;
+        best->Used += Width;
+        return true;
+    }
+
+    void DrawIcon(const ITEM_ICON& icon, float Width, float Height, int Type, int Level, int excellentFlags, int ancientDiscriminator)
+    {
+        PROFILE_SCOPE("DrawItemIcon");
+
+        GLint viewport[4];
+        GLint scissorBox[4];
+        GLfloat clearColor[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glGetIntegerv(GL_SCISSOR_BOX, scissorBox);
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+        const GLboolean scissorTest = glIsEnabled(GL_SCISSOR_TEST);
+
+        pglBindFramebuffer(GL_FRAMEBUFFER, s_Framebuffer);
+
+        // The item is drawn ICON_PADDING in from the top-left corner of the screen; the
+        // item camera's viewport is moved so that the padded slot lands on the cell.
+        glViewport(icon.X, icon.Y + icon.Height - static_cast<int>(WindowHeight), WindowWidth, WindowHeight);
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(icon.X, icon.Y, icon.Width, icon.Height);
+
+        EnableDepthMask();
+        glClearColor(0.f, 0.f, 0.f, 0.f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        SetPremultipliedBlendTarget(true);
+        glColor4f(1.f, 1.f, 1.f, 1.f);
+        RenderItem3DModel(ICON_PADDING, ICON_PADDING, Width, Height, Type, Level, excellentFlags, ancientDiscriminator, false, false);
+        SetPremultipliedBlendTarget(false);
+
+        pglBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glScissor(scissorBox[0], scissorBox[1], scissorBox[2], scissorBox[3]);
+        if (!scissorTest)
+        {
+            glDisable(GL_SCISSOR_TEST);
+        }
+        glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+        glColor4f(1.f, 1.f, 1.f, 1.f);
+    }
+}
+
+void InitItemIconCache()
+{
+    s_bAvailable = false;
+
+    bool loaded = LoadProc(pglGenFramebuffers, "glGenFramebuffers", "glGenFramebuffersEXT")
+        && LoadProc(pglDeleteFramebuffers, "glDeleteFramebuffers", "glDeleteFramebuffersEXT")
+        && LoadProc(pglBindFramebuffer, "glBindFramebuffer", "glBindFramebufferEXT")
+        && LoadProc(pglFramebufferTexture2D, "glFramebufferTexture2D", "glFramebufferTexture2DEXT")
+        && LoadProc(pglCheckFramebufferStatus, "glCheckFramebufferStatus", "glCheckFramebufferStatusEXT")
+        && LoadProc(pglGenRenderbuffers, "glGenRenderbuffers", "glGenRenderbuffersEXT")
+        && LoadProc(pglDeleteRenderbuffers, "glDeleteRenderbuffers", "glDeleteRenderbuffersEXT")
+        && LoadProc(pglBindRenderbuffer, "glBindRenderbuffer", "glBindRenderbufferEXT")
+        && LoadProc(pglRenderbufferStorage, "glRenderbufferStorage", "glRenderbufferStorageEXT")
+        && LoadProc(pglFramebufferRenderbuffer, "glFramebufferRenderbuffer", "glFramebufferRenderbufferEXT");
+
+    // also resolves the blend entry points the icons are drawn with
+    if (!loaded || !SetPremultipliedBlendTarget(true))
+    {
+        g_ErrorReport.Write(L"> Item icon cache unavailable, drawing items live.\r\n");
+        return;
+    }
+    SetPremultipliedBlendTarget(false);
+
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    s_AtlasSize = std::min(static_cast<int>(MAX_ATLAS_SIZE), static_cast<int>(maxTextureSize));
+
+    glGenTextures(1, &s_AtlasTexture);
+    glBindTexture(GL_TEXTURE_2D, s_AtlasTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, s_AtlasSize, s_AtlasSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    // BindTexture's cache no longer matches what is bound
+    BindTexture(-static_cast<int>(s_AtlasTexture));
+
+    pglGenRenderbuffers(1, &s_DepthBuffer);
+    pglBindRenderbuffer(GL_RENDERBUFFER, s_DepthBuffer);
+    pglRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, s_AtlasSize, s_AtlasSize);
+    pglBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    pglGenFramebuffers(1, &s_Framebuffer);
+    pglBindFramebuffer(GL_FRAMEBUFFER, s_Framebuffer);
+    pglFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, s_AtlasTexture, 0);
+    pglFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, s_DepthBuffer);
+    const GLenum status = pglCheckFramebufferStatus(GL_FRAMEBUFFER);
+    pglBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        g_ErrorReport.Write(L"> Item icon framebuffer incomplete (0x%04X), drawing items live.\r\n", status);
+        ReleaseItemIconCache();
+        return;
+    }
+
+    ResetAtlas();
+    s_bAvailable = true;
+}
+
+void ReleaseItemIconCache()
+{
+    if (s_Framebuffer != 0)
+        pglDeleteFramebuffers(1, &s_Framebuffer);
+    if (s_DepthBuffer != 0)
+        pglDeleteRenderbuffers(1, &s_DepthBuffer);
+    if (s_AtlasTexture != 0)
+        glDeleteTextures(1, &s_AtlasTexture);
+
+    s_Framebuffer = 0;
+    s_DepthBuffer = 0;
+    s_AtlasTexture = 0;
+    s_bAvailable = false;
+
+    s_Icons.clear();
+    s_Shelves.clear();
+    s_Quads.clear();
+}
+
+bool RenderItemIcon(float sx, float sy, float Width, float Height, int Type, int Level, int excellentFlags, int ancientDiscriminator)
+{
+    if (!g_bUseItemIconCache || !s_bAvailable)
+        return false;
+
+    if (IsItem3DSelected(sx, sy, Width, Height, false) || IsTurningItem(Type))
+        return false;
+
+    if (s_AtlasWindowWidth != WindowWidth || s_AtlasWindowHeight != WindowHeight)
+    {
+        // cells queued this frame still hold the old icons
+        if (!s_Quads.empty())
+            return false;
+        ResetAtlas();
+    }
+
+    const float padding[2] = { ConvertX(ICON_PADDING), ConvertY(ICON_PADDING) };
+    const int width = static_cast<int>(ceilf(ConvertX(Width + ICON_PADDING * 2.f)));
+    const int height = static_cast<int>(ceilf(ConvertY(Height + ICON_PADDING * 2.f)));
+
+    // only the glow passes of RenderPartObjectEffect look at the flags
+    const bool excellent = (excellentFlags & 63) > 0;
+    const bool ancient = ancientDiscriminator > 0;
+    const unsigned long long key = MakeIconKey(Type, Level, excellent, ancient, width, height);
+
+    auto it = s_Icons.find(key);
+    if (it == s_Icons.end())
+    {
+        ITEM_ICON icon;
+        if (s_bAtlasFull || !AllocateCell(width, height, icon))
+        {
+            s_bAtlasFull = true;
+            return false;
+        }
+
+        DrawIcon(icon, Width, Height, Type, Level, excellentFlags, ancientDiscriminator);
+        it = s_Icons.emplace(key, icon).first;
+    }
+
+    const ITEM_ICON& icon = it->second;
+    const float scale = 1.f / s_AtlasSize;
+
+    ICON_QUAD quad;
+    quad.X = floorf(ConvertX(sx) - padding[0] + 0.5f);
+    quad.Y = floorf(WindowHeight - ConvertY(sy) + padding[1] + 0.5f);
+    quad.Width = static_cast<float>(icon.Width);
+    quad.Height = static_cast<float>(icon.Height);
+    quad.U0 = icon.X * scale;
+    quad.V0 = icon.Y * scale;
+    quad.U1 = (icon.X + icon.Width) * scale;
+    quad.V1 = (icon.Y + icon.Height) * scale;
+    s_Quads.push_back(quad);
+    return true;
+}
+
+void FlushItemIcons()
+{
+    if (!s_Quads.empty())
+    {
+        EnableAlphaBlendPremultiplied();
+        BindTexture(-static_cast<int>(s_AtlasTexture));
+        glColor4f(1.f, 1.f, 1.f, 1.f);
+
+        ++g_RenderCounters.DrawCalls;
+        glBegin(GL_QUADS);
+        for (const ICON_QUAD& quad : s_Quads)
+        {
+            glTexCoord2f(quad.U0, quad.V1);
+            glVertex2f(quad.X, quad.Y);
+            glTexCoord2f(quad.U0, quad.V0);
+            glVertex2f(quad.X, quad.Y - quad.Height);
+            glTexCoord2f(quad.U1, quad.V0);
+            glVertex2f(quad.X + quad.Width, quad.Y - quad.Height);
+            glTexCoord2f(quad.U1, quad.V1);
+            glVertex2f(quad.X + quad.Width, quad.Y);
+        }
+        glEnd();
+    }
+
+    // Start over once the atlas is full, unless what is on screen fills most of it;
+    // the icons that do not fit are then drawn live instead of redrawn every frame.
+    if (s_bAtlasFull && s_Quads.size() * 2 < s_Icons.size())
+        ResetAtlas();
+
+    s_Quads.clear();
+}
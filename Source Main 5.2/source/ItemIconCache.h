@@ -0,0 +1,30 @@
+#pragma once
+
+// Cached item icons for the item grids.
+//
+// Inventory, storage, trade and shop slots used to draw every item with RenderItem3D,
+// which animates, skins and lights the full BMD model per slot per frame. RenderItemIcon
+// draws an item once into a cell of an atlas texture, keyed by what changes its look
+// (type, level, excellent and ancient glow, slot size in pixels), and from then on only
+// queues a quad; FlushItemIcons draws the queued quads of a UI camera in one call.
+// The hovered item and the few that turn on their own keep the live 3D path, and the
+// dragged item never comes through here.
+//
+// The icon is drawn by the same RenderItem3DModel code through the same item camera,
+// with the camera's viewport shifted onto the cell of a framebuffer object. Blending
+// keeps a premultiplied alpha channel meanwhile (SetPremultipliedBlendTarget) so glow
+// passes still add onto the inventory background when the quad is composited. Effects
+// that change over time, like the ancient glow pulse, stay as they were when the icon
+// was drawn.
+
+extern bool g_bUseItemIconCache;
+
+void InitItemIconCache();
+void ReleaseItemIconCache();
+
+// Called from a UI camera's 3D pass in place of RenderItem3D. Returns false when the
+// item has to be drawn live.
+bool RenderItemIcon(float sx, float sy, float Width, float Height, int Type, int Level, int excellentFlags, int ancientDiscriminator);
+
+// Draws the icons queued since the last call; expects the 2D projection of BeginBitmap.
+void FlushItemIcons();
@@ -0,0 +1,21 @@
+#pragma once
+
+// Ring buffer indexing behind JOINT::GetTail and JOINT::PushTail (_struct.h).
+//
+// The newest tail entry sits in slot 'head' and each older one a slot further on, wrapping
+// at the end of the array. Starting a new entry moves the head back one slot, so the entries
+// already there age by one frame without being copied. No game types are used here, so
+// bench_joints.cpp in the repository root builds the same code on its own.
+
+// The slot of the entry 'index' frames old.
+inline int GetTailSlot(int head, int index, int size)
+{
+    const int slot = head + index;
+    return slot < size ? slot : slot - size;
+}
+
+// The head slot once a new entry has been started.
+inline int PushTailSlot(int head, int size)
+{
+    return (head > 0 ? head : size) - 1;
+}
@@ -11,33 +11,31 @@
 
 #include "ZzzBMD.h"
 #include "ZzzTexture.h"
+#include "./Utilities/JobSystem.h"
 
 CLoadData gLoadData;
 
 CLoadData::CLoadData() // OK
 {
+    m_bStreamTextures = false;
 }
 
 CLoadData::~CLoadData() // OK
 {
 }
 
-void CLoadData::AccessModel(int Type, wchar_t* Dir, wchar_t* FileName, int i)
+static void GetModelFileName(wchar_t (&Name)[64], const wchar_t* FileName, int i)
 {
-    wchar_t Name[64];
     if (i == -1)
         swprintf(Name, L"%s.bmd", FileName);
     else if (i < 10)
         swprintf(Name, L"%s0%d.bmd", FileName, i);
     else
         swprintf(Name, L"%s%d.bmd", FileName, i);
+}
 
-    bool Success = false;
-
-    Models[Type].m_iBMDSeqID = Type;
-
-    Success = Models[Type].Open2(Dir, Name);
-
+static void CheckModelOpened(bool Success, const wchar_t* FileName, const wchar_t* Name)
+{
     if (Success == false && (wcscmp(FileName, L"Monster") == 0 ||
         wcscmp(FileName, L"Player") == 0 ||
         wcscmp(FileName, L"PlayerTest") == 0 ||
@@ -50,6 +48,96 @@ void CLoadData::AccessModel(int Type, wchar_t* Dir, wchar_t* FileName, int i)
     }
 }
 
+void CLoadData::AccessModel(int Type, wchar_t* Dir, wchar_t* FileName, int i)
+{
+    wchar_t Name[64];
+    GetModelFileName(Name, FileName, i);
+
+    bool Success = false;
+
+    Models[Type].m_iBMDSeqID = Type;
+
+    Success = Models[Type].Open2(Dir, Name);
+
+    CheckModelOpened(Success, FileName, Name);
+}
+
+void CLoadData::AccessModels(int FirstType, int Count, wchar_t* Dir, wchar_t* FileName, int FirstIndex)
+{
+    std::vector<std::wstring> Names(Count);
+    for (int i = 0; i < Count; ++i)
+    {
+        BMD* pModel = &Models[FirstType + i];
+        pModel->m_iBMDSeqID = FirstType + i;
+        if (pModel->m_bCompletedAlloc)
+            pModel->Release();
+
+        wchar_t Name[64];
+        GetModelFileName(Name, FileName, FirstIndex + i);
+        Names[i] = Name;
+    }
+
+    std::vector<char> Read(Count, 0);
+    JobSystem::Instance()->ParallelFor(Count, [&](int i)
+    {
+        Read[i] = Models[FirstType + i].ReadModel2(Dir, Names[i].c_str()) ? 1 : 0;
+    });
+
+    for (int i = 0; i < Count; ++i)
+    {
+        BMD* pModel = &Models[FirstType + i];
+        if (Read[i])
+            pModel->FinishOpen();
+        else if (pModel->Meshs)
+            pModel->Release();
+
+        CheckModelOpened(Read[i] != 0, FileName, Names[i].c_str());
+    }
+}
+
+static bool GetTexturePath(const Texture_t* pTexture, const wchar_t* SubFolder, wchar_t (&szFullPath)[256], wchar_t& cExt)
+{
+    wchar_t textureFileName[64] = { 0, };
+    MultiByteToWideChar(CP_UTF8, 0, pTexture->FileName, -1, textureFileName, (int)std::size(textureFileName) - 1);
+
+    wcscpy(szFullPath, L"Data\\");
+    wcscat(szFullPath, SubFolder);
+    wcscat(szFullPath, textureFileName);
+
+    wchar_t __ext[_MAX_EXT] = { 0, };
+    _wsplitpath(textureFileName, NULL, NULL, NULL, __ext);
+    cExt = towlower(__ext[1]);
+
+    return !(pTexture->FileName[0] == 'h' && pTexture->FileName[1] == 'i' && pTexture->FileName[2] == 'd');
+}
+
+void CLoadData::PrefetchTextures(int FirstModel, int Count, wchar_t* SubFolder)
+{
+    if (m_bStreamTextures)
+        return;
+
+    std::vector<std::wstring> FileNames;
+    for (int i = FirstModel; i < FirstModel + Count; ++i)
+    {
+        const BMD* pModel = &Models[i];
+        for (int j = 0; j < pModel->NumMeshs; ++j)
+        {
+            wchar_t szFullPath[256] = { 0, };
+            wchar_t cExt = 0;
+            if (!GetTexturePath(&pModel->Textures[j], SubFolder, szFullPath, cExt) || (cExt != 't' && cExt != 'j'))
+                continue;
+
+            if (Bitmaps.FindTexture(szFullPath) != NULL)
+                continue;
+
+            if (std::find(FileNames.begin(), FileNames.end(), szFullPath) == FileNames.end())
+                FileNames.push_back(szFullPath);
+        }
+    }
+
+    Bitmaps.PrefetchImages(FileNames);
+}
+
 void CLoadData::OpenTexture(int Model, wchar_t* SubFolder, int Wrap, int Type, bool Check)
 {
     BMD* pModel = &Models[Model];
@@ -75,11 +163,15 @@ void CLoadData::OpenTexture(int Model, wchar_t* SubFolder, int Wrap, int Type, b
         }
         else if (tolower(__ext[1]) == 't') // TGA
         {
-            pModel->IndexTexture[i] = Bitmaps.LoadImage(szFullPath, GL_NEAREST, Wrap);
+            pModel->IndexTexture[i] = m_bStreamTextures
+                ? Bitmaps.LoadImageAsync(szFullPath, GL_NEAREST, Wrap)
+                : Bitmaps.LoadImage(szFullPath, GL_NEAREST, Wrap);
         }
         else if (tolower(__ext[1]) == 'j') // JPG
         {
-            pModel->IndexTexture[i] = Bitmaps.LoadImage(szFullPath, Type, Wrap);
+            pModel->IndexTexture[i] = m_bStreamTextures
+                ? Bitmaps.LoadImageAsync(szFullPath, Type, Wrap)
+                : Bitmaps.LoadImage(szFullPath, Type, Wrap);
         }
 
         bool isSkin = (pTexture->FileName[0] == 's' && pTexture->FileName[1] == 'k' && pTexture->FileName[2] == 'i')
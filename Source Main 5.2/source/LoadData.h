@@ -10,9 +10,20 @@ public:
     CLoadData();
     virtual ~CLoadData();
     void AccessModel(int Type, wchar_t* Dir, wchar_t* FileName, int i = -1);
+    // AccessModel for Count consecutive models, numbered from FirstIndex. The files are
+    // read and parsed in parallel on the job system.
+    void AccessModels(int FirstType, int Count, wchar_t* Dir, wchar_t* FileName, int FirstIndex);
+    // Decodes the textures OpenTexture is about to load for these models in parallel.
+    // The caller drops leftovers with Bitmaps.ClearPrefetchedImages.
+    void PrefetchTextures(int FirstModel, int Count, wchar_t* SubFolder);
     void OpenTexture(int Model, wchar_t* SubFolder, int Wrap = GL_REPEAT, int Type = GL_NEAREST, bool Check = true);
 
-public:
+    // While set, OpenTexture streams the textures in the background (placeholder until
+    // uploaded) instead of decoding them on the spot. Used for models loaded mid-game.
+    void SetStreamTextures(bool bStream) { m_bStreamTextures = bStream; }
+
+private:
+    bool m_bStreamTextures;
 };
 
 extern CLoadData gLoadData;
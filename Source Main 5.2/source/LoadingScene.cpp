@@ -6,9 +6,12 @@
 #include "LoadingScene.h"
 
 #include "Input.h"
+#include "ZzzOpenglUtil.h"
 
 CLoadingScene::CLoadingScene()
 {
+    m_iStep = 0;
+    m_iStepCount = 0;
 }
 
 CLoadingScene::~CLoadingScene()
@@ -46,4 +49,21 @@ void CLoadingScene::Render()
     {
         m_asprBack[i].Render();
     }
+
+    if (m_iStepCount > 0)
+    {
+        const float fWidth = 300.f;
+        EnableAlphaTest();
+        glColor4f(0.f, 0.f, 0.f, 0.6f);
+        RenderColor(170.f, 450.f, fWidth, 6.f);
+        glColor4f(0.9f, 0.7f, 0.3f, 1.f);
+        RenderColor(171.f, 451.f, (fWidth - 2.f) * m_iStep / m_iStepCount, 4.f);
+        EndRenderColor();
+    }
+}
+
+void CLoadingScene::SetProgress(int iStep, int iStepCount)
+{
+    m_iStep = iStep;
+    m_iStepCount = iStepCount;
 }
\ No newline at end of file
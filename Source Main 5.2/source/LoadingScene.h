@@ -15,6 +15,8 @@ class CLoadingScene
 {
 protected:
     CSprite	m_asprBack[LDS_BACK_MAX];
+    int		m_iStep;
+    int		m_iStepCount;
 
 public:
     CLoadingScene();
@@ -23,6 +25,8 @@ public:
     void Create();
     void Release();
     void Render();
+    // Shown as a bar under the artwork while LoadWorld runs.
+    void SetProgress(int iStep, int iStepCount);
 };
 
 #endif // !defined(AFX_LOADINGSCENE_H__D5107C47_C7D8_49B8_8056_B21DDC7DACE0__INCLUDED_)
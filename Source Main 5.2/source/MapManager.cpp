@@ -23,9 +23,23 @@
 
 CMapManager gMapManager;
 
+namespace
+{
+    // Drops whatever LoadWorld prefetched, including on the early returns for broken files.
+    struct PREFETCH_SCOPE
+    {
+        ~PREFETCH_SCOPE()
+        {
+            ClearPrefetchedMapFiles();
+            Bitmaps.ClearPrefetchedImages();
+        }
+    };
+}
+
 CMapManager::CMapManager() // OK
 {
     this->WorldActive = -1;
+    m_pLoadingProgress = NULL;
 }
 
 CMapManager::~CMapManager() // OK
@@ -1118,14 +1132,15 @@ void CMapManager::Load() // OK
         }
 
         swprintf(DirName, L"Data\\Object%d\\", iMapWorld);
-        for (i = MODEL_WORLD_OBJECT; i < MAX_WORLD_OBJECTS; i++)
-            gLoadData.AccessModel(i, DirName, L"Object", i + 1);
+        gLoadData.AccessModels(MODEL_WORLD_OBJECT, MAX_WORLD_OBJECTS - MODEL_WORLD_OBJECT, DirName, L"Object", MODEL_WORLD_OBJECT + 1);
 
         swprintf(DirName, L"Object%d\\", iMapWorld);
+        gLoadData.PrefetchTextures(MODEL_WORLD_OBJECT, MAX_WORLD_OBJECTS - MODEL_WORLD_OBJECT, DirName);
         for (i = MODEL_WORLD_OBJECT; i < MAX_WORLD_OBJECTS; i++)
         {
             gLoadData.OpenTexture(i, DirName);
         }
+        Bitmaps.ClearPrefetchedImages();
 
         if (this->WorldActive == WD_1DUNGEON)
         {
@@ -1197,6 +1212,8 @@ void CMapManager::LoadWorld(int Map)
     g_Direction.m_CKanturu.m_iMayaState = 0;
     g_Direction.m_CKanturu.m_iNightmareState = 0;
 
+    PREFETCH_SCOPE PrefetchScope;
+
     this->Load();
 
     wchar_t FileName[64];
@@ -1222,39 +1239,27 @@ void CMapManager::LoadWorld(int Map)
 
     battleCastle::Init();
 
-    swprintf(WorldName, L"World%d", iMapWorld);
-    swprintf(FileName, L"Data\\%s\\EncTerrain%d.map", WorldName, iMapWorld);
-
-    int iResult = OpenTerrainMapping(FileName);
-
-    if (iMapWorld != iResult && -1 != iResult)
-    {
-        wchar_t Text[256];
-        swprintf(Text, L"%s file corrupted.", FileName);
-        g_ErrorReport.Write(Text);
-        g_ErrorReport.Write(L"\r\n");
-        MessageBox(g_hWnd, Text, NULL, MB_OK);
-        SendMessage(g_hWnd, WM_DESTROY, 0, 0);
-        return;
-    }
+    ReportLoadingProgress(1);
 
-    if (this->WorldActive == WD_73NEW_LOGIN_SCENE)
-    {
-        swprintf(FileName, L"Data\\%s\\CWScript%d.cws", WorldName, iMapWorld);
-        CCameraMove::GetInstancePtr()->LoadCameraWalkScript(FileName);
-    }
+    swprintf(WorldName, L"World%d", iMapWorld);
 
     int CryWolfState = M34CryWolf1st::IsCryWolf1stMVPStart();
 
+    wchar_t MappingFileName[64];
+    wchar_t AttributeFileName[64];
+    wchar_t ObjectFileName[64];
+    swprintf(MappingFileName, L"Data\\%s\\EncTerrain%d.map", WorldName, iMapWorld);
+    swprintf(ObjectFileName, L"Data\\%s\\EncTerrain%d.obj", WorldName, iMapWorld);
+
     if (gMapManager.InBattleCastle())
     {
         if (battleCastle::IsBattleCastleStart())
         {
-            swprintf(FileName, L"Data\\%s\\EncTerrain%d.att", WorldName, iMapWorld * 10 + 2);
+            swprintf(AttributeFileName, L"Data\\%s\\EncTerrain%d.att", WorldName, iMapWorld * 10 + 2);
         }
         else
         {
-            swprintf(FileName, L"Data\\%s\\EncTerrain%d.att", WorldName, iMapWorld);
+            swprintf(AttributeFileName, L"Data\\%s\\EncTerrain%d.att", WorldName, iMapWorld);
         }
     }
     else
@@ -1264,13 +1269,13 @@ void CMapManager::LoadWorld(int Map)
             switch (CryWolfState)
             {
             case CRYWOLF_OCCUPATION_STATE_PEACE:
-                swprintf(FileName, L"Data\\%s\\EncTerrain%d.att", WorldName, iMapWorld);
+                swprintf(AttributeFileName, L"Data\\%s\\EncTerrain%d.att", WorldName, iMapWorld);
                 break;
             case CRYWOLF_OCCUPATION_STATE_OCCUPIED:
-                swprintf(FileName, L"Data\\%s\\EncTerrain%d.att", WorldName, iMapWorld * 10 + 1);
+                swprintf(AttributeFileName, L"Data\\%s\\EncTerrain%d.att", WorldName, iMapWorld * 10 + 1);
                 break;
             case CRYWOLF_OCCUPATION_STATE_WAR:
-                swprintf(FileName, L"Data\\%s\\EncTerrain%d.att", WorldName, iMapWorld * 10 + 2);
+                swprintf(AttributeFileName, L"Data\\%s\\EncTerrain%d.att", WorldName, iMapWorld * 10 + 2);
                 break;
             }
         }
@@ -1278,22 +1283,84 @@ void CMapManager::LoadWorld(int Map)
         {
             if (M39Kanturu3rd::IsSuccessBattle())
             {
-                swprintf(FileName, L"Data\\%s\\EncTerrain%d.att", WorldName, iMapWorld * 10 + 1);
+                swprintf(AttributeFileName, L"Data\\%s\\EncTerrain%d.att", WorldName, iMapWorld * 10 + 1);
             }
             else
             {
-                swprintf(FileName, L"Data\\%s\\EncTerrain%d.att", WorldName, iMapWorld);
+                swprintf(AttributeFileName, L"Data\\%s\\EncTerrain%d.att", WorldName, iMapWorld);
             }
         }
         else
         {
-            swprintf(FileName, L"Data\\%s\\EncTerrain%d.att", WorldName, iMapWorld);
+            swprintf(AttributeFileName, L"Data\\%s\\EncTerrain%d.att", WorldName, iMapWorld);
         }
-    iResult = OpenTerrainAttribute(FileName);
+
+    wchar_t HeightFileName[64];
+    swprintf(HeightFileName, L"%s\\TerrainHeight.bmp", WorldName);
+
+    wchar_t LightFileName[64] = { 0, };
+    if (gMapManager.InBattleCastle())
+    {
+        if (battleCastle::IsBattleCastleStart())
+        {
+            swprintf(LightFileName, L"%s\\TerrainLight2.jpg", WorldName);
+        }
+        else
+        {
+            swprintf(LightFileName, L"%s\\TerrainLight.jpg", WorldName);
+        }
+    }
+    else
+        if (this->WorldActive == WD_34CRYWOLF_1ST)
+        {
+            switch (CryWolfState)
+            {
+            case CRYWOLF_OCCUPATION_STATE_PEACE:
+                swprintf(LightFileName, L"%s\\TerrainLight.jpg", WorldName);
+                break;
+            case CRYWOLF_OCCUPATION_STATE_OCCUPIED:
+                swprintf(LightFileName, L"%s\\TerrainLight1.jpg", WorldName);
+                break;
+            case CRYWOLF_OCCUPATION_STATE_WAR:
+                swprintf(LightFileName, L"%s\\TerrainLight2.jpg", WorldName);
+                break;
+            }
+        }
+        else
+        {
+            swprintf(LightFileName, L"%s\\TerrainLight.jpg", WorldName);
+        }
+
+    // Decrypt the terrain files, read the height map and decode the light map and the
+    // tile textures on the job system up front; the stages below then only parse them
+    // and upload on this thread.
+    std::vector<TERRAIN_TEXTURE> TerrainTextures;
+    if (!gMapManager.InHellas(this->WorldActive))
+    {
+        GetTerrainTextures(Map, WorldName, TerrainTextures);
+    }
+
+    std::vector<std::wstring> PrefetchFiles;
+    PrefetchFiles.push_back(MappingFileName);
+    PrefetchFiles.push_back(AttributeFileName);
+    PrefetchFiles.push_back(ObjectFileName);
+    PrefetchMapFiles(PrefetchFiles, HeightFileName, LightFileName);
+
+    PrefetchFiles.clear();
+    for (const auto& texture : TerrainTextures)
+    {
+        PrefetchFiles.push_back(std::wstring(L"Data\\") + texture.FileName);
+    }
+    Bitmaps.PrefetchImages(PrefetchFiles);
+
+    ReportLoadingProgress(2);
+
+    int iResult = OpenTerrainMapping(MappingFileName);
+
     if (iMapWorld != iResult && -1 != iResult)
     {
         wchar_t Text[256];
-        swprintf(Text, L"%s file corrupted.", FileName);
+        swprintf(Text, L"%s file corrupted.", MappingFileName);
         g_ErrorReport.Write(Text);
         g_ErrorReport.Write(L"\r\n");
         MessageBox(g_hWnd, Text, NULL, MB_OK);
@@ -1301,13 +1368,17 @@ void CMapManager::LoadWorld(int Map)
         return;
     }
 
-    swprintf(FileName, L"Data\\%s\\EncTerrain%d.obj", WorldName, iMapWorld);
+    if (this->WorldActive == WD_73NEW_LOGIN_SCENE)
+    {
+        swprintf(FileName, L"Data\\%s\\CWScript%d.cws", WorldName, iMapWorld);
+        CCameraMove::GetInstancePtr()->LoadCameraWalkScript(FileName);
+    }
 
-    iResult = OpenObjectsEnc(FileName);
+    iResult = OpenTerrainAttribute(AttributeFileName);
     if (iMapWorld != iResult && -1 != iResult)
     {
         wchar_t Text[256];
-        swprintf(Text, L"%s file corrupted.", FileName);
+        swprintf(Text, L"%s file corrupted.", AttributeFileName);
         g_ErrorReport.Write(Text);
         g_ErrorReport.Write(L"\r\n");
         MessageBox(g_hWnd, Text, NULL, MB_OK);
@@ -1315,195 +1386,178 @@ void CMapManager::LoadWorld(int Map)
         return;
     }
 
-    swprintf(FileName, L"%s\\TerrainHeight.bmp", WorldName);
+    iResult = OpenObjectsEnc(ObjectFileName);
+    if (iMapWorld != iResult && -1 != iResult)
+    {
+        wchar_t Text[256];
+        swprintf(Text, L"%s file corrupted.", ObjectFileName);
+        g_ErrorReport.Write(Text);
+        g_ErrorReport.Write(L"\r\n");
+        MessageBox(g_hWnd, Text, NULL, MB_OK);
+        SendMessage(g_hWnd, WM_DESTROY, 0, 0);
+        return;
+    }
+
+    ReportLoadingProgress(3);
+
     if (IsTerrainHeightExtMap(this->WorldActive) == true)
     {
-        CreateTerrain(FileName, true);
+        CreateTerrain(HeightFileName, true);
     }
     else
     {
-        CreateTerrain(FileName);
+        CreateTerrain(HeightFileName);
     }
 
-    if (gMapManager.InBattleCastle())
+    OpenTerrainLight(LightFileName);
+
+    ReportLoadingProgress(4);
+
+    if (CreateWaterTerrain(this->WorldActive) == false)
     {
-        if (battleCastle::IsBattleCastleStart())
+        for (const auto& texture : TerrainTextures)
         {
-            swprintf(FileName, L"%s\\TerrainLight2.jpg", WorldName);
-        }
-        else
-        {
-            swprintf(FileName, L"%s\\TerrainLight.jpg", WorldName);
+            LoadBitmap(texture.FileName.c_str(), texture.Index, texture.Filter, texture.Wrap, false);
         }
     }
-    else
-        if (this->WorldActive == WD_34CRYWOLF_1ST)
-        {
-            switch (CryWolfState)
-            {
-            case CRYWOLF_OCCUPATION_STATE_PEACE:
-                swprintf(FileName, L"%s\\TerrainLight.jpg", WorldName);
-                break;
-            case CRYWOLF_OCCUPATION_STATE_OCCUPIED:
-                swprintf(FileName, L"%s\\TerrainLight1.jpg", WorldName);
-                break;
-            case CRYWOLF_OCCUPATION_STATE_WAR:
-                swprintf(FileName, L"%s\\TerrainLight2.jpg", WorldName);
-                break;
-            }
-        }
-        else
-        {
-            swprintf(FileName, L"%s\\TerrainLight.jpg", WorldName);
-        }
 
-    OpenTerrainLight(FileName);
+    Bitmaps.WriteMemoryReport();
 
-    if (CreateWaterTerrain(this->WorldActive) == false)
+    if (iMapWorld != 74 && iMapWorld != 75)
     {
-        swprintf(FileName, L"%s\\TileGrass01.jpg", WorldName);
-        LoadBitmap(FileName, BITMAP_MAPTILE, GL_NEAREST, GL_REPEAT, false);
-        swprintf(FileName, L"%s\\TileGrass02.jpg", WorldName);
-        LoadBitmap(FileName, BITMAP_MAPTILE + 1, GL_NEAREST, GL_REPEAT, false);
-        if (this->WorldActive == WD_51HOME_6TH_CHAR
-            )
-        {
-            swprintf(FileName, L"%s\\AlphaTileGround01.Tga", WorldName);
-            LoadBitmap(FileName, BITMAP_MAPTILE + 2, GL_NEAREST, GL_REPEAT, false);
-        }
-        else
-        {
-            swprintf(FileName, L"%s\\TileGround01.jpg", WorldName);
-            LoadBitmap(FileName, BITMAP_MAPTILE + 2, GL_NEAREST, GL_REPEAT, false);
-        }
+        g_pNewUIMiniMap->UnloadImages();
+        g_pNewUIMiniMap->LoadImages(WorldName);
+    }
 
-        if (this->WorldActive == WD_39KANTURU_3RD)
-        {
-            swprintf(FileName, L"%s\\AlphaTileGround02.Tga", WorldName);
-            LoadBitmap(FileName, BITMAP_MAPTILE + 3, GL_NEAREST, GL_REPEAT, false);
-        }
-        else
-        {
-            swprintf(FileName, L"%s\\TileGround02.jpg", WorldName);
-            LoadBitmap(FileName, BITMAP_MAPTILE + 3, GL_NEAREST, GL_REPEAT, false);
-        }
-        if (gMapManager.IsCursedTemple())
-        {
-            swprintf(FileName, L"%s\\AlphaTileGround03.Tga", WorldName);
-            LoadBitmap(FileName, BITMAP_MAPTILE + 4, GL_NEAREST, GL_REPEAT, false);
-        }
-        else
-        {
-            swprintf(FileName, L"%s\\TileGround03.jpg", WorldName);
-            LoadBitmap(FileName, BITMAP_MAPTILE + 4, GL_NEAREST, GL_REPEAT, false);
-        }
+    ReportLoadingProgress(LOADING_STEP_COUNT);
+}
 
-        swprintf(FileName, L"%s\\TileWater01.jpg", WorldName);
-        LoadBitmap(FileName, BITMAP_MAPTILE + 5, GL_NEAREST, GL_REPEAT, false);
-        swprintf(FileName, L"%s\\TileWood01.jpg", WorldName);
-        LoadBitmap(FileName, BITMAP_MAPTILE + 6, GL_NEAREST, GL_REPEAT, false);
-        swprintf(FileName, L"%s\\TileRock01.jpg", WorldName);
-        LoadBitmap(FileName, BITMAP_MAPTILE + 7, GL_NEAREST, GL_REPEAT, false);
-        swprintf(FileName, L"%s\\TileRock02.jpg", WorldName);
-        LoadBitmap(FileName, BITMAP_MAPTILE + 8, GL_NEAREST, GL_REPEAT, false);
-        swprintf(FileName, L"%s\\TileRock03.jpg", WorldName);
-        LoadBitmap(FileName, BITMAP_MAPTILE + 9, GL_NEAREST, GL_REPEAT, false);
-
-        if (this->WorldActive == WD_73NEW_LOGIN_SCENE || this->WorldActive == WD_74NEW_CHARACTER_SCENE)
-        {
-            swprintf(FileName, L"%s\\AlphaTile01.Tga", WorldName);
-            LoadBitmap(FileName, BITMAP_MAPTILE + 10, GL_NEAREST, GL_REPEAT, false);
-        }
-        else
-        {
-            swprintf(FileName, L"%s\\TileRock04.jpg", WorldName);
-            LoadBitmap(FileName, BITMAP_MAPTILE + 10, GL_NEAREST, GL_REPEAT, false);
-        }
+static void AddTerrainTexture(std::vector<TERRAIN_TEXTURE>& Textures, GLuint Index, GLuint Filter, GLuint Wrap, const wchar_t* Format, const wchar_t* Folder)
+{
+    wchar_t FileName[64];
+    swprintf(FileName, Format, Folder);
 
-        if (IsPKField() || IsDoppelGanger2())
-        {
-            LoadBitmap(L"Object64\\song_lava1.jpg", BITMAP_MAPTILE + 11, GL_NEAREST, GL_REPEAT, false);
-        }
-        else
-        {
-            swprintf(FileName, L"%s\\TileRock05.jpg", WorldName);
-            LoadBitmap(FileName, BITMAP_MAPTILE + 11, GL_NEAREST, GL_REPEAT, false);
-        }
+    TERRAIN_TEXTURE texture = { FileName, Index, Filter, Wrap };
+    Textures.push_back(texture);
+}
+
+// Tile, grass, leaf and rain textures of the world, in the order LoadWorld loads them.
+void CMapManager::GetTerrainTextures(int Map, const wchar_t* WorldName, std::vector<TERRAIN_TEXTURE>& Textures)
+{
+    AddTerrainTexture(Textures, BITMAP_MAPTILE, GL_NEAREST, GL_REPEAT, L"%s\\TileGrass01.jpg", WorldName);
+    AddTerrainTexture(Textures, BITMAP_MAPTILE + 1, GL_NEAREST, GL_REPEAT, L"%s\\TileGrass02.jpg", WorldName);
+    if (this->WorldActive == WD_51HOME_6TH_CHAR)
+    {
+        AddTerrainTexture(Textures, BITMAP_MAPTILE + 2, GL_NEAREST, GL_REPEAT, L"%s\\AlphaTileGround01.Tga", WorldName);
+    }
+    else
+    {
+        AddTerrainTexture(Textures, BITMAP_MAPTILE + 2, GL_NEAREST, GL_REPEAT, L"%s\\TileGround01.jpg", WorldName);
+    }
+
+    if (this->WorldActive == WD_39KANTURU_3RD)
+    {
+        AddTerrainTexture(Textures, BITMAP_MAPTILE + 3, GL_NEAREST, GL_REPEAT, L"%s\\AlphaTileGround02.Tga", WorldName);
+    }
+    else
+    {
+        AddTerrainTexture(Textures, BITMAP_MAPTILE + 3, GL_NEAREST, GL_REPEAT, L"%s\\TileGround02.jpg", WorldName);
+    }
+    if (gMapManager.IsCursedTemple())
+    {
+        AddTerrainTexture(Textures, BITMAP_MAPTILE + 4, GL_NEAREST, GL_REPEAT, L"%s\\AlphaTileGround03.Tga", WorldName);
+    }
+    else
+    {
+        AddTerrainTexture(Textures, BITMAP_MAPTILE + 4, GL_NEAREST, GL_REPEAT, L"%s\\TileGround03.jpg", WorldName);
+    }
+
+    AddTerrainTexture(Textures, BITMAP_MAPTILE + 5, GL_NEAREST, GL_REPEAT, L"%s\\TileWater01.jpg", WorldName);
+    AddTerrainTexture(Textures, BITMAP_MAPTILE + 6, GL_NEAREST, GL_REPEAT, L"%s\\TileWood01.jpg", WorldName);
+    AddTerrainTexture(Textures, BITMAP_MAPTILE + 7, GL_NEAREST, GL_REPEAT, L"%s\\TileRock01.jpg", WorldName);
+    AddTerrainTexture(Textures, BITMAP_MAPTILE + 8, GL_NEAREST, GL_REPEAT, L"%s\\TileRock02.jpg", WorldName);
+    AddTerrainTexture(Textures, BITMAP_MAPTILE + 9, GL_NEAREST, GL_REPEAT, L"%s\\TileRock03.jpg", WorldName);
+
+    if (this->WorldActive == WD_73NEW_LOGIN_SCENE || this->WorldActive == WD_74NEW_CHARACTER_SCENE)
+    {
+        AddTerrainTexture(Textures, BITMAP_MAPTILE + 10, GL_NEAREST, GL_REPEAT, L"%s\\AlphaTile01.Tga", WorldName);
+    }
+    else
+    {
+        AddTerrainTexture(Textures, BITMAP_MAPTILE + 10, GL_NEAREST, GL_REPEAT, L"%s\\TileRock04.jpg", WorldName);
+    }
+
+    if (IsPKField() || IsDoppelGanger2())
+    {
+        AddTerrainTexture(Textures, BITMAP_MAPTILE + 11, GL_NEAREST, GL_REPEAT, L"Object64\\song_lava1.jpg", WorldName);
+    }
+    else
+    {
+        AddTerrainTexture(Textures, BITMAP_MAPTILE + 11, GL_NEAREST, GL_REPEAT, L"%s\\TileRock05.jpg", WorldName);
+    }
 #ifdef ASG_ADD_MAP_KARUTAN
-        if (IsKarutanMap())
-        {
-            swprintf(FileName, L"%s\\AlphaTile01.Tga", WorldName);
-            LoadBitmap(FileName, BITMAP_MAPTILE + 12, GL_NEAREST, GL_REPEAT, false);
-        }
-        else
-        {
+    if (IsKarutanMap())
+    {
+        AddTerrainTexture(Textures, BITMAP_MAPTILE + 12, GL_NEAREST, GL_REPEAT, L"%s\\AlphaTile01.Tga", WorldName);
+    }
+    else
+    {
 #endif	// ASG_ADD_MAP_KARUTAN
-            swprintf(FileName, L"%s\\TileRock06.jpg", WorldName);
-            LoadBitmap(FileName, BITMAP_MAPTILE + 12, GL_NEAREST, GL_REPEAT, false);
+        AddTerrainTexture(Textures, BITMAP_MAPTILE + 12, GL_NEAREST, GL_REPEAT, L"%s\\TileRock06.jpg", WorldName);
 #ifdef ASG_ADD_MAP_KARUTAN
-        }
+    }
 #endif	// ASG_ADD_MAP_KARUTAN
-        swprintf(FileName, L"%s\\TileRock07.jpg", WorldName);
-        LoadBitmap(FileName, BITMAP_MAPTILE + 13, GL_NEAREST, GL_REPEAT, false);
+    AddTerrainTexture(Textures, BITMAP_MAPTILE + 13, GL_NEAREST, GL_REPEAT, L"%s\\TileRock07.jpg", WorldName);
 
-        for (int i = 1; i <= 16; i++)
-        {
-            if (i >= 10)
-                swprintf(FileName, L"%s\\ExtTile%d.jpg", WorldName, i);
-            else
-                swprintf(FileName, L"%s\\ExtTile0%d.jpg", WorldName, i);
-            LoadBitmap(FileName, BITMAP_MAPTILE + 13 + i, GL_NEAREST, GL_REPEAT, false);
-        }
-        if (IsPKField() || IsDoppelGanger2())
-        {
-            swprintf(FileName, L"%s\\TileGrass01_R.jpg", WorldName);
-            LoadBitmap(FileName, BITMAP_MAPGRASS, GL_LINEAR, GL_REPEAT, false);
-        }
-        else
-        {
-            swprintf(FileName, L"%s\\TileGrass01.tga", WorldName);
-            LoadBitmap(FileName, BITMAP_MAPGRASS, GL_NEAREST, GL_REPEAT, false);
-        }
+    for (int i = 1; i <= 16; i++)
+    {
+        wchar_t Format[32];
+        swprintf(Format, L"%%s\\ExtTile%02d.jpg", i);
+        AddTerrainTexture(Textures, BITMAP_MAPTILE + 13 + i, GL_NEAREST, GL_REPEAT, Format, WorldName);
+    }
+    if (IsPKField() || IsDoppelGanger2())
+    {
+        AddTerrainTexture(Textures, BITMAP_MAPGRASS, GL_LINEAR, GL_REPEAT, L"%s\\TileGrass01_R.jpg", WorldName);
+    }
+    else
+    {
+        AddTerrainTexture(Textures, BITMAP_MAPGRASS, GL_NEAREST, GL_REPEAT, L"%s\\TileGrass01.tga", WorldName);
+    }
 
-        swprintf(FileName, L"%s\\TileGrass02.tga", WorldName);
-        LoadBitmap(FileName, BITMAP_MAPGRASS + 1, GL_NEAREST, GL_REPEAT, false);
-        swprintf(FileName, L"%s\\TileGrass03.tga", WorldName);
-        LoadBitmap(FileName, BITMAP_MAPGRASS + 2, GL_NEAREST, GL_REPEAT, false);
+    AddTerrainTexture(Textures, BITMAP_MAPGRASS + 1, GL_NEAREST, GL_REPEAT, L"%s\\TileGrass02.tga", WorldName);
+    AddTerrainTexture(Textures, BITMAP_MAPGRASS + 2, GL_NEAREST, GL_REPEAT, L"%s\\TileGrass03.tga", WorldName);
 
-        
-        swprintf(FileName, L"%s\\leaf01.tga", WorldName); 
-        LoadBitmap(FileName, BITMAP_LEAF1, GL_NEAREST, GL_CLAMP_TO_EDGE, false);
-        swprintf(FileName,(Map==0||Map==3||Map==63)? L"%s\\leaf01.tga": L"%s\\leaf01.jpg",WorldName);
-        LoadBitmap(FileName, BITMAP_LEAF1, GL_NEAREST, GL_CLAMP_TO_EDGE, false);
-        swprintf(FileName, L"%s\\leaf02.jpg", WorldName);
-        LoadBitmap(FileName, BITMAP_LEAF2, GL_NEAREST, GL_CLAMP_TO_EDGE, false);
+    AddTerrainTexture(Textures, BITMAP_LEAF1, GL_NEAREST, GL_CLAMP_TO_EDGE, L"%s\\leaf01.tga", WorldName);
+    AddTerrainTexture(Textures, BITMAP_LEAF1, GL_NEAREST, GL_CLAMP_TO_EDGE, (Map == 0 || Map == 3 || Map == 63) ? L"%s\\leaf01.tga" : L"%s\\leaf01.jpg", WorldName);
+    AddTerrainTexture(Textures, BITMAP_LEAF2, GL_NEAREST, GL_CLAMP_TO_EDGE, L"%s\\leaf02.jpg", WorldName);
 
-        if (M34CryWolf1st::IsCyrWolf1st() == true)
-        {
-            swprintf(FileName, L"%s\\rain011.tga", L"World1");
-            LoadBitmap(FileName, BITMAP_RAIN, GL_NEAREST, GL_CLAMP_TO_EDGE, false);
-        }
-        else
-        {
-            swprintf(FileName, L"%s\\rain01.tga", L"World1");
-            LoadBitmap(FileName, BITMAP_RAIN, GL_NEAREST, GL_CLAMP_TO_EDGE, false);
-        }
-        swprintf(FileName, L"%s\\rain02.tga", L"World1");
-        LoadBitmap(FileName, BITMAP_RAIN_CIRCLE, GL_NEAREST, GL_CLAMP_TO_EDGE, false);
-        swprintf(FileName, L"%s\\rain03.tga", L"World10");
-        LoadBitmap(FileName, BITMAP_RAIN_CIRCLE + 1, GL_NEAREST, GL_CLAMP_TO_EDGE, false);
+    if (M34CryWolf1st::IsCyrWolf1st() == true)
+    {
+        AddTerrainTexture(Textures, BITMAP_RAIN, GL_NEAREST, GL_CLAMP_TO_EDGE, L"%s\\rain011.tga", L"World1");
+    }
+    else
+    {
+        AddTerrainTexture(Textures, BITMAP_RAIN, GL_NEAREST, GL_CLAMP_TO_EDGE, L"%s\\rain01.tga", L"World1");
+    }
+    AddTerrainTexture(Textures, BITMAP_RAIN_CIRCLE, GL_NEAREST, GL_CLAMP_TO_EDGE, L"%s\\rain02.tga", L"World1");
+    AddTerrainTexture(Textures, BITMAP_RAIN_CIRCLE + 1, GL_NEAREST, GL_CLAMP_TO_EDGE, L"%s\\rain03.tga", L"World10");
 
-        if (IsEmpireGuardian1() || IsEmpireGuardian2() || IsEmpireGuardian3() || IsEmpireGuardian4())
-        {
-            swprintf(FileName, L"%s\\AlphaTile01.Tga", WorldName);
-            LoadBitmap(FileName, BITMAP_MAPTILE + 10, GL_NEAREST, GL_REPEAT, false);
-        }
+    if (IsEmpireGuardian1() || IsEmpireGuardian2() || IsEmpireGuardian3() || IsEmpireGuardian4())
+    {
+        AddTerrainTexture(Textures, BITMAP_MAPTILE + 10, GL_NEAREST, GL_REPEAT, L"%s\\AlphaTile01.Tga", WorldName);
     }
+}
 
-    if (iMapWorld != 74 && iMapWorld != 75)
+void CMapManager::SetLoadingProgressCallback(LOADING_PROGRESS_CALLBACK pCallback)
+{
+    m_pLoadingProgress = pCallback;
+}
+
+void CMapManager::ReportLoadingProgress(int iStep)
+{
+    if (m_pLoadingProgress != NULL)
     {
-        g_pNewUIMiniMap->UnloadImages();
-        g_pNewUIMiniMap->LoadImages(WorldName);
+        m_pLoadingProgress(iStep, LOADING_STEP_COUNT);
     }
 }
 
@@ -70,13 +70,27 @@ enum ENUM_WORLD
     NUM_WD
 };
 
+// Called between the stages of LoadWorld with the number of stages completed so far.
+typedef void (*LOADING_PROGRESS_CALLBACK)(int iStep, int iStepCount);
+
+typedef struct
+{
+    std::wstring FileName;
+    GLuint       Index;
+    GLuint       Filter;
+    GLuint       Wrap;
+} TERRAIN_TEXTURE;
+
 class CMapManager
 {
 public:
+    enum { LOADING_STEP_COUNT = 5 };
+
     CMapManager();
     virtual ~CMapManager();
     void Load();
     void LoadWorld(int Map);
+    void SetLoadingProgressCallback(LOADING_PROGRESS_CALLBACK pCallback);
     void DeleteObjects();
     bool InChaosCastle(int iMap = -1);
     bool InBloodCastle(int iMap = -1);
@@ -94,6 +108,11 @@ public:
     const wchar_t* GetMapName(int iMap);
 public:
     int WorldActive;
+private:
+    void GetTerrainTextures(int Map, const wchar_t* WorldName, std::vector<TERRAIN_TEXTURE>& Textures);
+    void ReportLoadingProgress(int iStep);
+
+    LOADING_PROGRESS_CALLBACK m_pLoadingProgress;
 };
 
 extern CMapManager gMapManager;
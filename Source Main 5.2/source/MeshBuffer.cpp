@@ -0,0 +1,684 @@
+///////////////////////////////////////////////////////////////////////////////
+// GPU-resident BMD mesh buffers
+///////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "MeshBuffer.h"
+#include "ZzzBMD.h"
+#include "RenderQueue.h"
+
+extern double WorldTime;
+extern float BoneScale;
+
+bool g_bUseMeshBuffers = true;
+
+namespace
+{
+    // Entry points are resolved by hand like the WGL extensions in ZzzOpenglUtil.cpp;
+    // the client does not initialise GLEW.
+    PFNGLGENBUFFERSPROC              pglGenBuffers = nullptr;
+    PFNGLDELETEBUFFERSPROC           pglDeleteBuffers = nullptr;
+    PFNGLBINDBUFFERPROC              pglBindBuffer = nullptr;
+    PFNGLBUFFERDATAPROC              pglBufferData = nullptr;
+    PFNGLCREATESHADERPROC            pglCreateShader = nullptr;
+    PFNGLDELETESHADERPROC            pglDeleteShader = nullptr;
+    PFNGLSHADERSOURCEPROC            pglShaderSource = nullptr;
+    PFNGLCOMPILESHADERPROC           pglCompileShader = nullptr;
+    PFNGLGETSHADERIVPROC             pglGetShaderiv = nullptr;
+    PFNGLGETSHADERINFOLOGPROC        pglGetShaderInfoLog = nullptr;
+    PFNGLCREATEPROGRAMPROC           pglCreateProgram = nullptr;
+    PFNGLATTACHSHADERPROC            pglAttachShader = nullptr;
+    PFNGLBINDATTRIBLOCATIONPROC      pglBindAttribLocation = nullptr;
+    PFNGLLINKPROGRAMPROC             pglLinkProgram = nullptr;
+    PFNGLGETPROGRAMIVPROC            pglGetProgramiv = nullptr;
+    PFNGLUSEPROGRAMPROC              pglUseProgram = nullptr;
+    PFNGLGETUNIFORMLOCATIONPROC      pglGetUniformLocation = nullptr;
+    PFNGLUNIFORM4FVPROC              pglUniform4fv = nullptr;
+    PFNGLUNIFORM4FPROC               pglUniform4f = nullptr;
+    PFNGLUNIFORM3FPROC               pglUniform3f = nullptr;
+    PFNGLUNIFORM2FPROC               pglUniform2f = nullptr;
+    PFNGLVERTEXATTRIBPOINTERPROC     pglVertexAttribPointer = nullptr;
+    PFNGLENABLEVERTEXATTRIBARRAYPROC pglEnableVertexAttribArray = nullptr;
+    PFNGLDISABLEVERTEXATTRIBARRAYPROC pglDisableVertexAttribArray = nullptr;
+
+    constexpr GLuint SKIN_ATTRIBUTE = 6;
+
+    enum MESH_BUFFER_MODE
+    {
+        MESH_BUFFER_MODE_TEXTURE = 0,
+        MESH_BUFFER_MODE_CHROME,
+        MESH_BUFFER_MODE_CHROME4,
+        MESH_BUFFER_MODE_OIL,
+        MESH_BUFFER_MODE_PLAIN,
+    };
+
+    // Same precedence as the g_chrome generation in BMD::RenderMesh.
+    enum MESH_BUFFER_CHROME
+    {
+        MESH_BUFFER_CHROME_NONE = 0,
+        MESH_BUFFER_CHROME_2,
+        MESH_BUFFER_CHROME_3,
+        MESH_BUFFER_CHROME_4,
+        MESH_BUFFER_CHROME_5,
+        MESH_BUFFER_CHROME_6,
+        MESH_BUFFER_CHROME_7,
+        MESH_BUFFER_CHROME_OIL,
+        MESH_BUFFER_CHROME_1,
+        MESH_BUFFER_CHROME_METAL,
+    };
+
+    struct MeshBufferVertex_t
+    {
+        float Position[3];
+        float Normal[3];
+        float TexCoord[2];
+        float Skin[3]; // vertex bone, normal bone, RENDER_WAVE phase
+    };
+
+    struct SkinningState_t
+    {
+        const BMD* Owner;
+        int        NumBones;
+        bool       Translate;
+        bool       LightValid;
+        float      Scale;
+        float      BoneScale;
+        float      BodyScale;
+        vec3_t     BodyOrigin;
+        vec3_t     LightPosition;
+        float      Palette[MAX_BONES][3][4];
+    };
+
+    struct SkinningProgram_t
+    {
+        GLuint Program;
+        GLint  Bones;
+        GLint  SkinParams;
+        GLint  BodyOrigin;
+        GLint  LightPosition;
+        GLint  BodyColor;
+        GLint  RenderParams;
+        GLint  ChromeParams;
+        GLint  ChromeLight;
+        GLint  TexCoordOffset;
+    };
+
+    bool s_bAvailable = false;
+    int s_iMaxSkinBones = 0;
+    SkinningProgram_t s_Program = {};
+    SkinningState_t s_Skinning = {};
+
+    // palettes referenced by queued draws; s_iQueuedSkinning is the copy of s_Skinning, if any
+    struct QueuedSkinning_t
+    {
+        int    NumBones;
+        bool   Translate;
+        float  Scale;
+        float  BoneScale;
+        float  BodyScale;
+        vec3_t BodyOrigin;
+        vec3_t LightPosition;
+        size_t Bones;
+    };
+
+    std::vector<QueuedSkinning_t> s_QueuedSkinning;
+    std::vector<float>            s_QueuedBones;
+    int                           s_iQueuedSkinning = -1;
+
+    const char* s_szVertexShader =
+        "uniform vec4 Bones[MAX_SKIN_BONES * 3];\n"
+        "uniform vec4 SkinParams;\n"     // x: BoneScale, y: Scale, z: BodyScale, w: Translate
+        "uniform vec3 BodyOrigin;\n"
+        "uniform vec3 LightPosition;\n"
+        "uniform vec4 BodyColor;\n"      // BodyLight, alpha
+        "uniform vec4 RenderParams;\n"   // x: mode, y: light, z: colour array, w: RENDER_WAVE phase (<0 = off)
+        "uniform vec4 ChromeParams;\n"   // x: chrome, y: wave, z: Wave2, w: WorldTime * 0.00006
+        "uniform vec3 ChromeLight;\n"
+        "uniform vec2 TexCoordOffset;\n"
+        "attribute vec3 Skin;\n"
+        "\n"
+        "vec2 Chrome(vec3 n)\n"
+        "{\n"
+        "    float c = ChromeParams.x;\n"
+        "    float w = ChromeParams.y;\n"
+        "    float w2 = ChromeParams.z;\n"
+        "    if (c < 1.5) return vec2((n.z + n.x) * 0.8 + w2 * 2.0, (n.y + n.x) * 1.0 + w2 * 3.0);\n"
+        "    if (c < 2.5) { float d = dot(n, vec3(0.0, -0.1, -0.8)); return vec2(d, 1.0 - d); }\n"
+        "    if (c < 3.5) { float d = dot(n, ChromeLight); return vec2(d + n.y * 0.5 + ChromeLight.y * 3.0, 1.0 - d - (n.z * 0.5 + w * 3.0)); }\n"
+        "    if (c < 4.5) { float d = dot(n, ChromeLight); return vec2(d + n.y * 3.0 + ChromeLight.y * 5.0, 1.0 - d - (n.z * 2.5 + w)); }\n"
+        "    if (c < 5.5) return vec2((n.z + n.x) * 0.8 + w2 * 2.0);\n"
+        "    if (c < 6.5) return vec2((n.z + n.x) * 0.8 + ChromeParams.w);\n"
+        "    if (c < 7.5) return n.xy;\n"
+        "    if (c < 8.5) return vec2(n.z * 0.5 + w, n.y * 0.5 + w * 2.0);\n"
+        "    return vec2(n.z * 0.5 + 0.2, n.y * 0.5 + 0.5);\n"
+        "}\n"
+        "\n"
+        "void main()\n"
+        "{\n"
+        "    int vb = int(Skin.x + 0.5) * 3;\n"
+        "    int nb = int(Skin.y + 0.5) * 3;\n"
+        "    vec4 p = vec4(gl_Vertex.xyz, 1.0);\n"
+        "    vec3 v;\n"
+        "    if (SkinParams.x == 1.0)\n"
+        "    {\n"
+        "        if (SkinParams.y != 0.0) p.xyz *= SkinParams.y;\n"
+        "        v = vec3(dot(Bones[vb], p), dot(Bones[vb + 1], p), dot(Bones[vb + 2], p));\n"
+        "    }\n"
+        "    else\n"
+        "    {\n"
+        "        vec3 r = vec3(dot(Bones[vb].xyz, p.xyz), dot(Bones[vb + 1].xyz, p.xyz), dot(Bones[vb + 2].xyz, p.xyz));\n"
+        "        v = r * SkinParams.x + vec3(Bones[vb].w, Bones[vb + 1].w, Bones[vb + 2].w);\n"
+        "    }\n"
+        "    if (SkinParams.w > 0.5) v = v * SkinParams.z + BodyOrigin;\n"
+        "\n"
+        "    vec3 n = vec3(dot(Bones[nb].xyz, gl_Normal), dot(Bones[nb + 1].xyz, gl_Normal), dot(Bones[nb + 2].xyz, gl_Normal));\n"
+        "    if (RenderParams.w >= 0.0) v += n * (sin(RenderParams.w + Skin.z) * 28.0);\n"
+        "\n"
+        "    vec2 t = gl_MultiTexCoord0.xy;\n"
+        "    vec4 color = BodyColor;\n"
+        "    if (RenderParams.x < 0.5)\n"
+        "    {\n"
+        "        t += TexCoordOffset;\n"
+        "        if (RenderParams.y > 0.5) color.rgb *= max(dot(n, LightPosition) * 0.8 + 0.4, 0.2);\n"
+        "    }\n"
+        "    else if (RenderParams.x < 1.5) t = Chrome(n);\n"
+        "    else if (RenderParams.x < 2.5) t = Chrome(n) + TexCoordOffset;\n"
+        "    else if (RenderParams.x < 3.5) t = Chrome(n) * t + TexCoordOffset;\n"
+        "\n"
+        "    vec4 eye = gl_ModelViewMatrix * vec4(v, 1.0);\n"
+        "    gl_Position = gl_ProjectionMatrix * eye;\n"
+        "    gl_FogFragCoord = abs(eye.z);\n"
+        "    gl_TexCoord[0] = vec4(t, 0.0, 1.0);\n"
+        "    gl_FrontColor = RenderParams.z > 0.5 ? color : gl_Color;\n"
+        "    gl_BackColor = gl_FrontColor;\n"
+        "}\n";
+
+    template <typename T>
+    bool LoadProc(T& proc, const char* name)
+    {
+        proc = reinterpret_cast<T>(wglGetProcAddress(name));
+        return proc != nullptr;
+    }
+
+    GLuint CompileSkinningShader()
+    {
+        char header[64];
+        sprintf(header, "#version 120\n#define MAX_SKIN_BONES %d\n", s_iMaxSkinBones);
+        const char* sources[2] = { header, s_szVertexShader };
+
+        GLuint shader = pglCreateShader(GL_VERTEX_SHADER);
+        pglShaderSource(shader, 2, sources, nullptr);
+        pglCompileShader(shader);
+
+        GLint status = GL_FALSE;
+        pglGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+        if (status != GL_TRUE)
+        {
+            char log[1024] = {};
+            pglGetShaderInfoLog(shader, sizeof(log) - 1, nullptr, log);
+            g_ErrorReport.Write(L"> Mesh buffer shader compile failed: %hs\r\n", log);
+            pglDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    }
+
+    bool CreateSkinningProgram()
+    {
+        GLuint shader = CompileSkinningShader();
+        if (shader == 0)
+            return false;
+
+        GLuint program = pglCreateProgram();
+        pglAttachShader(program, shader);
+        pglBindAttribLocation(program, SKIN_ATTRIBUTE, "Skin");
+        pglLinkProgram(program);
+        pglDeleteShader(shader);
+
+        GLint status = GL_FALSE;
+        pglGetProgramiv(program, GL_LINK_STATUS, &status);
+        if (status != GL_TRUE)
+        {
+            g_ErrorReport.Write(L"> Mesh buffer shader link failed.\r\n");
+            return false;
+        }
+
+        s_Program.Program = program;
+        s_Program.Bones = pglGetUniformLocation(program, "Bones");
+        s_Program.SkinParams = pglGetUniformLocation(program, "SkinParams");
+        s_Program.BodyOrigin = pglGetUniformLocation(program, "BodyOrigin");
+        s_Program.LightPosition = pglGetUniformLocation(program, "LightPosition");
+        s_Program.BodyColor = pglGetUniformLocation(program, "BodyColor");
+        s_Program.RenderParams = pglGetUniformLocation(program, "RenderParams");
+        s_Program.ChromeParams = pglGetUniformLocation(program, "ChromeParams");
+        s_Program.ChromeLight = pglGetUniformLocation(program, "ChromeLight");
+        s_Program.TexCoordOffset = pglGetUniformLocation(program, "TexCoordOffset");
+        return true;
+    }
+
+    int GetChromeMode(int renderFlags)
+    {
+        if ((renderFlags & RENDER_CHROME2) == RENDER_CHROME2) return MESH_BUFFER_CHROME_2;
+        if ((renderFlags & RENDER_CHROME3) == RENDER_CHROME3) return MESH_BUFFER_CHROME_3;
+        if ((renderFlags & RENDER_CHROME4) == RENDER_CHROME4) return MESH_BUFFER_CHROME_4;
+        if ((renderFlags & RENDER_CHROME5) == RENDER_CHROME5) return MESH_BUFFER_CHROME_5;
+        if ((renderFlags & RENDER_CHROME6) == RENDER_CHROME6) return MESH_BUFFER_CHROME_6;
+        if ((renderFlags & RENDER_CHROME7) == RENDER_CHROME7) return MESH_BUFFER_CHROME_7;
+        if ((renderFlags & RENDER_OIL) == RENDER_OIL) return MESH_BUFFER_CHROME_OIL;
+        if ((renderFlags & RENDER_CHROME) == RENDER_CHROME) return MESH_BUFFER_CHROME_1;
+        return MESH_BUFFER_CHROME_METAL;
+    }
+
+    void CreateMeshBuffer(Mesh_t* m)
+    {
+        if (m->NumTriangles <= 0 || m->Vertices == nullptr || m->Normals == nullptr || m->TexCoords == nullptr)
+            return;
+
+        std::vector<MeshBufferVertex_t> vertices;
+        std::vector<GLuint> indices;
+        std::map<unsigned long long, GLuint> corners;
+        vertices.reserve(m->NumVertices);
+        indices.reserve(m->NumTriangles * 3);
+
+        for (int j = 0; j < m->NumTriangles; j++)
+        {
+            const Triangle_t* tp = &m->Triangles[j];
+            if (tp->Polygon != 3)
+                return;
+
+            for (int k = 0; k < 3; k++)
+            {
+                const int vi = tp->VertexIndex[k];
+                const int ni = tp->NormalIndex[k];
+                const int ti = tp->TexCoordIndex[k];
+                if (vi < 0 || vi >= m->NumVertices || ni < 0 || ni >= m->NumNormals || ti < 0 || ti >= m->NumTexCoords)
+                    return;
+
+                const unsigned long long key = (static_cast<unsigned long long>(vi) << 32) | (static_cast<unsigned long long>(ni) << 16) | ti;
+                auto it = corners.find(key);
+                if (it != corners.end())
+                {
+                    indices.push_back(it->second);
+                    continue;
+                }
+
+                MeshBufferVertex_t vertex;
+                VectorCopy(m->Vertices[vi].Position, vertex.Position);
+                VectorCopy(m->Normals[ni].Normal, vertex.Normal);
+                vertex.TexCoord[0] = m->TexCoords[ti].TexCoordU;
+                vertex.TexCoord[1] = m->TexCoords[ti].TexCoordV;
+                vertex.Skin[0] = static_cast<float>(m->Vertices[vi].Node);
+                vertex.Skin[1] = static_cast<float>(m->Normals[ni].Node);
+                vertex.Skin[2] = static_cast<float>(fmod(vi * 931 * 0.007, 2.0 * Q_PI));
+
+                const auto index = static_cast<GLuint>(vertices.size());
+                corners.emplace(key, index);
+                vertices.push_back(vertex);
+                indices.push_back(index);
+            }
+        }
+
+        pglGenBuffers(1, &m->VertexBuffer);
+        pglBindBuffer(GL_ARRAY_BUFFER, m->VertexBuffer);
+        pglBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(MeshBufferVertex_t), vertices.data(), GL_STATIC_DRAW);
+        pglBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        pglGenBuffers(1, &m->IndexBuffer);
+        pglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m->IndexBuffer);
+        if (vertices.size() <= 0xFFFF)
+        {
+            std::vector<GLushort> shortIndices(indices.begin(), indices.end());
+            pglBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(GLushort), shortIndices.data(), GL_STATIC_DRAW);
+            m->IndexType = GL_UNSIGNED_SHORT;
+        }
+        else
+        {
+            pglBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+            m->IndexType = GL_UNSIGNED_INT;
+        }
+        pglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        m->NumIndices = static_cast<int>(indices.size());
+    }
+}
+
+void InitMeshBuffers()
+{
+    s_bAvailable = false;
+
+    bool loaded = LoadProc(pglGenBuffers, "glGenBuffers")
+        && LoadProc(pglDeleteBuffers, "glDeleteBuffers")
+        && LoadProc(pglBindBuffer, "glBindBuffer")
+        && LoadProc(pglBufferData, "glBufferData")
+        && LoadProc(pglCreateShader, "glCreateShader")
+        && LoadProc(pglDeleteShader, "glDeleteShader")
+        && LoadProc(pglShaderSource, "glShaderSource")
+        && LoadProc(pglCompileShader, "glCompileShader")
+        && LoadProc(pglGetShaderiv, "glGetShaderiv")
+        && LoadProc(pglGetShaderInfoLog, "glGetShaderInfoLog")
+        && LoadProc(pglCreateProgram, "glCreateProgram")
+        && LoadProc(pglAttachShader, "glAttachShader")
+        && LoadProc(pglBindAttribLocation, "glBindAttribLocation")
+        && LoadProc(pglLinkProgram, "glLinkProgram")
+        && LoadProc(pglGetProgramiv, "glGetProgramiv")
+        && LoadProc(pglUseProgram, "glUseProgram")
+        && LoadProc(pglGetUniformLocation, "glGetUniformLocation")
+        && LoadProc(pglUniform4fv, "glUniform4fv")
+        && LoadProc(pglUniform4f, "glUniform4f")
+        && LoadProc(pglUniform3f, "glUniform3f")
+        && LoadProc(pglUniform2f, "glUniform2f")
+        && LoadProc(pglVertexAttribPointer, "glVertexAttribPointer")
+        && LoadProc(pglEnableVertexAttribArray, "glEnableVertexAttribArray")
+        && LoadProc(pglDisableVertexAttribArray, "glDisableVertexAttribArray");
+
+    if (!loaded)
+    {
+        g_ErrorReport.Write(L"> Mesh buffers unavailable, using client arrays.\r\n");
+        return;
+    }
+
+    // Reserve a few vec4 slots for the non-palette uniforms.
+    GLint maxComponents = 0;
+    glGetIntegerv(GL_MAX_VERTEX_UNIFORM_COMPONENTS, &maxComponents);
+    s_iMaxSkinBones = min(MAX_BONES, (maxComponents / 4 - 16) / 3);
+    if (s_iMaxSkinBones <= 0)
+        return;
+
+    if (!CreateSkinningProgram())
+        return;
+
+    s_bAvailable = true;
+    g_ErrorReport.Write(L"> Mesh buffers enabled (%d bones per draw).\r\n", s_iMaxSkinBones);
+}
+
+bool IsMeshBufferAvailable()
+{
+    return s_bAvailable;
+}
+
+void CreateMeshBuffers(BMD* pModel)
+{
+    if (!s_bAvailable || pModel->NumBones > s_iMaxSkinBones)
+        return;
+
+    for (int i = 0; i < pModel->NumMeshs; i++)
+    {
+        Mesh_t* m = &pModel->Meshs[i];
+        if (m->VertexBuffer == 0)
+        {
+            CreateMeshBuffer(m);
+        }
+    }
+}
+
+void ReleaseMeshBuffers(BMD* pModel)
+{
+    if (pModel->Meshs == nullptr)
+        return;
+
+    FlushRenderQueue();
+
+    for (int i = 0; i < pModel->NumMeshs; i++)
+    {
+        Mesh_t* m = &pModel->Meshs[i];
+        if (m->VertexBuffer != 0)
+        {
+            pglDeleteBuffers(1, &m->VertexBuffer);
+            m->VertexBuffer = 0;
+        }
+        if (m->IndexBuffer != 0)
+        {
+            pglDeleteBuffers(1, &m->IndexBuffer);
+            m->IndexBuffer = 0;
+        }
+        m->NumIndices = 0;
+    }
+
+    if (s_Skinning.Owner == pModel)
+    {
+        s_Skinning.Owner = nullptr;
+    }
+}
+
+void SetSkinningPalette(const BMD* pModel, float(*BoneMatrix)[3][4], bool Translate, float Scale, const float* LightPosition)
+{
+    if (!s_bAvailable || pModel->NumBones > s_iMaxSkinBones)
+    {
+        s_Skinning.Owner = nullptr;
+        return;
+    }
+
+    s_Skinning.Owner = pModel;
+    s_iQueuedSkinning = -1;
+    s_Skinning.NumBones = pModel->NumBones;
+    s_Skinning.Translate = Translate;
+    s_Skinning.Scale = Scale;
+    s_Skinning.BoneScale = BoneScale;
+    s_Skinning.BodyScale = pModel->BodyScale;
+    VectorCopy(pModel->BodyOrigin, s_Skinning.BodyOrigin);
+    s_Skinning.LightValid = LightPosition != nullptr;
+    if (LightPosition != nullptr)
+    {
+        VectorCopy(LightPosition, s_Skinning.LightPosition);
+    }
+    memcpy(s_Skinning.Palette, BoneMatrix, sizeof(float) * 12 * pModel->NumBones);
+}
+
+void InvalidateSkinningPalette()
+{
+    s_Skinning.Owner = nullptr;
+    s_iQueuedSkinning = -1;
+    MarkTransformPatched();
+}
+
+namespace
+{
+    struct MeshBufferDraw_t
+    {
+        const Mesh_t* Mesh;
+        float         BodyColor[4];
+        float         RenderParams[4];
+        float         ChromeParams[4];
+        float         ChromeLight[3];
+        float         TexCoordOffset[2];
+    };
+
+    struct QueuedMeshBufferDraw_t
+    {
+        MeshBufferDraw_t Draw;
+        int              Skinning;
+    };
+
+    bool PrepareMeshBufferDraw(BMD* pModel, int meshIndex, int renderFlags, int finalRenderFlags, bool enableLight, bool enableColor, bool enableWave,
+        float alpha, float blendMeshTextureCoordU, float blendMeshTextureCoordV, MeshBufferDraw_t& draw)
+    {
+        if (!g_bUseMeshBuffers || !s_bAvailable || s_Skinning.Owner != pModel)
+            return false;
+
+        Mesh_t* m = &pModel->Meshs[meshIndex];
+        if (m->VertexBuffer == 0)
+            return false;
+
+        if (enableLight && finalRenderFlags == RENDER_TEXTURE && !s_Skinning.LightValid)
+            return false;
+
+        float mode = MESH_BUFFER_MODE_PLAIN;
+        switch (finalRenderFlags)
+        {
+        case RENDER_TEXTURE: mode = MESH_BUFFER_MODE_TEXTURE; break;
+        case RENDER_CHROME: mode = MESH_BUFFER_MODE_CHROME; break;
+        case RENDER_CHROME4: mode = MESH_BUFFER_MODE_CHROME4; break;
+        case RENDER_OIL: mode = MESH_BUFFER_MODE_OIL; break;
+        }
+
+        float wavePhase = -1.f;
+        if ((renderFlags & RENDER_SHADOWMAP) != RENDER_SHADOWMAP && (renderFlags & RENDER_WAVE) == RENDER_WAVE)
+        {
+            wavePhase = static_cast<float>(fmod(static_cast<int>(WorldTime) * 0.007, 2.0 * Q_PI));
+        }
+
+        float offsetU = 0.f;
+        float offsetV = 0.f;
+        if (finalRenderFlags != RENDER_TEXTURE || enableWave)
+        {
+            offsetU = blendMeshTextureCoordU;
+            offsetV = blendMeshTextureCoordV;
+        }
+
+        const float wave = static_cast<long>(WorldTime) % 10000 * 0.0001f;
+        const float wave2 = static_cast<int>(WorldTime) % 5000 * 0.00024f - 0.4f;
+
+        draw.Mesh = m;
+        Vector4(pModel->BodyLight[0], pModel->BodyLight[1], pModel->BodyLight[2], alpha, draw.BodyColor);
+        Vector4(mode, enableLight ? 1.f : 0.f, enableColor ? 1.f : 0.f, wavePhase, draw.RenderParams);
+        Vector4(static_cast<float>(GetChromeMode(renderFlags)), wave, wave2, static_cast<float>(WorldTime) * 0.00006f, draw.ChromeParams);
+        Vector(cosf(WorldTime * 0.001f), sinf(WorldTime * 0.002f), 1.f, draw.ChromeLight);
+        draw.TexCoordOffset[0] = offsetU;
+        draw.TexCoordOffset[1] = offsetV;
+        return true;
+    }
+
+    void BeginMeshBufferBatch()
+    {
+        pglUseProgram(s_Program.Program);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_NORMAL_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        pglEnableVertexAttribArray(SKIN_ATTRIBUTE);
+    }
+
+    void UploadSkinning(int numBones, const float* palette, float scale, bool translate, float boneScale, float bodyScale, const vec3_t bodyOrigin, const vec3_t lightPosition)
+    {
+        pglUniform4fv(s_Program.Bones, numBones * 3, palette);
+        pglUniform4f(s_Program.SkinParams, boneScale, scale, bodyScale, translate ? 1.f : 0.f);
+        pglUniform3f(s_Program.BodyOrigin, bodyOrigin[0], bodyOrigin[1], bodyOrigin[2]);
+        pglUniform3f(s_Program.LightPosition, lightPosition[0], lightPosition[1], lightPosition[2]);
+    }
+
+    void DrawMeshBuffer(const MeshBufferDraw_t& draw)
+    {
+        const Mesh_t* m = draw.Mesh;
+
+        pglUniform4fv(s_Program.BodyColor, 1, draw.BodyColor);
+        pglUniform4fv(s_Program.RenderParams, 1, draw.RenderParams);
+        pglUniform4fv(s_Program.ChromeParams, 1, draw.ChromeParams);
+        pglUniform3f(s_Program.ChromeLight, draw.ChromeLight[0], draw.ChromeLight[1], draw.ChromeLight[2]);
+        pglUniform2f(s_Program.TexCoordOffset, draw.TexCoordOffset[0], draw.TexCoordOffset[1]);
+
+        pglBindBuffer(GL_ARRAY_BUFFER, m->VertexBuffer);
+        pglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m->IndexBuffer);
+
+        constexpr GLsizei stride = sizeof(MeshBufferVertex_t);
+        glVertexPointer(3, GL_FLOAT, stride, reinterpret_cast<const void*>(offsetof(MeshBufferVertex_t, Position)));
+        glNormalPointer(GL_FLOAT, stride, reinterpret_cast<const void*>(offsetof(MeshBufferVertex_t, Normal)));
+        glTexCoordPointer(2, GL_FLOAT, stride, reinterpret_cast<const void*>(offsetof(MeshBufferVertex_t, TexCoord)));
+        pglVertexAttribPointer(SKIN_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(offsetof(MeshBufferVertex_t, Skin)));
+
+        ++g_RenderCounters.DrawCalls;
+        glDrawElements(GL_TRIANGLES, m->NumIndices, m->IndexType, nullptr);
+    }
+
+    void EndMeshBufferBatch()
+    {
+        pglDisableVertexAttribArray(SKIN_ATTRIBUTE);
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glDisableClientState(GL_NORMAL_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+
+        pglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        pglBindBuffer(GL_ARRAY_BUFFER, 0);
+        pglUseProgram(0);
+    }
+
+    bool s_bQueuedBatch = false;
+    int  s_iUploadedSkinning = -1;
+
+    void DrawQueuedMeshBuffer(const void* data)
+    {
+        const QueuedMeshBufferDraw_t* queued = static_cast<const QueuedMeshBufferDraw_t*>(data);
+        if (!s_bQueuedBatch)
+        {
+            BeginMeshBufferBatch();
+            s_bQueuedBatch = true;
+            s_iUploadedSkinning = -1;
+        }
+
+        // draws sharing a palette are sorted next to each other, so it is sent once
+        if (s_iUploadedSkinning != queued->Skinning)
+        {
+            const QueuedSkinning_t& s = s_QueuedSkinning[queued->Skinning];
+            UploadSkinning(s.NumBones, &s_QueuedBones[s.Bones], s.Scale, s.Translate, s.BoneScale, s.BodyScale, s.BodyOrigin, s.LightPosition);
+            s_iUploadedSkinning = queued->Skinning;
+        }
+
+        DrawMeshBuffer(queued->Draw);
+    }
+
+    void EndQueuedMeshBuffer()
+    {
+        if (s_bQueuedBatch)
+        {
+            EndMeshBufferBatch();
+            s_bQueuedBatch = false;
+        }
+    }
+
+    const RENDER_COMMAND_HANDLER s_QueuedMeshBufferHandler = { DrawQueuedMeshBuffer, EndQueuedMeshBuffer };
+}
+
+bool RenderMeshBuffer(BMD* pModel, int meshIndex, int renderFlags, int finalRenderFlags, bool enableLight, bool enableColor, bool enableWave,
+    float alpha, float blendMeshTextureCoordU, float blendMeshTextureCoordV)
+{
+    MeshBufferDraw_t draw;
+    if (!PrepareMeshBufferDraw(pModel, meshIndex, renderFlags, finalRenderFlags, enableLight, enableColor, enableWave,
+        alpha, blendMeshTextureCoordU, blendMeshTextureCoordV, draw))
+        return false;
+
+    BeginMeshBufferBatch();
+    UploadSkinning(s_Skinning.NumBones, &s_Skinning.Palette[0][0][0], s_Skinning.Scale, s_Skinning.Translate,
+        s_Skinning.BoneScale, s_Skinning.BodyScale, s_Skinning.BodyOrigin, s_Skinning.LightPosition);
+    DrawMeshBuffer(draw);
+    EndMeshBufferBatch();
+    return true;
+}
+
+bool QueueMeshBuffer(BMD* pModel, int meshIndex, const RENDER_STATE& state, int renderFlags, int finalRenderFlags, bool enableLight, bool enableWave,
+    float alpha, float blendMeshTextureCoordU, float blendMeshTextureCoordV)
+{
+    if (!IsRenderQueueRecording() || GetRenderPass(state) == RENDER_PASS_NONE)
+        return false;
+
+    QueuedMeshBufferDraw_t queued;
+    if (!PrepareMeshBufferDraw(pModel, meshIndex, renderFlags, finalRenderFlags, enableLight, true, enableWave,
+        alpha, blendMeshTextureCoordU, blendMeshTextureCoordV, queued.Draw))
+        return false;
+
+    if (IsRenderQueueEmpty())
+    {
+        s_QueuedSkinning.clear();
+        s_QueuedBones.clear();
+        s_iQueuedSkinning = -1;
+    }
+
+    // one palette copy per Transform, shared by the meshes drawn with it
+    if (s_iQueuedSkinning < 0)
+    {
+        QueuedSkinning_t skinning;
+        skinning.NumBones = s_Skinning.NumBones;
+        skinning.Scale = s_Skinning.Scale;
+        skinning.Translate = s_Skinning.Translate;
+        skinning.BoneScale = s_Skinning.BoneScale;
+        skinning.BodyScale = s_Skinning.BodyScale;
+        VectorCopy(s_Skinning.BodyOrigin, skinning.BodyOrigin);
+        VectorCopy(s_Skinning.LightPosition, skinning.LightPosition);
+        skinning.Bones = s_QueuedBones.size();
+
+        const float* palette = &s_Skinning.Palette[0][0][0];
+        s_QueuedBones.insert(s_QueuedBones.end(), palette, palette + s_Skinning.NumBones * 12);
+        s_QueuedSkinning.push_back(skinning);
+        s_iQueuedSkinning = static_cast<int>(s_QueuedSkinning.size()) - 1;
+    }
+    queued.Skinning = s_iQueuedSkinning;
+
+    return SubmitRenderCommand(state, &s_QueuedMeshBufferHandler, &queued, sizeof(queued), static_cast<unsigned int>(queued.Skinning));
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+// GPU-resident geometry for BMD meshes.
+//
+// Every Mesh_t gets a static vertex buffer (bind-pose position, normal, texture
+// coordinate and bone indices) and an index buffer, uploaded once when the model
+// is opened. At draw time only the bone palette recorded by the last BMD::Transform
+// is sent to the vertex shader; colour and texture coordinate generation for the
+// RENDER_* modes supported by BMD::RenderMesh are reproduced there. The fragment
+// stage stays fixed-function so blending, alpha test and fog keep working as before.
+//
+// When the driver lacks buffer objects / GLSL, the model has more bones than the
+// shader can hold, or CPU code has patched the transformed arrays between Transform
+// and RenderMesh, BMD::RenderMesh falls back to the legacy client-array path.
+
+class BMD;
+struct RENDER_STATE;
+
+extern bool g_bUseMeshBuffers;
+
+void InitMeshBuffers();
+bool IsMeshBufferAvailable();
+
+void CreateMeshBuffers(BMD* pModel);
+void ReleaseMeshBuffers(BMD* pModel);
+
+void SetSkinningPalette(const BMD* pModel, float(*BoneMatrix)[3][4], bool Translate, float Scale, const float* LightPosition);
+void InvalidateSkinningPalette();
+
+bool RenderMeshBuffer(BMD* pModel, int meshIndex, int renderFlags, int finalRenderFlags, bool enableLight, bool enableColor, bool enableWave,
+    float alpha, float blendMeshTextureCoordU, float blendMeshTextureCoordV);
+
+// Defers the draw to the render queue with its own copy of the palette. Only draws that
+// take their colour from the shader (no glColor) and whose state is queueable qualify.
+bool QueueMeshBuffer(BMD* pModel, int meshIndex, const RENDER_STATE& state, int renderFlags, int finalRenderFlags, bool enableLight, bool enableWave,
+    float alpha, float blendMeshTextureCoordU, float blendMeshTextureCoordV);
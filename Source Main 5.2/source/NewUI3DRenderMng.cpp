@@ -5,6 +5,7 @@
 #include "stdafx.h"
 #include "NewUI3DRenderMng.h"
 #include "NewUIManager.h"
+#include "ItemIconCache.h"
 
 using namespace SEASON3B;
 
@@ -136,6 +137,8 @@ bool SEASON3B::CNewUI3DCamera::Render()
     glPopMatrix();
     BeginBitmap();
 
+    FlushItemIcons();
+
     while (!m_deque2DEffects.empty())
     {
         UI_2DEFFECT_INFO& UI2DEffectInfo = m_deque2DEffects.front();
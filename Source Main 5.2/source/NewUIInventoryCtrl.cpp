@@ -1548,7 +1548,8 @@ void SEASON3B::CNewUIInventoryCtrl::Render3D()
         const float height = pItemAttr->Height * INVENTORY_SQUARE_HEIGHT;
         glColor4f(1.f, 1.f, 1.f, 1.f);
 
-        RenderItem3D(x, y, width, height, pItem->Type, pItem->Level, pItem->ExcellentFlags, pItem->AncientDiscriminator, false);
+        if (!RenderItemIcon(x, y, width, height, pItem->Type, pItem->Level, pItem->ExcellentFlags, pItem->AncientDiscriminator))
+            RenderItem3D(x, y, width, height, pItem->Type, pItem->Level, pItem->ExcellentFlags, pItem->AncientDiscriminator, false);
     }
 }
 
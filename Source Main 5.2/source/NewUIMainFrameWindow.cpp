@@ -966,14 +966,14 @@ bool SEASON3B::CNewUIItemHotKey::UpdateKeyEvent()
         pItem = g_pMyInventory->FindItem(iIndex);
         if ((pItem->Type >= ITEM_POTION + 78 && pItem->Type <= ITEM_POTION + 82))
         {
-            std::list<eBuffState> secretPotionbufflist;
-            secretPotionbufflist.push_back(eBuff_SecretPotion1);
-            secretPotionbufflist.push_back(eBuff_SecretPotion2);
-            secretPotionbufflist.push_back(eBuff_SecretPotion3);
-            secretPotionbufflist.push_back(eBuff_SecretPotion4);
-            secretPotionbufflist.push_back(eBuff_SecretPotion5);
-
-            if (g_isCharacterBufflist((&Hero->Object), secretPotionbufflist) != eBuffNone) {
+            BuffStateSet secretPotionbuffset;
+            secretPotionbuffset.set(eBuff_SecretPotion1);
+            secretPotionbuffset.set(eBuff_SecretPotion2);
+            secretPotionbuffset.set(eBuff_SecretPotion3);
+            secretPotionbuffset.set(eBuff_SecretPotion4);
+            secretPotionbuffset.set(eBuff_SecretPotion5);
+
+            if (g_isCharacterBufflist((&Hero->Object), secretPotionbuffset) != eBuffNone) {
                 SEASON3B::CreateOkMessageBox(GlobalText[2530], RGBA(255, 30, 0, 255));
             }
             else {
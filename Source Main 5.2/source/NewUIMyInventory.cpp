@@ -764,12 +764,19 @@ void CNewUIMyInventory::Render3D()
                 y = m_EquipmentSlots[i].y;
             }
 
+            const float x = m_EquipmentSlots[i].x + 1;
+            const float width = m_EquipmentSlots[i].width - 4;
+            const float height = m_EquipmentSlots[i].height - 4;
+
             glColor4f(1.f, 1.f, 1.f, 1.f);
+            if (RenderItemIcon(x, y, width, height, pEquippedItem->Type, pEquippedItem->Level, pEquippedItem->ExcellentFlags, pEquippedItem->AncientDiscriminator))
+                continue;
+
             RenderItem3D(
-                m_EquipmentSlots[i].x + 1,
+                x,
                 y,
-                m_EquipmentSlots[i].width - 4,
-                m_EquipmentSlots[i].height - 4,
+                width,
+                height,
                 pEquippedItem->Type,
                 pEquippedItem->Level,
                 pEquippedItem->ExcellentFlags,
@@ -1709,14 +1716,14 @@ bool CNewUIMyInventory::TryConsumeItem(CNewUIInventoryCtrl* targetControl, ITEM*
 
     if ((pItem->Type >= ITEM_POTION + 78 && pItem->Type <= ITEM_POTION + 82))
     {
-        std::list<eBuffState> secretPotionbufflist;
-        secretPotionbufflist.push_back(eBuff_SecretPotion1);
-        secretPotionbufflist.push_back(eBuff_SecretPotion2);
-        secretPotionbufflist.push_back(eBuff_SecretPotion3);
-        secretPotionbufflist.push_back(eBuff_SecretPotion4);
-        secretPotionbufflist.push_back(eBuff_SecretPotion5);
+        BuffStateSet secretPotionbuffset;
+        secretPotionbuffset.set(eBuff_SecretPotion1);
+        secretPotionbuffset.set(eBuff_SecretPotion2);
+        secretPotionbuffset.set(eBuff_SecretPotion3);
+        secretPotionbuffset.set(eBuff_SecretPotion4);
+        secretPotionbuffset.set(eBuff_SecretPotion5);
 
-        if (g_isCharacterBufflist((&Hero->Object), secretPotionbufflist) == eBuffNone) {
+        if (g_isCharacterBufflist((&Hero->Object), secretPotionbuffset) == eBuffNone) {
             SendRequestUse(iIndex, 0);
             return true;
         }
@@ -8,6 +8,7 @@
 #include "ZzzCharacter.h"
 #include "zzzEffect.h"
 #include "MapManager.h"
+#include "MeshBuffer.h"
 
 #define RENDER_CLOTH
 #define ADD_COLLISION
@@ -1181,6 +1182,7 @@ void CPhysicsClothMesh::Render(vec3_t* pvColor, int iLevel)
         m_pVertices[iVertex].GetPosition(&vPos);
         VectorCopy(vPos, VertexTransform[m_iMesh][iVertex]);
     }
+    InvalidateSkinningPalette();
 }
 
 float CPhysicsManager::s_fWind = 0.0f;
@@ -0,0 +1,443 @@
+// HeadlessGL.cpp - OpenGL stand-in for the replay build
+//
+// The "Global Replay" configuration defines MU_HEADLESS_REPLAY and links this file instead
+// of opengl32.lib and glu32.lib, so a packet capture (/x) can be replayed on a machine
+// without a GPU or a display driver. Every GL, GLU and WGL entry point the client calls is
+// defined here. Draw calls do nothing; the state the client reads back (matrix stacks,
+// viewport, current colour, enable flags, texture names) is tracked so camera matrices,
+// picking and the render queue behave the same way they do with a real context.
+// wglGetProcAddress returns null, which sends the mesh buffer, VSync and icon cache code
+// down their no-extension fallbacks.
+//
+// The replay build is Windows-only (MSVC, Win32). It replaces the GPU, not the OS: the
+// simulation code it drives still needs Win32 and Winsock (Winmain.cpp, WSclient.cpp, the
+// DirectSound mixer behind the Null audio device), and "Source Main 5.2" has no CMake
+// project the root CMakeLists.txt can add, so there is no Linux replay target yet.
+
+#ifdef MU_HEADLESS_REPLAY
+
+#ifndef NOMINMAX
+    #define NOMINMAX
+#endif
+// Keeps wingdi.h from declaring the wgl functions below as dllimport.
+#define NOGDI
+#include <windows.h>
+#include <cmath>
+#include <cstring>
+#include <unordered_set>
+#include <vector>
+
+typedef unsigned int GLenum;
+typedef unsigned char GLboolean;
+typedef unsigned int GLbitfield;
+typedef int GLint;
+typedef int GLsizei;
+typedef unsigned int GLuint;
+typedef unsigned char GLubyte;
+typedef float GLfloat;
+typedef float GLclampf;
+typedef double GLdouble;
+typedef void GLvoid;
+struct GLUquadric;
+
+namespace
+{
+    constexpr GLenum HGL_CURRENT_COLOR = 0x0B00;
+    constexpr GLenum HGL_VIEWPORT = 0x0BA2;
+    constexpr GLenum HGL_SCISSOR_BOX = 0x0C10;
+    constexpr GLenum HGL_MODELVIEW_MATRIX = 0x0BA6;
+    constexpr GLenum HGL_PROJECTION_MATRIX = 0x0BA7;
+    constexpr GLenum HGL_COLOR_CLEAR_VALUE = 0x0C22;
+    constexpr GLenum HGL_PACK_ALIGNMENT = 0x0D05;
+    constexpr GLenum HGL_UNPACK_ALIGNMENT = 0x0CF5;
+    constexpr GLenum HGL_MAX_TEXTURE_SIZE = 0x0D33;
+    constexpr GLenum HGL_DEPTH_COMPONENT = 0x1902;
+    constexpr GLenum HGL_FLOAT = 0x1406;
+    constexpr GLenum HGL_MODELVIEW = 0x1700;
+    constexpr GLenum HGL_PROJECTION = 0x1701;
+    constexpr GLenum HGL_VENDOR = 0x1F00;
+    constexpr GLenum HGL_RENDERER = 0x1F01;
+    constexpr GLenum HGL_VERSION = 0x1F02;
+    constexpr GLenum HGL_TEXTURE_BINDING_2D = 0x8069;
+    constexpr GLenum HGL_TEXTURE_WIDTH = 0x1000;
+    constexpr GLenum HGL_TEXTURE_HEIGHT = 0x1001;
+
+    struct MATRIX4
+    {
+        GLfloat m[16];
+    };
+
+    // Column-major like GL, so GL_MODELVIEW_MATRIX reads back exactly what a driver returns.
+    MATRIX4 Identity()
+    {
+        MATRIX4 r = {};
+        r.m[0] = r.m[5] = r.m[10] = r.m[15] = 1.f;
+        return r;
+    }
+
+    MATRIX4 Multiply(const MATRIX4& a, const MATRIX4& b)
+    {
+        MATRIX4 r;
+        for (int c = 0; c < 4; ++c)
+        {
+            for (int row = 0; row < 4; ++row)
+            {
+                GLfloat sum = 0.f;
+                for (int k = 0; k < 4; ++k)
+                    sum += a.m[k * 4 + row] * b.m[c * 4 + k];
+                r.m[c * 4 + row] = sum;
+            }
+        }
+        return r;
+    }
+
+    struct HEADLESS_CONTEXT
+    {
+        std::vector<MATRIX4> ModelView{ Identity() };
+        std::vector<MATRIX4> Projection{ Identity() };
+        std::vector<MATRIX4> Texture{ Identity() };
+        GLenum MatrixMode = HGL_MODELVIEW;
+        GLint Viewport[4] = { 0, 0, 640, 480 };
+        GLint ScissorBox[4] = { 0, 0, 640, 480 };
+        GLfloat Color[4] = { 1.f, 1.f, 1.f, 1.f };
+        GLfloat ClearColor[4] = {};
+        GLint PackAlignment = 4;
+        GLint UnpackAlignment = 4;
+        GLuint BoundTexture = 0;
+        GLuint NextTexture = 1;
+        std::unordered_set<GLenum> Enabled;
+        HDC CurrentDC = nullptr;
+        HGLRC CurrentRC = nullptr;
+    };
+
+    HEADLESS_CONTEXT g_Context;
+
+    MATRIX4& Top()
+    {
+        switch (g_Context.MatrixMode)
+        {
+        case HGL_PROJECTION: return g_Context.Projection.back();
+        case HGL_MODELVIEW: return g_Context.ModelView.back();
+        default: return g_Context.Texture.back();
+        }
+    }
+
+    std::vector<MATRIX4>& Stack()
+    {
+        switch (g_Context.MatrixMode)
+        {
+        case HGL_PROJECTION: return g_Context.Projection;
+        case HGL_MODELVIEW: return g_Context.ModelView;
+        default: return g_Context.Texture;
+        }
+    }
+
+    void MultiplyTop(const MATRIX4& m)
+    {
+        Top() = Multiply(Top(), m);
+    }
+
+    void SetColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+    {
+        g_Context.Color[0] = r;
+        g_Context.Color[1] = g;
+        g_Context.Color[2] = b;
+        g_Context.Color[3] = a;
+    }
+
+    void Ortho(GLdouble l, GLdouble r, GLdouble b, GLdouble t, GLdouble n, GLdouble f)
+    {
+        MATRIX4 m = Identity();
+        m.m[0] = (GLfloat)(2.0 / (r - l));
+        m.m[5] = (GLfloat)(2.0 / (t - b));
+        m.m[10] = (GLfloat)(-2.0 / (f - n));
+        m.m[12] = (GLfloat)(-(r + l) / (r - l));
+        m.m[13] = (GLfloat)(-(t + b) / (t - b));
+        m.m[14] = (GLfloat)(-(f + n) / (f - n));
+        MultiplyTop(m);
+    }
+
+    // Large enough to be read as an empty wide string too (IsGLExtensionSupported casts it).
+    const GLubyte s_EmptyString[8] = {};
+}
+
+extern "C"
+{
+// Matrix state
+
+void APIENTRY glMatrixMode(GLenum mode) { g_Context.MatrixMode = mode; }
+void APIENTRY glLoadIdentity() { Top() = Identity(); }
+void APIENTRY glLoadMatrixf(const GLfloat* m) { memcpy(Top().m, m, sizeof(MATRIX4)); }
+void APIENTRY glPushMatrix() { Stack().push_back(Top()); }
+
+void APIENTRY glPopMatrix()
+{
+    if (Stack().size() > 1)
+        Stack().pop_back();
+}
+
+void APIENTRY glTranslatef(GLfloat x, GLfloat y, GLfloat z)
+{
+    MATRIX4 m = Identity();
+    m.m[12] = x;
+    m.m[13] = y;
+    m.m[14] = z;
+    MultiplyTop(m);
+}
+
+void APIENTRY glScalef(GLfloat x, GLfloat y, GLfloat z)
+{
+    MATRIX4 m = Identity();
+    m.m[0] = x;
+    m.m[5] = y;
+    m.m[10] = z;
+    MultiplyTop(m);
+}
+
+void APIENTRY glRotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z)
+{
+    const GLfloat length = sqrtf(x * x + y * y + z * z);
+    if (length <= 0.f)
+        return;
+    x /= length;
+    y /= length;
+    z /= length;
+
+    const GLfloat radians = angle * 3.14159265358979f / 180.f;
+    const GLfloat c = cosf(radians);
+    const GLfloat s = sinf(radians);
+    const GLfloat t = 1.f - c;
+
+    MATRIX4 m = Identity();
+    m.m[0] = x * x * t + c;
+    m.m[1] = y * x * t + z * s;
+    m.m[2] = x * z * t - y * s;
+    m.m[4] = x * y * t - z * s;
+    m.m[5] = y * y * t + c;
+    m.m[6] = y * z * t + x * s;
+    m.m[8] = x * z * t + y * s;
+    m.m[9] = y * z * t - x * s;
+    m.m[10] = z * z * t + c;
+    MultiplyTop(m);
+}
+
+void APIENTRY glOrtho(GLdouble l, GLdouble r, GLdouble b, GLdouble t, GLdouble n, GLdouble f) { Ortho(l, r, b, t, n, f); }
+
+void APIENTRY glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    g_Context.Viewport[0] = x;
+    g_Context.Viewport[1] = y;
+    g_Context.Viewport[2] = width;
+    g_Context.Viewport[3] = height;
+}
+
+// Render state
+
+void APIENTRY glEnable(GLenum cap) { g_Context.Enabled.insert(cap); }
+void APIENTRY glDisable(GLenum cap) { g_Context.Enabled.erase(cap); }
+GLboolean APIENTRY glIsEnabled(GLenum cap) { return g_Context.Enabled.count(cap) ? 1 : 0; }
+
+void APIENTRY glClearColor(GLclampf r, GLclampf g, GLclampf b, GLclampf a)
+{
+    g_Context.ClearColor[0] = r;
+    g_Context.ClearColor[1] = g;
+    g_Context.ClearColor[2] = b;
+    g_Context.ClearColor[3] = a;
+}
+
+void APIENTRY glPixelStorei(GLenum name, GLint value)
+{
+    if (name == HGL_PACK_ALIGNMENT)
+        g_Context.PackAlignment = value;
+    else if (name == HGL_UNPACK_ALIGNMENT)
+        g_Context.UnpackAlignment = value;
+}
+
+void APIENTRY glAlphaFunc(GLenum, GLclampf) {}
+void APIENTRY glBlendFunc(GLenum, GLenum) {}
+void APIENTRY glDepthFunc(GLenum) {}
+void APIENTRY glDepthMask(GLboolean) {}
+void APIENTRY glColorMask(GLboolean, GLboolean, GLboolean, GLboolean) {}
+void APIENTRY glFrontFace(GLenum) {}
+void APIENTRY glPolygonMode(GLenum, GLenum) {}
+
+void APIENTRY glScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    g_Context.ScissorBox[0] = x;
+    g_Context.ScissorBox[1] = y;
+    g_Context.ScissorBox[2] = width;
+    g_Context.ScissorBox[3] = height;
+}
+
+void APIENTRY glStencilFunc(GLenum, GLint, GLuint) {}
+void APIENTRY glStencilOp(GLenum, GLenum, GLenum) {}
+void APIENTRY glFogf(GLenum, GLfloat) {}
+void APIENTRY glFogfv(GLenum, const GLfloat*) {}
+void APIENTRY glFogi(GLenum, GLint) {}
+void APIENTRY glTexEnvf(GLenum, GLenum, GLfloat) {}
+void APIENTRY glTexEnvi(GLenum, GLenum, GLint) {}
+
+// Queries
+
+void APIENTRY glGetIntegerv(GLenum name, GLint* params)
+{
+    switch (name)
+    {
+    case HGL_VIEWPORT: memcpy(params, g_Context.Viewport, sizeof(g_Context.Viewport)); break;
+    case HGL_SCISSOR_BOX: memcpy(params, g_Context.ScissorBox, sizeof(g_Context.ScissorBox)); break;
+    case HGL_MAX_TEXTURE_SIZE: params[0] = 2048; break;
+    case HGL_PACK_ALIGNMENT: params[0] = g_Context.PackAlignment; break;
+    case HGL_UNPACK_ALIGNMENT: params[0] = g_Context.UnpackAlignment; break;
+    case HGL_TEXTURE_BINDING_2D: params[0] = (GLint)g_Context.BoundTexture; break;
+    default: params[0] = 0; break;
+    }
+}
+
+void APIENTRY glGetFloatv(GLenum name, GLfloat* params)
+{
+    switch (name)
+    {
+    case HGL_MODELVIEW_MATRIX: memcpy(params, g_Context.ModelView.back().m, sizeof(MATRIX4)); break;
+    case HGL_PROJECTION_MATRIX: memcpy(params, g_Context.Projection.back().m, sizeof(MATRIX4)); break;
+    case HGL_CURRENT_COLOR: memcpy(params, g_Context.Color, sizeof(g_Context.Color)); break;
+    case HGL_COLOR_CLEAR_VALUE: memcpy(params, g_Context.ClearColor, sizeof(g_Context.ClearColor)); break;
+    default: params[0] = 0.f; break;
+    }
+}
+
+const GLubyte* APIENTRY glGetString(GLenum name)
+{
+    switch (name)
+    {
+    case HGL_VENDOR: return (const GLubyte*)"MU";
+    case HGL_RENDERER: return (const GLubyte*)"Headless replay";
+    case HGL_VERSION: return (const GLubyte*)"1.1";
+    default: return s_EmptyString;
+    }
+}
+
+GLenum APIENTRY glGetError() { return 0; }
+
+void APIENTRY glGetTexLevelParameteriv(GLenum, GLint, GLenum name, GLint* params)
+{
+    params[0] = (name == HGL_TEXTURE_WIDTH || name == HGL_TEXTURE_HEIGHT) ? 1 : 0;
+}
+
+// A cleared depth buffer, so depth tests against it always pass.
+void APIENTRY glReadPixels(GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid* pixels)
+{
+    if (!pixels)
+        return;
+
+    if (format == HGL_DEPTH_COMPONENT && type == HGL_FLOAT)
+    {
+        GLfloat* depth = (GLfloat*)pixels;
+        for (GLsizei i = 0; i < width * height; ++i)
+            depth[i] = 1.f;
+    }
+}
+
+// Textures
+
+void APIENTRY glGenTextures(GLsizei n, GLuint* textures)
+{
+    for (GLsizei i = 0; i < n; ++i)
+        textures[i] = g_Context.NextTexture++;
+}
+
+void APIENTRY glDeleteTextures(GLsizei n, const GLuint* textures)
+{
+    for (GLsizei i = 0; i < n; ++i)
+    {
+        if (textures[i] == g_Context.BoundTexture)
+            g_Context.BoundTexture = 0;
+    }
+}
+
+void APIENTRY glBindTexture(GLenum, GLuint texture) { g_Context.BoundTexture = texture; }
+void APIENTRY glTexParameteri(GLenum, GLenum, GLint) {}
+void APIENTRY glTexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const GLvoid*) {}
+void APIENTRY glTexSubImage2D(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const GLvoid*) {}
+
+// Immediate mode and vertex arrays
+
+void APIENTRY glColor3f(GLfloat r, GLfloat g, GLfloat b) { SetColor(r, g, b, 1.f); }
+void APIENTRY glColor3fv(const GLfloat* v) { SetColor(v[0], v[1], v[2], 1.f); }
+void APIENTRY glColor4f(GLfloat r, GLfloat g, GLfloat b, GLfloat a) { SetColor(r, g, b, a); }
+void APIENTRY glColor4fv(const GLfloat* v) { SetColor(v[0], v[1], v[2], v[3]); }
+void APIENTRY glColor3ub(GLubyte r, GLubyte g, GLubyte b) { SetColor(r / 255.f, g / 255.f, b / 255.f, 1.f); }
+void APIENTRY glColor4ub(GLubyte r, GLubyte g, GLubyte b, GLubyte a) { SetColor(r / 255.f, g / 255.f, b / 255.f, a / 255.f); }
+
+void APIENTRY glBegin(GLenum) {}
+void APIENTRY glEnd() {}
+void APIENTRY glVertex2f(GLfloat, GLfloat) {}
+void APIENTRY glVertex3f(GLfloat, GLfloat, GLfloat) {}
+void APIENTRY glVertex3fv(const GLfloat*) {}
+void APIENTRY glTexCoord2f(GLfloat, GLfloat) {}
+void APIENTRY glNormal3f(GLfloat, GLfloat, GLfloat) {}
+void APIENTRY glEnableClientState(GLenum) {}
+void APIENTRY glDisableClientState(GLenum) {}
+void APIENTRY glVertexPointer(GLint, GLenum, GLsizei, const GLvoid*) {}
+void APIENTRY glNormalPointer(GLenum, GLsizei, const GLvoid*) {}
+void APIENTRY glColorPointer(GLint, GLenum, GLsizei, const GLvoid*) {}
+void APIENTRY glTexCoordPointer(GLint, GLenum, GLsizei, const GLvoid*) {}
+void APIENTRY glDrawArrays(GLenum, GLint, GLsizei) {}
+void APIENTRY glDrawElements(GLenum, GLsizei, GLenum, const GLvoid*) {}
+void APIENTRY glClear(GLbitfield) {}
+void APIENTRY glFlush() {}
+
+// GLU
+
+void APIENTRY gluPerspective(GLdouble fovy, GLdouble aspect, GLdouble zNear, GLdouble zFar)
+{
+    const GLdouble f = 1.0 / tan(fovy * 3.14159265358979 / 360.0);
+    MATRIX4 m = {};
+    m.m[0] = (GLfloat)(f / aspect);
+    m.m[5] = (GLfloat)f;
+    m.m[10] = (GLfloat)((zFar + zNear) / (zNear - zFar));
+    m.m[11] = -1.f;
+    m.m[14] = (GLfloat)(2.0 * zFar * zNear / (zNear - zFar));
+    MultiplyTop(m);
+}
+
+void APIENTRY gluOrtho2D(GLdouble l, GLdouble r, GLdouble b, GLdouble t) { Ortho(l, r, b, t, -1.0, 1.0); }
+
+GLUquadric* APIENTRY gluNewQuadric()
+{
+    static char s_Quadric;
+    return (GLUquadric*)&s_Quadric;
+}
+
+void APIENTRY gluSphere(GLUquadric*, GLdouble, GLint, GLint) {}
+
+// WGL
+
+HGLRC WINAPI wglCreateContext(HDC)
+{
+    static char s_Context;
+    return (HGLRC)&s_Context;
+}
+
+BOOL WINAPI wglMakeCurrent(HDC dc, HGLRC rc)
+{
+    g_Context.CurrentDC = dc;
+    g_Context.CurrentRC = rc;
+    return TRUE;
+}
+
+BOOL WINAPI wglDeleteContext(HGLRC rc)
+{
+    if (g_Context.CurrentRC == rc)
+    {
+        g_Context.CurrentDC = nullptr;
+        g_Context.CurrentRC = nullptr;
+    }
+    return TRUE;
+}
+
+HDC WINAPI wglGetCurrentDC() { return g_Context.CurrentDC; }
+HGLRC WINAPI wglGetCurrentContext() { return g_Context.CurrentRC; }
+PROC WINAPI wglGetProcAddress(LPCSTR) { return nullptr; }
+}
+
+#endif // MU_HEADLESS_REPLAY
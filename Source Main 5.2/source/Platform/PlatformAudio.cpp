@@ -0,0 +1,1170 @@
+// PlatformAudio.cpp - Software mixer behind Platform::Audio
+//
+// Sources are mixed in blocks of BLOCK_FRAMES into 16-bit stereo at OUTPUT_RATE. Before
+// every block the playing sources are ranked and the first MAX_AUDIO_VOICES audible ones
+// are mixed; the rest only advance their play position. The Windows device pulls blocks
+// from a thread of its own, the Null and File devices are driven by Update or Render.
+// Sample files are read and decoded on a loader thread so playing a sound never waits
+// on the disk.
+
+#include "PlatformAudio.h"
+#include "Platform.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if PLATFORM_WINDOWS
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+    #include <mmsystem.h>
+
+    // UNICODE turns it into PlaySoundW, which would rename Audio::PlaySound below
+    #undef PlaySound
+#endif
+
+namespace Platform
+{
+    namespace
+    {
+        constexpr int OUTPUT_RATE = 22050;
+        constexpr int OUTPUT_CHANNELS = 2;
+        constexpr int BLOCK_FRAMES = 256;
+
+        // how much a clock driven device catches up after a long frame
+        constexpr int MAX_CATCHUP_FRAMES = OUTPUT_RATE / 4;
+
+        enum class SourceState
+        {
+            Stopped,
+            Playing,
+            Paused
+        };
+
+        struct BUFFER
+        {
+            std::string          Path;          // empty for buffers created from memory
+            std::vector<int16_t> Samples;       // interleaved
+            int                  Channels = 1;
+            int                  Rate = OUTPUT_RATE;
+            int                  Frames = 0;
+            int                  Refs = 1;      // the creator plus every source using it
+            bool                 Loaded = false;
+            bool                 Failed = false;
+            bool                 Queued = false;    // waiting for or on the loader thread
+        };
+
+        struct SOURCE
+        {
+            AudioBufferHandle Buffer = INVALID_AUDIO_BUFFER;
+            SourceState       State = SourceState::Stopped;
+            float             Volume = 1.f;
+            float             Pitch = 1.f;
+            bool              Looping = false;
+            bool              Positioned = false;
+            float             Position[3] = {};
+            int               Priority = 0;
+            float             MinDistance = 0.f;
+            float             MaxDistance = 0.f;
+            double            Cursor = 0.0;     // in frames of the buffer
+            bool              OneShot = false;  // destroyed once it stops
+            bool              Real = false;     // mixed in the last block
+
+            // worked out before every block
+            float             Gain = 0.f;
+            float             Pan = 0.f;
+            float             Distance = 0.f;
+        };
+
+        void MixLocked(int16_t* out, int frames);
+
+        class OutputDevice
+        {
+        public:
+            virtual ~OutputDevice() = default;
+            virtual bool Open() = 0;
+            virtual void Close() {}
+
+            // true when the device pulls blocks itself instead of being driven by Update
+            virtual bool IsRealtime() const { return false; }
+            virtual void Write(const int16_t* samples, int frames) {}
+        };
+
+        class NullDevice : public OutputDevice
+        {
+        public:
+            bool Open() override { return true; }
+        };
+
+        class FileDevice : public OutputDevice
+        {
+        public:
+            explicit FileDevice(const char* fileName) : m_FileName(fileName ? fileName : "") {}
+
+            bool Open() override
+            {
+                if (m_FileName.empty())
+                    return false;
+
+                m_File = fopen(m_FileName.c_str(), "wb");
+                if (!m_File)
+                    return false;
+
+                WriteHeader();
+                return true;
+            }
+
+            void Close() override
+            {
+                if (!m_File)
+                    return;
+
+                fseek(m_File, 0, SEEK_SET);
+                WriteHeader();
+                fclose(m_File);
+                m_File = nullptr;
+            }
+
+            void Write(const int16_t* samples, int frames) override
+            {
+                if (!m_File)
+                    return;
+
+                fwrite(samples, sizeof(int16_t) * OUTPUT_CHANNELS, frames, m_File);
+                m_DataBytes += static_cast<uint32_t>(frames) * sizeof(int16_t) * OUTPUT_CHANNELS;
+            }
+
+        private:
+            void PutU32(uint32_t value)
+            {
+                const uint8_t bytes[4] = { uint8_t(value), uint8_t(value >> 8), uint8_t(value >> 16), uint8_t(value >> 24) };
+                fwrite(bytes, 1, 4, m_File);
+            }
+
+            void PutU16(uint16_t value)
+            {
+                const uint8_t bytes[2] = { uint8_t(value), uint8_t(value >> 8) };
+                fwrite(bytes, 1, 2, m_File);
+            }
+
+            void WriteHeader()
+            {
+                const uint16_t blockAlign = sizeof(int16_t) * OUTPUT_CHANNELS;
+                fwrite("RIFF", 1, 4, m_File);
+                PutU32(36 + m_DataBytes);
+                fwrite("WAVEfmt ", 1, 8, m_File);
+                PutU32(16);
+                PutU16(1);
+                PutU16(OUTPUT_CHANNELS);
+                PutU32(OUTPUT_RATE);
+                PutU32(OUTPUT_RATE * blockAlign);
+                PutU16(blockAlign);
+                PutU16(16);
+                fwrite("data", 1, 4, m_File);
+                PutU32(m_DataBytes);
+            }
+
+            std::string m_FileName;
+            FILE*       m_File = nullptr;
+            uint32_t    m_DataBytes = 0;
+        };
+
+#if PLATFORM_WINDOWS
+        class WaveOutDevice : public OutputDevice
+        {
+        public:
+            bool Open() override
+            {
+                WAVEFORMATEX format = {};
+                format.wFormatTag = WAVE_FORMAT_PCM;
+                format.nChannels = OUTPUT_CHANNELS;
+                format.nSamplesPerSec = OUTPUT_RATE;
+                format.wBitsPerSample = 16;
+                format.nBlockAlign = format.nChannels * format.wBitsPerSample / 8;
+                format.nAvgBytesPerSec = format.nSamplesPerSec * format.nBlockAlign;
+
+                m_Event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+                if (waveOutOpen(&m_Device, WAVE_MAPPER, &format, reinterpret_cast<DWORD_PTR>(m_Event), 0, CALLBACK_EVENT) != MMSYSERR_NOERROR)
+                {
+                    CloseHandle(m_Event);
+                    m_Event = nullptr;
+                    return false;
+                }
+
+                for (int i = 0; i < QUEUED_BLOCKS; ++i)
+                {
+                    WAVEHDR& header = m_Headers[i];
+                    memset(&header, 0, sizeof(header));
+                    header.lpData = reinterpret_cast<LPSTR>(m_Samples[i]);
+                    header.dwBufferLength = sizeof(m_Samples[i]);
+                    waveOutPrepareHeader(m_Device, &header, sizeof(header));
+                }
+
+                m_bQuit = false;
+                m_Thread = std::thread([this] { Run(); });
+                return true;
+            }
+
+            void Close() override
+            {
+                if (!m_Device)
+                    return;
+
+                m_bQuit = true;
+                SetEvent(m_Event);
+                m_Thread.join();
+
+                waveOutReset(m_Device);
+                for (WAVEHDR& header : m_Headers)
+                    waveOutUnprepareHeader(m_Device, &header, sizeof(header));
+                waveOutClose(m_Device);
+                m_Device = nullptr;
+
+                CloseHandle(m_Event);
+                m_Event = nullptr;
+            }
+
+            bool IsRealtime() const override { return true; }
+
+        private:
+            enum { QUEUED_BLOCKS = 6 };
+
+            void Run()
+            {
+                while (!m_bQuit)
+                {
+                    for (WAVEHDR& header : m_Headers)
+                    {
+                        if (header.dwFlags & WHDR_INQUEUE)
+                            continue;
+
+                        MixLocked(reinterpret_cast<int16_t*>(header.lpData), BLOCK_FRAMES);
+                        waveOutWrite(m_Device, &header, sizeof(header));
+                    }
+                    WaitForSingleObject(m_Event, 100);
+                }
+            }
+
+            HWAVEOUT          m_Device = nullptr;
+            HANDLE            m_Event = nullptr;
+            WAVEHDR           m_Headers[QUEUED_BLOCKS];
+            int16_t           m_Samples[QUEUED_BLOCKS][BLOCK_FRAMES * OUTPUT_CHANNELS];
+            std::atomic<bool> m_bQuit{ false };
+            std::thread       m_Thread;
+        };
+#endif
+
+        struct MIXER
+        {
+            std::mutex Mutex;
+
+            bool                          Initialized = false;
+            std::unique_ptr<OutputDevice> Device;
+
+            std::unordered_map<AudioBufferHandle, BUFFER> Buffers;
+            std::unordered_map<AudioSourceHandle, SOURCE> Sources;
+            AudioBufferHandle NextBuffer = 1;
+            AudioSourceHandle NextSource = 1;
+
+            float MasterVolume = 1.f;
+            float MusicVolume = 1.f;
+            float SFXVolume = 1.f;
+
+            float ListenerPosition[3] = {};
+            float ListenerRight[3] = { 1.f, 0.f, 0.f };
+
+            std::vector<std::pair<AudioSourceHandle, SOURCE*>> Playing;
+            std::vector<AudioSourceHandle> Finished;
+            std::vector<float>   Accum;
+            std::vector<int16_t> Block;
+
+            std::thread                   Loader;
+            std::condition_variable       LoadSignal;
+            std::deque<AudioBufferHandle> LoadQueue;
+            bool                          QuitLoader = false;
+
+            std::chrono::steady_clock::time_point LastUpdate;
+            double PendingFrames = 0.0;
+
+            int RealVoices = 0;
+            int VirtualVoices = 0;
+            int Demotions = 0;
+        };
+
+        MIXER s_Mixer;
+
+        void ReleaseBufferRef(AudioBufferHandle handle)
+        {
+            auto it = s_Mixer.Buffers.find(handle);
+            if (it != s_Mixer.Buffers.end() && --it->second.Refs <= 0)
+                s_Mixer.Buffers.erase(it);
+        }
+
+        SOURCE* FindSource(AudioSourceHandle handle)
+        {
+            auto it = s_Mixer.Sources.find(handle);
+            return it != s_Mixer.Sources.end() ? &it->second : nullptr;
+        }
+
+        BUFFER* FindBuffer(AudioBufferHandle handle)
+        {
+            auto it = s_Mixer.Buffers.find(handle);
+            return it != s_Mixer.Buffers.end() ? &it->second : nullptr;
+        }
+
+        int GetChannelCount(AudioFormat format)
+        {
+            return (format == AudioFormat::Stereo8 || format == AudioFormat::Stereo16) ? 2 : 1;
+        }
+
+        bool Is8Bit(AudioFormat format)
+        {
+            return format == AudioFormat::Mono8 || format == AudioFormat::Stereo8;
+        }
+
+        bool FillBuffer(BUFFER& buffer, const void* data, size_t size, AudioFormat format, int sampleRate)
+        {
+            if (sampleRate <= 0)
+                return false;
+
+            const int channels = GetChannelCount(format);
+            const size_t sampleCount = Is8Bit(format) ? size : size / sizeof(int16_t);
+            const size_t frames = sampleCount / channels;
+            if (frames == 0)
+                return false;
+
+            buffer.Samples.resize(frames * channels);
+            if (Is8Bit(format))
+            {
+                const uint8_t* src = static_cast<const uint8_t*>(data);
+                for (size_t i = 0; i < buffer.Samples.size(); ++i)
+                    buffer.Samples[i] = static_cast<int16_t>((src[i] - 128) << 8);
+            }
+            else
+            {
+                memcpy(buffer.Samples.data(), data, buffer.Samples.size() * sizeof(int16_t));
+            }
+
+            buffer.Channels = channels;
+            buffer.Rate = sampleRate;
+            buffer.Frames = static_cast<int>(frames);
+            buffer.Loaded = true;
+            return true;
+        }
+
+        // Hands a file buffer to the loader thread; the lock is held.
+        void RequestLoadLocked(AudioBufferHandle handle, BUFFER& buffer)
+        {
+            if (buffer.Loaded || buffer.Failed || buffer.Queued)
+                return;
+
+            if (buffer.Path.empty())
+            {
+                buffer.Failed = true;
+                return;
+            }
+
+            buffer.Queued = true;
+            s_Mixer.LoadQueue.push_back(handle);
+            s_Mixer.LoadSignal.notify_one();
+        }
+
+        // Reads and decodes the queued files without holding the lock, so neither the game
+        // thread nor the output thread waits on the disk. Sources of a buffer that is still
+        // loading stay playing from the start and are mixed once the samples are in.
+        void RunLoader()
+        {
+            std::unique_lock<std::mutex> lock(s_Mixer.Mutex);
+            while (true)
+            {
+                s_Mixer.LoadSignal.wait(lock, [] { return s_Mixer.QuitLoader || !s_Mixer.LoadQueue.empty(); });
+                if (s_Mixer.QuitLoader)
+                    break;
+
+                const AudioBufferHandle handle = s_Mixer.LoadQueue.front();
+                s_Mixer.LoadQueue.pop_front();
+
+                BUFFER* buffer = FindBuffer(handle);
+                if (!buffer)
+                    continue;
+                const std::string path = buffer->Path;
+
+                lock.unlock();
+                void* data = nullptr;
+                size_t size = 0;
+                AudioFormat format = AudioFormat::Mono16;
+                int sampleRate = 0;
+                BUFFER decoded;
+                const bool read = AudioLoader::LoadWAV(path.c_str(), &data, &size, &format, &sampleRate)
+                    && FillBuffer(decoded, data, size, format, sampleRate);
+                AudioLoader::FreeAudioData(data);
+                lock.lock();
+
+                // the buffer may have been destroyed meanwhile
+                buffer = FindBuffer(handle);
+                if (!buffer)
+                    continue;
+
+                buffer->Queued = false;
+                if (!read)
+                {
+                    buffer->Failed = true;
+                    printf("[Audio] Cannot load %s\n", path.c_str());
+                    continue;
+                }
+
+                buffer->Samples = std::move(decoded.Samples);
+                buffer->Channels = decoded.Channels;
+                buffer->Rate = decoded.Rate;
+                buffer->Frames = decoded.Frames;
+                buffer->Loaded = true;
+            }
+        }
+
+        void UpdateSourceGain(SOURCE& source)
+        {
+            source.Gain = source.Volume;
+            source.Pan = 0.f;
+            source.Distance = 0.f;
+            if (!source.Positioned)
+                return;
+
+            float offset[3];
+            for (int i = 0; i < 3; ++i)
+                offset[i] = source.Position[i] - s_Mixer.ListenerPosition[i];
+            source.Distance = sqrtf(offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]);
+
+            if (source.MaxDistance <= 0.f)
+                return;
+
+            if (source.Distance >= source.MaxDistance)
+            {
+                source.Gain = 0.f;
+            }
+            else if (source.Distance > source.MinDistance)
+            {
+                source.Gain *= 1.f - (source.Distance - source.MinDistance) / (source.MaxDistance - source.MinDistance);
+            }
+
+            if (source.Distance > 0.f)
+            {
+                const float* right = s_Mixer.ListenerRight;
+                const float pan = (offset[0] * right[0] + offset[1] * right[1] + offset[2] * right[2]) / source.Distance;
+                source.Pan = std::max(-1.f, std::min(1.f, pan));
+            }
+        }
+
+        bool VoiceLess(const std::pair<AudioSourceHandle, SOURCE*>& x, const std::pair<AudioSourceHandle, SOURCE*>& y)
+        {
+            const SOURCE* a = x.second;
+            const SOURCE* b = y.second;
+            if (a->Priority != b->Priority)
+                return a->Priority > b->Priority;
+            if (a->Gain != b->Gain)
+                return a->Gain > b->Gain;
+            return a->Distance < b->Distance;
+        }
+
+        // Moves the play position on by 'frames' output frames. Returns false at the end of a
+        // sound that does not loop.
+        bool AdvanceSource(SOURCE& source, const BUFFER& buffer, int frames)
+        {
+            const double step = static_cast<double>(buffer.Rate) / OUTPUT_RATE * source.Pitch;
+            source.Cursor += step * frames;
+            if (source.Cursor < buffer.Frames)
+                return true;
+
+            if (!source.Looping)
+                return false;
+
+            source.Cursor = fmod(source.Cursor, static_cast<double>(buffer.Frames));
+            return true;
+        }
+
+        bool MixSource(SOURCE& source, const BUFFER& buffer, float* accum, int frames)
+        {
+            const float gain = source.Gain * s_Mixer.MasterVolume * s_Mixer.SFXVolume;
+            const float left = gain * (source.Pan > 0.f ? 1.f - source.Pan : 1.f);
+            const float right = gain * (source.Pan < 0.f ? 1.f + source.Pan : 1.f);
+            const double step = static_cast<double>(buffer.Rate) / OUTPUT_RATE * source.Pitch;
+            const int channels = buffer.Channels;
+            const int16_t* samples = buffer.Samples.data();
+
+            double cursor = source.Cursor;
+            for (int i = 0; i < frames; ++i)
+            {
+                int index = static_cast<int>(cursor);
+                if (index >= buffer.Frames)
+                {
+                    if (!source.Looping)
+                        return false;
+
+                    cursor = fmod(cursor, static_cast<double>(buffer.Frames));
+                    index = static_cast<int>(cursor);
+                }
+
+                int next = index + 1;
+                if (next >= buffer.Frames)
+                    next = source.Looping ? 0 : index;
+
+                const float t = static_cast<float>(cursor - index);
+                const int16_t* a = samples + index * channels;
+                const int16_t* b = samples + next * channels;
+                const float l = a[0] + (b[0] - a[0]) * t;
+                const float r = channels == 2 ? a[1] + (b[1] - a[1]) * t : l;
+
+                accum[i * 2] += l * left;
+                accum[i * 2 + 1] += r * right;
+                cursor += step;
+            }
+
+            source.Cursor = cursor;
+            if (source.Cursor >= buffer.Frames)
+            {
+                if (!source.Looping)
+                    return false;
+                source.Cursor = fmod(source.Cursor, static_cast<double>(buffer.Frames));
+            }
+            return true;
+        }
+
+        // Mixes one block of at most BLOCK_FRAMES frames; the lock is held.
+        void MixBlock(int16_t* out, int frames)
+        {
+            s_Mixer.Accum.assign(static_cast<size_t>(frames) * OUTPUT_CHANNELS, 0.f);
+            s_Mixer.Playing.clear();
+            s_Mixer.Finished.clear();
+
+            for (auto& entry : s_Mixer.Sources)
+            {
+                SOURCE& source = entry.second;
+                if (source.State != SourceState::Playing)
+                    continue;
+
+                UpdateSourceGain(source);
+                s_Mixer.Playing.emplace_back(entry.first, &source);
+            }
+
+            std::sort(s_Mixer.Playing.begin(), s_Mixer.Playing.end(), VoiceLess);
+
+            s_Mixer.RealVoices = 0;
+            s_Mixer.VirtualVoices = 0;
+            for (const auto& entry : s_Mixer.Playing)
+            {
+                SOURCE* source = entry.second;
+                const bool real = s_Mixer.RealVoices < MAX_AUDIO_VOICES && source->Gain > 0.f;
+                if (source->Real && !real)
+                    ++s_Mixer.Demotions;
+                source->Real = real;
+
+                bool playing = false;
+                if (const BUFFER* buffer = FindBuffer(source->Buffer))
+                {
+                    if (buffer->Loaded)
+                    {
+                        if (real)
+                            playing = MixSource(*source, *buffer, s_Mixer.Accum.data(), frames);
+                        else
+                            playing = AdvanceSource(*source, *buffer, frames);
+                    }
+                    else if (!buffer->Failed)
+                    {
+                        // still on the loader thread; starts from the beginning once it is in
+                        source->Real = false;
+                        continue;
+                    }
+                }
+
+                if (real)
+                    ++s_Mixer.RealVoices;
+                else
+                    ++s_Mixer.VirtualVoices;
+
+                if (!playing)
+                {
+                    source->State = SourceState::Stopped;
+                    source->Cursor = 0.0;
+                    source->Real = false;
+                    if (source->OneShot)
+                        s_Mixer.Finished.push_back(entry.first);
+                }
+            }
+
+            for (AudioSourceHandle handle : s_Mixer.Finished)
+            {
+                auto it = s_Mixer.Sources.find(handle);
+                if (it == s_Mixer.Sources.end())
+                    continue;
+                ReleaseBufferRef(it->second.Buffer);
+                s_Mixer.Sources.erase(it);
+            }
+            s_Mixer.Finished.clear();
+
+            const float* accum = s_Mixer.Accum.data();
+            for (int i = 0; i < frames * OUTPUT_CHANNELS; ++i)
+            {
+                const float sample = accum[i];
+                out[i] = static_cast<int16_t>(sample > 32767.f ? 32767 : (sample < -32768.f ? -32768 : static_cast<int>(sample)));
+            }
+        }
+
+        void MixLocked(int16_t* out, int frames)
+        {
+            std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+            MixBlock(out, frames);
+        }
+
+        void RenderLocked(int frames)
+        {
+            s_Mixer.Block.resize(BLOCK_FRAMES * OUTPUT_CHANNELS);
+            while (frames > 0)
+            {
+                const int count = std::min(frames, static_cast<int>(BLOCK_FRAMES));
+                MixBlock(s_Mixer.Block.data(), count);
+                s_Mixer.Device->Write(s_Mixer.Block.data(), count);
+                frames -= count;
+            }
+        }
+
+        AudioSourceHandle CreateSourceLocked()
+        {
+            const AudioSourceHandle handle = s_Mixer.NextSource++;
+            s_Mixer.Sources[handle] = SOURCE();
+            return handle;
+        }
+
+        void AttachBufferLocked(SOURCE& source, AudioBufferHandle handle)
+        {
+            if (BUFFER* buffer = FindBuffer(handle))
+                ++buffer->Refs;
+            else
+                handle = INVALID_AUDIO_BUFFER;
+
+            ReleaseBufferRef(source.Buffer);
+            source.Buffer = handle;
+            source.State = SourceState::Stopped;
+            source.Cursor = 0.0;
+        }
+
+        float Clamp01(float value)
+        {
+            return value < 0.f ? 0.f : (value > 1.f ? 1.f : value);
+        }
+    }
+
+    bool Audio::Initialize(AudioDevice device, const char* outputFile)
+    {
+        if (s_Mixer.Initialized)
+            return true;
+
+        std::unique_ptr<OutputDevice> output;
+        switch (device)
+        {
+        case AudioDevice::Default:
+#if PLATFORM_WINDOWS
+            output = std::make_unique<WaveOutDevice>();
+#else
+            output = std::make_unique<NullDevice>();
+#endif
+            break;
+        case AudioDevice::Null:
+            output = std::make_unique<NullDevice>();
+            break;
+        case AudioDevice::File:
+            output = std::make_unique<FileDevice>(outputFile);
+            break;
+        }
+
+        if (!output->Open())
+        {
+            printf("[Audio] Cannot open the output device\n");
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+            s_Mixer.LastUpdate = std::chrono::steady_clock::now();
+            s_Mixer.PendingFrames = 0.0;
+            s_Mixer.Demotions = 0;
+            s_Mixer.QuitLoader = false;
+            s_Mixer.Initialized = true;
+        }
+        s_Mixer.Loader = std::thread(RunLoader);
+
+        // the output thread may start mixing as soon as the device is published
+        s_Mixer.Device = std::move(output);
+        return true;
+    }
+
+    void Audio::Shutdown()
+    {
+        if (!s_Mixer.Initialized)
+            return;
+
+        // joins the output and loader threads, which take the lock themselves
+        s_Mixer.Device->Close();
+        {
+            std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+            s_Mixer.QuitLoader = true;
+        }
+        s_Mixer.LoadSignal.notify_one();
+        s_Mixer.Loader.join();
+
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        s_Mixer.Device.reset();
+        s_Mixer.Sources.clear();
+        s_Mixer.Buffers.clear();
+        s_Mixer.LoadQueue.clear();
+        s_Mixer.Initialized = false;
+    }
+
+    void Audio::SetMasterVolume(float volume)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        s_Mixer.MasterVolume = Clamp01(volume);
+    }
+
+    float Audio::GetMasterVolume()
+    {
+        return s_Mixer.MasterVolume;
+    }
+
+    void Audio::SetMusicVolume(float volume)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        s_Mixer.MusicVolume = Clamp01(volume);
+    }
+
+    float Audio::GetMusicVolume()
+    {
+        return s_Mixer.MusicVolume;
+    }
+
+    void Audio::SetSFXVolume(float volume)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        s_Mixer.SFXVolume = Clamp01(volume);
+    }
+
+    float Audio::GetSFXVolume()
+    {
+        return s_Mixer.SFXVolume;
+    }
+
+    AudioBufferHandle Audio::CreateBuffer(const void* data, size_t size, AudioFormat format, int sampleRate)
+    {
+        BUFFER buffer;
+        if (!data || !FillBuffer(buffer, data, size, format, sampleRate))
+            return INVALID_AUDIO_BUFFER;
+
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        const AudioBufferHandle handle = s_Mixer.NextBuffer++;
+        s_Mixer.Buffers[handle] = std::move(buffer);
+        return handle;
+    }
+
+    AudioBufferHandle Audio::CreateBufferFromFile(const char* filename)
+    {
+        if (!filename || !filename[0])
+            return INVALID_AUDIO_BUFFER;
+
+        // the samples are read on the loader thread the first time the buffer is played
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        const AudioBufferHandle handle = s_Mixer.NextBuffer++;
+        s_Mixer.Buffers[handle].Path = filename;
+        return handle;
+    }
+
+    void Audio::DestroyBuffer(AudioBufferHandle buffer)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        ReleaseBufferRef(buffer);
+    }
+
+    AudioSourceHandle Audio::CreateSource()
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        return CreateSourceLocked();
+    }
+
+    void Audio::DestroySource(AudioSourceHandle source)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        auto it = s_Mixer.Sources.find(source);
+        if (it == s_Mixer.Sources.end())
+            return;
+
+        ReleaseBufferRef(it->second.Buffer);
+        s_Mixer.Sources.erase(it);
+    }
+
+    void Audio::SetSourceBuffer(AudioSourceHandle source, AudioBufferHandle buffer)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        if (SOURCE* s = FindSource(source))
+            AttachBufferLocked(*s, buffer);
+    }
+
+    void Audio::SetSourceVolume(AudioSourceHandle source, float volume)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        if (SOURCE* s = FindSource(source))
+            s->Volume = volume < 0.f ? 0.f : volume;
+    }
+
+    void Audio::SetSourcePitch(AudioSourceHandle source, float pitch)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        if (SOURCE* s = FindSource(source))
+            s->Pitch = pitch > 0.01f ? pitch : 0.01f;
+    }
+
+    void Audio::SetSourceLooping(AudioSourceHandle source, bool looping)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        if (SOURCE* s = FindSource(source))
+            s->Looping = looping;
+    }
+
+    void Audio::SetSourcePosition(AudioSourceHandle source, float x, float y, float z)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        if (SOURCE* s = FindSource(source))
+        {
+            s->Positioned = true;
+            s->Position[0] = x;
+            s->Position[1] = y;
+            s->Position[2] = z;
+        }
+    }
+
+    void Audio::SetSourcePriority(AudioSourceHandle source, int priority)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        if (SOURCE* s = FindSource(source))
+            s->Priority = priority;
+    }
+
+    void Audio::SetSourceRange(AudioSourceHandle source, float minDistance, float maxDistance)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        if (SOURCE* s = FindSource(source))
+        {
+            s->MinDistance = minDistance > 0.f ? minDistance : 0.f;
+            s->MaxDistance = maxDistance > s->MinDistance ? maxDistance : 0.f;
+        }
+    }
+
+    void Audio::PlaySource(AudioSourceHandle source)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        SOURCE* s = FindSource(source);
+        if (!s)
+            return;
+
+        BUFFER* buffer = FindBuffer(s->Buffer);
+        if (!buffer)
+            return;
+
+        RequestLoadLocked(s->Buffer, *buffer);
+        if (buffer->Failed)
+            return;
+
+        if (s->State != SourceState::Paused)
+            s->Cursor = 0.0;
+        s->State = SourceState::Playing;
+    }
+
+    void Audio::PauseSource(AudioSourceHandle source)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        SOURCE* s = FindSource(source);
+        if (s && s->State == SourceState::Playing)
+        {
+            s->State = SourceState::Paused;
+            s->Real = false;
+        }
+    }
+
+    void Audio::StopSource(AudioSourceHandle source)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        if (SOURCE* s = FindSource(source))
+        {
+            s->State = SourceState::Stopped;
+            s->Cursor = 0.0;
+            s->Real = false;
+        }
+    }
+
+    bool Audio::IsSourcePlaying(AudioSourceHandle source)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        const SOURCE* s = FindSource(source);
+        return s && s->State == SourceState::Playing;
+    }
+
+    bool Audio::IsSourcePaused(AudioSourceHandle source)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        const SOURCE* s = FindSource(source);
+        return s && s->State == SourceState::Paused;
+    }
+
+    void Audio::SetListenerPosition(float x, float y, float z)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        s_Mixer.ListenerPosition[0] = x;
+        s_Mixer.ListenerPosition[1] = y;
+        s_Mixer.ListenerPosition[2] = z;
+    }
+
+    void Audio::SetListenerOrientation(float atX, float atY, float atZ, float upX, float upY, float upZ)
+    {
+        float right[3] = { atY * upZ - atZ * upY, atZ * upX - atX * upZ, atX * upY - atY * upX };
+        const float length = sqrtf(right[0] * right[0] + right[1] * right[1] + right[2] * right[2]);
+        if (length <= 0.f)
+            return;
+
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        for (int i = 0; i < 3; ++i)
+            s_Mixer.ListenerRight[i] = right[i] / length;
+    }
+
+    void Audio::PlaySound(AudioBufferHandle buffer, float volume, bool looping)
+    {
+        AudioSourceHandle source;
+        {
+            std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+            source = CreateSourceLocked();
+            SOURCE& s = s_Mixer.Sources[source];
+            AttachBufferLocked(s, buffer);
+            s.Volume = volume;
+            s.Looping = looping;
+            s.OneShot = !looping;
+        }
+        PlaySource(source);
+
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        SOURCE* s = FindSource(source);
+        if (s && s->OneShot && s->State != SourceState::Playing)
+        {
+            ReleaseBufferRef(s->Buffer);
+            s_Mixer.Sources.erase(source);
+        }
+    }
+
+    void Audio::PlaySound3D(AudioBufferHandle buffer, float x, float y, float z, float volume)
+    {
+        AudioSourceHandle source;
+        {
+            std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+            source = CreateSourceLocked();
+            SOURCE& s = s_Mixer.Sources[source];
+            AttachBufferLocked(s, buffer);
+            s.Volume = volume;
+            s.OneShot = true;
+            s.Positioned = true;
+            s.Position[0] = x;
+            s.Position[1] = y;
+            s.Position[2] = z;
+        }
+        PlaySource(source);
+
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        SOURCE* s = FindSource(source);
+        if (s && s->State != SourceState::Playing)
+        {
+            ReleaseBufferRef(s->Buffer);
+            s_Mixer.Sources.erase(source);
+        }
+    }
+
+    // Music stays with wzAudio; the mixer only plays sound effects.
+    bool Audio::PlayMusic(const char*, bool)
+    {
+        return false;
+    }
+
+    void Audio::StopMusic()
+    {
+    }
+
+    void Audio::PauseMusic()
+    {
+    }
+
+    void Audio::ResumeMusic()
+    {
+    }
+
+    bool Audio::IsMusicPlaying()
+    {
+        return false;
+    }
+
+    void Audio::Update()
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        if (!s_Mixer.Initialized || !s_Mixer.Device || s_Mixer.Device->IsRealtime())
+            return;
+
+        const auto now = std::chrono::steady_clock::now();
+        const double seconds = std::chrono::duration<double>(now - s_Mixer.LastUpdate).count();
+        s_Mixer.LastUpdate = now;
+
+        s_Mixer.PendingFrames = std::min(s_Mixer.PendingFrames + seconds * OUTPUT_RATE, static_cast<double>(MAX_CATCHUP_FRAMES));
+        const int frames = static_cast<int>(s_Mixer.PendingFrames);
+        s_Mixer.PendingFrames -= frames;
+        RenderLocked(frames);
+    }
+
+    void Audio::Render(int frames)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        if (!s_Mixer.Initialized || !s_Mixer.Device || s_Mixer.Device->IsRealtime() || frames <= 0)
+            return;
+
+        RenderLocked(frames);
+    }
+
+    int Audio::GetOutputRate()
+    {
+        return OUTPUT_RATE;
+    }
+
+    void Audio::GetStats(AudioStats& stats)
+    {
+        std::lock_guard<std::mutex> lock(s_Mixer.Mutex);
+        stats.PlayingSources = 0;
+        for (const auto& entry : s_Mixer.Sources)
+        {
+            if (entry.second.State == SourceState::Playing)
+                ++stats.PlayingSources;
+        }
+
+        stats.RealVoices = s_Mixer.RealVoices;
+        stats.VirtualVoices = s_Mixer.VirtualVoices;
+        stats.Demotions = s_Mixer.Demotions;
+        stats.LoadedBuffers = 0;
+        stats.SampleBytes = 0;
+        for (const auto& entry : s_Mixer.Buffers)
+        {
+            if (!entry.second.Loaded)
+                continue;
+            ++stats.LoadedBuffers;
+            stats.SampleBytes += entry.second.Samples.size() * sizeof(int16_t);
+        }
+    }
+
+    namespace AudioLoader
+    {
+        static uint32_t ReadU32(const uint8_t* p)
+        {
+            return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+
+        static uint16_t ReadU16(const uint8_t* p)
+        {
+            return static_cast<uint16_t>(p[0] | (p[1] << 8));
+        }
+
+        bool LoadWAV(const char* filename, void** data, size_t* size, AudioFormat* format, int* sampleRate)
+        {
+            *data = nullptr;
+            *size = 0;
+
+            FILE* fp = fopen(filename, "rb");
+            if (!fp)
+                return false;
+
+            uint8_t header[12];
+            if (fread(header, 1, sizeof(header), fp) != sizeof(header) || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0)
+            {
+                fclose(fp);
+                return false;
+            }
+
+            int channels = 0;
+            int bits = 0;
+            int rate = 0;
+            bool pcm = false;
+            bool found = false;
+
+            uint8_t chunk[8];
+            while (fread(chunk, 1, sizeof(chunk), fp) == sizeof(chunk))
+            {
+                const uint32_t length = ReadU32(chunk + 4);
+                const long padded = static_cast<long>(length + (length & 1));
+
+                if (memcmp(chunk, "fmt ", 4) == 0 && length >= 16)
+                {
+                    uint8_t fmt[16];
+                    if (fread(fmt, 1, sizeof(fmt), fp) != sizeof(fmt))
+                        break;
+
+                    const uint16_t tag = ReadU16(fmt);
+                    pcm = tag == 1 || tag == 0xFFFE;
+                    channels = ReadU16(fmt + 2);
+                    rate = static_cast<int>(ReadU32(fmt + 4));
+                    bits = ReadU16(fmt + 14);
+                    fseek(fp, padded - 16, SEEK_CUR);
+                }
+                else if (memcmp(chunk, "data", 4) == 0)
+                {
+                    *data = malloc(length);
+                    if (!*data)
+                        break;
+                    *size = fread(*data, 1, length, fp);
+                    found = true;
+                    break;
+                }
+                else
+                {
+                    fseek(fp, padded, SEEK_CUR);
+                }
+            }
+            fclose(fp);
+
+            if (!found || !pcm || (channels != 1 && channels != 2) || (bits != 8 && bits != 16) || rate <= 0)
+            {
+                FreeAudioData(*data);
+                *data = nullptr;
+                *size = 0;
+                return false;
+            }
+
+            if (channels == 1)
+                *format = bits == 8 ? AudioFormat::Mono8 : AudioFormat::Mono16;
+            else
+                *format = bits == 8 ? AudioFormat::Stereo8 : AudioFormat::Stereo16;
+            *sampleRate = rate;
+            return true;
+        }
+
+        bool LoadOGG(const char*, void**, size_t*, AudioFormat*, int*)
+        {
+            // no Vorbis decoder is linked
+            return false;
+        }
+
+        void FreeAudioData(void* data)
+        {
+            free(data);
+        }
+    }
+}
@@ -1,8 +1,17 @@
 // PlatformAudio.h - Cross-platform audio abstraction
-// Supports OpenAL (preferred) and platform-specific APIs
+// Implemented by a software mixer in PlatformAudio.cpp
+//
+// Every playing source holds a place in a fixed pool of voices. When more sources play
+// than there are voices, the ones that matter least (lowest priority, then quietest, then
+// farthest from the listener) become virtual: they keep their play position but are not
+// mixed until a voice frees up. Buffers created from files load their samples on a loader
+// thread the first time they are played, and free them when the last buffer or source
+// reference goes away. A source whose samples are still loading counts as playing and
+// starts from the beginning once they are in.
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 namespace Platform
@@ -24,12 +33,33 @@ namespace Platform
     typedef uint32_t AudioSourceHandle;
     constexpr AudioSourceHandle INVALID_AUDIO_SOURCE = 0;
 
+    // Number of sources mixed at the same time
+    constexpr int MAX_AUDIO_VOICES = 32;
+
+    // Output device
+    enum class AudioDevice
+    {
+        Default,    // the platform's sound output, Null when there is none
+        Null,       // mixes and discards the result, for headless runs
+        File        // writes the mix to a 16-bit stereo WAV file
+    };
+
+    struct AudioStats
+    {
+        int    PlayingSources;  // real and virtual
+        int    RealVoices;      // mixed in the last block
+        int    VirtualVoices;   // playing but not mixed in the last block
+        int    Demotions;       // times a mixed source went virtual, since Initialize
+        int    LoadedBuffers;   // buffers whose samples are in memory
+        size_t SampleBytes;
+    };
+
     // Audio manager
     class Audio
     {
     public:
-        // Initialize audio system
-        static bool Initialize();
+        // Initialize audio system. 'outputFile' names the WAV file of AudioDevice::File.
+        static bool Initialize(AudioDevice device = AudioDevice::Default, const char* outputFile = nullptr);
 
         // Shutdown audio system
         static void Shutdown();
@@ -70,6 +100,13 @@ namespace Platform
         static void SetSourceLooping(AudioSourceHandle source, bool looping);
         static void SetSourcePosition(AudioSourceHandle source, float x, float y, float z);
 
+        // Higher priorities keep their voice first (default 0)
+        static void SetSourcePriority(AudioSourceHandle source, int priority);
+
+        // Positioned sources fade out linearly from minDistance to maxDistance and are panned.
+        // A maxDistance of 0 (the default) only uses the position to rank sources.
+        static void SetSourceRange(AudioSourceHandle source, float minDistance, float maxDistance);
+
         // Source playback control
         static void PlaySource(AudioSourceHandle source);
         static void PauseSource(AudioSourceHandle source);
@@ -94,9 +131,17 @@ namespace Platform
         static void ResumeMusic();
         static bool IsMusicPlaying();
 
-        // Update audio system (call once per frame)
+        // Update audio system (call once per frame). The Null and File devices mix the time
+        // that passed since the last call.
         static void Update();
 
+        // Mixes 'frames' output frames right away on the Null and File devices, for tests
+        // that need the same output on every run; these do not call Update.
+        static void Render(int frames);
+
+        static int GetOutputRate();
+        static void GetStats(AudioStats& stats);
+
     private:
         Audio() = delete;
     };
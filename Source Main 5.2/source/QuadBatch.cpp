@@ -0,0 +1,246 @@
+///////////////////////////////////////////////////////////////////////////////
+// Batched billboard and trail quads
+///////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "QuadBatch.h"
+#include "RenderQueue.h"
+#include "ZzzOpenglUtil.h"
+
+namespace
+{
+    enum
+    {
+        // keeps a runaway effect from growing the stream without bound
+        MAX_BATCH_QUADS = 8192,
+    };
+
+    struct QUAD_BUCKET
+    {
+        RENDER_STATE              State;
+        std::vector<BATCH_VERTEX> Vertices;
+    };
+
+    // Buckets keep their storage between flushes; only the first Count are in use.
+    struct BUCKET_LIST
+    {
+        std::vector<QUAD_BUCKET> Buckets;
+        int                      Count = 0;
+    };
+
+    // order-dependent quads, one bucket per run of quads with the same state and texture
+    BUCKET_LIST s_Ordered;
+    // order-independent quads, one bucket per state and texture for the whole batch
+    BUCKET_LIST s_Classes;
+    int s_LastClass = -1;
+    int s_QuadCount = 0;
+
+    bool s_bActive = false;
+
+    // what the helpers in ZzzOpenglUtil.cpp have asked for since the batch began
+    RENDER_STATE s_State;
+
+    // what the current colour would be had the quads been drawn immediately
+    float s_Color[4] = { 1.f, 1.f, 1.f, 1.f };
+
+    bool IsOrderIndependent(const RENDER_STATE& state)
+    {
+        if (state.DepthMask || state.AlphaTest)
+            return false;
+
+        return state.Blend == 3 || state.Blend == 4 || state.Blend == 5 || state.Blend == 7;
+    }
+
+    bool SameState(const RENDER_STATE& a, const RENDER_STATE& b)
+    {
+        return a.Texture == b.Texture
+            && a.Blend == b.Blend
+            && a.DepthTest == b.DepthTest
+            && a.DepthMask == b.DepthMask
+            && a.Fog == b.Fog
+            && a.CullFace == b.CullFace
+            && a.AlphaTest == b.AlphaTest
+            && a.Texture2D == b.Texture2D
+            && a.AlphaRef == b.AlphaRef;
+    }
+
+    std::vector<BATCH_VERTEX>& AddBucket(BUCKET_LIST& list, const RENDER_STATE& state)
+    {
+        if (list.Count == static_cast<int>(list.Buckets.size()))
+            list.Buckets.emplace_back();
+
+        QUAD_BUCKET& bucket = list.Buckets[list.Count++];
+        bucket.State = state;
+        bucket.Vertices.clear();
+        return bucket.Vertices;
+    }
+
+    std::vector<BATCH_VERTEX>& GetBucket(const RENDER_STATE& state)
+    {
+        if (!IsOrderIndependent(state))
+        {
+            if (s_Ordered.Count > 0 && SameState(s_Ordered.Buckets[s_Ordered.Count - 1].State, state))
+                return s_Ordered.Buckets[s_Ordered.Count - 1].Vertices;
+
+            return AddBucket(s_Ordered, state);
+        }
+
+        if (s_LastClass >= 0 && SameState(s_Classes.Buckets[s_LastClass].State, state))
+            return s_Classes.Buckets[s_LastClass].Vertices;
+
+        for (int i = 0; i < s_Classes.Count; ++i)
+        {
+            if (SameState(s_Classes.Buckets[i].State, state))
+            {
+                s_LastClass = i;
+                return s_Classes.Buckets[i].Vertices;
+            }
+        }
+
+        s_LastClass = s_Classes.Count;
+        return AddBucket(s_Classes, state);
+    }
+
+    void DrawBuckets(BUCKET_LIST& list)
+    {
+        for (int i = 0; i < list.Count; ++i)
+        {
+            const QUAD_BUCKET& bucket = list.Buckets[i];
+            const BATCH_VERTEX* v = bucket.Vertices.data();
+
+            SetRenderState(bucket.State);
+            glVertexPointer(3, GL_FLOAT, sizeof(BATCH_VERTEX), v->Position);
+            glTexCoordPointer(2, GL_FLOAT, sizeof(BATCH_VERTEX), v->TexCoord);
+            glColorPointer(4, GL_FLOAT, sizeof(BATCH_VERTEX), v->Color);
+
+            ++g_RenderCounters.DrawCalls;
+            glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(bucket.Vertices.size()));
+        }
+        list.Count = 0;
+    }
+}
+
+void BeginQuadBatch()
+{
+    FlushQuadBatch();
+
+    GetRenderState(s_State);
+    s_State.Fog = FogEnable ? (glIsEnabled(GL_FOG) == GL_TRUE ? 1 : 0) : -1;
+
+    // quads that never set a colour draw white, batched or not
+    s_Color[0] = s_Color[1] = s_Color[2] = s_Color[3] = 1.f;
+    glColor4fv(s_Color);
+
+    s_bActive = true;
+}
+
+void EndQuadBatch()
+{
+    FlushQuadBatch();
+    s_bActive = false;
+}
+
+bool IsQuadBatchActive()
+{
+    return s_bActive;
+}
+
+RENDER_STATE* GetQuadBatchState()
+{
+    return s_bActive ? &s_State : nullptr;
+}
+
+bool AddBatchQuad(const BATCH_VERTEX* vertices)
+{
+    if (!s_bActive)
+        return false;
+
+    std::vector<BATCH_VERTEX>& bucket = GetBucket(s_State);
+    bucket.insert(bucket.end(), vertices, vertices + 4);
+    memcpy(s_Color, vertices[3].Color, sizeof(s_Color));
+
+    ++g_RenderCounters.BatchedQuads;
+    if (++s_QuadCount >= MAX_BATCH_QUADS)
+        FlushQuadBatch();
+    return true;
+}
+
+void BatchColor3f(float r, float g, float b)
+{
+    s_Color[0] = r;
+    s_Color[1] = g;
+    s_Color[2] = b;
+    s_Color[3] = 1.f;
+    if (!s_bActive)
+        glColor3f(r, g, b);
+}
+
+void BatchColor3fv(const float* color)
+{
+    BatchColor3f(color[0], color[1], color[2]);
+}
+
+void RenderBatchQuad(const float* p0, const float* p1, const float* p2, const float* p3, const float (*texCoord)[2])
+{
+    const float* p[4] = { p0, p1, p2, p3 };
+
+    if (s_bActive)
+    {
+        BATCH_VERTEX vertices[4];
+        for (int i = 0; i < 4; i++)
+        {
+            memcpy(vertices[i].Position, p[i], sizeof(vertices[i].Position));
+            memcpy(vertices[i].TexCoord, texCoord[i], sizeof(vertices[i].TexCoord));
+            memcpy(vertices[i].Color, s_Color, sizeof(vertices[i].Color));
+        }
+        AddBatchQuad(vertices);
+        return;
+    }
+
+    ++g_RenderCounters.DrawCalls;
+    glBegin(GL_QUADS);
+    for (int i = 0; i < 4; i++)
+    {
+        glTexCoord2f(texCoord[i][0], texCoord[i][1]);
+        glVertex3fv(p[i]);
+    }
+    glEnd();
+}
+
+void FlushQuadBatch()
+{
+    if (!s_bActive)
+        return;
+
+    // the helpers apply to GL again while the buckets are drawn
+    s_bActive = false;
+
+    if (s_QuadCount > 0)
+    {
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+
+        DrawBuckets(s_Ordered);
+        DrawBuckets(s_Classes);
+
+        glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+
+        s_LastClass = -1;
+        s_QuadCount = 0;
+    }
+
+    // leave GL in the state the caller asked for, so it can draw on directly
+    SetRenderState(s_State);
+    glColor4fv(s_Color);
+
+    s_bActive = true;
+}
+
+void QuadBatchBarrier()
+{
+    if (s_QuadCount > 0)
+        FlushQuadBatch();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+// Batched billboard and trail quads.
+//
+// Particles, sprites and joint trails used to draw every quad with its own glBegin/glEnd.
+// Between BeginQuadBatch and EndQuadBatch those quads go into vertex buckets instead, one
+// per render state and texture, and each bucket is drawn with a single glDrawArrays.
+//
+// While a batch is open the state helpers in ZzzOpenglUtil.cpp record into the batch's
+// state instead of calling GL, and every quad is filed under the state recorded when it was
+// added. The additive, subtractive and screen blends (3, 4, 5 and 7 without depth writes)
+// give the same result in any order, so each of those states collects its quads for the
+// whole batch and is drawn once when the batch is flushed; between different states the
+// order was only ever the pool order. The order-dependent modes keep submission order and
+// only merge consecutive quads that share state and texture; they are drawn first. Code that touches GL directly while a batch is open (texture
+// environment, matrices, immediate draws) calls FlushQuadBatch first, which draws what is
+// pending and applies the recorded state.
+
+struct RENDER_STATE;
+
+struct BATCH_VERTEX
+{
+    float Position[3];
+    float TexCoord[2];
+    float Color[4];
+};
+
+void BeginQuadBatch();
+void EndQuadBatch();
+bool IsQuadBatchActive();
+
+// The state the helpers record into while a batch is open; null when no batch is open.
+RENDER_STATE* GetQuadBatchState();
+
+// Adds a GL_QUADS quad drawn with the texture and state recorded so far. Returns false
+// when no batch is open.
+bool AddBatchQuad(const BATCH_VERTEX* vertices);
+
+// glColor replacements for code that sets a colour and then emits quads with RenderBatchQuad.
+void BatchColor3f(float r, float g, float b);
+void BatchColor3fv(const float* color);
+
+// Textured quad in the current colour; drawn immediately when no batch is open.
+void RenderBatchQuad(const float* p0, const float* p1, const float* p2, const float* p3, const float (*texCoord)[2]);
+
+void FlushQuadBatch();
+
+// Draws whatever is pending before GL state changes outside the helpers.
+void QuadBatchBarrier();
@@ -0,0 +1,188 @@
+///////////////////////////////////////////////////////////////////////////////
+// Sorted render command queue
+///////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include <algorithm>
+#include "RenderQueue.h"
+#include "./Utilities/Profiler.h"
+
+RENDER_COUNTERS g_RenderCounters = {};
+RENDER_COUNTERS g_LastRenderCounters = {};
+
+namespace
+{
+    struct RENDER_COMMAND
+    {
+        RENDER_STATE                  State;
+        RENDER_PASS                   Pass;
+        const RENDER_COMMAND_HANDLER* Handler;
+        unsigned int                  SortKey;
+        int                           Sequence;
+        size_t                        Data;
+    };
+
+    std::vector<RENDER_COMMAND> s_Commands;
+    std::vector<BYTE>           s_Data;
+
+    bool s_bRecording = false;
+    bool s_bFlushing = false;
+
+    bool SameState(const RENDER_STATE& a, const RENDER_STATE& b)
+    {
+        return a.Blend == b.Blend
+            && a.Texture == b.Texture
+            && a.Texture2D == b.Texture2D
+            && a.AlphaTest == b.AlphaTest
+            && a.DepthTest == b.DepthTest
+            && a.DepthMask == b.DepthMask
+            && a.CullFace == b.CullFace
+            && a.Fog == b.Fog
+            && a.AlphaRef == b.AlphaRef;
+    }
+
+    bool CommandLess(const RENDER_COMMAND& a, const RENDER_COMMAND& b)
+    {
+        if (a.Pass != b.Pass)
+            return a.Pass < b.Pass;
+
+        if (a.Pass == RENDER_PASS_OPAQUE)
+        {
+            const RENDER_STATE& s = a.State;
+            const RENDER_STATE& t = b.State;
+            if (s.Blend != t.Blend) return s.Blend < t.Blend;
+            if (s.DepthTest != t.DepthTest) return s.DepthTest < t.DepthTest;
+            if (s.CullFace != t.CullFace) return s.CullFace < t.CullFace;
+            if (s.Texture2D != t.Texture2D) return s.Texture2D < t.Texture2D;
+            if (s.Texture != t.Texture) return s.Texture < t.Texture;
+            if (a.Handler != b.Handler) return a.Handler < b.Handler;
+            if (a.SortKey != b.SortKey) return a.SortKey < b.SortKey;
+        }
+
+        return a.Sequence < b.Sequence;
+    }
+}
+
+void ResetRenderCounters()
+{
+    g_LastRenderCounters = g_RenderCounters;
+    g_RenderCounters = {};
+}
+
+RENDER_PASS GetRenderPass(const RENDER_STATE& state)
+{
+    if (!state.DepthTest || !state.DepthMask)
+        return RENDER_PASS_NONE;
+
+    if (state.Blend == 0 && !state.AlphaTest)
+        return RENDER_PASS_OPAQUE;
+
+    if (state.Blend == 2 && state.AlphaTest)
+        return RENDER_PASS_ALPHA_TEST;
+
+    return RENDER_PASS_NONE;
+}
+
+void BeginRenderQueue()
+{
+    s_bRecording = true;
+}
+
+void EndRenderQueue()
+{
+    FlushRenderQueue();
+    s_bRecording = false;
+}
+
+bool IsRenderQueueRecording()
+{
+    return s_bRecording && !s_bFlushing;
+}
+
+bool IsRenderQueueEmpty()
+{
+    return s_Commands.empty();
+}
+
+bool SubmitRenderCommand(const RENDER_STATE& state, const RENDER_COMMAND_HANDLER* handler, const void* data, size_t size, unsigned int sortKey)
+{
+    if (!IsRenderQueueRecording())
+        return false;
+
+    const RENDER_PASS pass = GetRenderPass(state);
+    if (pass == RENDER_PASS_NONE)
+        return false;
+
+    RENDER_COMMAND command;
+    command.State = state;
+    command.Pass = pass;
+    command.Handler = handler;
+    command.SortKey = sortKey;
+    command.Sequence = static_cast<int>(s_Commands.size());
+    command.Data = s_Data.size();
+
+    // keep every payload 8-byte aligned
+    s_Data.resize(s_Data.size() + ((size + 7) & ~static_cast<size_t>(7)));
+    memcpy(&s_Data[command.Data], data, size);
+
+    s_Commands.push_back(command);
+    ++g_RenderCounters.QueuedCommands;
+    return true;
+}
+
+void FlushRenderQueue()
+{
+    if (s_Commands.empty() || s_bFlushing)
+        return;
+
+    PROFILE_SCOPE("FlushRenderQueue");
+
+    s_bFlushing = true;
+    ++g_RenderCounters.Flushes;
+
+    RENDER_STATE saved;
+    GetRenderState(saved);
+    const bool fog = glIsEnabled(GL_FOG) == GL_TRUE;
+
+    std::sort(s_Commands.begin(), s_Commands.end(), CommandLess);
+
+    const RENDER_STATE* applied = nullptr;
+    const RENDER_COMMAND_HANDLER* active = nullptr;
+    for (const RENDER_COMMAND& command : s_Commands)
+    {
+        if (applied == nullptr || !SameState(*applied, command.State))
+        {
+            SetRenderState(command.State);
+            applied = &command.State;
+        }
+
+        if (active != command.Handler)
+        {
+            if (active != nullptr && active->End != nullptr)
+                active->End();
+            active = command.Handler;
+        }
+
+        active->Draw(&s_Data[command.Data]);
+    }
+
+    if (active != nullptr && active->End != nullptr)
+        active->End();
+
+    s_Commands.clear();
+    s_Data.clear();
+
+    // the barrier may have fired in the middle of a caller's own state setup
+    SetRenderState(saved);
+    if (fog)
+        glEnable(GL_FOG);
+    else
+        glDisable(GL_FOG);
+    s_bFlushing = false;
+}
+
+void RenderQueueBarrier()
+{
+    if (!s_Commands.empty() && !s_bFlushing)
+        FlushRenderQueue();
+}
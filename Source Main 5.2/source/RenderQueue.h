@@ -0,0 +1,100 @@
+#pragma once
+
+// Per-frame render command queue.
+//
+// The fixed-function state in ZzzOpenglUtil.cpp (blend mode, alpha test, depth, cull,
+// bound texture) is set by whoever draws next, in whatever order objects are walked.
+// While the queue is recording, callers that can defer their draw submit a command with
+// the state it needs instead of touching GL; FlushRenderQueue sorts the commands by
+// (pass, blend, depth, texture) and issues them, changing only the state that differs
+// between neighbours.
+//
+// Only depth-writing passes are queued. Opaque draws are sorted freely; alpha-tested
+// draws still blend their edges, so they keep submission order and only drop redundant
+// state. Anything that is about to blend, stop writing depth, or otherwise depend on
+// what is already in the frame buffer flushes the queue first: the state helpers do it
+// whenever such a state is requested outside a capture (an alpha-tested draw that is
+// not queued blends too), BMD::RenderMesh does it before every depth-writing mesh it
+// draws right away, and code that touches GL directly (stencil shadows, depth reads,
+// 2D setup, the terrain's client arrays) calls FlushRenderQueue itself.
+//
+// g_RenderCounters counts the GL draws, texture binds and tracked state changes issued
+// by the model, terrain, sprite, effect and queue paths; the profiler overlay shows the
+// totals of the previous frame.
+
+enum RENDER_PASS
+{
+    RENDER_PASS_NONE = -1,
+    RENDER_PASS_OPAQUE,
+    RENDER_PASS_ALPHA_TEST,
+};
+
+// Snapshot of the state tracked by the helpers in ZzzOpenglUtil.cpp.
+struct RENDER_STATE
+{
+    int  Blend;      // AlphaBlendType
+    int  Texture;    // bitmap index given to BindTexture
+    bool Texture2D;
+    bool AlphaTest;
+    bool DepthTest;
+    bool DepthMask;
+    bool CullFace;
+    int  Fog;        // last fog request of the helpers: -1 none, 0 off, 1 on
+    float AlphaRef;  // glAlphaFunc(GL_GREATER, AlphaRef)
+};
+
+struct RENDER_COUNTERS
+{
+    int DrawCalls;
+    int TextureBinds;
+    int StateChanges;
+    int QueuedCommands;
+    int Flushes;
+    int BatchedQuads;
+};
+
+extern RENDER_COUNTERS g_RenderCounters;     // frame being rendered
+extern RENDER_COUNTERS g_LastRenderCounters; // last finished frame
+
+void ResetRenderCounters();
+
+// Implemented next to the helpers in ZzzOpenglUtil.cpp.
+void GetRenderState(RENDER_STATE& state);
+void SetRenderState(const RENDER_STATE& state);
+
+// While a capture is open the helpers record into it instead of calling GL. Ending the
+// capture without End() (an early return) applies what was recorded.
+class CRenderStateCapture
+{
+public:
+    explicit CRenderStateCapture(bool enable);
+    ~CRenderStateCapture();
+
+    bool End(RENDER_STATE& state);
+
+private:
+    bool m_bActive;
+};
+
+RENDER_PASS GetRenderPass(const RENDER_STATE& state);
+
+// Draw runs with the command's state applied. Consecutive commands with the same handler
+// form one batch; End is called once after the last of them.
+struct RENDER_COMMAND_HANDLER
+{
+    void (*Draw)(const void* data);
+    void (*End)();
+};
+
+void BeginRenderQueue();
+void EndRenderQueue();
+bool IsRenderQueueRecording();
+bool IsRenderQueueEmpty();
+
+// 'data' is copied. 'sortKey' orders commands that share state and handler.
+bool SubmitRenderCommand(const RENDER_STATE& state, const RENDER_COMMAND_HANDLER* handler, const void* data, size_t size, unsigned int sortKey);
+
+void FlushRenderQueue();
+
+// Called by the state helpers whenever a non-queueable state is requested.
+void RenderQueueBarrier();
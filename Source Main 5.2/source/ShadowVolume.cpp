@@ -10,6 +10,7 @@
 #include "ShadowVolume.h"
 #include "ZzzLodTerrain.h"
 #include "zzzTexture.h"
+#include "RenderQueue.h"
 #include "BaseCls.h"
 #include "ZzzCharacter.h"
 
@@ -42,6 +43,7 @@ void RenderShadowVolumesAsFrame(void)
 
 void ShadeWithShadowVolumes(void)
 {
+    FlushRenderQueue();
     DisableAlphaBlend();
 
     DisableDepthMask();
@@ -66,6 +68,7 @@ void ShadeWithShadowVolumes(void)
 
 void RenderShadowToScreen(void)
 {
+    FlushRenderQueue();
     DisableDepthTest();
     DisableDepthMask();
     glEnable(GL_STENCIL_TEST);
@@ -117,7 +120,7 @@ void CShadowVolume::Clear(void)
     m_pEdges = NULL;
 }
 
-BOOL CShadowVolume::GetReadyToCreate(vec3_t ppVertexTransformed[MAX_MESH][MAX_VERTICES], BMD* b, OBJECT* o, bool SkipTga)
+BOOL CShadowVolume::GetReadyToCreate(vec3_t* ppVertexTransformed[MAX_MESH], BMD* b, OBJECT* o, bool SkipTga)
 {
     if (o->Alpha < 0.01f)
     {
@@ -166,7 +169,7 @@ BOOL CShadowVolume::GetReadyToCreate(vec3_t ppVertexTransformed[MAX_MESH][MAX_VE
     return (TRUE);
 }
 
-void CShadowVolume::Create(vec3_t ppVertexTransformed[MAX_MESH][MAX_VERTICES], BMD* b, OBJECT* o, bool SkipTga)
+void CShadowVolume::Create(vec3_t* ppVertexTransformed[MAX_MESH], BMD* b, OBJECT* o, bool SkipTga)
 {
     m_vLight[0] = -1.f; m_vLight[1] = 0.03f; m_vLight[2] = -1.f;
     VectorNormalize(m_vLight);
@@ -226,7 +229,7 @@ void CShadowVolume::AddEdgeFast(short nV1, short nV2, short nMesh, int iTriangle
     }
 }
 
-void CShadowVolume::DeterminateSilhouette(short nMesh, vec3_t ppVertexTransformed[MAX_MESH][MAX_VERTICES], short nNumTriangles, Triangle_t* pTriangles, bool Tga)
+void CShadowVolume::DeterminateSilhouette(short nMesh, vec3_t* ppVertexTransformed[MAX_MESH], short nNumTriangles, Triangle_t* pTriangles, bool Tga)
 {
     for (int iTriangle = 0; iTriangle < nNumTriangles; ++iTriangle)
     {
@@ -264,7 +267,7 @@ void CShadowVolume::DeterminateSilhouette(short nMesh, vec3_t ppVertexTransforme
 
 #define GROUND_HEIGHT 22.5f
 
-void CShadowVolume::GenerateSidePolygon(vec3_t ppVertexTransformed[MAX_MESH][MAX_VERTICES])
+void CShadowVolume::GenerateSidePolygon(vec3_t* ppVertexTransformed[MAX_MESH])
 {
     m_nNumVertices = 0;
     m_pVertices = new vec3_t[m_iNumEdge * 6];
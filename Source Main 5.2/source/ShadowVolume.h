@@ -29,9 +29,9 @@ protected:
     short	m_nNumVertices;	//  
     vec3_t* m_pVertices;	// 
 protected:
-    BOOL GetReadyToCreate(vec3_t ppVertexTransformed[MAX_MESH][MAX_VERTICES], BMD* b, OBJECT* o, bool SkipTga = true);	// 
+    BOOL GetReadyToCreate(vec3_t* ppVertexTransformed[MAX_MESH], BMD* b, OBJECT* o, bool SkipTga = true);	// 
 public:
-    virtual void Create(vec3_t ppVertexTransformed[MAX_MESH][MAX_VERTICES], BMD* b, OBJECT* o, bool SkipTga = true);	// 
+    virtual void Create(vec3_t* ppVertexTransformed[MAX_MESH], BMD* b, OBJECT* o, bool SkipTga = true);	// 
     virtual void Destroy(void);	// 
     void RenderAsFrame(void);	//   frame  ׸
     void Shade(void);	// ۿ ׸ ׸
@@ -41,10 +41,10 @@ protected:
     vec3_t m_vLight;	// 
     int m_iNumEdge;		// ڸ 
     St_Edges* m_pEdges;	// ڸ
-    void DeterminateSilhouette(short nMesh, vec3_t ppVertexTransformed[MAX_MESH][MAX_VERTICES], short nNumTriangles, Triangle_t* pTriangles, bool Tga);	// Mesh  ڸ 
+    void DeterminateSilhouette(short nMesh, vec3_t* ppVertexTransformed[MAX_MESH], short nNumTriangles, Triangle_t* pTriangles, bool Tga);	// Mesh  ڸ 
     void AddEdge(short nV1, short nV2, short nMesh);	// ڸ ߰
     void AddEdgeFast(short nV1, short nV2, short nMesh, int iTriangle, int Edge, Triangle_t* pTriangles);	// ڸ ߰
-    void GenerateSidePolygon(vec3_t ppVertexTransformed[MAX_MESH][MAX_VERTICES]);	// ڸ ̿  
+    void GenerateSidePolygon(vec3_t* ppVertexTransformed[MAX_MESH]);	// ڸ ̿  
 
     // c) ǥ
 protected:
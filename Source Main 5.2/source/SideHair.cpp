@@ -26,7 +26,7 @@ CSideHair::~CSideHair()
 {
 }
 
-void CSideHair::Create(vec3_t ppVertexTransformed[MAX_MESH][MAX_VERTICES], BMD* b, OBJECT* o, bool SkipTga)
+void CSideHair::Create(vec3_t* ppVertexTransformed[MAX_MESH], BMD* b, OBJECT* o, bool SkipTga)
 {
     VectorSubtract(Hero->Object.Position, CameraPosition, m_vLight);
     VectorNormalize(m_vLight);
@@ -81,7 +81,7 @@ void CSideHair::Destroy(void)
     delete[] m_pVertices;
 }
 
-void CSideHair::Render(vec3_t ppVertexTransformed[MAX_MESH][MAX_VERTICES], vec3_t ppLightTransformed[MAX_MESH][MAX_VERTICES])
+void CSideHair::Render(vec3_t* ppVertexTransformed[MAX_MESH], vec3_t ppLightTransformed[MAX_MESH][MAX_VERTICES])
 {
     for (int i = 0; i < m_iNumEdge; ++i)
     {
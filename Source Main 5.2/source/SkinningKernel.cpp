@@ -0,0 +1,176 @@
+///////////////////////////////////////////////////////////////////////////////
+// Batched CPU skinning for BMD meshes
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SkinningKernel.h"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define SKINNING_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    inline void TransformScalar(const float(*m)[4], float x, float y, float z, float* out)
+    {
+        out[0] = m[0][0] * x + m[0][1] * y + m[0][2] * z + m[0][3];
+        out[1] = m[1][0] * x + m[1][1] * y + m[1][2] * z + m[1][3];
+        out[2] = m[2][0] * x + m[2][1] * y + m[2][2] * z + m[2][3];
+    }
+
+    inline void RotateScalar(const float(*m)[4], float x, float y, float z, float* out)
+    {
+        out[0] = m[0][0] * x + m[0][1] * y + m[0][2] * z;
+        out[1] = m[1][0] * x + m[1][1] * y + m[1][2] * z;
+        out[2] = m[2][0] * x + m[2][1] * y + m[2][2] * z;
+    }
+
+    inline float Luminosity(const float* n, const float* LightPosition)
+    {
+        float l = (n[0] * LightPosition[0] + n[1] * LightPosition[1] + n[2] * LightPosition[2]) * 0.8f + 0.4f;
+        return l < 0.2f ? 0.2f : l;
+    }
+}
+
+void BuildSkinningStream(SkinningStream_t& stream, std::vector<SkinningSource_t>& sources)
+{
+    std::stable_sort(sources.begin(), sources.end(),
+        [](const SkinningSource_t& a, const SkinningSource_t& b) { return a.Bone < b.Bone; });
+
+    const size_t count = sources.size();
+    stream.Runs.clear();
+    stream.X.resize(count);
+    stream.Y.resize(count);
+    stream.Z.resize(count);
+    stream.Index.resize(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const SkinningSource_t& s = sources[i];
+        stream.X[i] = s.Position[0];
+        stream.Y[i] = s.Position[1];
+        stream.Z[i] = s.Position[2];
+        stream.Index[i] = s.Index;
+
+        if (stream.Runs.empty() || stream.Runs.back().Bone != s.Bone)
+        {
+            SkinningRun_t run = { s.Bone, 0, static_cast<int>(i) };
+            stream.Runs.push_back(run);
+        }
+        stream.Runs.back().Count++;
+    }
+}
+
+void SkinVertices(const SkinningStream_t& stream, const float(*Matrices)[3][4], float(*out)[3])
+{
+    const float* X = stream.X.data();
+    const float* Y = stream.Y.data();
+    const float* Z = stream.Z.data();
+    const short* Index = stream.Index.data();
+
+    for (const SkinningRun_t& run : stream.Runs)
+    {
+        const float(*m)[4] = Matrices[run.Bone];
+        int i = run.Start;
+        const int end = run.Start + run.Count;
+
+#ifdef SKINNING_USE_SSE2
+        const __m128 m00 = _mm_set1_ps(m[0][0]), m01 = _mm_set1_ps(m[0][1]), m02 = _mm_set1_ps(m[0][2]), m03 = _mm_set1_ps(m[0][3]);
+        const __m128 m10 = _mm_set1_ps(m[1][0]), m11 = _mm_set1_ps(m[1][1]), m12 = _mm_set1_ps(m[1][2]), m13 = _mm_set1_ps(m[1][3]);
+        const __m128 m20 = _mm_set1_ps(m[2][0]), m21 = _mm_set1_ps(m[2][1]), m22 = _mm_set1_ps(m[2][2]), m23 = _mm_set1_ps(m[2][3]);
+
+        alignas(16) float ox[4], oy[4], oz[4];
+        for (; i + 4 <= end; i += 4)
+        {
+            const __m128 x = _mm_loadu_ps(X + i);
+            const __m128 y = _mm_loadu_ps(Y + i);
+            const __m128 z = _mm_loadu_ps(Z + i);
+
+            _mm_store_ps(ox, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m01, y)), _mm_add_ps(_mm_mul_ps(m02, z), m03)));
+            _mm_store_ps(oy, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, x), _mm_mul_ps(m11, y)), _mm_add_ps(_mm_mul_ps(m12, z), m13)));
+            _mm_store_ps(oz, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, x), _mm_mul_ps(m21, y)), _mm_add_ps(_mm_mul_ps(m22, z), m23)));
+
+            for (int k = 0; k < 4; ++k)
+            {
+                float* vp = out[Index[i + k]];
+                vp[0] = ox[k];
+                vp[1] = oy[k];
+                vp[2] = oz[k];
+            }
+        }
+#endif
+        for (; i < end; ++i)
+        {
+            TransformScalar(m, X[i], Y[i], Z[i], out[Index[i]]);
+        }
+    }
+}
+
+void SkinNormals(const SkinningStream_t& stream, const float(*Matrices)[3][4], float(*out)[3], float* intensity, const float* LightPosition)
+{
+    const float* X = stream.X.data();
+    const float* Y = stream.Y.data();
+    const float* Z = stream.Z.data();
+    const short* Index = stream.Index.data();
+    const bool lighting = intensity != nullptr && LightPosition != nullptr;
+
+    for (const SkinningRun_t& run : stream.Runs)
+    {
+        const float(*m)[4] = Matrices[run.Bone];
+        int i = run.Start;
+        const int end = run.Start + run.Count;
+
+#ifdef SKINNING_USE_SSE2
+        const __m128 m00 = _mm_set1_ps(m[0][0]), m01 = _mm_set1_ps(m[0][1]), m02 = _mm_set1_ps(m[0][2]);
+        const __m128 m10 = _mm_set1_ps(m[1][0]), m11 = _mm_set1_ps(m[1][1]), m12 = _mm_set1_ps(m[1][2]);
+        const __m128 m20 = _mm_set1_ps(m[2][0]), m21 = _mm_set1_ps(m[2][1]), m22 = _mm_set1_ps(m[2][2]);
+        const __m128 lx = _mm_set1_ps(lighting ? LightPosition[0] : 0.f);
+        const __m128 ly = _mm_set1_ps(lighting ? LightPosition[1] : 0.f);
+        const __m128 lz = _mm_set1_ps(lighting ? LightPosition[2] : 0.f);
+        const __m128 scale = _mm_set1_ps(0.8f), bias = _mm_set1_ps(0.4f), minimum = _mm_set1_ps(0.2f);
+
+        alignas(16) float ox[4], oy[4], oz[4], ol[4];
+        for (; i + 4 <= end; i += 4)
+        {
+            const __m128 x = _mm_loadu_ps(X + i);
+            const __m128 y = _mm_loadu_ps(Y + i);
+            const __m128 z = _mm_loadu_ps(Z + i);
+
+            const __m128 nx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m01, y)), _mm_mul_ps(m02, z));
+            const __m128 ny = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, x), _mm_mul_ps(m11, y)), _mm_mul_ps(m12, z));
+            const __m128 nz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, x), _mm_mul_ps(m21, y)), _mm_mul_ps(m22, z));
+            _mm_store_ps(ox, nx);
+            _mm_store_ps(oy, ny);
+            _mm_store_ps(oz, nz);
+
+            for (int k = 0; k < 4; ++k)
+            {
+                float* tn = out[Index[i + k]];
+                tn[0] = ox[k];
+                tn[1] = oy[k];
+                tn[2] = oz[k];
+            }
+
+            if (lighting)
+            {
+                const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, lx), _mm_mul_ps(ny, ly)), _mm_mul_ps(nz, lz));
+                _mm_store_ps(ol, _mm_max_ps(_mm_add_ps(_mm_mul_ps(d, scale), bias), minimum));
+                for (int k = 0; k < 4; ++k)
+                {
+                    intensity[Index[i + k]] = ol[k];
+                }
+            }
+        }
+#endif
+        for (; i < end; ++i)
+        {
+            float* tn = out[Index[i]];
+            RotateScalar(m, X[i], Y[i], Z[i], tn);
+            if (lighting)
+            {
+                intensity[Index[i]] = Luminosity(tn, LightPosition);
+            }
+        }
+    }
+}
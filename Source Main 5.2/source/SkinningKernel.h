@@ -0,0 +1,53 @@
+#pragma once
+
+// Batched CPU skinning used by BMD::Transform.
+//
+// At load time the bind pose of every mesh is copied into a structure-of-arrays
+// layout grouped by bone, so the kernel can keep one bone matrix in registers and
+// transform four vertices per iteration with SSE2 (scalar tail / fallback on other
+// targets). Results are scattered back into the regular AoS output arrays, so
+// callers reading VertexTransform / NormalTransform / IntensityTransform are unaffected.
+//
+// The kernel only depends on the standard library (no stdafx.h), so bench_skinning.cpp
+// in the repository root can build it on its own.
+
+#include <vector>
+
+struct SkinningSource_t
+{
+    short  Bone;
+    short  Index;
+    float  Position[3];
+};
+
+struct SkinningRun_t
+{
+    short Bone;
+    short Count;
+    int   Start;
+};
+
+struct SkinningStream_t
+{
+    std::vector<SkinningRun_t> Runs;
+    std::vector<float>         X;
+    std::vector<float>         Y;
+    std::vector<float>         Z;
+    std::vector<short>         Index;
+};
+
+struct SkinningBatch_t
+{
+    SkinningStream_t Vertices;
+    SkinningStream_t Normals;
+};
+
+// Sorts sources by bone and fills stream with them; sources is reordered.
+void BuildSkinningStream(SkinningStream_t& stream, std::vector<SkinningSource_t>& sources);
+
+// out[i] = Matrices[bone] * p (full 3x4 transform)
+void SkinVertices(const SkinningStream_t& stream, const float(*Matrices)[3][4], float(*out)[3]);
+
+// out[i] = rotation part of Matrices[bone] * n; when LightPosition is given also
+// intensity[i] = max(dot(out[i], LightPosition) * 0.8 + 0.4, 0.2)
+void SkinNormals(const SkinningStream_t& stream, const float(*Matrices)[3][4], float(*out)[3], float* intensity, const float* LightPosition);
@@ -0,0 +1,233 @@
+///////////////////////////////////////////////////////////////////////////////
+// Deferred dynamic terrain lights
+///////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "TerrainLightBatch.h"
+#include "ZzzLodTerrain.h"
+
+#if defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define TERRAIN_LIGHT_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    enum
+    {
+        // a scene that moves effects without calling InitTerrainLight still gets flushed
+        MAX_QUEUED_LIGHTS = 4096,
+    };
+
+    struct TERRAIN_LIGHT
+    {
+        float  X;       // tile units
+        float  Y;
+        vec3_t Color;
+        int    Range;
+        bool   Clip;
+    };
+
+    std::vector<TERRAIN_LIGHT> s_Lights;
+
+    int s_MinX = 0;
+    int s_MinY = 0;
+    int s_MaxX = TERRAIN_SIZE_MASK;
+    int s_MaxY = TERRAIN_SIZE_MASK;
+
+    // sum of the current run of additive lights, indexed like the light map
+    float s_AccumR[TERRAIN_SIZE * TERRAIN_SIZE];
+    float s_AccumG[TERRAIN_SIZE * TERRAIN_SIZE];
+    float s_AccumB[TERRAIN_SIZE * TERRAIN_SIZE];
+    bool  s_bAccum = false;
+    int   s_AccumMinX, s_AccumMinY, s_AccumMaxX, s_AccumMaxY;
+
+    bool GetLightRect(const TERRAIN_LIGHT& light, int& x0, int& y0, int& x1, int& y1)
+    {
+        const int xi = (int)light.X;
+        const int yi = (int)light.Y;
+        x0 = max(xi - light.Range, s_MinX);
+        y0 = max(yi - light.Range, s_MinY);
+        x1 = min(xi + light.Range, s_MaxX);
+        y1 = min(yi + light.Range, s_MaxY);
+        return x0 <= x1 && y0 <= y1;
+    }
+
+    void AccumulateLight(const TERRAIN_LIGHT& light)
+    {
+        int x0, y0, x1, y1;
+        if (!GetLightRect(light, x0, y0, x1, y1))
+            return;
+
+        if (!s_bAccum)
+        {
+            s_bAccum = true;
+            s_AccumMinX = x0;
+            s_AccumMinY = y0;
+            s_AccumMaxX = x1;
+            s_AccumMaxY = y1;
+        }
+        else
+        {
+            s_AccumMinX = min(s_AccumMinX, x0);
+            s_AccumMinY = min(s_AccumMinY, y0);
+            s_AccumMaxX = max(s_AccumMaxX, x1);
+            s_AccumMaxY = max(s_AccumMaxY, y1);
+        }
+
+        const float rf = (float)light.Range;
+        for (int y = y0; y <= y1; ++y)
+        {
+            const float yd = light.Y - (float)y;
+            const float yd2 = yd * yd;
+            const int row = y * TERRAIN_SIZE;
+            int x = x0;
+
+#ifdef TERRAIN_LIGHT_USE_SSE2
+            const __m128 lx = _mm_set1_ps(light.X);
+            const __m128 ly2 = _mm_set1_ps(yd2);
+            const __m128 range = _mm_set1_ps(rf);
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 r = _mm_set1_ps(light.Color[0]);
+            const __m128 g = _mm_set1_ps(light.Color[1]);
+            const __m128 b = _mm_set1_ps(light.Color[2]);
+            const __m128 four = _mm_set1_ps(4.f);
+            __m128 cx = _mm_setr_ps((float)x, (float)(x + 1), (float)(x + 2), (float)(x + 3));
+            for (; x + 4 <= x1 + 1; x += 4, cx = _mm_add_ps(cx, four))
+            {
+                const __m128 xd = _mm_sub_ps(lx, cx);
+                const __m128 d = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(xd, xd), ly2));
+                const __m128 lf = _mm_max_ps(_mm_div_ps(_mm_sub_ps(range, d), range), zero);
+
+                float* pr = s_AccumR + row + x;
+                float* pg = s_AccumG + row + x;
+                float* pb = s_AccumB + row + x;
+                _mm_storeu_ps(pr, _mm_add_ps(_mm_loadu_ps(pr), _mm_mul_ps(lf, r)));
+                _mm_storeu_ps(pg, _mm_add_ps(_mm_loadu_ps(pg), _mm_mul_ps(lf, g)));
+                _mm_storeu_ps(pb, _mm_add_ps(_mm_loadu_ps(pb), _mm_mul_ps(lf, b)));
+            }
+#endif
+            for (; x <= x1; ++x)
+            {
+                const float xd = light.X - (float)x;
+                const float lf = (rf - sqrtf(xd * xd + yd2)) / rf;
+                if (lf > 0.f)
+                {
+                    s_AccumR[row + x] += light.Color[0] * lf;
+                    s_AccumG[row + x] += light.Color[1] * lf;
+                    s_AccumB[row + x] += light.Color[2] * lf;
+                }
+            }
+        }
+    }
+
+    void ResolveAccum()
+    {
+        if (!s_bAccum)
+            return;
+
+        for (int y = s_AccumMinY; y <= s_AccumMaxY; ++y)
+        {
+            const int row = y * TERRAIN_SIZE;
+            for (int x = s_AccumMinX; x <= s_AccumMaxX; ++x)
+            {
+                float* b = PrimaryTerrainLight[row + x];
+                b[0] += s_AccumR[row + x];
+                b[1] += s_AccumG[row + x];
+                b[2] += s_AccumB[row + x];
+                if (b[0] < 0.f) b[0] = 0.f;
+                if (b[1] < 0.f) b[1] = 0.f;
+                if (b[2] < 0.f) b[2] = 0.f;
+            }
+
+            const int count = s_AccumMaxX - s_AccumMinX + 1;
+            memset(s_AccumR + row + s_AccumMinX, 0, count * sizeof(float));
+            memset(s_AccumG + row + s_AccumMinX, 0, count * sizeof(float));
+            memset(s_AccumB + row + s_AccumMinX, 0, count * sizeof(float));
+        }
+        s_bAccum = false;
+    }
+
+    // Same falloff and clamping as AddTerrainLight / AddTerrainLightClip.
+    void ApplyLight(const TERRAIN_LIGHT& light)
+    {
+        int x0, y0, x1, y1;
+        if (!GetLightRect(light, x0, y0, x1, y1))
+            return;
+
+        const float rf = (float)light.Range;
+        for (int y = y0; y <= y1; ++y)
+        {
+            const float yd = light.Y - (float)y;
+            for (int x = x0; x <= x1; ++x)
+            {
+                const float xd = light.X - (float)x;
+                const float lf = (rf - sqrtf(xd * xd + yd * yd)) / rf;
+                if (lf <= 0.f)
+                    continue;
+
+                float* b = PrimaryTerrainLight[y * TERRAIN_SIZE + x];
+                for (int i = 0; i < 3; i++)
+                {
+                    b[i] += light.Color[i] * lf;
+                    if (b[i] < 0.f) b[i] = 0.f;
+                    else if (light.Clip && b[i] > 1.f) b[i] = 1.f;
+                }
+            }
+        }
+    }
+}
+
+void BeginTerrainLights(int MinX, int MinY, int MaxX, int MaxY)
+{
+    s_Lights.clear();
+    s_MinX = max(MinX, 0);
+    s_MinY = max(MinY, 0);
+    s_MaxX = min(MaxX, static_cast<int>(TERRAIN_SIZE_MASK));
+    s_MaxY = min(MaxY, static_cast<int>(TERRAIN_SIZE_MASK));
+}
+
+void QueueTerrainLight(float xf, float yf, const vec3_t Light, int Range, bool Clip)
+{
+    if (Range <= 0)
+        return;
+
+    TERRAIN_LIGHT light;
+    light.X = xf / TERRAIN_SCALE;
+    light.Y = yf / TERRAIN_SCALE;
+    VectorCopy(Light, light.Color);
+    light.Range = Range;
+    light.Clip = Clip;
+
+    int x0, y0, x1, y1;
+    if (!GetLightRect(light, x0, y0, x1, y1))
+        return;
+
+    s_Lights.push_back(light);
+    if (s_Lights.size() >= MAX_QUEUED_LIGHTS)
+        FlushTerrainLights();
+}
+
+void FlushTerrainLights()
+{
+    if (s_Lights.empty())
+        return;
+
+    for (const TERRAIN_LIGHT& light : s_Lights)
+    {
+        // with non-negative lights the per-light clamp of AddTerrainLight never fires,
+        // so the run can be summed first
+        if (!light.Clip && light.Color[0] >= 0.f && light.Color[1] >= 0.f && light.Color[2] >= 0.f)
+        {
+            AccumulateLight(light);
+        }
+        else
+        {
+            ResolveAccum();
+            ApplyLight(light);
+        }
+    }
+    ResolveAccum();
+
+    s_Lights.clear();
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+// Deferred dynamic lights for PrimaryTerrainLight.
+//
+// AddTerrainLight / AddTerrainLightClip on PrimaryTerrainLight only queue the light.
+// The queue is splatted in one pass the next time the light map is read (RequestTerrainLight,
+// the terrain and terrain bitmap renderers), clipped to the area InitTerrainLight restored
+// this frame; cells outside it are never drawn and were left stale before as well. Runs of
+// additive lights are summed into a structure-of-arrays buffer four cells at a time with
+// SSE2 and added to the light map once; darkening and clipped lights are applied in queue
+// order with the original clamping.
+
+// Drops the queue and sets the area lights are applied to (inclusive tile bounds).
+void BeginTerrainLights(int MinX, int MinY, int MaxX, int MaxY);
+
+void QueueTerrainLight(float xf, float yf, const vec3_t Light, int Range, bool Clip);
+
+// Applies every queued light to PrimaryTerrainLight.
+void FlushTerrainLights();
@@ -0,0 +1,676 @@
+///////////////////////////////////////////////////////////////////////////////
+// Chunked terrain geometry
+///////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include <algorithm>
+#include <map>
+#include "TerrainMesh.h"
+#include "ZzzOpenglUtil.h"
+#include "ZzzTexture.h"
+#include "ZzzLodTerrain.h"
+#include "zzzpath.h"
+#include "CSChaosCastle.h"
+#include "MapManager.h"
+#include "w_MapHeaders.h"
+#include "./Utilities/Profiler.h"
+#include "RenderQueue.h"
+
+extern float WaterMove;
+extern float TerrainGrassWind[];
+extern float g_fSpecialHeight;
+extern int   WaterTextureNumber;
+extern int   FrustrumBoundMinX;
+extern int   FrustrumBoundMinY;
+extern int   FrustrumBoundMaxX;
+extern int   FrustrumBoundMaxY;
+
+bool g_bUseTerrainMesh = true;
+
+namespace
+{
+    enum
+    {
+        CHUNK_TILES = 16,
+        CHUNKS_PER_ROW = TERRAIN_SIZE / CHUNK_TILES,
+        CHUNK_COUNT = CHUNKS_PER_ROW * CHUNKS_PER_ROW,
+        // a tile uses the samples to its right and below, so the last row and column
+        // of samples start no tile
+        TILE_END = TERRAIN_SIZE_MASK,
+        MAX_LOD = 2,
+        CRYWOLF_WATER = 5,
+    };
+
+    constexpr float LOD_DISTANCE = 3000.f;
+
+    enum TERRAIN_PASS
+    {
+        PASS_BASE,  // Layer1, or Layer2 where the alpha map covers the tile
+        PASS_BLEND, // additive water over Layer2 == 5 in Atlans and Doppelganger 3
+        PASS_ALPHA, // Layer2 alpha tested over Layer1
+    };
+
+    constexpr WORD NO_LAYER = 0xFFFF;
+
+    WORD MakeKey(int pass, bool water, int texture)
+    {
+        return static_cast<WORD>((pass << 12) | (water ? 0x800 : 0) | texture);
+    }
+
+    int KeyPass(WORD key) { return key >> 12; }
+    bool KeyWater(WORD key) { return (key & 0x800) != 0; }
+    int KeyTexture(WORD key) { return key & 0x7FF; }
+
+    struct CHUNK_BATCH
+    {
+        WORD Key;
+        std::vector<WORD> Indices;
+    };
+
+    struct TERRAIN_CHUNK
+    {
+        int  X0, Y0, X1, Y1;    // tiles [X0, X1) x [Y0, Y1)
+        int  MaxLod = 0;
+        int  Lod = 0;
+        bool Dirty = true;
+        bool HasAlpha = false;
+        int  CacheKey = -1;
+        std::vector<CHUNK_BATCH> Batches;
+        std::vector<WORD> WaterSpots;   // Crywolf water tiles, once per water layer
+    };
+
+    struct FRAME_BATCH
+    {
+        std::vector<WORD> Indices;
+        std::vector<int>  Chunks;
+    };
+
+    float  s_Position[TERRAIN_SIZE * TERRAIN_SIZE][3];
+    float  s_TexCoord[TERRAIN_SIZE * TERRAIN_SIZE][2];
+    float  s_WaterTexCoord[TERRAIN_SIZE * TERRAIN_SIZE][2];
+    float  s_BlendColor[TERRAIN_SIZE * TERRAIN_SIZE][3];
+    float  s_AlphaColor[TERRAIN_SIZE * TERRAIN_SIZE][4];
+    WORD   s_BaseKey[TERRAIN_SIZE * TERRAIN_SIZE];
+    WORD   s_LayerKey[TERRAIN_SIZE * TERRAIN_SIZE];
+
+    TERRAIN_CHUNK s_Chunks[CHUNK_COUNT];
+    bool   s_bInitialized = false;
+    int    s_BakedWorld = -1;
+    float  s_BakedSpecialHeight = 0.f;
+
+    std::vector<int> s_Visible;
+    std::map<WORD, FRAME_BATCH> s_FrameBatches;
+
+    int Index(int x, int y)
+    {
+        return y * TERRAIN_SIZE + x;
+    }
+
+    void Initialize()
+    {
+        for (int y = 0; y < TERRAIN_SIZE; ++y)
+        {
+            for (int x = 0; x < TERRAIN_SIZE; ++x)
+            {
+                s_TexCoord[Index(x, y)][0] = static_cast<float>(x);
+                s_TexCoord[Index(x, y)][1] = static_cast<float>(y);
+            }
+        }
+
+        for (int cy = 0; cy < CHUNKS_PER_ROW; ++cy)
+        {
+            for (int cx = 0; cx < CHUNKS_PER_ROW; ++cx)
+            {
+                TERRAIN_CHUNK& chunk = s_Chunks[cy * CHUNKS_PER_ROW + cx];
+                chunk.X0 = cx * CHUNK_TILES;
+                chunk.Y0 = cy * CHUNK_TILES;
+                chunk.X1 = min(chunk.X0 + CHUNK_TILES, static_cast<int>(TILE_END));
+                chunk.Y1 = min(chunk.Y0 + CHUNK_TILES, static_cast<int>(TILE_END));
+            }
+        }
+        s_bInitialized = true;
+    }
+
+    // Same layer selection as RenderTerrainFace.
+    void BakeTileKeys(int x, int y)
+    {
+        const int i1 = Index(x, y);
+        const int i2 = Index(x + 1, y);
+        const int i3 = Index(x + 1, y + 1);
+        const int i4 = Index(x, y + 1);
+        const float* alpha = TerrainMappingAlpha;
+
+        int texture;
+        bool layered;
+        bool water = false;
+        if (alpha[i1] >= 1.f && alpha[i2] >= 1.f && alpha[i3] >= 1.f && alpha[i4] >= 1.f)
+        {
+            texture = TerrainMappingLayer2[i1];
+            layered = false;
+        }
+        else
+        {
+            texture = TerrainMappingLayer1[i1];
+            layered = true;
+            if (texture == 5)
+                water = true;
+            if (texture == 11 && (gMapManager.IsPKField() || IsDoppelGanger2()))
+                water = true;
+        }
+        s_BaseKey[i1] = MakeKey(PASS_BASE, water, texture);
+        s_LayerKey[i1] = NO_LAYER;
+
+        if (alpha[i1] > 0.f || alpha[i2] > 0.f || alpha[i3] > 0.f || alpha[i4] > 0.f)
+        {
+            if ((gMapManager.WorldActive == WD_7ATLANSE || IsDoppelGanger3()) && TerrainMappingLayer2[i1] == 5)
+            {
+                s_LayerKey[i1] = MakeKey(PASS_BLEND, false, 0);
+            }
+            else if (layered && TerrainMappingLayer2[i1] != 255)
+            {
+                texture = TerrainMappingLayer2[i1];
+                s_LayerKey[i1] = MakeKey(PASS_ALPHA, water && texture == 5, texture);
+            }
+        }
+    }
+
+    bool IsUniformCell(int x, int y, int step)
+    {
+        const WORD key = s_BaseKey[Index(x, y)];
+        for (int j = 0; j < step; ++j)
+        {
+            for (int i = 0; i < step; ++i)
+            {
+                const int index = Index(x + i, y + j);
+                if (s_BaseKey[index] != key || s_LayerKey[index] != NO_LAYER)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    void BakeChunk(TERRAIN_CHUNK& chunk)
+    {
+        bool fullDetail = (chunk.X1 - chunk.X0) != CHUNK_TILES || (chunk.Y1 - chunk.Y0) != CHUNK_TILES;
+
+        for (int y = chunk.Y0; y <= chunk.Y1; ++y)
+        {
+            for (int x = chunk.X0; x <= chunk.X1; ++x)
+            {
+                const int index = Index(x, y);
+                s_Position[index][0] = x * TERRAIN_SCALE;
+                s_Position[index][1] = y * TERRAIN_SCALE;
+                s_Position[index][2] = BackTerrainHeight[index];
+                if ((TerrainWall[index] & TW_HEIGHT) == TW_HEIGHT)
+                {
+                    s_Position[index][2] = g_fSpecialHeight;
+                    fullDetail = true;
+                }
+
+                const float alpha = TerrainMappingAlpha[index];
+                s_BlendColor[index][0] = alpha;
+                s_BlendColor[index][1] = alpha;
+                s_BlendColor[index][2] = alpha;
+            }
+        }
+
+        chunk.HasAlpha = false;
+        chunk.WaterSpots.clear();
+        const bool crywolf = gMapManager.WorldActive == WD_34CRYWOLF_1ST;
+        for (int y = chunk.Y0; y < chunk.Y1; ++y)
+        {
+            for (int x = chunk.X0; x < chunk.X1; ++x)
+            {
+                const int index = Index(x, y);
+                BakeTileKeys(x, y);
+
+                if ((TerrainWall[index] & TW_NOGROUND) == TW_NOGROUND)
+                {
+                    fullDetail = true;
+                    continue;
+                }
+                if (s_LayerKey[index] != NO_LAYER && KeyPass(s_LayerKey[index]) == PASS_ALPHA)
+                    chunk.HasAlpha = true;
+
+                if (crywolf)
+                {
+                    const WORD base = s_BaseKey[index];
+                    const WORD layer = s_LayerKey[index];
+                    if (KeyWater(base) && KeyTexture(base) == CRYWOLF_WATER)
+                        chunk.WaterSpots.push_back(static_cast<WORD>(index));
+                    if (layer != NO_LAYER && KeyWater(layer) && KeyTexture(layer) == CRYWOLF_WATER)
+                        chunk.WaterSpots.push_back(static_cast<WORD>(index));
+                }
+            }
+        }
+
+        chunk.MaxLod = 0;
+        for (int lod = 1; lod <= MAX_LOD && !fullDetail; ++lod)
+        {
+            const int step = 1 << lod;
+            bool uniform = true;
+            for (int y = chunk.Y0; y < chunk.Y1 && uniform; y += step)
+            {
+                for (int x = chunk.X0; x < chunk.X1 && uniform; x += step)
+                    uniform = IsUniformCell(x, y, step);
+            }
+            if (!uniform)
+                break;
+            chunk.MaxLod = lod;
+        }
+
+        chunk.Dirty = false;
+        chunk.CacheKey = -1;
+    }
+
+    void AddQuad(TERRAIN_CHUNK& chunk, WORD key, const WORD v[4])
+    {
+        CHUNK_BATCH* batch = nullptr;
+        for (CHUNK_BATCH& b : chunk.Batches)
+        {
+            if (b.Key == key)
+            {
+                batch = &b;
+                break;
+            }
+        }
+        if (batch == nullptr)
+        {
+            chunk.Batches.push_back({ key, std::vector<WORD>() });
+            batch = &chunk.Batches.back();
+        }
+
+        // the fan RenderFace draws, minus the triangles collapsed by edge snapping
+        if (v[0] != v[1] && v[1] != v[2] && v[0] != v[2])
+        {
+            batch->Indices.push_back(v[0]);
+            batch->Indices.push_back(v[1]);
+            batch->Indices.push_back(v[2]);
+        }
+        if (v[0] != v[2] && v[2] != v[3] && v[0] != v[3])
+        {
+            batch->Indices.push_back(v[0]);
+            batch->Indices.push_back(v[2]);
+            batch->Indices.push_back(v[3]);
+        }
+    }
+
+    // step: the chunk's cell size; top/right/bottom/left: cell size to match on that edge.
+    void BuildChunkIndices(TERRAIN_CHUNK& chunk, int step, int top, int right, int bottom, int left)
+    {
+        for (CHUNK_BATCH& batch : chunk.Batches)
+            batch.Indices.clear();
+
+        for (int y = chunk.Y0; y < chunk.Y1; y += step)
+        {
+            for (int x = chunk.X0; x < chunk.X1; x += step)
+            {
+                const int index = Index(x, y);
+                if ((TerrainWall[index] & TW_NOGROUND) == TW_NOGROUND)
+                    continue;
+
+                const int cornerX[4] = { x, x + step, x + step, x };
+                const int cornerY[4] = { y, y, y + step, y + step };
+                WORD v[4];
+                for (int i = 0; i < 4; ++i)
+                {
+                    int vx = cornerX[i];
+                    int vy = cornerY[i];
+                    // chunk origins are multiples of every cell size, so rounding down
+                    // lands on the neighbour's samples
+                    if (vy == chunk.Y0) vx = vx / top * top;
+                    else if (vy == chunk.Y1) vx = vx / bottom * bottom;
+                    if (vx == chunk.X0) vy = vy / left * left;
+                    else if (vx == chunk.X1) vy = vy / right * right;
+                    v[i] = static_cast<WORD>(Index(vx, vy));
+                }
+
+                AddQuad(chunk, s_BaseKey[index], v);
+                if (s_LayerKey[index] != NO_LAYER)
+                    AddQuad(chunk, s_LayerKey[index], v);
+            }
+        }
+    }
+
+    int ChooseLod(const TERRAIN_CHUNK& chunk)
+    {
+        if (chunk.MaxLod == 0)
+            return 0;
+
+        const float x0 = chunk.X0 * TERRAIN_SCALE;
+        const float y0 = chunk.Y0 * TERRAIN_SCALE;
+        const float x1 = chunk.X1 * TERRAIN_SCALE;
+        const float y1 = chunk.Y1 * TERRAIN_SCALE;
+        const float dx = max(max(x0 - CameraPosition[0], CameraPosition[0] - x1), 0.f);
+        const float dy = max(max(y0 - CameraPosition[1], CameraPosition[1] - y1), 0.f);
+        const float distance = sqrtf(dx * dx + dy * dy);
+
+        int lod = static_cast<int>(distance / LOD_DISTANCE);
+        return min(lod, chunk.MaxLod);
+    }
+
+    int NeighbourStep(int cx, int cy, int step)
+    {
+        if (cx < 0 || cy < 0 || cx >= CHUNKS_PER_ROW || cy >= CHUNKS_PER_ROW)
+            return step;
+        return max(step, 1 << s_Chunks[cy * CHUNKS_PER_ROW + cx].Lod);
+    }
+
+    void UpdateChunkIndices(int chunkIndex)
+    {
+        TERRAIN_CHUNK& chunk = s_Chunks[chunkIndex];
+        const int cx = chunkIndex % CHUNKS_PER_ROW;
+        const int cy = chunkIndex / CHUNKS_PER_ROW;
+        const int step = 1 << chunk.Lod;
+        const int top = NeighbourStep(cx, cy - 1, step);
+        const int right = NeighbourStep(cx + 1, cy, step);
+        const int bottom = NeighbourStep(cx, cy + 1, step);
+        const int left = NeighbourStep(cx - 1, cy, step);
+
+        // steps are powers of two up to 4; three bits each
+        const int key = step | (top << 3) | (right << 6) | (bottom << 9) | (left << 12);
+        if (key == chunk.CacheKey)
+            return;
+
+        BuildChunkIndices(chunk, step, top, right, bottom, left);
+        chunk.CacheKey = key;
+    }
+
+    // InitTerrainLight only refreshes the frustum bounds; chunks reach a little past
+    // them, so restore the static light there instead of drawing last frame's lights.
+    void RefreshChunkLight(const TERRAIN_CHUNK& chunk)
+    {
+        const int maxX = min(FrustrumBoundMaxX + 3, static_cast<int>(TERRAIN_SIZE_MASK));
+        const int maxY = min(FrustrumBoundMaxY + 3, static_cast<int>(TERRAIN_SIZE_MASK));
+        for (int y = chunk.Y0; y <= chunk.Y1; ++y)
+        {
+            const bool rowInside = y >= FrustrumBoundMinY && y <= maxY;
+            for (int x = chunk.X0; x <= chunk.X1; ++x)
+            {
+                if (rowInside && x >= FrustrumBoundMinX && x <= maxX)
+                {
+                    x = maxX;
+                    continue;
+                }
+                VectorCopy(BackTerrainLight[Index(x, y)], PrimaryTerrainLight[Index(x, y)]);
+            }
+        }
+    }
+
+    void FillAlphaColor(const TERRAIN_CHUNK& chunk)
+    {
+        for (int y = chunk.Y0; y <= chunk.Y1; ++y)
+        {
+            for (int x = chunk.X0; x <= chunk.X1; ++x)
+            {
+                const int index = Index(x, y);
+                s_AlphaColor[index][0] = PrimaryTerrainLight[index][0];
+                s_AlphaColor[index][1] = PrimaryTerrainLight[index][1];
+                s_AlphaColor[index][2] = PrimaryTerrainLight[index][2];
+                s_AlphaColor[index][3] = TerrainMappingAlpha[index];
+            }
+        }
+    }
+
+    // Same texture coordinates as FaceTexture with Water set. The wind only depends on
+    // x and is refreshed inside the frustum bounds, so it is read from their first row.
+    void FillWaterTexCoord(const TERRAIN_CHUNK& chunk, int texture, float width, float height)
+    {
+        float move = WaterMove;
+        if (gMapManager.WorldActive == WD_30BATTLECASTLE && texture == 5)
+            move = -WaterMove;
+
+        const int windMinX = FrustrumBoundMinX;
+        const int windMaxX = min(FrustrumBoundMaxX + 3, static_cast<int>(TERRAIN_SIZE_MASK));
+        for (int x = chunk.X0; x <= chunk.X1; ++x)
+        {
+            const int windX = min(max(x, windMinX), windMaxX);
+            const float wind = TerrainGrassWind[Index(windX, FrustrumBoundMinY)] * 0.002f;
+            for (int y = chunk.Y0; y <= chunk.Y1; ++y)
+            {
+                const int index = Index(x, y);
+                s_WaterTexCoord[index][0] = x * width + move;
+                s_WaterTexCoord[index][1] = y * height + wind;
+            }
+        }
+    }
+
+    void CollectVisibleChunks()
+    {
+        s_Visible.clear();
+
+        const int minCX = FrustrumBoundMinX / CHUNK_TILES;
+        const int minCY = FrustrumBoundMinY / CHUNK_TILES;
+        const int maxCX = min((FrustrumBoundMaxX + 3) / CHUNK_TILES, CHUNKS_PER_ROW - 1);
+        const int maxCY = min((FrustrumBoundMaxY + 3) / CHUNK_TILES, CHUNKS_PER_ROW - 1);
+
+        for (int cy = minCY; cy <= maxCY; ++cy)
+        {
+            for (int cx = minCX; cx <= maxCX; ++cx)
+            {
+                const int chunkIndex = cy * CHUNKS_PER_ROW + cx;
+                TERRAIN_CHUNK& chunk = s_Chunks[chunkIndex];
+                if (!CameraTopViewEnable && !TestFrustrum2DRect((float)chunk.X0, (float)chunk.Y0, (float)chunk.X1, (float)chunk.Y1))
+                    continue;
+
+                s_Visible.push_back(chunkIndex);
+            }
+        }
+
+        // front to back so the base pass rejects hidden fragments early
+        const float camX = CameraPosition[0] / TERRAIN_SCALE;
+        const float camY = CameraPosition[1] / TERRAIN_SCALE;
+        auto distance = [camX, camY](int chunkIndex)
+            {
+                const TERRAIN_CHUNK& chunk = s_Chunks[chunkIndex];
+                const float dx = (chunk.X0 + chunk.X1) * 0.5f - camX;
+                const float dy = (chunk.Y0 + chunk.Y1) * 0.5f - camY;
+                return dx * dx + dy * dy;
+            };
+        std::sort(s_Visible.begin(), s_Visible.end(), [&distance](int a, int b) { return distance(a) < distance(b); });
+    }
+
+    // Per tile work RenderTerrainFace does besides drawing.
+    void UpdateTileEffects()
+    {
+        const bool chaosCastle = gMapManager.InChaosCastle();
+        const bool crywolf = gMapManager.WorldActive == WD_34CRYWOLF_1ST;
+        if (!chaosCastle && !crywolf)
+            return;
+
+        for (int chunkIndex : s_Visible)
+        {
+            const TERRAIN_CHUNK& chunk = s_Chunks[chunkIndex];
+
+            for (WORD index : chunk.WaterSpots)
+            {
+                const int x = index % TERRAIN_SIZE;
+                const int y = index / TERRAIN_SIZE;
+                if (TestFrustrum2D(x + 0.5f, y + 0.5f, 0.f) || CameraTopViewEnable)
+                    CreateTerrainWaterSpot((float)x, (float)y);
+            }
+
+            if (!chaosCastle)
+                continue;
+
+            for (int y = chunk.Y0; y < chunk.Y1; ++y)
+            {
+                for (int x = chunk.X0; x < chunk.X1; ++x)
+                {
+                    if ((TerrainWall[Index(x, y)] & TW_NOGROUND) == TW_NOGROUND)
+                        continue;
+                    if (TestFrustrum2D(x + 0.5f, y + 0.5f, 0.f) || CameraTopViewEnable)
+                        RenderTerrainVisual(x, y);
+                }
+            }
+        }
+    }
+
+    void DrawBatch(WORD key, FRAME_BATCH& batch)
+    {
+        const int pass = KeyPass(key);
+        int texture = KeyTexture(key);
+
+        if (pass == PASS_BASE)
+        {
+            if (!SetTerrainFaceState(texture))
+                return;
+            glColorPointer(3, GL_FLOAT, 0, PrimaryTerrainLight);
+        }
+        else if (pass == PASS_BLEND)
+        {
+            texture = BITMAP_WATER - BITMAP_MAPTILE + WaterTextureNumber;
+            EnableAlphaBlend();
+            glColorPointer(3, GL_FLOAT, 0, s_BlendColor);
+        }
+        else
+        {
+            EnableAlphaTest();
+            glColorPointer(4, GL_FLOAT, 0, s_AlphaColor);
+        }
+        BindTexture(BITMAP_MAPTILE + texture);
+
+        BITMAP_t* b = &Bitmaps[BITMAP_MAPTILE + texture];
+        const float tile = pass == PASS_BLEND ? 16.f : 64.f;
+        const float width = tile / b->Width;
+        const float height = tile / b->Height;
+
+        if (KeyWater(key))
+        {
+            for (int chunkIndex : batch.Chunks)
+                FillWaterTexCoord(s_Chunks[chunkIndex], texture, width, height);
+            glTexCoordPointer(2, GL_FLOAT, 0, s_WaterTexCoord);
+        }
+        else
+        {
+            glMatrixMode(GL_TEXTURE);
+            glLoadIdentity();
+            glScalef(width, height, 1.f);
+            glMatrixMode(GL_MODELVIEW);
+            glTexCoordPointer(2, GL_FLOAT, 0, s_TexCoord);
+        }
+
+        ++g_RenderCounters.DrawCalls;
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(batch.Indices.size()), GL_UNSIGNED_SHORT, batch.Indices.data());
+
+        if (!KeyWater(key))
+        {
+            glMatrixMode(GL_TEXTURE);
+            glLoadIdentity();
+            glMatrixMode(GL_MODELVIEW);
+        }
+    }
+}
+
+void InvalidateTerrainMesh()
+{
+    for (TERRAIN_CHUNK& chunk : s_Chunks)
+        chunk.Dirty = true;
+}
+
+void InvalidateTerrainMeshArea(int xi, int yi, int Range)
+{
+    // edits near the border wrap around like TERRAIN_INDEX_REPEAT
+    if (xi - Range < 0 || yi - Range < 0 || xi + Range > TERRAIN_SIZE_MASK || yi + Range > TERRAIN_SIZE_MASK)
+    {
+        InvalidateTerrainMesh();
+        return;
+    }
+
+    // one extra sample: a tile's keys depend on the alpha of the samples right and below
+    const int minCX = max(xi - Range - 1, 0) / CHUNK_TILES;
+    const int minCY = max(yi - Range - 1, 0) / CHUNK_TILES;
+    const int maxCX = (xi + Range) / CHUNK_TILES;
+    const int maxCY = (yi + Range) / CHUNK_TILES;
+    for (int cy = minCY; cy <= maxCY; ++cy)
+    {
+        for (int cx = minCX; cx <= maxCX; ++cx)
+            s_Chunks[cy * CHUNKS_PER_ROW + cx].Dirty = true;
+    }
+}
+
+bool RenderTerrainMesh()
+{
+    if (!g_bUseTerrainMesh)
+        return false;
+
+    // the login scene culls blocks by distance from the camera
+    if (gMapManager.WorldActive == WD_73NEW_LOGIN_SCENE)
+        return false;
+
+#ifdef SHOW_PATH_INFO
+#ifdef CSK_DEBUG_MAP_PATHFINDING
+    if (g_bShowPath == true)
+#endif // CSK_DEBUG_MAP_PATHFINDING
+        return false;
+#endif // SHOW_PATH_INFO
+
+    PROFILE_SCOPE("TerrainMesh");
+
+    if (!s_bInitialized)
+        Initialize();
+
+    if (s_BakedWorld != gMapManager.WorldActive || s_BakedSpecialHeight != g_fSpecialHeight)
+    {
+        InvalidateTerrainMesh();
+        s_BakedWorld = gMapManager.WorldActive;
+        s_BakedSpecialHeight = g_fSpecialHeight;
+    }
+
+    CollectVisibleChunks();
+
+    // levels first: the stitching of a chunk depends on its neighbours' levels
+    for (int chunkIndex : s_Visible)
+    {
+        TERRAIN_CHUNK& chunk = s_Chunks[chunkIndex];
+        if (chunk.Dirty)
+            BakeChunk(chunk);
+        chunk.Lod = ChooseLod(chunk);
+    }
+
+    for (auto& entry : s_FrameBatches)
+    {
+        entry.second.Indices.clear();
+        entry.second.Chunks.clear();
+    }
+
+    for (int chunkIndex : s_Visible)
+    {
+        TERRAIN_CHUNK& chunk = s_Chunks[chunkIndex];
+        UpdateChunkIndices(chunkIndex);
+        RefreshChunkLight(chunk);
+        if (chunk.HasAlpha)
+            FillAlphaColor(chunk);
+
+        for (const CHUNK_BATCH& batch : chunk.Batches)
+        {
+            if (batch.Indices.empty())
+                continue;
+
+            FRAME_BATCH& frame = s_FrameBatches[batch.Key];
+            frame.Indices.insert(frame.Indices.end(), batch.Indices.begin(), batch.Indices.end());
+            frame.Chunks.push_back(chunkIndex);
+        }
+    }
+
+    UpdateTileEffects();
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, s_Position);
+
+    // keys sort by pass first, so every layer goes over a finished base
+    for (auto& entry : s_FrameBatches)
+    {
+        if (!entry.second.Indices.empty())
+            DrawBatch(entry.first, entry.second);
+    }
+
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glColor3f(1.f, 1.f, 1.f);
+
+    return true;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+// Chunked terrain geometry for the normal terrain pass.
+//
+// The 256x256 height map is baked once per map into static vertex arrays (position and
+// tile coordinate per height sample) and cut into 16x16 tile chunks. Every chunk keeps
+// index lists per layer texture for the level of detail it was last drawn at, so a frame
+// only culls the chunks against the 2D frustum and hands each texture one glDrawElements
+// call. Chunks whose cells share one layer texture and have no alpha layer drop to 2x2
+// or 4x4 cells with distance; edge vertices are snapped onto the coarser neighbour's
+// grid so no cracks open between levels. Holes (TW_NOGROUND) and TW_HEIGHT samples keep
+// a chunk at full detail. Lighting stays per vertex in PrimaryTerrainLight.
+//
+// Anything that edits heights, attributes or mapping layers must invalidate the affected
+// area; the editor pass, the grass pass and the _After pass still use the tile renderer.
+
+extern bool g_bUseTerrainMesh;
+
+void InvalidateTerrainMesh();
+void InvalidateTerrainMeshArea(int xi, int yi, int Range);
+
+// Draws the terrain for the current frustum; returns false when the tile renderer
+// has to be used instead.
+bool RenderTerrainMesh();
@@ -2609,6 +2609,14 @@ void CUIRenderText::RenderText(int iPos_x, int iPos_y, const wchar_t* pszText, i
         m_pRenderText->RenderText(iPos_x, iPos_y, pszText, iBoxWidth, iBoxHeight, iSort, lpTextSize);
     }
 }
+namespace
+{
+    void BindGlyphTexture(GLuint uiTexture)
+    {
+        BindTexture(-(int)uiTexture);
+    }
+}
+
 CUIRenderTextOriginal::CUIRenderTextOriginal()
 {
     m_hFontDC = nullptr;
@@ -2644,10 +2652,15 @@ bool CUIRenderTextOriginal::Create(HDC hDC)
         Release();
         return false;
     }
+
+    const int iPitch = (((int)(640 * g_fScreenRate_x) * 24 + 31) & ~31) >> 3;
+    m_GlyphAtlas.Create(m_hFontDC, m_pFontBuffer, iPitch, BindGlyphTexture);
     return true;
 }
 void CUIRenderTextOriginal::Release()
 {
+    m_GlyphAtlas.Release();
+
     if (m_hFontDC != nullptr)
     {
         DeleteDC(m_hFontDC);
@@ -2775,7 +2788,17 @@ void CUIRenderTextOriginal::RenderText(int iPos_x, int iPos_y, const wchar_t* ps
 
     SIZE RealTextSize;
 
-    if (pszText[0] == '\0')
+    const CGlyphAtlas::TEXT_LAYOUT* pLayout = nullptr;
+    if (!m_GlyphAtlas.IsTextureFailed())
+    {
+        if (m_GlyphAtlas.CreateTexture())
+            pLayout = m_GlyphAtlas.GetTextLayout(pszText);
+        else
+            g_ErrorReport.Write(L"Glyph atlas could not be created, falling back to TextOut rendering.\r\n");
+    }
+    if (pLayout != nullptr)
+        RealTextSize = pLayout->Size;
+    else if (pszText[0] == '\0')
         GetTextExtentPoint32(m_hFontDC, L"0", 1, &RealTextSize);
     else
         GetTextExtentPoint32(m_hFontDC, pszText, lstrlen(pszText), &RealTextSize);
@@ -2868,23 +2891,31 @@ void CUIRenderTextOriginal::RenderText(int iPos_x, int iPos_y, const wchar_t* ps
         EndRenderColor();
     }
 
-    if (pszText[0] != 0x0a)
+    if (pLayout != nullptr)
     {
-        ::SetBkColor(m_hFontDC, RGB(0, 0, 0));
-        ::SetTextColor(m_hFontDC, RGB(255, 255, 255));
-        TextOut(m_hFontDC, 0, 0, pszText, lstrlen(pszText));
+        if (pszText[0] != 0x0a)
+            m_GlyphAtlas.RenderGlyphs(pLayout, RealBoxPos.x + iTab, WindowHeight - RealBoxPos.y, iClipMove, RealRenderingSize.cx, RealRenderingSize.cy, m_dwTextColor);
     }
-
-    int iRealRenderWidth = RealRenderingSize.cx;
-    int iNumberOfSections = (RealRenderingSize.cx / LIMIT_WIDTH) + ((iRealRenderWidth % LIMIT_WIDTH >= 0) ? 1 : 0);
-    for (int i = 0; i < iNumberOfSections; i++)
+    else
     {
-        SIZE RealSectionLine = { (long)LIMIT_WIDTH, (long)RealRenderingSize.cy };
-        if (i == iNumberOfSections - 1)
-            RealSectionLine.cx = iRealRenderWidth % LIMIT_WIDTH;
+        if (pszText[0] != 0x0a)
+        {
+            ::SetBkColor(m_hFontDC, RGB(0, 0, 0));
+            ::SetTextColor(m_hFontDC, RGB(255, 255, 255));
+            TextOut(m_hFontDC, 0, 0, pszText, lstrlen(pszText));
+        }
 
-        WriteText(LIMIT_WIDTH * i * 3 + iClipMove, RealSectionLine.cx, RealSectionLine.cy);
-        UploadText(RealBoxPos.x + LIMIT_WIDTH * i + iTab, RealBoxPos.y, RealSectionLine.cx, RealSectionLine.cy);
+        int iRealRenderWidth = RealRenderingSize.cx;
+        int iNumberOfSections = (RealRenderingSize.cx / LIMIT_WIDTH) + ((iRealRenderWidth % LIMIT_WIDTH >= 0) ? 1 : 0);
+        for (int i = 0; i < iNumberOfSections; i++)
+        {
+            SIZE RealSectionLine = { (long)LIMIT_WIDTH, (long)RealRenderingSize.cy };
+            if (i == iNumberOfSections - 1)
+                RealSectionLine.cx = iRealRenderWidth % LIMIT_WIDTH;
+
+            WriteText(LIMIT_WIDTH * i * 3 + iClipMove, RealSectionLine.cx, RealSectionLine.cy);
+            UploadText(RealBoxPos.x + LIMIT_WIDTH * i + iTab, RealBoxPos.y, RealSectionLine.cx, RealSectionLine.cy);
+        }
     }
 
     if (lpTextSize)
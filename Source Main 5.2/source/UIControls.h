@@ -7,6 +7,7 @@
 
 #include "WSclient.h"
 #include "Time/Timer.h"
+#include "GlyphAtlas.h"
 
 #ifdef KJH_ADD_INGAMESHOP_UI_SYSTEM
 #define UIMAX_TEXT_LINE			150
@@ -763,6 +764,10 @@ class CUIRenderTextOriginal : public IUIRenderText
     HBITMAP m_hBitmap;
     BYTE* m_pFontBuffer;
     DWORD m_dwTextColor, m_dwBackColor;
+
+    // Glyphs are rasterized once with GDI into a shared atlas texture; strings are laid out
+    // once per (font, text) and then drawn as one batch of textured quads per call.
+    CGlyphAtlas m_GlyphAtlas;
 public:
     CUIRenderTextOriginal();
     virtual ~CUIRenderTextOriginal();
@@ -1800,7 +1800,7 @@ void CUIPhotoViewer::RenderPhotoCharacter()
     CullFaceEnable = true;
     DepthMaskEnable = true;
     glDepthFunc(GL_LEQUAL);
-    glAlphaFunc(GL_GREATER, 0.25f);
+    SetAlphaTestReference(0.25f);
     glDisable(GL_FOG);
     glClear(GL_DEPTH_BUFFER_BIT);
     o->Scale = 0.7f * m_fCurrentZoom;
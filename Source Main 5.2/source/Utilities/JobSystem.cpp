@@ -0,0 +1,193 @@
+#include "stdafx.h"
+#include <atomic>
+#include <deque>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "JobSystem.h"
+
+class JobSystem::Impl
+{
+public:
+    Impl()
+    {
+        const unsigned int cores = std::thread::hardware_concurrency();
+        const int workerCount = cores > 1 ? static_cast<int>(cores) - 1 : 0;
+
+        m_queueCount = workerCount + 1; // last queue belongs to the caller
+        m_queues = std::make_unique<Queue[]>(m_queueCount);
+        for (int i = 0; i < workerCount; ++i)
+        {
+            m_workers.emplace_back([this, i] { WorkerLoop(i); });
+        }
+    }
+
+    ~Impl()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_shutdown = true;
+        }
+        m_wake.notify_all();
+        for (auto& worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    void ParallelFor(int count, const std::function<void(int)>& job, int grainSize)
+    {
+        if (count <= 0)
+            return;
+
+        if (grainSize < 1)
+            grainSize = 1;
+
+        if (m_workers.empty() || count <= grainSize)
+        {
+            for (int i = 0; i < count; ++i)
+                job(i);
+            return;
+        }
+
+        // Only the render thread submits, one batch at a time.
+        m_job = &job;
+        const int chunkCount = (count + grainSize - 1) / grainSize;
+        m_pending.store(chunkCount);
+
+        const int queueCount = m_queueCount;
+        for (int c = 0; c < chunkCount; ++c)
+        {
+            const int begin = c * grainSize;
+            const int end = min(begin + grainSize, count);
+            Queue& queue = m_queues[c % queueCount];
+            std::lock_guard<std::mutex> lock(queue.Mutex);
+            queue.Chunks.push_back({ begin, end });
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            ++m_generation;
+        }
+        m_wake.notify_all();
+
+        const int self = queueCount - 1;
+        while (m_pending.load() > 0)
+        {
+            if (!RunOne(self))
+                std::this_thread::yield();
+        }
+        m_job = nullptr;
+    }
+
+    int GetWorkerCount() const
+    {
+        return static_cast<int>(m_workers.size());
+    }
+
+private:
+    struct Chunk
+    {
+        int Begin;
+        int End;
+    };
+
+    struct Queue
+    {
+        std::mutex        Mutex;
+        std::deque<Chunk> Chunks;
+    };
+
+    bool PopLocal(int index, Chunk& chunk)
+    {
+        Queue& queue = m_queues[index];
+        std::lock_guard<std::mutex> lock(queue.Mutex);
+        if (queue.Chunks.empty())
+            return false;
+        chunk = queue.Chunks.front();
+        queue.Chunks.pop_front();
+        return true;
+    }
+
+    bool Steal(int thief, Chunk& chunk)
+    {
+        const int queueCount = m_queueCount;
+        for (int offset = 1; offset < queueCount; ++offset)
+        {
+            Queue& queue = m_queues[(thief + offset) % queueCount];
+            std::lock_guard<std::mutex> lock(queue.Mutex);
+            if (!queue.Chunks.empty())
+            {
+                chunk = queue.Chunks.back();
+                queue.Chunks.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool RunOne(int index)
+    {
+        Chunk chunk;
+        if (!PopLocal(index, chunk) && !Steal(index, chunk))
+            return false;
+
+        const std::function<void(int)>& job = *m_job;
+        for (int i = chunk.Begin; i < chunk.End; ++i)
+            job(i);
+
+        m_pending.fetch_sub(1);
+        return true;
+    }
+
+    void WorkerLoop(int index)
+    {
+        unsigned int seenGeneration = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_wakeMutex);
+                m_wake.wait(lock, [&] { return m_shutdown || m_generation != seenGeneration; });
+                if (m_shutdown)
+                    return;
+                seenGeneration = m_generation;
+            }
+
+            while (m_pending.load() > 0)
+            {
+                if (!RunOne(index))
+                    break;
+            }
+        }
+    }
+
+    std::vector<std::thread>          m_workers;
+    std::unique_ptr<Queue[]>          m_queues;
+    int                               m_queueCount = 0;
+    std::mutex                        m_wakeMutex;
+    std::condition_variable           m_wake;
+    unsigned int                      m_generation = 0;
+    bool                              m_shutdown = false;
+    std::atomic<int>                  m_pending{ 0 };
+    const std::function<void(int)>*   m_job = nullptr;
+};
+
+JobSystem* JobSystem::Instance()
+{
+    static JobSystem instance;
+    return &instance;
+}
+
+JobSystem::JobSystem() : pImpl(std::make_unique<Impl>()) {}
+
+JobSystem::~JobSystem() = default;
+
+void JobSystem::ParallelFor(int count, const std::function<void(int)>& job, int grainSize)
+{
+    pImpl->ParallelFor(count, job, grainSize);
+}
+
+int JobSystem::GetWorkerCount() const
+{
+    return pImpl->GetWorkerCount();
+}
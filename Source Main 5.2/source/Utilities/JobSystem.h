@@ -0,0 +1,26 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+
+// Small work-stealing thread pool for per-frame data-parallel work.
+//
+// ParallelFor splits [0, count) into chunks that are dealt round-robin onto the
+// workers' local queues; an idle worker first drains its own queue and then steals
+// from the others. The calling thread helps until every chunk is done, so the call
+// is synchronous and jobs may freely read state owned by the render thread.
+class JobSystem {
+public:
+    static JobSystem* Instance();
+
+    void ParallelFor(int count, const std::function<void(int)>& job, int grainSize = 1);
+
+    int GetWorkerCount() const;
+
+private:
+    JobSystem();
+    ~JobSystem();
+
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
@@ -0,0 +1,301 @@
+#include "stdafx.h"
+#include <algorithm>
+#include "PacketCapture.h"
+
+namespace
+{
+    constexpr DWORD CAPTURE_MAGIC = 'MUPC';
+    constexpr DWORD CAPTURE_VERSION = 1;
+
+    struct CAPTURE_HEADER
+    {
+        DWORD Magic;
+        DWORD Version;
+    };
+
+    struct CAPTURE_RECORD
+    {
+        DWORD   Frame;
+        DWORD   Milliseconds;
+        int32_t Size;
+    };
+
+    BYTE GetHeadCode(const BYTE* data, int32_t size)
+    {
+        // C1/C3 packets have a one byte size field, C2/C4 packets a two byte one
+        const int offset = data[0] % 2 == 1 ? 2 : 3;
+        return size > offset ? data[offset] : 0;
+    }
+
+    LONGLONG Now()
+    {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return counter.QuadPart;
+    }
+}
+
+class PacketCapture::Impl
+{
+public:
+    ~Impl()
+    {
+        if (m_pFile != nullptr)
+            fclose(m_pFile);
+    }
+
+    bool StartRecording(const wchar_t* fileName)
+    {
+        if (m_pFile != nullptr || m_bReplaying)
+            return false;
+
+        m_pFile = _wfopen(fileName, L"wb");
+        if (m_pFile == nullptr)
+        {
+            g_ErrorReport.Write(L"PacketCapture: cannot create %ls\r\n", fileName);
+            return false;
+        }
+        setvbuf(m_pFile, nullptr, _IOFBF, 1 << 16);
+
+        const CAPTURE_HEADER header = { CAPTURE_MAGIC, CAPTURE_VERSION };
+        fwrite(&header, sizeof(header), 1, m_pFile);
+
+        g_ConsoleDebug->Write(MCD_NORMAL, L"PacketCapture: recording to %ls", fileName);
+        return true;
+    }
+
+    bool StartReplay(const wchar_t* fileName)
+    {
+        if (m_pFile != nullptr || m_bReplaying)
+            return false;
+
+        FILE* fp = _wfopen(fileName, L"rb");
+        if (fp == nullptr)
+        {
+            g_ErrorReport.Write(L"PacketCapture: cannot open %ls\r\n", fileName);
+            return false;
+        }
+
+        fseek(fp, 0, SEEK_END);
+        const long fileSize = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+
+        m_Data.resize(fileSize > 0 ? fileSize : 0);
+        const size_t read = m_Data.empty() ? 0 : fread(m_Data.data(), 1, m_Data.size(), fp);
+        fclose(fp);
+
+        CAPTURE_HEADER header = { 0, 0 };
+        if (read != m_Data.size() || read < sizeof(header))
+        {
+            g_ErrorReport.Write(L"PacketCapture: cannot read %ls\r\n", fileName);
+            m_Data.clear();
+            return false;
+        }
+
+        memcpy(&header, m_Data.data(), sizeof(header));
+        if (header.Magic != CAPTURE_MAGIC || header.Version != CAPTURE_VERSION)
+        {
+            g_ErrorReport.Write(L"PacketCapture: %ls is not a packet capture\r\n", fileName);
+            m_Data.clear();
+            return false;
+        }
+
+        m_ReplayOffset = sizeof(header);
+        m_bReplaying = true;
+        g_ConsoleDebug->Write(MCD_NORMAL, L"PacketCapture: replaying %ls (%u bytes)", fileName, static_cast<unsigned int>(m_Data.size()));
+        return true;
+    }
+
+    void BeginSession()
+    {
+        if (m_bSessionStarted)
+            return;
+
+        m_bSessionStarted = true;
+        m_dwFrame = 0;
+        m_dwSessionStart = timeGetTime();
+        m_llReplayStart = Now();
+
+        if (m_bReplaying)
+            srand(REPLAY_RANDOM_SEED);
+    }
+
+    void EndFrame()
+    {
+        if (!m_bSessionStarted)
+            return;
+
+        ++m_dwFrame;
+
+        if (m_bReplaying && m_ReplayOffset >= m_Data.size())
+            FinishReplay();
+    }
+
+    void Record(const BYTE* data, int32_t size)
+    {
+        if (m_pFile == nullptr)
+            return;
+
+        const CAPTURE_RECORD record = { m_dwFrame, timeGetTime() - m_dwSessionStart, size };
+        if (fwrite(&record, sizeof(record), 1, m_pFile) != 1 || fwrite(data, 1, size, m_pFile) != static_cast<size_t>(size))
+        {
+            g_ErrorReport.Write(L"PacketCapture: write failed, recording stopped\r\n");
+            fclose(m_pFile);
+            m_pFile = nullptr;
+        }
+    }
+
+    void ReplayPackets(PacketHandler handler)
+    {
+        if (!m_bSessionStarted)
+            return;
+
+        while (m_ReplayOffset + sizeof(CAPTURE_RECORD) <= m_Data.size())
+        {
+            CAPTURE_RECORD record;
+            memcpy(&record, &m_Data[m_ReplayOffset], sizeof(record));
+            if (record.Frame > m_dwFrame)
+                break;
+
+            const size_t payload = m_ReplayOffset + sizeof(record);
+            if (record.Size <= 0 || payload + record.Size > m_Data.size())
+            {
+                g_ErrorReport.Write(L"PacketCapture: capture truncated at offset %u\r\n", static_cast<unsigned int>(m_ReplayOffset));
+                m_ReplayOffset = m_Data.size();
+                break;
+            }
+            m_ReplayOffset = payload + record.Size;
+
+            const BYTE* data = &m_Data[payload];
+            const BYTE headCode = GetHeadCode(data, record.Size);
+            const LONGLONG begin = Now();
+            try
+            {
+                handler(data, record.Size);
+            }
+            catch (const std::exception& e)
+            {
+                HandlerFailed(headCode, record.Frame, e.what());
+            }
+            catch (...)
+            {
+                HandlerFailed(headCode, record.Frame, "unknown exception");
+            }
+
+            HANDLER_STAT& stat = m_HandlerStats[headCode];
+            stat.Ticks += Now() - begin;
+            ++stat.Count;
+            ++m_dwPackets;
+        }
+
+        if (m_ReplayOffset + sizeof(CAPTURE_RECORD) > m_Data.size())
+            m_ReplayOffset = m_Data.size();
+    }
+
+    FILE* m_pFile = nullptr;
+    bool m_bReplaying = false;
+
+private:
+    struct HANDLER_STAT
+    {
+        LONGLONG Ticks = 0;
+        DWORD    Count = 0;
+        DWORD    Failures = 0;
+    };
+
+    // Only the first failure of a head code is logged; the rest show up in the summary.
+    void HandlerFailed(BYTE headCode, DWORD frame, const char* what)
+    {
+        if (m_HandlerStats[headCode].Failures++ == 0)
+            g_ErrorReport.Write(L"PacketCapture: handler for 0x%02X failed on frame %u: %hs\r\n", headCode, frame, what);
+        ++m_dwFailures;
+    }
+
+    void FinishReplay()
+    {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        const double ticksPerMillisecond = static_cast<double>(frequency.QuadPart) / 1000.0;
+        const double milliseconds = (Now() - m_llReplayStart) / ticksPerMillisecond;
+
+        g_ErrorReport.Write(L"PacketCapture: replayed %u packets in %u frames, %.1f ms (%.1f frames/s), %u handler failures\r\n",
+            m_dwPackets, m_dwFrame, milliseconds, milliseconds > 0.0 ? m_dwFrame * 1000.0 / milliseconds : 0.0, m_dwFailures);
+
+        int order[256];
+        for (int i = 0; i < 256; ++i)
+            order[i] = i;
+        std::sort(order, order + 256, [this](int a, int b) { return m_HandlerStats[a].Ticks > m_HandlerStats[b].Ticks; });
+
+        for (int i = 0; i < 256 && m_HandlerStats[order[i]].Count > 0; ++i)
+        {
+            const HANDLER_STAT& stat = m_HandlerStats[order[i]];
+            const double total = stat.Ticks / ticksPerMillisecond;
+            g_ErrorReport.Write(L"  0x%02X: %6u packets %10.3f ms total %8.4f ms avg %6u failed\r\n", order[i], stat.Count, total, total / stat.Count, stat.Failures);
+        }
+
+        m_bReplaying = false;
+        m_Data.clear();
+        SendMessage(g_hWnd, WM_DESTROY, 0, 0);
+    }
+
+    bool     m_bSessionStarted = false;
+    DWORD    m_dwFrame = 0;
+    DWORD    m_dwSessionStart = 0;
+
+    std::vector<BYTE> m_Data;
+    size_t   m_ReplayOffset = 0;
+    LONGLONG m_llReplayStart = 0;
+    DWORD    m_dwPackets = 0;
+    DWORD    m_dwFailures = 0;
+    HANDLER_STAT m_HandlerStats[256];
+};
+
+PacketCapture* PacketCapture::Instance()
+{
+    static PacketCapture instance;
+    return &instance;
+}
+
+PacketCapture::PacketCapture() : pImpl(std::make_unique<Impl>()) {}
+
+PacketCapture::~PacketCapture() = default;
+
+bool PacketCapture::StartRecording(const wchar_t* fileName)
+{
+    return pImpl->StartRecording(fileName);
+}
+
+bool PacketCapture::StartReplay(const wchar_t* fileName)
+{
+    return pImpl->StartReplay(fileName);
+}
+
+bool PacketCapture::IsRecording() const
+{
+    return pImpl->m_pFile != nullptr;
+}
+
+bool PacketCapture::IsReplaying() const
+{
+    return pImpl->m_bReplaying;
+}
+
+void PacketCapture::BeginSession()
+{
+    pImpl->BeginSession();
+}
+
+void PacketCapture::EndFrame()
+{
+    pImpl->EndFrame();
+}
+
+void PacketCapture::Record(const BYTE* data, int32_t size)
+{
+    pImpl->Record(data, size);
+}
+
+void PacketCapture::ReplayPackets(PacketHandler handler)
+{
+    pImpl->ReplayPackets(handler);
+}
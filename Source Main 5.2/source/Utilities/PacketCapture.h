@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+
+// Records the server packets handled by the game loop and plays them back.
+//
+// A capture holds the packets in the order ProcessPacketQueue handled them, each tagged
+// with the frame (RenderScene call) it was handled on and the milliseconds since the
+// session started; a session starts at the first CreateSocket. Replay hands the packets
+// back to ProcessPacket on the same frame numbers, with no server behind the connection
+// and WorldTime advancing by a fixed tick, so the simulation side of a session can be
+// re-run and timed. rand() is reseeded with REPLAY_RANDOM_SEED when the session starts,
+// and VSync and the frame limiter are off, so runs are comparable. Handler exceptions are
+// counted rather than stopping the replay. When the last packet is handled the replay
+// writes frames/second, the time spent and the failures per head code to the error log
+// and closes the client.
+//
+// /r<file> on the command line records a capture, /x<file> replays one. The "Global Replay"
+// configuration builds MainReplay.exe against a stubbed OpenGL (Platform/HeadlessGL.cpp),
+// which only replays and runs without a GPU.
+class PacketCapture
+{
+public:
+    typedef void (*PacketHandler)(const BYTE* data, int32_t size);
+
+    static constexpr unsigned int REPLAY_RANDOM_SEED = 0x4D55;
+
+    static PacketCapture* Instance();
+
+    bool StartRecording(const wchar_t* fileName);
+    bool StartReplay(const wchar_t* fileName);
+
+    bool IsRecording() const;
+    bool IsReplaying() const;
+
+    // Called by CreateSocket; the first call starts the frame count.
+    void BeginSession();
+    // Called once at the end of RenderScene.
+    void EndFrame();
+
+    void Record(const BYTE* data, int32_t size);
+    // Hands every packet due on the current frame to 'handler'.
+    void ReplayPackets(PacketHandler handler);
+
+private:
+    PacketCapture();
+    ~PacketCapture();
+
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
@@ -0,0 +1,305 @@
+#include "stdafx.h"
+#include <cstring>
+#include <thread>
+#include "Profiler.h"
+
+class Profiler::Impl
+{
+public:
+    Impl() : m_mainThread(std::this_thread::get_id())
+    {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        m_ticksPerMillisecond = static_cast<double>(frequency.QuadPart) / 1000.0;
+
+        m_nodes.push_back(Node("Frame", -1, 0));
+        m_frameStart = Now();
+        m_windowStart = m_frameStart;
+    }
+
+    void BeginZone(const char* name)
+    {
+        if (std::this_thread::get_id() != m_mainThread)
+            return;
+
+        const int node = FindChild(m_current, name);
+        m_open.push_back({ node, Now() });
+        m_current = node;
+    }
+
+    void EndZone()
+    {
+        if (std::this_thread::get_id() != m_mainThread || m_open.empty())
+            return;
+
+        const OpenZone zone = m_open.back();
+        m_open.pop_back();
+
+        const LONGLONG ticks = Now() - zone.Begin;
+        Node& node = m_nodes[zone.Node];
+        node.FrameTicks += ticks;
+        node.FrameCalls += 1;
+        m_current = node.Parent;
+
+        if (m_captureFramesLeft > 0)
+            Record(node.Name, zone.Begin, ticks, node.Depth);
+    }
+
+    void EndFrame()
+    {
+        if (std::this_thread::get_id() != m_mainThread)
+            return;
+
+        const LONGLONG now = Now();
+        const LONGLONG frameTicks = now - m_frameStart;
+
+        if (m_captureFramesLeft > 0)
+        {
+            Record(m_nodes[0].Name, m_frameStart, frameTicks, 0);
+            if (--m_captureFramesLeft == 0)
+                WriteCapture();
+        }
+        m_frameStart = now;
+
+        for (Node& node : m_nodes)
+        {
+            node.WindowTicks += node.FrameTicks;
+            node.WindowCalls += node.FrameCalls;
+            node.FrameTicks = 0;
+            node.FrameCalls = 0;
+        }
+        m_windowFrameTicks += frameTicks;
+        ++m_windowFrames;
+
+        if ((now - m_windowStart) < static_cast<LONGLONG>(m_ticksPerMillisecond * WINDOW_MILLISECONDS))
+            return;
+
+        for (Node& node : m_nodes)
+        {
+            node.DisplayMilliseconds = node.WindowTicks / m_ticksPerMillisecond / m_windowFrames;
+            node.DisplayCalls = static_cast<double>(node.WindowCalls) / m_windowFrames;
+            node.WindowTicks = 0;
+            node.WindowCalls = 0;
+        }
+        m_displayFrameMilliseconds = m_windowFrameTicks / m_ticksPerMillisecond / m_windowFrames;
+        m_windowFrameTicks = 0;
+        m_windowFrames = 0;
+        m_windowStart = now;
+    }
+
+    void GetZoneStats(std::vector<ZONE_STAT>& out) const
+    {
+        out.clear();
+        AppendStats(m_nodes[0].FirstChild, out);
+    }
+
+    bool StartCapture(int frameCount)
+    {
+        if (m_captureFramesLeft > 0 || frameCount <= 0)
+            return false;
+
+        m_events.clear();
+        m_eventsDropped = 0;
+        m_captureStart = m_frameStart;
+        m_captureFramesLeft = frameCount;
+        return true;
+    }
+
+    bool IsCapturing() const { return m_captureFramesLeft > 0; }
+    double GetFrameMilliseconds() const { return m_displayFrameMilliseconds; }
+
+    bool m_overlayVisible = false;
+
+private:
+    enum
+    {
+        WINDOW_MILLISECONDS = 500,
+        MAX_CAPTURE_EVENTS = 1 << 20,
+    };
+
+    struct Node
+    {
+        Node(const char* name, int parent, int depth) : Name(name), Parent(parent), Depth(depth) {}
+
+        const char* Name;
+        int         Parent;
+        int         Depth;
+        int         FirstChild = -1;
+        int         NextSibling = -1;
+        LONGLONG    FrameTicks = 0;
+        int         FrameCalls = 0;
+        LONGLONG    WindowTicks = 0;
+        int         WindowCalls = 0;
+        double      DisplayMilliseconds = 0.0;
+        double      DisplayCalls = 0.0;
+    };
+
+    struct OpenZone
+    {
+        int      Node;
+        LONGLONG Begin;
+    };
+
+    struct TraceEvent
+    {
+        const char* Name;
+        LONGLONG    Begin;
+        LONGLONG    Ticks;
+        int         Depth;
+    };
+
+    static LONGLONG Now()
+    {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return counter.QuadPart;
+    }
+
+    int FindChild(int parent, const char* name)
+    {
+        int last = -1;
+        for (int child = m_nodes[parent].FirstChild; child >= 0; child = m_nodes[child].NextSibling)
+        {
+            if (m_nodes[child].Name == name || strcmp(m_nodes[child].Name, name) == 0)
+                return child;
+            last = child;
+        }
+
+        const int node = static_cast<int>(m_nodes.size());
+        m_nodes.push_back(Node(name, parent, m_nodes[parent].Depth + 1));
+        if (last >= 0)
+            m_nodes[last].NextSibling = node;
+        else
+            m_nodes[parent].FirstChild = node;
+        return node;
+    }
+
+    void AppendStats(int node, std::vector<ZONE_STAT>& out) const
+    {
+        for (; node >= 0; node = m_nodes[node].NextSibling)
+        {
+            const Node& n = m_nodes[node];
+            if (n.DisplayCalls <= 0.0)
+                continue;
+
+            out.push_back({ n.Name, n.Depth - 1, n.DisplayMilliseconds, n.DisplayCalls });
+            AppendStats(n.FirstChild, out);
+        }
+    }
+
+    void Record(const char* name, LONGLONG begin, LONGLONG ticks, int depth)
+    {
+        if (m_events.size() >= MAX_CAPTURE_EVENTS)
+        {
+            ++m_eventsDropped;
+            return;
+        }
+        m_events.push_back({ name, begin, ticks, depth });
+    }
+
+    void WriteCapture()
+    {
+        SYSTEMTIME st;
+        GetLocalTime(&st);
+        wchar_t fileName[64];
+        swprintf(fileName, L"Profile(%02d_%02d-%02d_%02d_%02d).json", st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond);
+
+        FILE* fp = _wfopen(fileName, L"wt");
+        if (fp == nullptr)
+        {
+            g_ConsoleDebug->Write(MCD_ERROR, L"Profiler: cannot create %ls", fileName);
+            m_events.clear();
+            return;
+        }
+
+        const double ticksPerMicrosecond = m_ticksPerMillisecond / 1000.0;
+        fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        for (size_t i = 0; i < m_events.size(); ++i)
+        {
+            const TraceEvent& e = m_events[i];
+            fprintf(fp, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}\n",
+                i == 0 ? "" : ",", e.Name, e.Depth == 0 ? "frame" : "zone",
+                (e.Begin - m_captureStart) / ticksPerMicrosecond, e.Ticks / ticksPerMicrosecond);
+        }
+        fprintf(fp, "]}\n");
+        fclose(fp);
+
+        g_ConsoleDebug->Write(MCD_NORMAL, L"Profiler: wrote %u events to %ls (%u dropped)",
+            static_cast<unsigned int>(m_events.size()), fileName, m_eventsDropped);
+
+        std::vector<TraceEvent>().swap(m_events);
+    }
+
+    std::thread::id          m_mainThread;
+    double                   m_ticksPerMillisecond = 1.0;
+
+    std::vector<Node>        m_nodes;
+    std::vector<OpenZone>    m_open;
+    int                      m_current = 0;
+
+    LONGLONG                 m_frameStart = 0;
+    LONGLONG                 m_windowStart = 0;
+    LONGLONG                 m_windowFrameTicks = 0;
+    int                      m_windowFrames = 0;
+    double                   m_displayFrameMilliseconds = 0.0;
+
+    std::vector<TraceEvent>  m_events;
+    unsigned int             m_eventsDropped = 0;
+    LONGLONG                 m_captureStart = 0;
+    int                      m_captureFramesLeft = 0;
+};
+
+Profiler* Profiler::Instance()
+{
+    static Profiler instance;
+    return &instance;
+}
+
+Profiler::Profiler() : pImpl(std::make_unique<Impl>()) {}
+
+Profiler::~Profiler() = default;
+
+void Profiler::BeginZone(const char* name)
+{
+    pImpl->BeginZone(name);
+}
+
+void Profiler::EndZone()
+{
+    pImpl->EndZone();
+}
+
+void Profiler::EndFrame()
+{
+    pImpl->EndFrame();
+}
+
+void Profiler::ToggleOverlay()
+{
+    pImpl->m_overlayVisible = !pImpl->m_overlayVisible;
+}
+
+bool Profiler::IsOverlayVisible() const
+{
+    return pImpl->m_overlayVisible;
+}
+
+void Profiler::GetZoneStats(std::vector<ZONE_STAT>& out) const
+{
+    pImpl->GetZoneStats(out);
+}
+
+double Profiler::GetFrameMilliseconds() const
+{
+    return pImpl->GetFrameMilliseconds();
+}
+
+bool Profiler::StartCapture(int frameCount)
+{
+    return pImpl->StartCapture(frameCount);
+}
+
+bool Profiler::IsCapturing() const
+{
+    return pImpl->IsCapturing();
+}
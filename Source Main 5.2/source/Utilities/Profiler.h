@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+// Hierarchical CPU profiler for the main thread.
+//
+// PROFILE_SCOPE("Name") opens a zone that closes at the end of the enclosing block.
+// Zones nest by call order, so the same name under two parents shows up twice. Times
+// are summed per frame (EndFrame is called once at the end of RenderScene), averaged
+// over half a second for the overlay, and while a capture is running every zone is
+// also recorded as a Chrome trace event (load the file in chrome://tracing or
+// Perfetto). Zones opened on other threads are ignored. Removing ENABLE_PROFILER
+// from Winmain.h compiles every PROFILE_SCOPE out.
+class Profiler {
+public:
+    struct ZONE_STAT
+    {
+        const char* Name;
+        int         Depth;        // 0 for top-level zones
+        double      Milliseconds; // average per frame
+        double      Calls;        // average per frame
+    };
+
+    static Profiler* Instance();
+
+    // 'name' must outlive the profiler (a string literal).
+    void BeginZone(const char* name);
+    void EndZone();
+    void EndFrame();
+
+    void ToggleOverlay();
+    bool IsOverlayVisible() const;
+
+    // Zones of the last averaging window in depth-first order.
+    void GetZoneStats(std::vector<ZONE_STAT>& out) const;
+    double GetFrameMilliseconds() const;
+
+    // Records the next 'frameCount' frames and writes them to a trace file in the
+    // working directory. Returns false if a capture is already running.
+    bool StartCapture(int frameCount);
+    bool IsCapturing() const;
+
+private:
+    Profiler();
+    ~Profiler();
+
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name) { Profiler::Instance()->BeginZone(name); }
+    ~ProfileScope() { Profiler::Instance()->EndZone(); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#ifdef ENABLE_PROFILER
+#define PROFILE_SCOPE_JOIN2(a, b) a##b
+#define PROFILE_SCOPE_JOIN(a, b) PROFILE_SCOPE_JOIN2(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_SCOPE_JOIN(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#endif
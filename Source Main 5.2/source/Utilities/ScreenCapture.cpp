@@ -0,0 +1,331 @@
+#include "stdafx.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "ScreenCapture.h"
+#include "ZzzOpenglUtil.h"
+#include "ZzzTexture.h"
+
+namespace
+{
+    enum
+    {
+        READBACK_SLOTS = 2,
+        MAX_QUEUED_FRAMES = 8,
+        JPEG_QUALITY = 100,
+    };
+
+    struct ENCODE_JOB
+    {
+        std::wstring      FileName;
+        int               Width;
+        int               Height;
+        std::vector<BYTE> Pixels;
+    };
+
+    template <typename T>
+    bool LoadProc(T& proc, const char* name)
+    {
+        proc = reinterpret_cast<T>(wglGetProcAddress(name));
+        return proc != nullptr;
+    }
+}
+
+class ScreenCapture::Impl
+{
+public:
+    ~Impl()
+    {
+        if (!m_encoder.joinable())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bQuit = true;
+        }
+        m_wake.notify_all();
+        m_encoder.join();
+    }
+
+    void RequestScreenshot(const wchar_t* fileName)
+    {
+        m_Requests.push_back(fileName);
+    }
+
+    bool StartSequence(int frameCount, int intervalMs)
+    {
+        if (m_SequenceLeft > 0 || frameCount <= 0)
+            return false;
+
+        SYSTEMTIME st;
+        GetLocalTime(&st);
+        wchar_t folder[64];
+        swprintf(folder, L"Capture(%02d_%02d-%02d_%02d_%02d)", st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond);
+        if (!CreateDirectoryW(folder, nullptr) && GetLastError() != ERROR_ALREADY_EXISTS)
+        {
+            g_ConsoleDebug->Write(MCD_ERROR, L"ScreenCapture: cannot create %ls", folder);
+            return false;
+        }
+
+        m_SequenceFolder = folder;
+        m_SequenceLeft = frameCount;
+        m_SequenceIndex = 0;
+        m_SequenceInterval = intervalMs > 0 ? intervalMs : 0;
+        m_NextSequenceTime = timeGetTime();
+        m_Dropped = 0;
+        return true;
+    }
+
+    void StopSequence()
+    {
+        if (m_SequenceLeft <= 0)
+            return;
+
+        m_SequenceLeft = 0;
+        ReportSequence();
+    }
+
+    void ReportSequence()
+    {
+        g_ConsoleDebug->Write(MCD_NORMAL, L"ScreenCapture: %d frames to %ls (%d dropped)",
+            m_SequenceIndex - m_Dropped, m_SequenceFolder.c_str(), m_Dropped);
+    }
+
+    void Capture()
+    {
+        // last frame's read has landed by now
+        for (int i = 0; i < READBACK_SLOTS; ++i)
+        {
+            const int slot = (m_NextSlot + i) % READBACK_SLOTS;
+            if (m_Slots[slot].Pending)
+                FinishReadback(m_Slots[slot]);
+        }
+
+        std::wstring fileName;
+        bool sequenceFrame = false;
+        if (!m_Requests.empty())
+        {
+            fileName = m_Requests.front();
+            m_Requests.pop_front();
+        }
+        else if (m_SequenceLeft > 0)
+        {
+            const DWORD now = timeGetTime();
+            if (static_cast<int>(now - m_NextSequenceTime) < 0)
+                return;
+
+            m_NextSequenceTime += m_SequenceInterval;
+            if (static_cast<int>(now - m_NextSequenceTime) >= 0)
+                m_NextSequenceTime = now + m_SequenceInterval;
+
+            wchar_t name[32];
+            swprintf(name, L"\\Frame-%05d.jpg", m_SequenceIndex++);
+            fileName = m_SequenceFolder + name;
+            sequenceFrame = true;
+        }
+        else
+        {
+            return;
+        }
+
+        if (sequenceFrame && QueuedFrames() >= MAX_QUEUED_FRAMES)
+        {
+            ++m_Dropped;
+        }
+        else
+        {
+            StartReadback(fileName);
+        }
+
+        if (sequenceFrame && --m_SequenceLeft == 0)
+            ReportSequence();
+    }
+
+    int m_SequenceLeft = 0;
+
+private:
+    struct READBACK_SLOT
+    {
+        GLuint       Buffer = 0;
+        size_t       Capacity = 0;
+        bool         Pending = false;
+        std::wstring FileName;
+        int          Width = 0;
+        int          Height = 0;
+    };
+
+    bool InitPixelBuffers()
+    {
+        if (m_bInitialized)
+            return m_bPixelBuffers;
+        m_bInitialized = true;
+
+        m_bPixelBuffers = LoadProc(m_glGenBuffers, "glGenBuffers")
+            && LoadProc(m_glBindBuffer, "glBindBuffer")
+            && LoadProc(m_glBufferData, "glBufferData")
+            && LoadProc(m_glMapBuffer, "glMapBuffer")
+            && LoadProc(m_glUnmapBuffer, "glUnmapBuffer");
+        if (!m_bPixelBuffers)
+        {
+            g_ErrorReport.Write(L"> Pixel buffers unavailable, screenshots read back synchronously.\r\n");
+            return false;
+        }
+
+        for (READBACK_SLOT& slot : m_Slots)
+            m_glGenBuffers(1, &slot.Buffer);
+        return true;
+    }
+
+    void StartReadback(const std::wstring& fileName)
+    {
+        const int width = static_cast<int>(WindowWidth);
+        const int height = static_cast<int>(WindowHeight);
+        const size_t size = static_cast<size_t>(width) * height * 3;
+        if (size == 0)
+            return;
+
+        GLint packAlignment = 4;
+        glGetIntegerv(GL_PACK_ALIGNMENT, &packAlignment);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+        if (InitPixelBuffers())
+        {
+            READBACK_SLOT& slot = m_Slots[m_NextSlot];
+            m_NextSlot = (m_NextSlot + 1) % READBACK_SLOTS;
+
+            m_glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer);
+            if (slot.Capacity != size)
+            {
+                m_glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+                slot.Capacity = size;
+            }
+            glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+            m_glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+            slot.Pending = true;
+            slot.FileName = fileName;
+            slot.Width = width;
+            slot.Height = height;
+        }
+        else
+        {
+            ENCODE_JOB job = { fileName, width, height, std::vector<BYTE>(size) };
+            glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, job.Pixels.data());
+            Submit(std::move(job));
+        }
+
+        glPixelStorei(GL_PACK_ALIGNMENT, packAlignment);
+    }
+
+    void FinishReadback(READBACK_SLOT& slot)
+    {
+        slot.Pending = false;
+
+        m_glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer);
+        const void* pixels = m_glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+        if (pixels != nullptr)
+        {
+            const BYTE* begin = static_cast<const BYTE*>(pixels);
+            ENCODE_JOB job = { slot.FileName, slot.Width, slot.Height, std::vector<BYTE>(begin, begin + slot.Capacity) };
+            m_glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            Submit(std::move(job));
+        }
+        m_glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    size_t QueuedFrames()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_Jobs.size();
+    }
+
+    void Submit(ENCODE_JOB&& job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_Jobs.push_back(std::move(job));
+        }
+        if (!m_encoder.joinable())
+            m_encoder = std::thread([this] { EncodeLoop(); });
+        m_wake.notify_one();
+    }
+
+    void EncodeLoop()
+    {
+        for (;;)
+        {
+            ENCODE_JOB job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this] { return m_bQuit || !m_Jobs.empty(); });
+                if (m_Jobs.empty())
+                    return;
+                job = std::move(m_Jobs.front());
+                m_Jobs.pop_front();
+            }
+
+            if (!WriteJpeg(&job.FileName[0], job.Width, job.Height, job.Pixels.data(), JPEG_QUALITY))
+                g_ErrorReport.Write(L"ScreenCapture: cannot write %ls\r\n", job.FileName.c_str());
+        }
+    }
+
+    std::deque<std::wstring> m_Requests;
+
+    std::wstring m_SequenceFolder;
+    int          m_SequenceIndex = 0;
+    int          m_SequenceInterval = 0;
+    DWORD        m_NextSequenceTime = 0;
+    int          m_Dropped = 0;
+
+    bool          m_bInitialized = false;
+    bool          m_bPixelBuffers = false;
+    READBACK_SLOT m_Slots[READBACK_SLOTS];
+    int           m_NextSlot = 0;
+
+    PFNGLGENBUFFERSPROC  m_glGenBuffers = nullptr;
+    PFNGLBINDBUFFERPROC  m_glBindBuffer = nullptr;
+    PFNGLBUFFERDATAPROC  m_glBufferData = nullptr;
+    PFNGLMAPBUFFERPROC   m_glMapBuffer = nullptr;
+    PFNGLUNMAPBUFFERPROC m_glUnmapBuffer = nullptr;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_wake;
+    std::deque<ENCODE_JOB>  m_Jobs;
+    bool                    m_bQuit = false;
+    std::thread             m_encoder;
+};
+
+ScreenCapture* ScreenCapture::Instance()
+{
+    static ScreenCapture instance;
+    return &instance;
+}
+
+ScreenCapture::ScreenCapture() : pImpl(std::make_unique<Impl>()) {}
+
+ScreenCapture::~ScreenCapture() = default;
+
+void ScreenCapture::RequestScreenshot(const wchar_t* fileName)
+{
+    pImpl->RequestScreenshot(fileName);
+}
+
+bool ScreenCapture::StartSequence(int frameCount, int intervalMs)
+{
+    return pImpl->StartSequence(frameCount, intervalMs);
+}
+
+void ScreenCapture::StopSequence()
+{
+    pImpl->StopSequence();
+}
+
+bool ScreenCapture::IsSequenceRunning() const
+{
+    return pImpl->m_SequenceLeft > 0;
+}
+
+void ScreenCapture::Capture()
+{
+    pImpl->Capture();
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <memory>
+
+// Screenshots and frame sequences that do not stall the render thread.
+//
+// Capture() runs once per frame right before SwapBuffers. A frame that is due is read
+// into one of two pixel pack buffers, so glReadPixels returns without waiting for the
+// GPU; the buffer is mapped on the next frame, once the copy has landed, and the pixels
+// go to a background thread that encodes the JPEG. Drivers without pixel buffer objects
+// read synchronously, but the encoding still happens off the render thread. When the
+// encoder falls more than a few frames behind, sequence frames are dropped rather than
+// queued without bound.
+//
+// A sequence writes 'frameCount' frames, one every 'intervalMs', to a Capture(...)
+// folder in the working directory.
+class ScreenCapture
+{
+public:
+    static ScreenCapture* Instance();
+
+    void RequestScreenshot(const wchar_t* fileName);
+
+    bool StartSequence(int frameCount, int intervalMs);
+    void StopSequence();
+    bool IsSequenceRunning() const;
+
+    // Called with the finished frame in the back buffer.
+    void Capture();
+
+private:
+    ScreenCapture();
+    ~ScreenCapture();
+
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
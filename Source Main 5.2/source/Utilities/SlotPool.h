@@ -0,0 +1,166 @@
+#pragma once
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Slot bookkeeping for the fixed global effect arrays (Particles, Effects, Joints, ...).
+//
+// The arrays stay plain globals that the rest of the code indexes and kills in place
+// (o->Live = false), so the pool never owns the Live flag. It keeps one bit per slot
+// for the slots handed out since the last Collect(): creation takes the lowest clear
+// bit instead of scanning the array from slot 0, and the per-frame loops walk the set
+// bits with First()/Next() instead of the whole array. Both happen in ascending slot
+// order, so reuse and update/draw order match the old full-array scans, and a slot
+// created mid-loop above the current one is still visited in the same pass. Slots
+// killed in place stay listed (and are skipped by their Live check) until the next
+// Collect() clears them.
+template <typename T, int Size>
+class SlotPool
+{
+public:
+    SlotPool(T* slots, const wchar_t* name) : m_Slots(slots), m_Name(name)
+    {
+        Reset();
+    }
+
+    // Rebuilds the listed bits from the Live flags.
+    void Reset()
+    {
+        memset(m_Listed, 0, sizeof(m_Listed));
+        m_iListedCount = 0;
+        for (int i = 0; i < Size; ++i)
+        {
+            if (m_Slots[i].Live)
+                List(i);
+        }
+        m_iFreeWord = 0;
+    }
+
+    // Returns the lowest slot index that is not Live, or -1 when every slot is in use.
+    // The caller sets Live; a slot left dead is simply reclaimed by the next Collect().
+    int Acquire()
+    {
+        for (int w = m_iFreeWord; w < WORD_COUNT; ++w)
+        {
+            DWORD dwFree = ~m_Listed[w] & WordMask(w);
+            while (dwFree != 0)
+            {
+                const int i = w * 32 + LowestBit(dwFree);
+                List(i);
+                if (!m_Slots[i].Live)
+                {
+                    m_iFreeWord = w;
+                    return i;
+                }
+                dwFree &= dwFree - 1;
+            }
+        }
+        m_iFreeWord = WORD_COUNT;
+
+        // Nothing left unlisted: reuse a slot that died since the last Collect().
+        // This keeps the old "first dead slot wins" behaviour when the pool is full.
+        for (int i = First(); i >= 0; i = Next(i))
+        {
+            if (!m_Slots[i].Live)
+                return i;
+        }
+
+        ++m_dwDropped;
+        return -1;
+    }
+
+    // Unlists slots that died since the last call so Acquire() can hand them out again.
+    void Collect()
+    {
+        for (int w = 0; w < WORD_COUNT; ++w)
+        {
+            DWORD dwListed = m_Listed[w];
+            while (dwListed != 0)
+            {
+                const int b = LowestBit(dwListed);
+                dwListed &= dwListed - 1;
+                if (!m_Slots[w * 32 + b].Live)
+                {
+                    m_Listed[w] &= ~(1u << b);
+                    --m_iListedCount;
+                    if (w < m_iFreeWord)
+                        m_iFreeWord = w;
+                }
+            }
+        }
+
+        if (m_iListedCount > m_iPeakCount)
+            m_iPeakCount = m_iListedCount;
+
+        if (m_dwDropped != m_dwReported)
+        {
+            g_ConsoleDebug->Write(MCD_ERROR, L"%ls pool saturated: %u creations dropped (capacity %d)", m_Name, m_dwDropped - m_dwReported, Size);
+            m_dwReported = m_dwDropped;
+        }
+    }
+
+    // Listed slots in ascending order: for (int i = First(); i >= 0; i = Next(i)).
+    int First() const { return Find(0); }
+    int Next(int i) const { return Find(i + 1); }
+
+    int GetLiveCount() const { return m_iListedCount; }
+
+    int GetCapacity() const { return Size; }
+    int GetPeakCount() const { return m_iPeakCount; }
+    DWORD GetDroppedCount() const { return m_dwDropped; }
+
+private:
+    static constexpr int WORD_COUNT = (Size + 31) / 32;
+
+    static int LowestBit(DWORD dwBits)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, dwBits);
+        return (int)index;
+#else
+        return __builtin_ctz(dwBits);
+#endif
+    }
+
+    // Bits of word w that map to real slots.
+    static DWORD WordMask(int w)
+    {
+        const int bits = Size - w * 32;
+        return bits >= 32 ? 0xFFFFFFFFu : (1u << bits) - 1;
+    }
+
+    void List(int i)
+    {
+        m_Listed[i >> 5] |= 1u << (i & 31);
+        ++m_iListedCount;
+    }
+
+    int Find(int i) const
+    {
+        if (i >= Size)
+            return -1;
+
+        int w = i >> 5;
+        DWORD dwBits = m_Listed[w] & (0xFFFFFFFFu << (i & 31));
+        while (dwBits == 0)
+        {
+            if (++w >= WORD_COUNT)
+                return -1;
+            dwBits = m_Listed[w];
+        }
+        return w * 32 + LowestBit(dwBits);
+    }
+
+    T* m_Slots;
+    const wchar_t* m_Name;
+
+    DWORD m_Listed[WORD_COUNT];
+    int m_iListedCount = 0;
+    int m_iFreeWord = 0;
+
+    int   m_iPeakCount = 0;
+    DWORD m_dwDropped = 0;
+    DWORD m_dwReported = 0;
+};
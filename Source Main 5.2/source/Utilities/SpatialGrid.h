@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+// Tile-bucketed index over one of the fixed global arrays (CharactersClient, Items).
+//
+// The 256x256 terrain is split into cells of CELL_TILES x CELL_TILES tiles and every
+// entry sits in the intrusive list of the cell under its world position, so Update and
+// Remove are O(1) and a radius query only visits the few cells it overlaps. Entries are
+// refreshed once per frame by the owner's move loop, so a query pads its square by one
+// tile to cover what moved since, and returns candidates: callers keep their own exact
+// distance and liveness tests. Main thread only.
+template <int Size>
+class SpatialGrid
+{
+public:
+    enum
+    {
+        CELL_TILES = 8,
+        CELLS_PER_ROW = 256 / CELL_TILES,
+        CELL_COUNT = CELLS_PER_ROW * CELLS_PER_ROW,
+    };
+
+    SpatialGrid()
+    {
+        Clear();
+    }
+
+    void Clear()
+    {
+        std::fill(m_Head, m_Head + CELL_COUNT, -1);
+        std::fill(m_Cell, m_Cell + Size, -1);
+    }
+
+    // Files entry 'index' under the cell containing the world position (x, y).
+    void Update(int index, float x, float y)
+    {
+        const int cell = CellIndex(TileCoord(x), TileCoord(y));
+        if (m_Cell[index] == cell)
+            return;
+
+        Remove(index);
+
+        m_Cell[index] = cell;
+        m_Prev[index] = -1;
+        m_Next[index] = m_Head[cell];
+        if (m_Head[cell] >= 0)
+            m_Prev[m_Head[cell]] = index;
+        m_Head[cell] = index;
+    }
+
+    void Remove(int index)
+    {
+        const int cell = m_Cell[index];
+        if (cell < 0)
+            return;
+
+        if (m_Prev[index] >= 0)
+            m_Next[m_Prev[index]] = m_Next[index];
+        else
+            m_Head[cell] = m_Next[index];
+        if (m_Next[index] >= 0)
+            m_Prev[m_Next[index]] = m_Prev[index];
+
+        m_Cell[index] = -1;
+    }
+
+    // Replaces 'out' with the entries filed within 'radius' world units of (x, y) on
+    // either axis, plus the one-tile margin, in ascending index order so callers that
+    // stop after N hits pick the same entries a full array scan would.
+    void Query(float x, float y, float radius, std::vector<int>& out) const
+    {
+        out.clear();
+
+        const float margin = radius + TERRAIN_SCALE;
+        const int minX = TileCoord(x - margin) / CELL_TILES;
+        const int maxX = TileCoord(x + margin) / CELL_TILES;
+        const int minY = TileCoord(y - margin) / CELL_TILES;
+        const int maxY = TileCoord(y + margin) / CELL_TILES;
+
+        for (int cy = minY; cy <= maxY; ++cy)
+        {
+            for (int cx = minX; cx <= maxX; ++cx)
+            {
+                for (int i = m_Head[cy * CELLS_PER_ROW + cx]; i >= 0; i = m_Next[i])
+                    out.push_back(i);
+            }
+        }
+
+        std::sort(out.begin(), out.end());
+    }
+
+private:
+    static int TileCoord(float position)
+    {
+        const int tile = static_cast<int>(position / TERRAIN_SCALE);
+        return tile < 0 ? 0 : (tile > 255 ? 255 : tile);
+    }
+
+    static int CellIndex(int tileX, int tileY)
+    {
+        return (tileY / CELL_TILES) * CELLS_PER_ROW + (tileX / CELL_TILES);
+    }
+
+    int m_Head[CELL_COUNT];
+    int m_Next[Size];
+    int m_Prev[Size];
+    int m_Cell[Size];
+};
@@ -71,6 +71,8 @@
 #include "Dotnet/Connection.h"
 
 #include "MUHelper/MuHelper.h"
+#include "./Utilities/Profiler.h"
+#include "./Utilities/PacketCapture.h"
 
 #define MAX_DEBUG_MAX 10
 
@@ -149,8 +151,8 @@ void AddDebugText(const unsigned char* Buffer, int Size)
     }
 }
 
-// Forward declaration
-static void HandleIncomingPacket(int32_t Handle, const BYTE* ReceiveBuffer, int32_t Size);
+// Filled by the receive thread of SocketClient, drained by the game loop.
+static PacketQueue g_PacketQueue;
 
 BOOL CreateSocket(wchar_t* IpAddr, unsigned short Port)
 {
@@ -159,7 +161,17 @@ BOOL CreateSocket(wchar_t* IpAddr, unsigned short Port)
 
     // todo: generally, it's a bad idea to assume a specific port number (range).
     const bool isEncrypted = Port > 0xADFF || Port < 0xAD00;
-    SocketClient = new Connection(IpAddr, Port, isEncrypted, &HandleIncomingPacket);
+
+    PacketCapture* pCapture = PacketCapture::Instance();
+    pCapture->BeginSession();
+    if (pCapture->IsReplaying())
+    {
+        // the server side comes from the capture file
+        SocketClient = new Connection();
+        return bResult;
+    }
+
+    SocketClient = new Connection(IpAddr, Port, isEncrypted, &g_PacketQueue);
     if (!SocketClient->IsConnected())
     {
         bResult = FALSE;
@@ -790,7 +802,7 @@ BOOL ReceiveJoinMapServer(std::span<const BYTE> ReceiveBuffer)
     matchEvent::CreateEventMatch(gMapManager.WorldActive);
 
     CreateCharacterPointer(c, MODEL_PLAYER, Data->PositionX, Data->PositionY, ((float)Data->Angle - 1.f) * 45.f);
-    c->Key = HeroKey;
+    SetCharacterKey(c, HeroKey);
 
     g_ConsoleDebug->Write(MCD_RECEIVE, L"0x03 [ReceiveJoinMapServer] Key: %d Map: %d X: %d Y:%d", c->Key, gMapManager.WorldActive, Data->PositionX, Data->PositionY);
     OBJECT* o = &c->Object;
@@ -937,7 +949,7 @@ void ReceiveRevival(const BYTE* ReceiveBuffer)
     BYTE byBackupEtcPart = c->EtcPart;
 
     CreateCharacterPointer(c, MODEL_PLAYER, Data->PositionX, Data->PositionY, ((float)Data->Angle - 1.f) * 45.f);
-    c->Key = HeroKey;
+    SetCharacterKey(c, HeroKey);
     c->GuildStatus = BackUpGuildStatus;
     c->GuildType = BackUpGuildType;
     c->GuildRelationShip = BackUpGuildRelationShip;
@@ -14222,25 +14234,40 @@ static void ProcessPacket(const BYTE* ReceiveBuffer, int32_t Size)
     //return ( TRUE);
 }
 
-void ProcessPacketCallback(const PacketInfo* Packet)
+void ProcessPacketQueue(int iMaxPackets)
 {
-    try
+    PROFILE_SCOPE("ProcessPackets");
+
+    PacketCapture* pCapture = PacketCapture::Instance();
+    if (pCapture->IsReplaying())
     {
-        ProcessPacket(Packet->ReceiveBuffer.get(), Packet->Size);
+        pCapture->ReplayPackets(ProcessPacket);
+        return;
     }
-    catch (const std::exception&)
+
+    int32_t Handle, Size;
+    const BYTE* ReceiveBuffer;
+
+    for (int iProcessed = 0; iMaxPackets <= 0 || iProcessed < iMaxPackets; ++iProcessed)
     {
-    }
-}
+        if (!g_PacketQueue.Front(Handle, ReceiveBuffer, Size))
+            break;
 
-static void HandleIncomingPacket(int32_t Handle, const BYTE* ReceiveBuffer, int32_t Size)
-{
-    auto Packet = std::make_unique<PacketInfo>();
-    Packet->ReceiveBuffer = std::make_unique<BYTE[]>(Size);
-    std::copy(ReceiveBuffer, ReceiveBuffer + Size, Packet->ReceiveBuffer.get());
-    Packet->Size = Size;
+        if (pCapture->IsRecording())
+        {
+            pCapture->Record(ReceiveBuffer, Size);
+        }
+
+        try
+        {
+            ProcessPacket(ReceiveBuffer, Size);
+        }
+        catch (const std::exception&)
+        {
+        }
 
-    PostMessage(g_hWnd, WM_RECEIVE_BUFFER, reinterpret_cast<WPARAM>(Packet.release()), 0);
+        g_PacketQueue.Pop();
+    }
 }
 
 bool CheckExceptionBuff(eBuffState buff, OBJECT* o, bool iserase)
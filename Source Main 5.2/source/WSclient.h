@@ -3551,12 +3551,8 @@ BOOL CreateSocket(wchar_t* IpAddr, unsigned short Port);
 void DeleteSocket();
 void ReceiveMovePosition(const BYTE* ReceiveBuffer);
 
-struct PacketInfo
-{
-    std::unique_ptr<BYTE[]> ReceiveBuffer;
-    int32_t Size;
-};
-void ProcessPacketCallback(const PacketInfo* Packet);
+// Processes packets received since the last call; iMaxPackets <= 0 drains the queue.
+void ProcessPacketQueue(int iMaxPackets);
 
 void InitGame();
 void InitGuildWar();
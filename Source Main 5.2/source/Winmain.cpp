@@ -16,6 +16,8 @@
 #include "ZzzOpenData.h"
 #include "ZzzScene.h"
 #include "ZzzBMD.h"
+#include "MeshBuffer.h"
+#include "ItemIconCache.h"
 #include "ZzzInfomation.h"
 #include "ZzzObject.h"
 #include "ZzzCharacter.h"
@@ -52,6 +54,7 @@
 
 
 #include "NewUISystem.h"
+#include "./Utilities/PacketCapture.h"
 
 CUIMercenaryInputBox* g_pMercenaryInputBox = nullptr;
 CUITextInputBox* g_pSingleTextInputBox = nullptr;
@@ -189,6 +192,7 @@ GLvoid KillGLWindow(GLvoid)
 {
     if (g_hRC)
     {
+        ReleaseItemIconCache();
         wglMakeCurrent(nullptr, nullptr);
         if (!wglDeleteContext(g_hRC))
         {
@@ -504,11 +508,6 @@ LONG FAR PASCAL WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
             break;
         }
         break;
-    case WM_RECEIVE_BUFFER: {
-        auto Packet = std::unique_ptr<PacketInfo>(reinterpret_cast<PacketInfo*>(wParam));
-        ProcessPacketCallback(Packet.release());
-        break;
-    }
     case WM_NPROTECT_EXIT_TWO:
         SocketClient->ToGameServer()->SendLogOutByCheatDetection(0);
         SetTimer(g_hWnd, WINDOWMINIMIZED_TIMER, 1 * 1000, nullptr);
@@ -812,6 +811,14 @@ void SetMaxMessagePerCycle(int messages)
     g_MaxMessagePerCycle = (messages > 0) ? max(messages, custom_min) : messages;
 }
 
+// unlimited as default, every received packet is processed before the next frame
+int g_MaxPacketsPerCycle = -1;
+
+void SetMaxPacketsPerCycle(int packets)
+{
+    g_MaxPacketsPerCycle = packets;
+}
+
 MSG MainLoop()
 {
     MSG msg;
@@ -840,6 +847,8 @@ MSG MainLoop()
             }
         }
 
+        ProcessPacketQueue(g_MaxPacketsPerCycle);
+
         if (CheckRenderNextFrame())
         {
             if (g_bUseWindowMode || g_bWndActive)
@@ -908,6 +917,25 @@ int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLin
         g_ServerPort = wPortNumber;
     }
 
+    std::wstring lpszCaptureFile;
+    if (Util_CheckOption(GetCommandLine(), L'x', lpszCaptureFile))
+    {
+        PacketCapture::Instance()->StartReplay(lpszCaptureFile.c_str());
+    }
+    else if (Util_CheckOption(GetCommandLine(), L'r', lpszCaptureFile))
+    {
+        PacketCapture::Instance()->StartRecording(lpszCaptureFile.c_str());
+    }
+
+#ifdef MU_HEADLESS_REPLAY
+    // there is nothing to draw to, so this build only runs a replay
+    if (!PacketCapture::Instance()->IsReplaying())
+    {
+        g_ErrorReport.Write(L"> The replay build needs a packet capture to replay (/x<file>).\r\n");
+        return FALSE;
+    }
+#endif
+
     g_ErrorReport.Write(L"> To read config.ini.\r\n");
 
     //#ifdef _DEBUG
@@ -995,6 +1023,14 @@ int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLin
             wcscpy(g_aszMLSelection, L"Eng");
         }
         g_strSelectedML = g_aszMLSelection;
+
+        DWORD dwReleaseTextureBuffers = 0;
+        dwSize = sizeof(DWORD);
+        if (RegQueryValueEx(hKey, L"ReleaseTextureBuffers", nullptr, nullptr, (LPBYTE)&dwReleaseTextureBuffers, &dwSize) != ERROR_SUCCESS)
+        {
+            dwReleaseTextureBuffers = 0;
+        }
+        Bitmaps.SetReleaseUploadedBuffers(dwReleaseTextureBuffers != 0);
     }
     RegCloseKey(hKey);
 #else
@@ -1004,6 +1040,12 @@ int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLin
     g_strSelectedML = g_aszMLSelection;
 #endif
 
+#ifdef MU_HEADLESS_REPLAY
+    // the window is never shown: no display mode change, no music
+    g_bUseWindowMode = TRUE;
+    m_MusicOnOff = 0;
+#endif
+
     switch (m_Resolution)
     {
     case 0:
@@ -1206,9 +1248,11 @@ int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLin
         return FALSE;
     }
 
+#ifndef MU_HEADLESS_REPLAY
     ShowWindow(g_hWnd, SW_SHOW);
     SetForegroundWindow(g_hWnd);
     SetFocus(g_hWnd);
+#endif
 
     g_ErrorReport.Write(L"> OpenGL init success.\r\n");
     g_ErrorReport.AddSeparator();
@@ -1216,19 +1260,30 @@ int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLin
     g_ErrorReport.AddSeparator();
     g_ErrorReport.WriteSoundCardInfo();
 
+#ifndef MU_HEADLESS_REPLAY
     ShowWindow(g_hWnd, nCmdShow);
     UpdateWindow(g_hWnd);
+#endif
 
     g_ErrorReport.WriteImeInfo( g_hWnd);
     g_ErrorReport.AddSeparator();
 
     InitVSync();
+    InitMeshBuffers();
+    InitItemIconCache();
     if (IsVSyncAvailable())
     {
         EnableVSync();
         SetTargetFps(-1); // unlimited
     }
 
+    if (PacketCapture::Instance()->IsReplaying())
+    {
+        // a replay runs as fast as the simulation allows
+        DisableVSync();
+        SetTargetFps(-1);
+    }
+
     FontHeight = static_cast<int>(std::ceil(12 + ((WindowHeight - 480) / 200.f)));
 
     int nFixFontHeight = WindowHeight <= 600 ? 14 : 15;
@@ -1276,7 +1331,10 @@ int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLin
     SetTimer(g_hWnd, HACK_TIMER, 20 * 1000, nullptr);
     SetTimer(g_hWnd, MUHELPER_TIMER, 250 /* ms */, MUHelper::CMuHelper::TimerProc);
 
-    srand((unsigned)time(nullptr));
+    if (PacketCapture::Instance()->IsReplaying())
+        srand(PacketCapture::REPLAY_RANDOM_SEED);
+    else
+        srand((unsigned)time(nullptr));
 
     for (int & i : RandomTable)
         i = rand() % 360;
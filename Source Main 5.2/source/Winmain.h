@@ -43,13 +43,14 @@
 
 #define ACTIVE_FOCUS_OUT
 
+#define ENABLE_PROFILER     // PROFILE_SCOPE zones, F11 overlay, Shift+F11 trace capture
+
 //#define DEVIAS_XMAS_EVENT  //more snow in devias
 //#define GUILD_WAR_EVENT
 #define DUEL_SYSTEM
 //#define CAMERA_TEST
 
 
-#define WM_RECEIVE_BUFFER	( WM_USER + 2)
 #define WM_NPROTECT_EXIT_TWO  (WM_USER + 10001)
 
 extern bool ashies;
@@ -75,9 +76,11 @@ extern int  m_Resolution;
 extern int m_nColorDepth;
 extern int m_RememberMe;
 extern int g_MaxMessagePerCycle;
+extern int g_MaxPacketsPerCycle;
 extern double CPU_AVG;
 
 extern void SetMaxMessagePerCycle(int messages);
+extern void SetMaxPacketsPerCycle(int packets);
 extern void CheckHack(void);
 extern DWORD GetCheckSum(WORD wKey);
 extern void StopMp3(char* Name, BOOL bEnforce = false);
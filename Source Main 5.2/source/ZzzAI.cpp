@@ -14,6 +14,7 @@
 #include "ZzzAI.h"
 
 #include <random>
+#include <thread>
 
 #include "ZzzTexture.h"
 #include "ZzzOpenglUtil.h"
@@ -24,6 +25,7 @@
 #include "ZzzPath.h"
 #include "CharacterManager.h"
 #include "SkillManager.h"
+#include "./Utilities/PacketCapture.h"
 
 float CreateAngle2D(const vec3_t from, const vec2_t to)
 {
@@ -547,6 +549,8 @@ void Damage(vec3_t soPosition, CHARACTER* tc, float AttackRange, int AttackPoint
 PATH _path;
 PATH* path = &_path;
 
+static std::thread::id s_PathThreadId;
+
 bool MovePath(CHARACTER* c, bool Turn)
 {
     bool Success = false;
@@ -640,6 +644,25 @@ bool MovePath(CHARACTER* c, bool Turn)
 void InitPath()
 {
     path->SetMapDimensions(256, 256, TerrainWall);
+    s_PathThreadId = std::this_thread::get_id();
+}
+
+// The search buffers are reused between calls, so threads other than the one that
+// called InitPath (e.g. the MU helper) get their own copy instead of sharing 'path'.
+static PATH* GetPathScratch()
+{
+    if (std::this_thread::get_id() == s_PathThreadId)
+    {
+        return path;
+    }
+
+    thread_local std::unique_ptr<PATH> pThreadPath;
+    if (!pThreadPath)
+    {
+        pThreadPath = std::make_unique<PATH>();
+        pThreadPath->SetMapDimensions(256, 256, TerrainWall);
+    }
+    return pThreadPath.get();
 }
 
 bool PathFinding2(int sx, int sy, int tx, int ty, PATH_t* a, float fDistance, int iDefaultWall)
@@ -659,7 +682,9 @@ bool PathFinding2(int sx, int sy, int tx, int ty, PATH_t* a, float fDistance, in
 
     int Wall = iDefaultWall;
 
-    bool PathFound = path->FindPath(sx, sy, tx, ty, true, Wall, Value, fDistance);
+    PATH* pPath = GetPathScratch();
+
+    bool PathFound = pPath->FindPath(sx, sy, tx, ty, true, Wall, Value, fDistance);
     if (!PathFound)
     {
         if (((TerrainWall[TERRAIN_INDEX_REPEAT(sx, sy)] & TW_SAFEZONE) == TW_SAFEZONE || (TerrainWall[TERRAIN_INDEX_REPEAT(tx, ty)] & TW_SAFEZONE) == TW_SAFEZONE) && (TerrainWall[TERRAIN_INDEX_REPEAT(tx, ty)] & TW_CHARACTER) != TW_CHARACTER)
@@ -667,17 +692,17 @@ bool PathFinding2(int sx, int sy, int tx, int ty, PATH_t* a, float fDistance, in
             Wall = TW_NOMOVE;
         }
 
-        PathFound = path->FindPath(sx, sy, tx, ty, false, Wall, Value, fDistance);
+        PathFound = pPath->FindPath(sx, sy, tx, ty, false, Wall, Value, fDistance);
     }
 
     if (PathFound)
     {
-        int PathNum = path->GetPath();
+        int PathNum = pPath->GetPath();
         if (PathNum > 1)
         {
             a->PathNum = PathNum;
-            unsigned char* x = path->GetPathX();
-            unsigned char* y = path->GetPathY();
+            unsigned char* x = pPath->GetPathX();
+            unsigned char* y = pPath->GetPathY();
 
             for (int i = 0; i < a->PathNum; i++)
             {
@@ -740,7 +765,15 @@ void CalcFPS()
     }
 
     frame++;
-    WorldTime = g_WorldTime->GetTimeElapsed();
+    if (PacketCapture::Instance()->IsReplaying())
+    {
+        // fixed tick, so a replay simulates the same frames on any machine
+        WorldTime = last + 1000.0 / REFERENCE_FPS;
+    }
+    else
+    {
+        WorldTime = g_WorldTime->GetTimeElapsed();
+    }
 
     const double differenceMs = WorldTime - last;
     if (differenceMs <= 0)
@@ -17,22 +17,56 @@
 #include "CameraMove.h"
 #include "PhysicsManager.h"
 #include "NewUISystem.h"
+#include "MeshBuffer.h"
+#include "RenderQueue.h"
+#include "SkinningKernel.h"
 
 BMD* Models;
 BMD* ModelsDump;
 
-vec4_t BoneQuaternion[MAX_BONES];
 short  BoundingVertices[MAX_BONES];
 vec3_t BoundingMin[MAX_BONES];
 vec3_t BoundingMax[MAX_BONES];
 
 float  BoneTransform[MAX_BONES][3][4];
 
-vec3_t VertexTransform[MAX_MESH][MAX_VERTICES];
-vec3_t NormalTransform[MAX_MESH][MAX_VERTICES];
-float  IntensityTransform[MAX_MESH][MAX_VERTICES];
+static vec3_t ScratchVertexTransform[MAX_MESH][MAX_VERTICES];
+static vec3_t ScratchNormalTransform[MAX_MESH][MAX_VERTICES];
+static float  ScratchIntensityTransform[MAX_MESH][MAX_VERTICES];
+
+vec3_t* VertexTransform[MAX_MESH];
+vec3_t* NormalTransform[MAX_MESH];
+float* IntensityTransform[MAX_MESH];
 vec3_t LightTransform[MAX_MESH][MAX_VERTICES];
 
+// The prepared output the arrays point at, if any.
+static CSkinnedModel* s_pBoundSkin = nullptr;
+
+void BindScratchTransform()
+{
+    s_pBoundSkin = nullptr;
+    for (int i = 0; i < MAX_MESH; i++)
+    {
+        VertexTransform[i] = ScratchVertexTransform[i];
+        NormalTransform[i] = ScratchNormalTransform[i];
+        IntensityTransform[i] = ScratchIntensityTransform[i];
+    }
+}
+
+void MarkTransformPatched()
+{
+    if (s_pBoundSkin != nullptr)
+    {
+        s_pBoundSkin->Patched = true;
+        s_pBoundSkin = nullptr;
+    }
+}
+
+static struct ScratchTransformBinder
+{
+    ScratchTransformBinder() { BindScratchTransform(); }
+} s_ScratchTransformBinder;
+
 vec3_t RenderArrayVertices[MAX_VERTICES * 3];
 vec4_t RenderArrayColors[MAX_VERTICES * 3];
 vec2_t RenderArrayTexCoords[MAX_VERTICES * 3];
@@ -43,30 +77,83 @@ float ParentMatrix[3][4];
 static vec3_t LightVector = { 0.f, -0.1f, -0.8f };
 static vec3_t LightVector2 = { 0.f, -0.5f, -0.8f };
 
-void BMD::Animation(float(*BoneMatrix)[3][4], float AnimationFrame, float PriorFrame, unsigned short PriorAction, vec3_t Angle, vec3_t HeadAngle, bool Parent, bool Translate)
+void BMD::MakeAnimationKey(BoneAnimation_t& Key, unsigned short Action, float Height, float Scale, const vec3_t Origin,
+    float AnimationFrame, float PriorFrame, unsigned short PriorAction, const vec3_t Angle, const vec3_t HeadAngle, bool Translate) const
 {
-    if (NumActions <= 0) return;
+    memset(&Key, 0, sizeof(Key)); // keys are compared with memcmp
+    Key.Model = this;
+    Key.CurrentAction = Action;
+    Key.PriorAction = PriorAction;
+    Key.AnimationFrame = AnimationFrame;
+    Key.PriorAnimationFrame = PriorFrame;
+    Key.BodyHeight = Height;
+    Key.BodyScale = Scale;
+    VectorCopy(Origin, Key.BodyOrigin);
+    VectorCopy(Angle, Key.Angle);
+    VectorCopy(HeadAngle, Key.HeadAngle);
+    Key.Translate = Translate;
+}
 
-    if (PriorAction >= NumActions) PriorAction = 0;
-    if (CurrentAction >= NumActions)CurrentAction = 0;
-    VectorCopy(Angle, BodyAngle);
+void BMD::ClampAnimationKey(const BoneAnimation_t& Key, unsigned short& Action, unsigned short& PriorAction, int& Frame, int& PriorFrame) const
+{
+    Action = Key.CurrentAction < NumActions ? Key.CurrentAction : 0;
+    PriorAction = Key.PriorAction < NumActions ? Key.PriorAction : 0;
+
+    Frame = (int)Key.AnimationFrame;
+    PriorFrame = (int)Key.PriorAnimationFrame;
+    if (PriorFrame < 0)
+        PriorFrame = 0;
+    if (Frame < 0)
+        Frame = 0;
+    if (PriorFrame >= Actions[PriorAction].NumAnimationKeys)
+        PriorFrame = 0;
+    if (Frame >= Actions[Action].NumAnimationKeys)
+        Frame = 0;
+}
 
-    CurrentAnimation = AnimationFrame;
-    CurrentAnimationFrame = (int)AnimationFrame;
-    float s1 = (CurrentAnimation - CurrentAnimationFrame);
-    float s2 = 1.f - s1;
-    auto PriorAnimationFrame = (int)PriorFrame;
-    if (NumActions > 0)
+void BMD::BodyMatrix(const BoneAnimation_t& Key, float(*Matrix)[4]) const
+{
+    AngleMatrix(Key.Angle, Matrix);
+    if (Key.Translate)
     {
-        if (PriorAnimationFrame < 0)
-            PriorAnimationFrame = 0;
-        if (CurrentAnimationFrame < 0)
-            CurrentAnimationFrame = 0;
-        if (PriorAnimationFrame >= Actions[PriorAction].NumAnimationKeys)
-            PriorAnimationFrame = 0;
-        if (CurrentAnimationFrame >= Actions[CurrentAction].NumAnimationKeys)
-            CurrentAnimationFrame = 0;
+        for (int y = 0; y < 3; ++y)
+        {
+            for (int x = 0; x < 3; ++x)
+            {
+                Matrix[y][x] *= Key.BodyScale;
+            }
+        }
+
+        Matrix[0][3] = Key.BodyOrigin[0];
+        Matrix[1][3] = Key.BodyOrigin[1];
+        Matrix[2][3] = Key.BodyOrigin[2];
+    }
+}
+
+void BMD::SetAnimationState(const BoneAnimation_t& Key, bool Parent)
+{
+    unsigned short PriorAction;
+    int Frame, PriorFrame;
+    ClampAnimationKey(Key, CurrentAction, PriorAction, Frame, PriorFrame);
+
+    VectorCopy(Key.Angle, BodyAngle);
+    CurrentAnimation = Key.AnimationFrame;
+    CurrentAnimationFrame = (short)Frame;
+
+    if (!Parent)
+    {
+        BodyMatrix(Key, ParentMatrix);
     }
+}
+
+void BMD::AnimateBones(const BoneAnimation_t& Key, float(*BoneMatrix)[3][4], const float(*RootMatrix)[4]) const
+{
+    unsigned short CurrentAction, PriorAction;
+    int CurrentAnimationFrame, PriorAnimationFrame;
+    ClampAnimationKey(Key, CurrentAction, PriorAction, CurrentAnimationFrame, PriorAnimationFrame);
+
+    float s1 = Key.AnimationFrame - (int)Key.AnimationFrame;
+    float s2 = 1.f - s1;
 
     // bones
     for (int i = 0; i < NumBones; i++)
@@ -78,7 +165,7 @@ void BMD::Animation(float(*BoneMatrix)[3][4], float AnimationFrame, float PriorF
         }
         BoneMatrix_t* bm1 = &b->BoneMatrixes[PriorAction];
         BoneMatrix_t* bm2 = &b->BoneMatrixes[CurrentAction];
-        vec4_t q1, q2;
+        vec4_t q1, q2, q;
 
         if (i == BoneHead)
         {
@@ -86,8 +173,8 @@ void BMD::Animation(float(*BoneMatrix)[3][4], float AnimationFrame, float PriorF
             VectorCopy(bm1->Rotation[PriorAnimationFrame], Angle1);
             VectorCopy(bm2->Rotation[CurrentAnimationFrame], Angle2);
 
-            float HeadAngleX = HeadAngle[0] / (180.f / Q_PI);
-            float HeadAngleY = HeadAngle[1] / (180.f / Q_PI);
+            float HeadAngleX = Key.HeadAngle[0] / (180.f / Q_PI);
+            float HeadAngleY = Key.HeadAngle[1] / (180.f / Q_PI);
             Angle1[0] -= HeadAngleX;
             Angle2[0] -= HeadAngleX;
             Angle1[2] -= HeadAngleY;
@@ -102,15 +189,15 @@ void BMD::Animation(float(*BoneMatrix)[3][4], float AnimationFrame, float PriorF
         }
         if (!QuaternionCompare(q1, q2))
         {
-            QuaternionSlerp(q1, q2, s1, BoneQuaternion[i]);
+            QuaternionSlerp(q1, q2, s1, q);
         }
         else
         {
-            QuaternionCopy(q1, BoneQuaternion[i]);
+            QuaternionCopy(q1, q);
         }
 
         float Matrix[3][4];
-        QuaternionMatrix(BoneQuaternion[i], Matrix);
+        QuaternionMatrix(q, Matrix);
         float* Position1 = bm1->Position[PriorAnimationFrame];
         float* Position2 = bm2->Position[CurrentAnimationFrame];
 
@@ -118,7 +205,7 @@ void BMD::Animation(float(*BoneMatrix)[3][4], float AnimationFrame, float PriorF
         {
             Matrix[0][3] = bm2->Position[0][0];
             Matrix[1][3] = bm2->Position[0][1];
-            Matrix[2][3] = Position1[2] * s2 + Position2[2] * s1 + BodyHeight;
+            Matrix[2][3] = Position1[2] * s2 + Position2[2] * s1 + Key.BodyHeight;
         }
         else
         {
@@ -129,25 +216,7 @@ void BMD::Animation(float(*BoneMatrix)[3][4], float AnimationFrame, float PriorF
 
         if (b->Parent == -1)
         {
-            if (!Parent)
-            {
-                AngleMatrix(BodyAngle, ParentMatrix);
-                if (Translate)
-                {
-                    for (auto & y : ParentMatrix)
-                    {
-                        for (int x = 0; x < 3; ++x)
-                        {
-                            y[x] *= BodyScale;
-                        }
-                    }
-
-                    ParentMatrix[0][3] = BodyOrigin[0];
-                    ParentMatrix[1][3] = BodyOrigin[1];
-                    ParentMatrix[2][3] = BodyOrigin[2];
-                }
-            }
-            R_ConcatTransforms(ParentMatrix, Matrix, BoneMatrix[i]);
+            R_ConcatTransforms(RootMatrix, Matrix, BoneMatrix[i]);
         }
         else
         {
@@ -156,19 +225,43 @@ void BMD::Animation(float(*BoneMatrix)[3][4], float AnimationFrame, float PriorF
     }
 }
 
+void BMD::Animation(float(*BoneMatrix)[3][4], float AnimationFrame, float PriorFrame, unsigned short PriorAction, vec3_t Angle, vec3_t HeadAngle, bool Parent, bool Translate)
+{
+    if (NumActions <= 0) return;
+
+    BoneAnimation_t Key;
+    MakeAnimationKey(Key, CurrentAction, BodyHeight, BodyScale, BodyOrigin, AnimationFrame, PriorFrame, PriorAction, Angle, HeadAngle, Translate);
+    SetAnimationState(Key, Parent);
+    AnimateBones(Key, BoneMatrix, ParentMatrix);
+}
+
 extern EGameScene SceneFlag;
 extern int EditFlag;
 
 bool HighLight = true;
 float BoneScale = 1.f;
 
-void BMD::Transform(float(*BoneMatrix)[3][4], vec3_t BoundingBoxMin, vec3_t BoundingBoxMax, OBB_t* OBB, bool Translate, float _Scale)
+void BMD::MakeSkinningKey(SkinningKey_t& Key, float Scale, const vec3_t Origin, bool Light, float fBoneScale, bool Translate, float _Scale) const
 {
-    vec3_t LightPosition;
+    memset(&Key, 0, sizeof(Key)); // keys are compared with memcmp
+    Key.Model = this;
+    Key.BodyScale = Scale;
+    VectorCopy(Origin, Key.BodyOrigin);
+    Key.BoneScale = fBoneScale;
+    Key.Scale = _Scale;
+    Key.Translate = Translate;
+#ifdef _DEBUG
+    Key.CalcBounds = true;
+#else
+    Key.CalcBounds = EditFlag == 2;
+#endif
 
-    if (LightEnable)
+    Key.LightEnable = Light;
+    if (Light)
     {
         vec3_t Position;
+        vec3_t Angle;
+        VectorCopy(ShadowAngle, Angle);
 
         float Matrix[3][4];
         if (HighLight)
@@ -178,35 +271,75 @@ void BMD::Transform(float(*BoneMatrix)[3][4], vec3_t BoundingBoxMin, vec3_t Boun
         else if (gMapManager.InBattleCastle())
         {
             Vector(0.5f, -1.f, 1.f, Position);
-            Vector(0.f, 0.f, -45.f, ShadowAngle);
+            Vector(0.f, 0.f, -45.f, Angle);
         }
         else
         {
             Vector(0.f, -1.5f, 0.f, Position);
         }
 
-        AngleMatrix(ShadowAngle, Matrix);
-        VectorIRotate(Position, Matrix, LightPosition);
+        AngleMatrix(Angle, Matrix);
+        VectorIRotate(Position, Matrix, Key.LightPosition);
     }
-    vec3_t BoundingMin;
-    vec3_t BoundingMax;
-#ifdef _DEBUG
-#else
-    if (EditFlag == 2)
-#endif
+}
+
+void BMD::TransformVertices(const SkinningKey_t& Key, float(*BoneMatrix)[3][4], vec3_t** Vertices, vec3_t** Normals, float** Intensities, vec3_t BoundingMin, vec3_t BoundingMax) const
+{
+    if (Key.CalcBounds)
     {
         Vector(999999.f, 999999.f, 999999.f, BoundingMin);
         Vector(-999999.f, -999999.f, -999999.f, BoundingMax);
     }
+
+    const bool Translate = Key.Translate;
+    const float _Scale = Key.Scale;
+    const float* LightPosition = Key.LightEnable ? Key.LightPosition : nullptr;
+
+    // Fold the vertex scale, BodyScale and BodyOrigin into one matrix per bone
+    // so the batched kernel does a single 3x4 transform per vertex.
+    float SkinningMatrix[MAX_BONES][3][4];
+    const float translationScale = Translate ? Key.BodyScale : 1.f;
+    const float rotationScale = (Key.BoneScale == 1.f ? (_Scale ? _Scale : 1.f) : Key.BoneScale) * translationScale;
+    for (int b = 0; b < NumBones; b++)
+    {
+        for (int r = 0; r < 3; r++)
+        {
+            SkinningMatrix[b][r][0] = BoneMatrix[b][r][0] * rotationScale;
+            SkinningMatrix[b][r][1] = BoneMatrix[b][r][1] * rotationScale;
+            SkinningMatrix[b][r][2] = BoneMatrix[b][r][2] * rotationScale;
+            SkinningMatrix[b][r][3] = BoneMatrix[b][r][3] * translationScale + (Translate ? Key.BodyOrigin[r] : 0.f);
+        }
+    }
+
     for (int i = 0; i < NumMeshs; i++)
     {
         Mesh_t* m = &Meshs[i];
+        if (m->m_pSkinning != nullptr)
+        {
+            SkinVertices(m->m_pSkinning->Vertices, SkinningMatrix, Vertices[i]);
+            SkinNormals(m->m_pSkinning->Normals, BoneMatrix, Normals[i], Intensities[i], LightPosition);
+
+            if (Key.CalcBounds)
+            {
+                for (int j = 0; j < m->NumVertices; j++)
+                {
+                    for (int k = 0; k < 3; k++)
+                    {
+                        const float value = Vertices[i][j][k] - (Translate ? Key.BodyOrigin[k] : 0.f);
+                        if (value < BoundingMin[k]) BoundingMin[k] = value;
+                        if (value > BoundingMax[k]) BoundingMax[k] = value;
+                    }
+                }
+            }
+            continue;
+        }
+
         for (int j = 0; j < m->NumVertices; j++)
         {
             Vertex_t* v = &m->Vertices[j];
-            float* vp = VertexTransform[i][j];
+            float* vp = Vertices[i][j];
 
-            if (BoneScale == 1.f)
+            if (Key.BoneScale == 1.f)
             {
                 if (_Scale)
                 {
@@ -218,21 +351,18 @@ void BMD::Transform(float(*BoneMatrix)[3][4], vec3_t BoundingBoxMin, vec3_t Boun
                 else
                     VectorTransform(v->Position, BoneMatrix[v->Node], vp);
                 if (Translate)
-                    VectorScale(vp, BodyScale, vp);
+                    VectorScale(vp, Key.BodyScale, vp);
             }
             else
             {
                 VectorRotate(v->Position, BoneMatrix[v->Node], vp);
-                vp[0] = vp[0] * BoneScale + BoneMatrix[v->Node][0][3];
-                vp[1] = vp[1] * BoneScale + BoneMatrix[v->Node][1][3];
-                vp[2] = vp[2] * BoneScale + BoneMatrix[v->Node][2][3];
+                vp[0] = vp[0] * Key.BoneScale + BoneMatrix[v->Node][0][3];
+                vp[1] = vp[1] * Key.BoneScale + BoneMatrix[v->Node][1][3];
+                vp[2] = vp[2] * Key.BoneScale + BoneMatrix[v->Node][2][3];
                 if (Translate)
-                    VectorScale(vp, BodyScale, vp);
+                    VectorScale(vp, Key.BodyScale, vp);
             }
-#ifdef _DEBUG
-#else
-            if (EditFlag == 2)
-#endif
+            if (Key.CalcBounds)
             {
                 for (int k = 0; k < 3; k++)
                 {
@@ -241,24 +371,64 @@ void BMD::Transform(float(*BoneMatrix)[3][4], vec3_t BoundingBoxMin, vec3_t Boun
                 }
             }
             if (Translate)
-                VectorAdd(vp, BodyOrigin, vp);
+                VectorAdd(vp, Key.BodyOrigin, vp);
         }
 
         for (int j = 0; j < m->NumNormals; j++)
         {
             Normal_t* sn = &m->Normals[j];
-            float* tn = NormalTransform[i][j];
+            float* tn = Normals[i][j];
             VectorRotate(sn->Normal, BoneMatrix[sn->Node], tn);
-            if (LightEnable)
+            if (LightPosition != nullptr)
             {
                 float Luminosity;
                 Luminosity = DotProduct(tn, LightPosition) * 0.8f + 0.4f;
 
                 if (Luminosity < 0.2f) Luminosity = 0.2f;
-                IntensityTransform[i][j] = Luminosity;
+                Intensities[i][j] = Luminosity;
             }
         }
     }
+}
+
+void BMD::Transform(float(*BoneMatrix)[3][4], vec3_t BoundingBoxMin, vec3_t BoundingBoxMax, OBB_t* OBB, bool Translate, float _Scale, CSkinnedModel* Prepared)
+{
+    if (LightEnable && !HighLight && gMapManager.InBattleCastle())
+    {
+        Vector(0.f, 0.f, -45.f, ShadowAngle);
+    }
+
+    SkinningKey_t Key;
+    MakeSkinningKey(Key, BodyScale, BodyOrigin, LightEnable, BoneScale, Translate, _Scale);
+
+    vec3_t BoundingMin;
+    vec3_t BoundingMax;
+    if (Prepared != nullptr && !Prepared->Patched
+        && memcmp(&Prepared->Key, &Key, sizeof(Key)) == 0
+        && memcmp(Prepared->Palette, BoneMatrix, sizeof(float) * 12 * NumBones) == 0)
+    {
+        s_pBoundSkin = Prepared;
+        for (int i = 0; i < NumMeshs; i++)
+        {
+            VertexTransform[i] = Prepared->Vertices[i];
+            NormalTransform[i] = Prepared->Normals[i];
+            IntensityTransform[i] = Prepared->Intensities[i];
+        }
+        VectorCopy(Prepared->BoundingMin, BoundingMin);
+        VectorCopy(Prepared->BoundingMax, BoundingMax);
+    }
+    else
+    {
+        s_pBoundSkin = nullptr;
+        for (int i = 0; i < NumMeshs; i++)
+        {
+            VertexTransform[i] = ScratchVertexTransform[i];
+            NormalTransform[i] = ScratchNormalTransform[i];
+            IntensityTransform[i] = ScratchIntensityTransform[i];
+        }
+        TransformVertices(Key, BoneMatrix, VertexTransform, NormalTransform, IntensityTransform, BoundingMin, BoundingMax);
+    }
+
     if (EditFlag == 2)
     {
         VectorCopy(BoundingMin, OBB->StartPos);
@@ -282,6 +452,33 @@ void BMD::Transform(float(*BoneMatrix)[3][4], vec3_t BoundingBoxMin, vec3_t Boun
     OBB->YAxis[2] = 0.f;
     OBB->ZAxis[0] = 0.f;
     OBB->ZAxis[1] = 0.f;
+
+    SetSkinningPalette(this, BoneMatrix, Translate, _Scale, Key.LightEnable ? Key.LightPosition : nullptr);
+}
+
+void CSkinnedModel::Allocate(const BMD* b)
+{
+    size_t size = 0;
+    for (int i = 0; i < b->NumMeshs; i++)
+    {
+        size += b->Meshs[i].NumVertices * 3 + b->Meshs[i].NumNormals * 4;
+    }
+    if (m_Storage.size() < size)
+    {
+        m_Storage.resize(size);
+    }
+
+    float* p = m_Storage.data();
+    for (int i = 0; i < b->NumMeshs; i++)
+    {
+        Vertices[i] = reinterpret_cast<vec3_t*>(p);
+        p += b->Meshs[i].NumVertices * 3;
+        Normals[i] = reinterpret_cast<vec3_t*>(p);
+        p += b->Meshs[i].NumNormals * 3;
+        Intensities[i] = p;
+        p += b->Meshs[i].NumNormals;
+    }
+    Patched = false;
 }
 
 void BMD::TransformByObjectBone(vec3_t vResultPosition, OBJECT* pObject, int iBoneNumber, vec3_t vRelativePosition)
@@ -934,6 +1131,7 @@ void BMD::EndRenderCoinHeap(int coinCount)
 
     constexpr int meshIndex = 0;
     Mesh_t* m = &Meshs[meshIndex];
+    ++g_RenderCounters.DrawCalls;
     glDrawArrays(GL_TRIANGLES, 0, m->NumTriangles * 3 * coinCount);
 
     glDisableClientState(GL_TEXTURE_COORD_ARRAY);
@@ -1007,6 +1205,10 @@ void BMD::RenderMesh(int meshIndex, int renderFlags, float alpha, int blendMeshI
         }
     }
 
+    // while the render queue records, the state below is collected instead of applied so
+    // that a deferred draw does not touch GL here
+    CRenderStateCapture stateCapture(IsRenderQueueRecording());
+
     int finalRenderFlags = renderFlags;
     if ((renderFlags & RENDER_COLOR) == RENDER_COLOR)
     {
@@ -1275,6 +1477,28 @@ void BMD::RenderMesh(int meshIndex, int renderFlags, float alpha, int blendMeshI
         || finalRenderFlags == RENDER_CHROME4
         || finalRenderFlags == RENDER_OIL;
 
+    RENDER_STATE meshState;
+    if (stateCapture.End(meshState))
+    {
+        if (enableColor && QueueMeshBuffer(this, meshIndex, meshState, renderFlags, finalRenderFlags, enableLight, EnableWave,
+            alpha, blendMeshTextureCoordU, blendMeshTextureCoordV))
+        {
+            return;
+        }
+
+        // drawn right away: whatever is still queued belongs in front of or behind it,
+        // and its alpha-tested edges blend onto what is already there
+        if (meshState.DepthTest && meshState.DepthMask)
+            RenderQueueBarrier();
+        SetRenderState(meshState);
+    }
+
+    if (RenderMeshBuffer(this, meshIndex, renderFlags, finalRenderFlags, enableLight, enableColor, EnableWave,
+        alpha, blendMeshTextureCoordU, blendMeshTextureCoordV))
+    {
+        return;
+    }
+
     glEnableClientState(GL_VERTEX_ARRAY);
     if (enableColor) glEnableClientState(GL_COLOR_ARRAY);
     glEnableClientState(GL_TEXTURE_COORD_ARRAY);
@@ -1365,6 +1589,7 @@ void BMD::RenderMesh(int meshIndex, int renderFlags, float alpha, int blendMeshI
     if (enableColor) glColorPointer(4, GL_FLOAT, 0, colors);
     glTexCoordPointer(2, GL_FLOAT, 0, texCoords);
 
+    ++g_RenderCounters.DrawCalls;
     glDrawArrays(GL_TRIANGLES, 0, m->NumTriangles * 3);
 
     glDisableClientState(GL_TEXTURE_COORD_ARRAY);
@@ -2288,6 +2513,7 @@ void BMD::AddClothesShadowTriangles(void* pClothes, const int clothesCount, cons
 
     glEnableClientState(GL_VERTEX_ARRAY);
     glVertexPointer(3, GL_FLOAT, 0, vertices);
+    ++g_RenderCounters.DrawCalls;
     glDrawArrays(GL_TRIANGLES, 0, target_vertex_index + 1);
     glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 }
@@ -2332,6 +2558,7 @@ void BMD::AddMeshShadowTriangles(const int blendMesh, const int hiddenMesh, cons
 
     glEnableClientState(GL_VERTEX_ARRAY);
     glVertexPointer(3, GL_FLOAT, 0, vertices);
+    ++g_RenderCounters.DrawCalls;
     glDrawArrays(GL_TRIANGLES, 0, target_vertex_index + 1);
     glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 }
@@ -2357,6 +2584,7 @@ void BMD::RenderBodyShadow(const int blendMesh, const int hiddenMesh, const int
     BeginRender(1.f);
 
     // enable stencil and continue draw
+    FlushRenderQueue();
     glEnable(GL_STENCIL_TEST);
     glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
 
@@ -2454,6 +2682,7 @@ void BMD::RenderObjectBoundingBox()
 void BMD::RenderBone(float(*BoneMatrix)[3][4])
 {
     DisableTexture();
+    FlushRenderQueue();
     glDepthFunc(GL_ALWAYS);
     glColor3f(0.8f, 0.8f, 0.2f);
     for (int i = 0; i < NumBones; i++)
@@ -2544,6 +2773,8 @@ void BMD::Release()
         }
     }
 
+    ReleaseMeshBuffers(this);
+
     if (Meshs)
     {
         for (int i = 0; i < NumMeshs; ++i)
@@ -2554,6 +2785,7 @@ void BMD::Release()
             if (m->Normals) { delete[] m->Normals; m->Normals = nullptr; }
             if (m->TexCoords) { delete[] m->TexCoords; m->TexCoords = nullptr; }
             if (m->Triangles) { delete[] m->Triangles; m->Triangles = nullptr; }
+            if (m->m_pSkinning) { delete m->m_pSkinning; m->m_pSkinning = nullptr; }
 
             if (m->m_csTScript)
             {
@@ -2689,6 +2921,19 @@ bool BMD::Open2(wchar_t* DirName, wchar_t* ModelFileName, bool bReAlloc)
         Release();
     }
 
+    if (!ReadModel2(DirName, ModelFileName))
+    {
+        if (Meshs)
+            Release();
+        return false;
+    }
+
+    FinishOpen();
+    return true;
+}
+
+bool BMD::ReadModel2(const wchar_t* DirName, const wchar_t* ModelFileName)
+{
     wchar_t ModelPath[260] = {};
     _snwprintf(ModelPath, std::size(ModelPath), L"%s%s", DirName, ModelFileName);
 
@@ -2796,7 +3041,7 @@ bool BMD::Open2(wchar_t* DirName, wchar_t* ModelFileName, bool bReAlloc)
 
     if (!Meshs || !Bones || !Actions || !Textures || !IndexTexture)
     {
-        Release();
+        // the caller releases what was allocated; Release is not safe on a worker
         m_bCompletedAlloc = false;
         return false;
     }
@@ -2905,9 +3150,61 @@ bool BMD::Open2(wchar_t* DirName, wchar_t* ModelFileName, bool bReAlloc)
         }
     }
 
+    return true;
+}
+
+// Bind pose of one mesh in the kernel's bone-grouped layout; nullptr keeps the mesh on
+// the scalar path in BMD::TransformVertices.
+static SkinningBatch_t* CreateSkinningBatch(const Mesh_t* m, int numBones)
+{
+    if (m->Vertices == nullptr || m->Normals == nullptr)
+        return nullptr;
+
+    std::vector<SkinningSource_t> sources;
+
+    sources.reserve(m->NumVertices);
+    for (int j = 0; j < m->NumVertices; j++)
+    {
+        const Vertex_t* v = &m->Vertices[j];
+        if (v->Node < 0 || v->Node >= numBones)
+            return nullptr;
+
+        SkinningSource_t s = { v->Node, static_cast<short>(j), { v->Position[0], v->Position[1], v->Position[2] } };
+        sources.push_back(s);
+    }
+
+    auto batch = new SkinningBatch_t;
+    BuildSkinningStream(batch->Vertices, sources);
+
+    sources.clear();
+    sources.reserve(m->NumNormals);
+    for (int j = 0; j < m->NumNormals; j++)
+    {
+        const Normal_t* n = &m->Normals[j];
+        if (n->Node < 0 || n->Node >= numBones)
+        {
+            delete batch;
+            return nullptr;
+        }
+
+        SkinningSource_t s = { n->Node, static_cast<short>(j), { n->Normal[0], n->Normal[1], n->Normal[2] } };
+        sources.push_back(s);
+    }
+    BuildSkinningStream(batch->Normals, sources);
+
+    return batch;
+}
+
+
+void BMD::FinishOpen()
+{
     Init(false);
+    for (int i = 0; i < NumMeshs; ++i)
+    {
+        Meshs[i].m_pSkinning = CreateSkinningBatch(&Meshs[i], NumBones);
+    }
+    CreateMeshBuffers(this);
     m_bCompletedAlloc = true;
-    return true;
 }
 
 
@@ -3,6 +3,8 @@
 
 #include "TextureScript.h"
 
+struct SkinningBatch_t;
+
 #define MAX_BONES    200
 #define MAX_MESH     50
 #define MAX_VERTICES 15000
@@ -146,6 +148,12 @@ typedef struct _Mesh_t
     unsigned char* Commands; //ver1.1
 
     TextureScript* m_csTScript;
+    SkinningBatch_t* m_pSkinning;
+
+    GLuint        VertexBuffer;
+    GLuint        IndexBuffer;
+    GLenum        IndexType;
+    int           NumIndices;
 
     _Mesh_t()
     {
@@ -154,12 +162,34 @@ typedef struct _Mesh_t
         Triangles = NULL;
         Commands = NULL;
         m_csTScript = NULL;
+        m_pSkinning = NULL;
 
         NumVertices = NumNormals = NumTexCoords =
             NumVertexColors = NumTriangles = 0;
+
+        VertexBuffer = IndexBuffer = 0;
+        IndexType = GL_UNSIGNED_SHORT;
+        NumIndices = 0;
     }
 } Mesh_t;
 
+class BMD;
+class CSkinnedModel;
+
+// Inputs of one BMD::Transform() call besides the bone palette.
+typedef struct
+{
+    const BMD* Model;
+    float      BodyScale;
+    vec3_t     BodyOrigin;
+    float      BoneScale;
+    float      Scale;
+    vec3_t     LightPosition;
+    bool       LightEnable;
+    bool       Translate;
+    bool       CalcBounds;
+} SkinningKey_t;
+
 class BMD
 {
 public:
@@ -224,14 +254,37 @@ public:
     //utility
     void Init(bool Dummy);
     bool Open2(wchar_t* DirName, wchar_t* FileName, bool bReAlloc = true);
+    // Open2 in two steps. ReadModel2 reads, decrypts and parses the file and touches
+    // nothing but this model, so models can be read on the job system; on failure the
+    // caller releases what it allocated. FinishOpen builds the bounding boxes (shared
+    // scratch arrays), skinning batches and mesh buffers on the render thread.
+    bool ReadModel2(const wchar_t* DirName, const wchar_t* FileName);
+    void FinishOpen();
     bool Save2(wchar_t* DirName, wchar_t* FileName);
     void Release();
     void CreateBoundingBox();
 
     bool PlayAnimation(float* AnimationFrame, float* PriorAnimationFrame, unsigned short* PriorAction, float Speed, vec3_t Origin, vec3_t Angle);
     void Animation(float(*BoneTransform)[3][4], float AnimationFrame, float PriorAnimationFrame, unsigned short PriorAction, vec3_t Angle, vec3_t HeadAngle, bool Parent = false, bool Translate = true);
+
+    // Animation() split into reentrant pieces so bone palettes can be built off the render thread:
+    // MakeAnimationKey captures every input, AnimateBones only reads the model and writes BoneTransform,
+    // SetAnimationState applies the side effects Animation() has on this model and on ParentMatrix.
+    void MakeAnimationKey(BoneAnimation_t& Key, unsigned short Action, float Height, float Scale, const vec3_t Origin,
+        float AnimationFrame, float PriorAnimationFrame, unsigned short PriorAction, const vec3_t Angle, const vec3_t HeadAngle, bool Translate) const;
+    void BodyMatrix(const BoneAnimation_t& Key, float(*Matrix)[4]) const;
+    void AnimateBones(const BoneAnimation_t& Key, float(*BoneTransform)[3][4], const float(*RootMatrix)[4]) const;
+    void SetAnimationState(const BoneAnimation_t& Key, bool Parent = false);
+
     void InterpolationTrans(float(*Mat1)[4], float(*TransMat2)[4], float _Scale);
-    void Transform(float(*BoneMatrix)[3][4], vec3_t BoundingBoxMin, vec3_t BoundingBoxMax, OBB_t* OBB, bool Translate = false, float _Scale = 0.0f);
+    // Prepared is output skinned ahead by RunPreparedSkinning(); it is used instead of skinning
+    // again when it was made from the same key and bone palette and not patched since.
+    void Transform(float(*BoneMatrix)[3][4], vec3_t BoundingBoxMin, vec3_t BoundingBoxMax, OBB_t* OBB, bool Translate = false, float _Scale = 0.0f, CSkinnedModel* Prepared = NULL);
+
+    // Transform() split the same way: MakeSkinningKey captures the inputs on the render
+    // thread, TransformVertices only reads the model and writes the given per-mesh arrays.
+    void MakeSkinningKey(SkinningKey_t& Key, float Scale, const vec3_t Origin, bool Light, float fBoneScale, bool Translate, float _Scale) const;
+    void TransformVertices(const SkinningKey_t& Key, float(*BoneMatrix)[3][4], vec3_t** Vertices, vec3_t** Normals, float** Intensities, vec3_t BoundingMin, vec3_t BoundingMax) const;
     void TransformByObjectBone(vec3_t vResultPosition, OBJECT* pObject, int iBoneNumber, vec3_t vRelativePosition = NULL);
     void TransformByBoneMatrix(vec3_t vResultPosition, float(*BoneMatrix)[4], vec3_t vWorldPosition = NULL, vec3_t vRelativePosition = NULL);
     void TransformPosition(float(*Matrix)[4], vec3_t Position, vec3_t WorldPosition, bool Translate = false);
@@ -306,15 +359,48 @@ private:
 
     void AddClothesShadowTriangles(void* pClothes, int clothesCount, float sx, float sy) const;
     void AddMeshShadowTriangles(int blendMesh, int hiddenMesh, int startMesh, int endMesh, float sx, float sy) const;
+    void ClampAnimationKey(const BoneAnimation_t& Key, unsigned short& Action, unsigned short& PriorAction, int& Frame, int& PriorFrame) const;
 };
 
 extern BMD* Models;
 extern BMD* ModelsDump;
 extern float BoneTransform[MAX_BONES][3][4];
-extern vec3_t VertexTransform[MAX_MESH][MAX_VERTICES];
-extern vec3_t NormalTransform[MAX_MESH][MAX_VERTICES];
+// Per mesh output of the last BMD::Transform. They point at shared scratch arrays, or at
+// a CSkinnedModel when Transform could use one.
+extern vec3_t* VertexTransform[MAX_MESH];
+extern vec3_t* NormalTransform[MAX_MESH];
+extern float* IntensityTransform[MAX_MESH];
 extern vec3_t LightTransform[MAX_MESH][MAX_VERTICES];
-extern float  IntensityTransform[MAX_MESH][MAX_VERTICES];
 extern float g_chrome[MAX_VERTICES][2];
 
+// Skinned vertices, normals and light intensities of one model, sized to its meshes.
+class CSkinnedModel
+{
+public:
+    void Allocate(const BMD* b);
+
+    SkinningKey_t Key;
+    // Set when the job system animated Palette from Animation rather than copying the
+    // object's prepared bones; AnimateObject then takes the palette instead of animating again.
+    bool    Animated;
+    BoneAnimation_t Animation;
+    float   Palette[MAX_BONES][3][4];
+    vec3_t  BoundingMin;
+    vec3_t  BoundingMax;
+    vec3_t* Vertices[MAX_MESH];
+    vec3_t* Normals[MAX_MESH];
+    float* Intensities[MAX_MESH];
+    const OBJECT* Owner;
+    bool    Patched;
+
+private:
+    std::vector<float> m_Storage;
+};
+
+// Points VertexTransform / NormalTransform / IntensityTransform back at the scratch arrays.
+void BindScratchTransform();
+// Called by InvalidateSkinningPalette: the arrays were patched in place, so the prepared
+// output they point at no longer matches its key.
+void MarkTransformPatched();
+
 #endif
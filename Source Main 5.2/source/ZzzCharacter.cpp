@@ -46,6 +46,8 @@
 #include "DuelMgr.h"
 #include "MonkSystem.h"
 #include <NewUISystem.h>
+#include "./Utilities/JobSystem.h"
+#include "./Utilities/Profiler.h"
 
 CHARACTER* CharactersClient;
 CHARACTER CharacterView;
@@ -4494,7 +4496,10 @@ void MoveCharacter(CHARACTER* c, OBJECT* o)
             OBJECT* p_o[MAX_FENRIR_SKILL_MONSTER_NUM];
             int iMonsterNum = 0;
 
-            for (int i = 0; i < MAX_CHARACTERS_CLIENT; i++)
+            static std::vector<int> s_vecNearby;
+            g_CharacterGrid.Query(c->Object.Position[0], c->Object.Position[1], gSkillManager.GetSkillDistance(AT_SKILL_PLASMA_STORM_FENRIR) * TERRAIN_SCALE, s_vecNearby);
+
+            for (int i : s_vecNearby)
             {
                 p_temp_c = &CharactersClient[i];
 
@@ -6356,8 +6361,12 @@ void MoveCharacterClient(CHARACTER* cc)
     }
 }
 
+SpatialGrid<MAX_CHARACTERS_CLIENT> g_CharacterGrid;
+
 void MoveCharactersClient()
 {
+    PROFILE_SCOPE("MoveCharacters");
+
     for (int i = 0; i < TERRAIN_SIZE * TERRAIN_SIZE; i++)
     {
         if ((TerrainWall[i] & TW_CHARACTER) == TW_CHARACTER) TerrainWall[i] -= TW_CHARACTER;
@@ -6373,6 +6382,11 @@ void MoveCharactersClient()
             TerrainWall[Index] |= TW_CHARACTER;
         }
 
+        if (to->Live)
+            g_CharacterGrid.Update(i, to->Position[0], to->Position[1]);
+        else
+            g_CharacterGrid.Remove(i);
+
         to->Visible = TestFrustrum2D(to->Position[0] * 0.01f, to->Position[1] * 0.01f, -20.f);
     }
 
@@ -11196,8 +11210,79 @@ void RenderCharacter(CHARACTER* c, OBJECT* o, int Select)
     }
 }
 
+// Builds the bone palettes of all visible characters on the job system before the
+// (serial) render loop, then skins their body (monsters) or body parts (players) with
+// them the same way; AnimateObject() in ZzzObject.cpp and BMD::Transform pick the
+// results up when their inputs still match and fall back to the serial path otherwise.
+static void PrepareCharacterBones()
+{
+    static OBJECT* Prepared[MAX_CHARACTERS_CLIENT];
+    int count = 0;
+
+    for (int i = 0; i < MAX_CHARACTERS_CLIENT; ++i)
+    {
+        OBJECT* o = &CharactersClient[i].Object;
+        o->m_bBonesPrepared = false;
+
+        if (!o->Live || !o->Visible || !o->EnableBoneMatrix || o->BoneTransform == nullptr)
+            continue;
+
+        const BMD* b = &Models[o->Type];
+        if (b->NumActions <= 0 || b->Bones == nullptr)
+            continue;
+
+        // same inputs Calc_RenderObject / Calc_ObjectAnimation use for a translated character
+        b->MakeAnimationKey(o->m_BonesPrepared, o->CurrentAction, 0.f, o->Scale, o->Position,
+            o->AnimationFrame, o->PriorAnimationFrame, o->PriorAction, o->Angle, o->HeadAngle, false);
+        Prepared[count++] = o;
+    }
+
+    JobSystem::Instance()->ParallelFor(count, [](int index)
+        {
+            OBJECT* o = Prepared[index];
+            const BMD* b = o->m_BonesPrepared.Model;
+
+            float RootMatrix[3][4];
+            b->BodyMatrix(o->m_BonesPrepared, RootMatrix);
+            b->AnimateBones(o->m_BonesPrepared, o->BoneTransform, RootMatrix);
+        });
+
+    for (int i = 0; i < count; ++i)
+    {
+        Prepared[i]->m_bBonesPrepared = true;
+    }
+
+    // RenderCharacter draws with Translate set and the character's own palette.
+    BeginPreparedSkinning();
+    for (int i = 0; i < MAX_CHARACTERS_CLIENT; ++i)
+    {
+        CHARACTER* c = &CharactersClient[i];
+        OBJECT* o = &c->Object;
+        if (!o->m_bBonesPrepared)
+            continue;
+
+        if (o->Type == MODEL_PLAYER)
+        {
+            for (int j = 0; j < MAX_BODYPART; ++j)
+            {
+                if (c->BodyPart[j].Type != -1)
+                    QueuePreparedSkin(o, c->BodyPart[j].Type, true);
+            }
+        }
+        else
+        {
+            QueuePreparedSkin(o, o->Type, true);
+        }
+    }
+    RunPreparedSkinning();
+}
+
 void RenderCharactersClient()
 {
+    PROFILE_SCOPE("RenderCharacters");
+
+    PrepareCharacterBones();
+
     for (int i = 0; i < MAX_CHARACTERS_CLIENT; ++i)
     {
         CHARACTER* c = &CharactersClient[i];
@@ -11266,6 +11351,11 @@ void RenderCharactersClient()
         }
     }
 
+    for (int i = 0; i < MAX_CHARACTERS_CLIENT; ++i)
+    {
+        CharactersClient[i].Object.m_bBonesPrepared = false;
+    }
+
     if (gMapManager.InBattleCastle() || gMapManager.WorldActive == WD_31HUNTING_GROUND)
     {
         battleCastle::InitEtcSetting();
@@ -11285,6 +11375,177 @@ void RenderProtectGuildMark(CHARACTER* c)
     }
 }
 
+namespace
+{
+    // Open-addressing (linear probing) map from a 32-bit key to a CharactersClient slot.
+    // Entries are only hints: callers validate the slot they get back and erase stale ones.
+    class CharacterSlotIndex
+    {
+    public:
+        CharacterSlotIndex() { Clear(); }
+
+        void Clear()
+        {
+            for (auto& entry : m_Entries)
+                entry.Slot = EMPTY;
+            m_iUsed = 0;
+        }
+
+        int Find(DWORD key) const
+        {
+            for (DWORD i = Hash(key);; i = (i + 1) & (CAPACITY - 1))
+            {
+                const Entry& entry = m_Entries[i];
+                if (entry.Slot == EMPTY)
+                    return -1;
+                if (entry.Slot != DELETED && entry.Key == key)
+                    return entry.Slot;
+            }
+        }
+
+        // Returns false when the table is too full and has to be rebuilt.
+        bool Insert(DWORD key, int slot)
+        {
+            int reuse = -1;
+            DWORD i = Hash(key);
+            for (;; i = (i + 1) & (CAPACITY - 1))
+            {
+                Entry& entry = m_Entries[i];
+                if (entry.Slot == EMPTY)
+                    break;
+                if (entry.Slot == DELETED)
+                {
+                    if (reuse < 0)
+                        reuse = static_cast<int>(i);
+                    continue;
+                }
+                if (entry.Key == key)
+                {
+                    entry.Slot = static_cast<short>(slot);
+                    return true;
+                }
+            }
+
+            if (reuse >= 0)
+            {
+                i = static_cast<DWORD>(reuse);
+            }
+            else
+            {
+                if (m_iUsed >= CAPACITY / 2)
+                    return false;
+                ++m_iUsed;
+            }
+
+            m_Entries[i].Key = key;
+            m_Entries[i].Slot = static_cast<short>(slot);
+            return true;
+        }
+
+        void Erase(DWORD key)
+        {
+            for (DWORD i = Hash(key);; i = (i + 1) & (CAPACITY - 1))
+            {
+                Entry& entry = m_Entries[i];
+                if (entry.Slot == EMPTY)
+                    return;
+                if (entry.Slot != DELETED && entry.Key == key)
+                {
+                    entry.Slot = DELETED;
+                    return;
+                }
+            }
+        }
+
+    private:
+        static const int CAPACITY = 2048; // power of two, well above 2 * MAX_CHARACTERS_CLIENT
+        static const int CAPACITY_BITS = 11;
+        enum { EMPTY = -1, DELETED = -2 };
+
+        struct Entry
+        {
+            DWORD Key;
+            short Slot;
+        };
+
+        static DWORD Hash(DWORD key)
+        {
+            return (key * 2654435761u) >> (32 - CAPACITY_BITS);
+        }
+
+        Entry m_Entries[CAPACITY];
+        int   m_iUsed;
+    };
+
+    // Key -> slot is authoritative: every key assignment on a live slot goes through
+    // SetCharacterKey or CreateCharacter. Name -> slot is a cache only, since c->ID is
+    // written directly by many packet handlers.
+    CharacterSlotIndex g_CharacterKeyIndex;
+    CharacterSlotIndex g_CharacterNameIndex;
+
+    DWORD HashCharacterName(const wchar_t* szName)
+    {
+        DWORD hash = 2166136261u;
+        for (; *szName; ++szName)
+            hash = (hash ^ static_cast<DWORD>(*szName)) * 16777619u;
+        return hash;
+    }
+
+    bool IsCharacterSlot(int slot, int Key)
+    {
+        const CHARACTER* c = &CharactersClient[slot];
+        return c->Object.Live && c->Key == Key;
+    }
+
+    int ScanCharacterIndex(int Key)
+    {
+        for (int i = 0; i < MAX_CHARACTERS_CLIENT; i++)
+        {
+            if (IsCharacterSlot(i, Key))
+                return i;
+        }
+        return MAX_CHARACTERS_CLIENT;
+    }
+
+    void RebuildCharacterIndex()
+    {
+        g_CharacterKeyIndex.Clear();
+        g_CharacterNameIndex.Clear();
+
+        for (int i = 0; i < MAX_CHARACTERS_CLIENT; i++)
+        {
+            CHARACTER* c = &CharactersClient[i];
+            if (!c->Object.Live)
+                continue;
+
+            g_CharacterKeyIndex.Insert(static_cast<DWORD>(c->Key), i);
+            if (c->ID[0] != L'\0')
+                g_CharacterNameIndex.Insert(HashCharacterName(c->ID), i);
+        }
+    }
+
+    void IndexCharacterKey(int slot)
+    {
+        if (!g_CharacterKeyIndex.Insert(static_cast<DWORD>(CharactersClient[slot].Key), slot))
+            RebuildCharacterIndex();
+    }
+
+    void IndexCharacterName(const wchar_t* szName, int slot)
+    {
+        if (!g_CharacterNameIndex.Insert(HashCharacterName(szName), slot))
+            RebuildCharacterIndex();
+    }
+}
+
+void SetCharacterKey(CHARACTER* c, int Key)
+{
+    c->Key = Key;
+
+    const ptrdiff_t slot = c - CharactersClient;
+    if (slot >= 0 && slot < MAX_CHARACTERS_CLIENT)
+        IndexCharacterKey(static_cast<int>(slot));
+}
+
 void ClearCharacters(int Key)
 {
     for (int i = 0; i < MAX_CHARACTERS_CLIENT; i++)
@@ -11294,6 +11555,7 @@ void ClearCharacters(int Key)
         if (o->Live && c->Key != Key)
         {
             o->Live = false;
+            g_CharacterGrid.Remove(i);
 
             BoneManager::UnregisterBone(c);
 
@@ -11309,32 +11571,32 @@ void ClearCharacters(int Key)
         DeleteCloth(c, o);
         DeleteParts(c);
     }
+
+    RebuildCharacterIndex();
 }
 
 void DeleteCharacter(int Key)
 {
-    for (int i = 0; i < MAX_CHARACTERS_CLIENT; i++)
-    {
-        CHARACTER* c = &CharactersClient[i];
-        OBJECT* o = &c->Object;
-        if (o->Live && c->Key == Key)
-        {
-            o->Live = false;
+    const int i = FindCharacterIndex(Key);
+    if (i == MAX_CHARACTERS_CLIENT)
+        return;
 
-            BoneManager::UnregisterBone(c);
+    CHARACTER* c = &CharactersClient[i];
+    OBJECT* o = &c->Object;
+    o->Live = false;
+    g_CharacterGrid.Remove(i);
 
-            for (int j = 0; j < MAX_MOUNTS; j++)
-            {
-                OBJECT* b = &Mounts[j];
-                if (b->Live && b->Owner == o)
-                    b->Live = false;
-            }
-            DeletePet(c);
-            DeleteCloth(c, o);
-            DeleteParts(c);
-            return;
-        }
+    BoneManager::UnregisterBone(c);
+
+    for (int j = 0; j < MAX_MOUNTS; j++)
+    {
+        OBJECT* b = &Mounts[j];
+        if (b->Live && b->Owner == o)
+            b->Live = false;
     }
+    DeletePet(c);
+    DeleteCloth(c, o);
+    DeleteParts(c);
 }
 
 void DeleteCharacter(CHARACTER* c, OBJECT* o)
@@ -11357,15 +11619,21 @@ void DeleteCharacter(CHARACTER* c, OBJECT* o)
 
 int FindCharacterIndex(int Key)
 {
-    for (int i = 0; i < MAX_CHARACTERS_CLIENT; i++)
-    {
-        CHARACTER* c = &CharactersClient[i];
-        if (c->Object.Live && c->Key == Key)
-        {
-            return i;
-        }
-    }
-    return MAX_CHARACTERS_CLIENT;
+    const int slot = g_CharacterKeyIndex.Find(static_cast<DWORD>(Key));
+    if (slot < 0)
+        return MAX_CHARACTERS_CLIENT;
+
+    if (IsCharacterSlot(slot, Key))
+        return slot;
+
+    // The slot died or was reused under another key. Another live slot may still
+    // carry this key (duplicates are tolerated), so repair the entry from a scan.
+    const int found = ScanCharacterIndex(Key);
+    if (found == MAX_CHARACTERS_CLIENT)
+        g_CharacterKeyIndex.Erase(static_cast<DWORD>(Key));
+    else
+        IndexCharacterKey(found);
+    return found;
 }
 
 int FindCharacterIndexByMonsterIndex(int Type)
@@ -11383,15 +11651,10 @@ int FindCharacterIndexByMonsterIndex(int Type)
 
 int HangerBloodCastleQuestItem(int Key)
 {
-    int index = MAX_CHARACTERS_CLIENT;
+    const int index = FindCharacterIndex(Key);
     for (int i = 0; i < MAX_CHARACTERS_CLIENT; i++)
     {
-        CHARACTER* c = &CharactersClient[i];
-        if (c->Object.Live && c->Key == Key)
-        {
-            index = i;
-        }
-        c->EtcPart = 0;
+        CharactersClient[i].EtcPart = 0;
     }
     return index;
 }
@@ -11854,16 +12117,13 @@ void CreateCharacterPointer(CHARACTER* c, int Type, unsigned char PositionX, uns
 
 CHARACTER* CreateCharacter(int Key, int Type, unsigned char PositionX, unsigned char PositionY, float Rotation)
 {
-    for (int i = 0; i < MAX_CHARACTERS_CLIENT; i++)
+    const int index = FindCharacterIndex(Key);
+    if (index != MAX_CHARACTERS_CLIENT)
     {
-        CHARACTER* c = &CharactersClient[i];
-        OBJECT* o = &c->Object;
-        if (o->Live && c->Key == Key)
-        {
-            CreateCharacterPointer(c, Type, PositionX, PositionY, Rotation);
-            g_CharacterClearBuff(o);
-            return c;
-        }
+        CHARACTER* c = &CharactersClient[index];
+        CreateCharacterPointer(c, Type, PositionX, PositionY, Rotation);
+        g_CharacterClearBuff(&c->Object);
+        return c;
     }
 
     for (int i = 0; i < MAX_CHARACTERS_CLIENT; i++)
@@ -11878,7 +12138,7 @@ CHARACTER* CreateCharacter(int Key, int Type, unsigned char PositionX, unsigned
             DeleteParts(c);
             CreateCharacterPointer(c, Type, PositionX, PositionY, Rotation);
             g_CharacterClearBuff(o);
-            c->Key = Key;
+            SetCharacterKey(c, Key);
             return c;
         }
     }
@@ -12188,32 +12448,40 @@ DWORD GetGuildRelationShipBGColor(BYTE GuildRelationShip)
 
 CHARACTER* FindCharacterByID(wchar_t* szName)
 {
-    for (int i = 0; i < MAX_CHARACTERS_CLIENT; i++)
+    const DWORD hash = HashCharacterName(szName);
+    const int slot = g_CharacterNameIndex.Find(hash);
+    if (slot >= 0)
     {
-        CHARACTER* c = &CharactersClient[i];
+        CHARACTER* c = &CharactersClient[slot];
         if (c->Object.Live && !wcscmp(szName, c->ID))
         {
             return c;
         }
+        g_CharacterNameIndex.Erase(hash);
     }
-    return NULL;
-}
 
-
-
-CHARACTER* FindCharacterByKey(int Key)
-{
     for (int i = 0; i < MAX_CHARACTERS_CLIENT; i++)
     {
         CHARACTER* c = &CharactersClient[i];
-        if (c->Object.Live && c->Key == Key)
+        if (c->Object.Live && !wcscmp(szName, c->ID))
         {
+            IndexCharacterName(szName, i);
             return c;
         }
     }
     return NULL;
 }
 
+
+
+CHARACTER* FindCharacterByKey(int Key)
+{
+    const int index = FindCharacterIndex(Key);
+    if (index == MAX_CHARACTERS_CLIENT)
+        return NULL;
+    return &CharactersClient[index];
+}
+
 int LevelConvert(BYTE Level)
 {
     switch (Level)
@@ -14755,7 +15023,7 @@ CHARACTER* CreateHero(int Index, CLASS_TYPE Class, int Skin, float x, float y, f
     OBJECT* o = &c->Object;
     CreateCharacterPointer(c, MODEL_PLAYER, 0, 0, Rotate);
     Vector(0.3f, 0.3f, 0.3f, o->Light);
-    c->Key = Index;
+    SetCharacterKey(c, Index);
     o->Position[0] = x;
     o->Position[1] = y;
     c->Class = Class;
@@ -2,9 +2,11 @@
 #define __ZZCHARACTER_H__
 
 #include "ZzzBMD.h"
+#include "./Utilities/SpatialGrid.h"
 
 extern Script_Skill MonsterSkill[];
 extern CHARACTER* CharactersClient;
+extern SpatialGrid<MAX_CHARACTERS_CLIENT> g_CharacterGrid;
 extern CHARACTER CharacterView;
 extern CHARACTER* Hero;
 
@@ -32,6 +34,7 @@ void ClearCharacters(int Key = -1);
 void DeleteCharacter(int Key);
 void DeleteCharacter(CHARACTER* c, OBJECT* o);
 int FindCharacterIndex(int Key);
+void SetCharacterKey(CHARACTER* c, int Key);
 int FindCharacterIndexByMonsterIndex(int Type);
 
 void DeadCharacterBuff(OBJECT* o);
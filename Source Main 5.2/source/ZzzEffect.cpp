@@ -20,6 +20,7 @@
 #include "SkillManager.h"
 #include <NewUISystem.h>
 #include "ZzzInterface.h"
+#include "./Utilities/Profiler.h"
 
 PARTICLE  Particles[MAX_PARTICLES];
 #ifdef DEVIAS_XMAS_EVENT
@@ -29,9 +30,13 @@ PARTICLE  Leaves[MAX_LEAVES];
 #endif // DEVIAS_XMAS_EVENT
 JOINT     Joints[MAX_JOINTS];
 
+SlotPool<PARTICLE, MAX_PARTICLES> g_ParticlePool(Particles, L"Particle");
+SlotPool<JOINT, MAX_JOINTS>       g_JointPool(Joints, L"Joint");
+
 BYTE    g_byUpperBoneLocation[7] = { 25, 26, 27, 20, 34, 35, 36 };
 
 OBJECT Effects[MAX_EFFECTS];
+SlotPool<OBJECT, MAX_EFFECTS> g_EffectPool(Effects, L"Effect");
 
 bool CheckCharacterRange(OBJECT* so, float Range, short PKKey, BYTE Kind = 0)
 {
@@ -331,15 +336,22 @@ void CreateEffectFpsChecked(int Type, vec3_t Position, vec3_t Angle, vec3_t Ligh
 
 void CreateEffect(int Type, vec3_t Position, vec3_t Angle, vec3_t Light, int SubType, OBJECT* Owner, short PKKey, WORD SkillIndex, WORD Skill, WORD SkillSerialNum, float Scale, short int sTargetIndex)
 {
-    for (int icntEffect = 0; icntEffect < MAX_EFFECTS; icntEffect++)
+    OBJECT* o = nullptr;
+    if (g_SkillEffects.IsSkillEffect(Type, Position, Angle, Light, SubType, Owner, PKKey, SkillIndex, Skill, SkillSerialNum, Scale, sTargetIndex))
     {
-        OBJECT* o = &Effects[icntEffect];
-
-        if (g_SkillEffects.IsSkillEffect(Type, Position, Angle, Light, SubType, Owner, PKKey, SkillIndex, Skill, SkillSerialNum, Scale, sTargetIndex))
+        o = g_SkillEffects.CreateEffect();
+    }
+    else
+    {
+        const int iEffect = g_EffectPool.Acquire();
+        if (iEffect >= 0)
         {
-            o = g_SkillEffects.CreateEffect();
+            o = &Effects[iEffect];
         }
+    }
 
+    if (o != nullptr)
+    {
         if (!o->Live)
         {
             o->Live = true;
@@ -17977,12 +17989,16 @@ void MoveEffect(OBJECT* o, int iIndex)
 
 void MoveEffects()
 {
+    PROFILE_SCOPE("MoveEffects");
+
     if (SceneFlag == MAIN_SCENE)
     {
         g_pCatapultWindow->SetCameraPos();
     }
 
-    for (int i = 0; i < MAX_EFFECTS; i++)
+    g_EffectPool.Collect();
+
+    for (int i = g_EffectPool.First(); i >= 0; i = g_EffectPool.Next(i))
     {
         OBJECT* o = &Effects[i];
         if (o->Live)
@@ -18075,18 +18091,25 @@ void RenderSkillSpear(OBJECT* o)
 
 void RenderEffects(bool bRenderBlendMesh)
 {
-    int iEffectSize = MAX_EFFECTS + g_SkillEffects.GetSize();
+    PROFILE_SCOPE("RenderEffects");
 
-    for (int i = 0; i < iEffectSize; ++i)
+    int iEffect = g_EffectPool.First();
+    int iSkillEffect = 0;
+    for (;;)
     {
         OBJECT* o;
-        if (i < MAX_EFFECTS)
+        if (iEffect >= 0)
         {
-            o = &Effects[i];
+            o = &Effects[iEffect];
+            iEffect = g_EffectPool.Next(iEffect);
+        }
+        else if (iSkillEffect < g_SkillEffects.GetSize())
+        {
+            o = g_SkillEffects.GetEffect(iSkillEffect++);
         }
         else
         {
-            o = g_SkillEffects.GetEffect(i - MAX_EFFECTS);
+            break;
         }
 
         if (o->Live)
@@ -19026,17 +19049,23 @@ void RenderAfterEffects(bool bRenderBlendMesh)
     if (!g_Direction.m_CKanturu.IsMayaScene())
         return;
 
-    int iEffectSize = MAX_EFFECTS + g_SkillEffects.GetSize();
-    for (int i = 0; i < iEffectSize; ++i)
+    int iEffect = g_EffectPool.First();
+    int iSkillEffect = 0;
+    for (;;)
     {
         OBJECT* o;
-        if (i < MAX_EFFECTS)
+        if (iEffect >= 0)
+        {
+            o = &Effects[iEffect];
+            iEffect = g_EffectPool.Next(iEffect);
+        }
+        else if (iSkillEffect < g_SkillEffects.GetSize())
         {
-            o = &Effects[i];
+            o = g_SkillEffects.GetEffect(iSkillEffect++);
         }
         else
         {
-            o = g_SkillEffects.GetEffect(i - MAX_EFFECTS);
+            break;
         }
         if (o->Live && o->m_bRenderAfterCharacter)
         {
@@ -19074,17 +19103,23 @@ void RenderEffectShadows()
         return;
     }
 
-    int iEffectSize = MAX_EFFECTS + g_SkillEffects.GetSize();
-    for (int i = 0; i < iEffectSize; ++i)
+    int iEffect = g_EffectPool.First();
+    int iSkillEffect = 0;
+    for (;;)
     {
         OBJECT* o;
-        if (i < MAX_EFFECTS)
+        if (iEffect >= 0)
+        {
+            o = &Effects[iEffect];
+            iEffect = g_EffectPool.Next(iEffect);
+        }
+        else if (iSkillEffect < g_SkillEffects.GetSize())
         {
-            o = &Effects[i];
+            o = g_SkillEffects.GetEffect(iSkillEffect++);
         }
         else
         {
-            o = g_SkillEffects.GetEffect(i - MAX_EFFECTS);
+            break;
         }
         if (o->Live)
         {
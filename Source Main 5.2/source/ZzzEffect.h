@@ -1,6 +1,8 @@
 #ifndef __ZZZ_EFFECT_H__
 #define __ZZZ_EFFECT_H__
 
+#include "./Utilities/SlotPool.h"
+
 extern OBJECT    Effects[];
 extern OBJECT    Sprites[];
 extern JOINT     Joints[];
@@ -10,6 +12,12 @@ extern PARTICLE  Leaves[];
 extern PARTICLE  Points[];
 extern PARTICLE  Pointers[];
 
+extern SlotPool<OBJECT, MAX_EFFECTS>     g_EffectPool;
+extern SlotPool<OBJECT, MAX_SPRITES>     g_SpritePool;
+extern SlotPool<JOINT, MAX_JOINTS>       g_JointPool;
+extern SlotPool<PARTICLE, MAX_PARTICLES> g_ParticlePool;
+extern SlotPool<PARTICLE, MAX_POINTERS>  g_PointerPool;
+
 void CreateBlur(CHARACTER* Owner, vec3_t p1, vec3_t p2, vec3_t Light, int Type, bool Short = false, int SubType = 0);
 void MoveBlurs();
 void RenderBlurs();
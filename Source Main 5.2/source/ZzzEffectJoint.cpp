@@ -9,6 +9,7 @@
 #include "ZzzCharacter.h"
 #include "ZzzLodTerrain.h"
 #include "ZzzTexture.h"
+#include "QuadBatch.h"
 #include "ZzzAi.h"
 #include "ZzzEffect.h"
 #include "DSPlaySound.h"
@@ -29,7 +30,8 @@ void CreateJointFpsChecked(int Type, vec3_t Position, vec3_t TargetPosition, vec
 void CreateJoint(int Type, vec3_t Position, vec3_t TargetPosition, vec3_t Angle, int SubType, OBJECT* Target, float Scale, short PKKey,
     WORD SkillIndex, WORD SkillSerialNum, int iChaIndex, const float* vPriorColor, short int sTargetindex)
 {
-    for (int i = 0; i < MAX_JOINTS; i++)
+    const int i = g_JointPool.Acquire();
+    if (i >= 0)
     {
         JOINT* o = &Joints[i];
         if (!o->Live)
@@ -91,6 +93,7 @@ void CreateJoint(int Type, vec3_t Position, vec3_t TargetPosition, vec3_t Angle,
             }
 
             o->NumTails = 0;
+            o->TailHead = 0;
             float Matrix[3][4];
             vec3_t Position, p;
 
@@ -141,19 +144,20 @@ void CreateJoint(int Type, vec3_t Position, vec3_t TargetPosition, vec3_t Angle,
 
             if (bCreateStartTail)
             {
+                vec3_t* tail = o->GetTail(0);
                 AngleMatrix(o->Angle, Matrix);
                 Vector(-o->Scale * 0.5f, 0.f, 0.f, Position);
                 VectorRotate(Position, Matrix, p);
-                VectorAdd(o->Position, p, o->Tails[0][0]);
+                VectorAdd(o->Position, p, tail[0]);
                 Vector(o->Scale * 0.5f, 0.f, 0.f, Position);
                 VectorRotate(Position, Matrix, p);
-                VectorAdd(o->Position, p, o->Tails[0][1]);
+                VectorAdd(o->Position, p, tail[1]);
                 Vector(0.f, 0.f, -o->Scale * 0.5f, Position);
                 VectorRotate(Position, Matrix, p);
-                VectorAdd(o->Position, p, o->Tails[0][2]);
+                VectorAdd(o->Position, p, tail[2]);
                 Vector(0.f, 0.f, o->Scale * 0.5f, Position);
                 VectorRotate(Position, Matrix, p);
-                VectorAdd(o->Position, p, o->Tails[0][3]);
+                VectorAdd(o->Position, p, tail[3]);
             }
 
             vec3_t BitePosition;
@@ -2765,42 +2769,38 @@ void CreateTailAxis(JOINT* o, float Matrix[3][4], BYTE axis)
         o->NumTails = o->MaxTails - 1;
     }
 
-    for (int j = (int)(o->NumTails - 1); j >= 0; j--)
-    {
-        for (int k = 0; k < 4; k++)
-            VectorCopy(o->Tails[j][k], o->Tails[j + 1][k]);
-    }
+    vec3_t* tail = o->PushTail();
 
     vec3_t Position, p;
     if (axis == 0)
     {
         Vector(-o->Scale * 0.5f, 0.f, 0.f, Position);
         VectorRotate(Position, Matrix, p);
-        VectorAdd(o->Position, p, o->Tails[0][0]);
+        VectorAdd(o->Position, p, tail[0]);
         Vector(o->Scale * 0.5f, 0.f, 0.f, Position);
         VectorRotate(Position, Matrix, p);
-        VectorAdd(o->Position, p, o->Tails[0][1]);
+        VectorAdd(o->Position, p, tail[1]);
         Vector(0.f, 0.f, -o->Scale * 0.5f, Position);
         VectorRotate(Position, Matrix, p);
-        VectorAdd(o->Position, p, o->Tails[0][2]);
+        VectorAdd(o->Position, p, tail[2]);
         Vector(0.f, 0.f, o->Scale * 0.5f, Position);
         VectorRotate(Position, Matrix, p);
-        VectorAdd(o->Position, p, o->Tails[0][3]);
+        VectorAdd(o->Position, p, tail[3]);
     }
     else
     {
         Vector(-o->Scale * 0.5f, 0.f, 0.f, Position);
         VectorRotate(Position, Matrix, p);
-        VectorAdd(o->Position, p, o->Tails[0][0]);
+        VectorAdd(o->Position, p, tail[0]);
         Vector(o->Scale * 0.5f, 0.f, 0.f, Position);
         VectorRotate(Position, Matrix, p);
-        VectorAdd(o->Position, p, o->Tails[0][1]);
+        VectorAdd(o->Position, p, tail[1]);
         Vector(0.f, -o->Scale * 0.5f, 0.f, Position);
         VectorRotate(Position, Matrix, p);
-        VectorAdd(o->Position, p, o->Tails[0][2]);
+        VectorAdd(o->Position, p, tail[2]);
         Vector(0.f, o->Scale * 0.5f, 0.f, Position);
         VectorRotate(Position, Matrix, p);
-        VectorAdd(o->Position, p, o->Tails[0][3]);
+        VectorAdd(o->Position, p, tail[3]);
     }
 }
 
@@ -2818,39 +2818,36 @@ void CreateTail(JOINT* o, float Matrix[3][4], bool Blur)
                 o->NumTails = o->MaxTails - 1;
             }
 
-            for (int j = o->NumTails - 1; j >= 0; j--)
-            {
-                for (int k = 0; k < 4; k++)
-                    VectorCopy(o->Tails[j][k], o->Tails[j + 1][k]);
-            }
+            vec3_t* tail = o->PushTail();
 
             if (i == 0 && (int)o->NumTails > 1)
             {
+                const vec3_t* prev = o->GetTail(1);
                 vec3_t Position, p;
                 Vector(-o->Scale * 0.5f, 0.f, 0.f, Position);
                 VectorRotate(Position, Matrix, p);
-                VectorAdd(o->Position, p, o->Tails[0][0]);
-                o->Tails[0][0][0] = (o->Tails[0][0][0] + o->Tails[1][0][0]) / 2.f;
-                o->Tails[0][0][1] = (o->Tails[0][0][1] + o->Tails[1][0][1]) / 2.f;
-                o->Tails[0][0][2] = (o->Tails[0][0][2] + o->Tails[1][0][2]) / 2.f;
+                VectorAdd(o->Position, p, tail[0]);
+                tail[0][0] = (tail[0][0] + prev[0][0]) / 2.f;
+                tail[0][1] = (tail[0][1] + prev[0][1]) / 2.f;
+                tail[0][2] = (tail[0][2] + prev[0][2]) / 2.f;
                 Vector(o->Scale * 0.5f, 0.f, 0.f, Position);
                 VectorRotate(Position, Matrix, p);
-                VectorAdd(o->Position, p, o->Tails[0][1]);
-                o->Tails[0][1][0] = (o->Tails[0][1][0] + o->Tails[1][1][0]) / 2.f;
-                o->Tails[0][1][1] = (o->Tails[0][1][1] + o->Tails[1][1][1]) / 2.f;
-                o->Tails[0][1][2] = (o->Tails[0][1][2] + o->Tails[1][1][2]) / 2.f;
+                VectorAdd(o->Position, p, tail[1]);
+                tail[1][0] = (tail[1][0] + prev[1][0]) / 2.f;
+                tail[1][1] = (tail[1][1] + prev[1][1]) / 2.f;
+                tail[1][2] = (tail[1][2] + prev[1][2]) / 2.f;
                 Vector(0.f, 0.f, -o->Scale * 0.5f, Position);
                 VectorRotate(Position, Matrix, p);
-                VectorAdd(o->Position, p, o->Tails[0][2]);
-                o->Tails[0][2][0] = (o->Tails[0][2][0] + o->Tails[1][2][0]) / 2.f;
-                o->Tails[0][2][1] = (o->Tails[0][2][1] + o->Tails[1][2][1]) / 2.f;
-                o->Tails[0][2][2] = (o->Tails[0][2][2] + o->Tails[1][2][2]) / 2.f;
+                VectorAdd(o->Position, p, tail[2]);
+                tail[2][0] = (tail[2][0] + prev[2][0]) / 2.f;
+                tail[2][1] = (tail[2][1] + prev[2][1]) / 2.f;
+                tail[2][2] = (tail[2][2] + prev[2][2]) / 2.f;
                 Vector(0.f, 0.f, o->Scale * 0.5f, Position);
                 VectorRotate(Position, Matrix, p);
-                VectorAdd(o->Position, p, o->Tails[0][3]);
-                o->Tails[0][3][0] = (o->Tails[0][3][0] + o->Tails[1][3][0]) / 2.f;
-                o->Tails[0][3][1] = (o->Tails[0][3][1] + o->Tails[1][3][1]) / 2.f;
-                o->Tails[0][3][2] = (o->Tails[0][3][2] + o->Tails[1][3][2]) / 2.f;
+                VectorAdd(o->Position, p, tail[3]);
+                tail[3][0] = (tail[3][0] + prev[3][0]) / 2.f;
+                tail[3][1] = (tail[3][1] + prev[3][1]) / 2.f;
+                tail[3][2] = (tail[3][2] + prev[3][2]) / 2.f;
             }
             else
             {
@@ -2858,19 +2855,19 @@ void CreateTail(JOINT* o, float Matrix[3][4], bool Blur)
 
                 Vector(-o->Scale * 0.5f, 0.f, 0.f, Position);
                 VectorRotate(Position, Matrix, p);
-                VectorAdd(o->Position, p, o->Tails[0][0]);
+                VectorAdd(o->Position, p, tail[0]);
 
                 Vector(o->Scale * 0.5f, 0.f, 0.f, Position);
                 VectorRotate(Position, Matrix, p);
-                VectorAdd(o->Position, p, o->Tails[0][1]);
+                VectorAdd(o->Position, p, tail[1]);
 
                 Vector(0.f, 0.f, -o->Scale * 0.5f, Position);
                 VectorRotate(Position, Matrix, p);
-                VectorAdd(o->Position, p, o->Tails[0][2]);
+                VectorAdd(o->Position, p, tail[2]);
 
                 Vector(0.f, 0.f, o->Scale * 0.5f, Position);
                 VectorRotate(Position, Matrix, p);
-                VectorAdd(o->Position, p, o->Tails[0][3]);
+                VectorAdd(o->Position, p, tail[3]);
             }
         }
     }
@@ -2882,35 +2879,28 @@ void CreateTail(JOINT* o, float Matrix[3][4], bool Blur)
             o->NumTails = o->MaxTails - 1;
         }
 
-        // TODO: Instead of copying, leave it and add new tail values at the end
-        // We need something like a circular buffer here ...
-        for (int j = o->NumTails - 1; j >= 0; j--)
-        {
-            for (int k = 0; k < 4; k++)
-                VectorCopy(o->Tails[j][k], o->Tails[j + 1][k]);
-        }
+        vec3_t* tail = o->PushTail();
 
         vec3_t Position, p;
 
         Vector(-o->Scale * 0.5f, 0.f, 0.f, Position);
         VectorRotate(Position, Matrix, p);
-        VectorAdd(o->Position, p, o->Tails[0][0]);
+        VectorAdd(o->Position, p, tail[0]);
 
         Vector(o->Scale * 0.5f, 0.f, 0.f, Position);
         VectorRotate(Position, Matrix, p);
-        VectorAdd(o->Position, p, o->Tails[0][1]);
+        VectorAdd(o->Position, p, tail[1]);
 
         Vector(0.f, 0.f, -o->Scale * 0.5f, Position);
         VectorRotate(Position, Matrix, p);
-        VectorAdd(o->Position, p, o->Tails[0][2]);
+        VectorAdd(o->Position, p, tail[2]);
 
         Vector(0.f, 0.f, o->Scale * 0.5f, Position);
         VectorRotate(Position, Matrix, p);
-        VectorAdd(o->Position, p, o->Tails[0][3]);
+        VectorAdd(o->Position, p, tail[3]);
     }
 }
 
-
 /*void MoveShpere(vec3_t Position,vec3_t Angle)
 {
 OBJECT *to = &Hero->Object;
@@ -3479,8 +3469,9 @@ void MoveJoint(JOINT* o, int iIndex)
             VectorCopy(o->Target->Position, o->TargetPosition);
             for (int j = o->NumTails - 1; j >= 0; j--)
             {
+                vec3_t* tail = o->GetTail(j);
                 for (int k = 0; k < 4; k++)
-                    VectorSubtract(o->Tails[j][k], Position, o->Tails[j][k]);
+                    VectorSubtract(tail[k], Position, tail[k]);
             }
 
             o->Position[0] = o->TargetPosition[0] + sinf(o->MultiUse * 0.1f) * o->Direction[0];
@@ -3511,8 +3502,9 @@ void MoveJoint(JOINT* o, int iIndex)
             VectorCopy(o->Target->Position, o->TargetPosition);
             for (int j = o->NumTails - 1; j >= 0; j--)
             {
+                vec3_t* tail = o->GetTail(j);
                 for (int k = 0; k < 4; k++)
-                    VectorSubtract(o->Tails[j][k], Position, o->Tails[j][k]);
+                    VectorSubtract(tail[k], Position, tail[k]);
             }
 
             o->Position[0] = o->TargetPosition[0] + sinf(o->MultiUse * 0.1f) * o->Direction[0];
@@ -4396,8 +4388,9 @@ void MoveJoint(JOINT* o, int iIndex)
             {
                 for (int j = o->NumTails - 1; j >= 0; j--)
                 {
+                    vec3_t* tail = o->GetTail(j);
                     for (int k = 0; k < 4; k++)
-                        VectorSubtract(o->Tails[j][k], o->TargetPosition, o->Tails[j][k]);
+                        VectorSubtract(tail[k], o->TargetPosition, tail[k]);
                 }
             }
 
@@ -4420,16 +4413,18 @@ void MoveJoint(JOINT* o, int iIndex)
 
                 for (int j = o->NumTails - 1; j >= 0; j--)
                 {
+                    vec3_t* tail = o->GetTail(j);
                     for (int k = 0; k < 4; k++)
-                        VectorSubtract(o->Tails[j][k], o->StartPosition, o->Tails[j][k]);
+                        VectorSubtract(tail[k], o->StartPosition, tail[k]);
                 }
                 VectorCopy(o->Target->Owner->Position, o->StartPosition);
                 VectorCopy(o->Target->Position, o->TargetPosition);
 
                 for (int j = o->NumTails - 1; j >= 0; j--)
                 {
+                    vec3_t* tail = o->GetTail(j);
                     for (int k = 0; k < 4; k++)
-                        VectorAdd(o->Tails[j][k], o->StartPosition, o->Tails[j][k]);
+                        VectorAdd(tail[k], o->StartPosition, tail[k]);
                 }
             }
             else
@@ -4446,8 +4441,9 @@ void MoveJoint(JOINT* o, int iIndex)
             {
                 for (int j = o->NumTails - 1; j >= 0; j--)
                 {
+                    vec3_t* tail = o->GetTail(j);
                     for (int k = 0; k < 4; k++)
-                        VectorAdd(o->Tails[j][k], o->TargetPosition, o->Tails[j][k]);
+                        VectorAdd(tail[k], o->TargetPosition, tail[k]);
                 }
             }
             int iFrame = static_cast<int>(WorldTime / 40.f);
@@ -5757,8 +5753,9 @@ void MoveJoint(JOINT* o, int iIndex)
 
             for (int j = o->NumTails - 1; j >= 0; j--)
             {
+                vec3_t* tail = o->GetTail(j);
                 for (int k = 0; k < 4; k++)
-                    VectorSubtract(o->Tails[j][k], Position, o->Tails[j][k]);
+                    VectorSubtract(tail[k], Position, tail[k]);
             }
 
             if (o->LifeTime < 20)
@@ -6907,7 +6904,9 @@ void MoveJoint(JOINT* o, int iIndex)
 
 void MoveJoints()
 {
-    for (int i = 0; i < MAX_JOINTS; i++)
+    g_JointPool.Collect();
+
+    for (int i = g_JointPool.First(); i >= 0; i = g_JointPool.Next(i))
     {
         JOINT* o = &Joints[i];
         if (o->Live)
@@ -6919,7 +6918,9 @@ void MoveJoints()
 
 void RenderJoints(BYTE bRenderOneMore)
 {
-    for (int i = 0; i < MAX_JOINTS; i++)
+    BeginQuadBatch();
+
+    for (int i = g_JointPool.First(); i >= 0; i = g_JointPool.Next(i))
     {
         JOINT* o = &Joints[i];
         if (o->Type == BITMAP_JOINT_ENERGY && o->SubType == 54 && o->Target->CurrentAction != MONSTER01_ATTACK1)
@@ -6965,7 +6966,7 @@ void RenderJoints(BYTE bRenderOneMore)
                 case 9:
                 case 10:
                     fAlpha = (float)min(o->LifeTime, 20) * 0.05f;
-                    glColor3f(fAlpha * o->Light[0], fAlpha * o->Light[1], fAlpha * o->Light[2]);
+                    BatchColor3f(fAlpha * o->Light[0], fAlpha * o->Light[1], fAlpha * o->Light[2]);
                     break;
                 case 3:
                 case 5:
@@ -6975,10 +6976,10 @@ void RenderJoints(BYTE bRenderOneMore)
                 case 16:
                 case 14:
                 case 17:
-                    glColor3f(o->Light[0], o->Light[1], o->Light[2]);
+                    BatchColor3f(o->Light[0], o->Light[1], o->Light[2]);
                     break;
                 case 15:
-                    glColor3f(o->Light[0], o->Light[1], o->Light[2]);
+                    BatchColor3f(o->Light[0], o->Light[1], o->Light[2]);
                     EnableAlphaBlendMinus();
                     break;
                 }
@@ -6986,12 +6987,12 @@ void RenderJoints(BYTE bRenderOneMore)
             else if (o->Type == BITMAP_FLARE_BLUE && o->SubType == 20)
             {
                 EnableAlphaBlend2();
-                glColor3fv(o->Light);
+                BatchColor3fv(o->Light);
             }
             else if (o->Type == BITMAP_SMOKE && o->SubType == 0)
             {
                 float fAlpha = (float)min(o->LifeTime, 20) * 0.1f;
-                glColor3f(fAlpha * o->Light[0], fAlpha * o->Light[1], fAlpha * o->Light[2]);
+                BatchColor3f(fAlpha * o->Light[0], fAlpha * o->Light[1], fAlpha * o->Light[2]);
             }
             else if (o->Type == BITMAP_JOINT_SPARK)
             {
@@ -7000,7 +7001,7 @@ void RenderJoints(BYTE bRenderOneMore)
             }
             else
             {
-                glColor3fv(o->Light);
+                BatchColor3fv(o->Light);
             }
 
             BindTexture(o->TexType);
@@ -7017,8 +7018,8 @@ void RenderJoints(BYTE bRenderOneMore)
                     continue;
                 }
 
-                auto currentTail = o->Tails[j];
-                auto nextTail = o->Tails[j + 1];
+                const vec3_t* currentTail = o->GetTail(j);
+                const vec3_t* nextTail = o->GetTail(j + 1);
 
                 float Light1, Light2;
                 if (o->bTileMapping)
@@ -7066,14 +7067,10 @@ void RenderJoints(BYTE bRenderOneMore)
                 {
                     float Luminosity = ((float)((o->MaxTails - j) / (float)(o->MaxTails)) * 2);
                     Luminosity *= powf(o->Light[0], FPS_ANIMATION_FACTOR);
-                    glColor3f(Luminosity, Luminosity, Luminosity);
+                    BatchColor3f(Luminosity, Luminosity, Luminosity);
 
-                    glBegin(GL_QUADS);
-                    glTexCoord2f(Light1, 0.f); glVertex3fv(currentTail[0]);
-                    glTexCoord2f(Light1, 1.f); glVertex3fv(currentTail[1]);
-                    glTexCoord2f(Light2, 1.f); glVertex3fv(nextTail[1]);
-                    glTexCoord2f(Light2, 0.f); glVertex3fv(nextTail[0]);
-                    glEnd();
+                    const float uv[4][2] = { { Light1, 0.f }, { Light1, 1.f }, { Light2, 1.f }, { Light2, 0.f } };
+                    RenderBatchQuad(currentTail[0], currentTail[1], nextTail[1], nextTail[0], uv);
                 }
                 else
                 {
@@ -7095,17 +7092,17 @@ void RenderJoints(BYTE bRenderOneMore)
                             if (fJointHeight > 0)
                             {
                                 Vector(o->Light[0] - fJointHeight, o->Light[1] - fJointHeight, o->Light[2] - fJointHeight, Light);
-                                glColor3fv(Light);
+                                BatchColor3fv(Light);
                             }
                             else
                             {
                                 VectorCopy(o->Light, Light);
-                                glColor3fv(o->Light);//1.f,1.f,1.f);
+                                BatchColor3fv(o->Light);//1.f,1.f,1.f);
                             }
                         }
                         else
                         {
-                            glColor3f(1.f, 1.f, 1.f);
+                            BatchColor3f(1.f, 1.f, 1.f);
                         }
 
                         if (j == ((int)o->NumTails / 2))
@@ -7131,7 +7128,7 @@ void RenderJoints(BYTE bRenderOneMore)
                             float  fJointHeight = (j) * 0.01f;
                             VectorScale(o->Light, powf(0.9978f, FPS_ANIMATION_FACTOR), o->Light);
                             Vector(o->Light[0] - fJointHeight, o->Light[1] - fJointHeight, o->Light[2] - fJointHeight, Light);
-                            glColor3fv(Light);
+                            BatchColor3fv(Light);
 
                             vec3_t  Position;
 
@@ -7152,15 +7149,15 @@ void RenderJoints(BYTE bRenderOneMore)
                         if (tail == j)
                         {
                             float l = o->Light[2] - j;
-                            glColor3f(l, l, l);
+                            BatchColor3f(l, l, l);
                         }
                         else if (tail < j)
                         {
-                            glColor3f(0.f, 0.f, 0.f);
+                            BatchColor3f(0.f, 0.f, 0.f);
                         }
                         else
                         {
-                            glColor3f(0.7f, 0.7f, 0.7f);
+                            BatchColor3f(0.7f, 0.7f, 0.7f);
                         }
                     }
                     else if (o->Type == BITMAP_FLARE + 1 && o->SubType == 6)
@@ -7201,17 +7198,19 @@ void RenderJoints(BYTE bRenderOneMore)
                     {
                         float Luminosity = ((float)(((int)o->NumTails - 1 - j) / (float)(o->MaxTails)) * 2);
 
-                        glColor3f(o->Light[0] * Luminosity, o->Light[1] * Luminosity, o->Light[2] * Luminosity);
+                        BatchColor3f(o->Light[0] * Luminosity, o->Light[1] * Luminosity, o->Light[2] * Luminosity);
                     }
                     else if (o->Type == BITMAP_JOINT_FORCE && o->SubType == 1)
                     {
                         float Luminosity = (1.f - ((int)o->NumTails - j) / (float)(o->NumTails)) * 2.f;
 
-                        glColor3f(o->Light[0] * Luminosity, o->Light[1] * Luminosity, o->Light[2] * Luminosity);
+                        BatchColor3f(o->Light[0] * Luminosity, o->Light[1] * Luminosity, o->Light[2] * Luminosity);
                     }
 #ifdef GUILD_WAR_EVENT
                     if (o->Type == BITMAP_FLARE && o->SubType == 22)
                     {
+                        FlushQuadBatch();
+
                         vec3_t t_bias;
                         VectorSubtract(o->Target->Position, o->StartPosition, t_bias);
                         glMatrixMode(GL_MODELVIEW);
@@ -7221,12 +7220,12 @@ void RenderJoints(BYTE bRenderOneMore)
                         glBegin(GL_QUADS);
                         glTexCoord2f(Light1, 1.f); glVertex3fv(currentTail[2]);
                         glTexCoord2f(Light1, 0.f); glVertex3fv(currentTail[3]);
-                        glTexCoord2f(Light2, 0.f); glVertex3fv(o->Tails[j + 1][3]);
-                        glTexCoord2f(Light2, 1.f); glVertex3fv(o->Tails[j + 1][2]);
+                        glTexCoord2f(Light2, 0.f); glVertex3fv(nextTail[3]);
+                        glTexCoord2f(Light2, 1.f); glVertex3fv(nextTail[2]);
                         glTexCoord2f(Light1, 0.f); glVertex3fv(currentTail[0]);
                         glTexCoord2f(Light1, 1.f); glVertex3fv(currentTail[1]);
-                        glTexCoord2f(Light2, 1.f); glVertex3fv(o->Tails[j + 1][1]);
-                        glTexCoord2f(Light2, 0.f); glVertex3fv(o->Tails[j + 1][0]);
+                        glTexCoord2f(Light2, 1.f); glVertex3fv(nextTail[1]);
+                        glTexCoord2f(Light2, 0.f); glVertex3fv(nextTail[0]);
                         glEnd();
 
                         glPopMatrix();
@@ -7251,12 +7250,8 @@ void RenderJoints(BYTE bRenderOneMore)
 
                     if ((o->RenderFace & RENDER_FACE_ONE) == RENDER_FACE_ONE)
                     {
-                        glBegin(GL_QUADS);
-                        glTexCoord2f(L1, V2); glVertex3fv(currentTail[2]);
-                        glTexCoord2f(L1, V1); glVertex3fv(currentTail[3]);
-                        glTexCoord2f(L2, V1); glVertex3fv(nextTail[3]);
-                        glTexCoord2f(L2, V2); glVertex3fv(nextTail[2]);
-                        glEnd();
+                        const float uv[4][2] = { { L1, V2 }, { L1, V1 }, { L2, V1 }, { L2, V2 } };
+                        RenderBatchQuad(currentTail[2], currentTail[3], nextTail[3], nextTail[2], uv);
                     }
 
                     if ((o->RenderFace & RENDER_FACE_TWO) == RENDER_FACE_TWO)
@@ -7266,12 +7261,8 @@ void RenderJoints(BYTE bRenderOneMore)
                             L1 += Scroll * 2.f;
                             L2 += Scroll * 2.f;
                         }
-                        glBegin(GL_QUADS);
-                        glTexCoord2f(L1, V1); glVertex3fv(currentTail[0]);
-                        glTexCoord2f(L1, V2); glVertex3fv(currentTail[1]);
-                        glTexCoord2f(L2, V2); glVertex3fv(nextTail[1]);
-                        glTexCoord2f(L2, V1); glVertex3fv(nextTail[0]);
-                        glEnd();
+                        const float uv[4][2] = { { L1, V1 }, { L1, V2 }, { L2, V2 }, { L2, V1 } };
+                        RenderBatchQuad(currentTail[0], currentTail[1], nextTail[1], nextTail[0], uv);
                     }
                 }
             }
@@ -7283,14 +7274,18 @@ void RenderJoints(BYTE bRenderOneMore)
             if (o->Type == BITMAP_JOINT_THUNDER + 1 && o->SubType == 6)
             { 
                 vec3_t Light;
+                EndQuadBatch();
                 EnableAlphaBlend();
                 o->Velocity *= powf(1.f / 1.1f, FPS_ANIMATION_FACTOR);
                 Vector(o->Velocity, o->Velocity, o->Velocity, Light);
                 RenderTerrainAlphaBitmap(BITMAP_MAGIC + 1, o->TargetPosition[0], o->TargetPosition[1], 2.f, 2.f, Light);
                 DisableAlphaBlend();
+                BeginQuadBatch();
             }
         }
     }
+
+    EndQuadBatch();
 }
 
 void GetMagicScrew(int iParam, vec3_t vResult, float fSpeedRate)
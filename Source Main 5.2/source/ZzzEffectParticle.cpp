@@ -10,12 +10,14 @@
 #include "ZzzCharacter.h"
 #include "ZzzLodTerrain.h"
 #include "ZzzTexture.h"
+#include "QuadBatch.h"
 #include "ZzzAi.h"
 #include "ZzzEffect.h"
 #include "DSPlaySound.h"
 #include "WSClient.h"
 #include "MapManager.h"
 #include "NewUISystem.h"
+#include "./Utilities/Profiler.h"
 
 vec3_t g_vParticleWind = { 0.0f, 0.0f, 0.0f };
 vec3_t g_vParticleWindVelo = { 0.0f, 0.0f, 0.0f };
@@ -58,7 +60,8 @@ int CreateParticle(int Type, vec3_t Position, vec3_t Angle, vec3_t Light, int Su
         return false;
     }
 
-    for (int i = 0; i < MAX_PARTICLES; i++)
+    const int i = g_ParticlePool.Acquire();
+    if (i >= 0)
     {
         PARTICLE* o = &Particles[i];
         if (!o->Live)
@@ -3835,6 +3838,8 @@ int CreateParticle(int Type, vec3_t Position, vec3_t Angle, vec3_t Light, int Su
 
 void MoveParticles()
 {
+    PROFILE_SCOPE("MoveParticles");
+
     if (!g_pOption->GetRenderAllEffects())
     {
         return;
@@ -3856,7 +3861,9 @@ void MoveParticles()
 
     int count = 0;
 
-    for (int i = 0; i < MAX_PARTICLES; i++)
+    g_ParticlePool.Collect();
+
+    for (int i = g_ParticlePool.First(); i >= 0; i = g_ParticlePool.Next(i))
     {
         PARTICLE* o = &Particles[i];
 
@@ -8894,12 +8901,16 @@ void MoveParticles()
 
 void RenderParticles(BYTE byRenderOneMore)
 {
+    PROFILE_SCOPE("RenderParticles");
+
     if (!g_pOption->GetRenderAllEffects())
     {
         return;
     }
 
-    for (int i = 0; i < MAX_PARTICLES; i++)
+    BeginQuadBatch();
+
+    for (int i = g_ParticlePool.First(); i >= 0; i = g_ParticlePool.Next(i))
     {
         PARTICLE* o = &Particles[i];
         if (o->Live)
@@ -9025,9 +9036,11 @@ void RenderParticles(BYTE byRenderOneMore)
             case BITMAP_ADV_SMOKE + 1:
                 if (o->SubType == 2)
                 {
+                    FlushQuadBatch();
                     glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_ADD);
                     EnableAlphaBlend3();
                     RenderSprite(o->TexType, o->Position, Width, Height, o->Light, o->Rotation);
+                    FlushQuadBatch();
                     glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
                 }
                 else
@@ -9270,4 +9283,6 @@ void RenderParticles(BYTE byRenderOneMore)
             }
         }
     }
+
+    EndQuadBatch();
 }
\ No newline at end of file
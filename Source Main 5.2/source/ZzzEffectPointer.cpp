@@ -15,48 +15,55 @@
 #include "WSClient.h"
 
 PARTICLE  Pointers[MAX_POINTERS];
+SlotPool<PARTICLE, MAX_POINTERS> g_PointerPool(Pointers, L"Pointer");
 
 void CreatePointer(int Type, vec3_t Position, float Angle, vec3_t Light, float Scale)
 {
-    PARTICLE* Select = NULL;
-    int MinLifeTime = 9999;
-    for (int i = 0; i < MAX_POINTERS; i++)
+    const int i = g_PointerPool.Acquire();
+    if (i < 0)
     {
-        PARTICLE* o = &Pointers[i];
-        if (!o->Live)
-        {
-            o->Live = true;
-            o->Type = Type;
-            VectorCopy(Position, o->Position);
-            VectorCopy(Light, o->Light);
-            o->Angle[2] = Angle;
-            o->Alpha = 1.f;
-            o->Scale = Scale;
-            switch (Type)
-            {
-            case BITMAP_BLOOD:
-            case BITMAP_BLOOD + 1:
-            case BITMAP_FOOT:
-                o->LifeTime = 50 + rand() % 32;
-                break;
-            }
-            return;
-        }
-        else
+        // Full: retire the oldest mark so the next one has room.
+        PARTICLE* Select = NULL;
+        int MinLifeTime = 9999;
+        for (int k = g_PointerPool.First(); k >= 0; k = g_PointerPool.Next(k))
         {
+            PARTICLE* o = &Pointers[k];
             if (MinLifeTime > o->LifeTime)
             {
                 MinLifeTime = o->LifeTime;
                 Select = o;
             }
         }
+        if (Select != NULL)
+        {
+            Select->Live = false;
+        }
+        return;
+    }
+
+    PARTICLE* o = &Pointers[i];
+    o->Live = true;
+    o->Type = Type;
+    VectorCopy(Position, o->Position);
+    VectorCopy(Light, o->Light);
+    o->Angle[2] = Angle;
+    o->Alpha = 1.f;
+    o->Scale = Scale;
+    switch (Type)
+    {
+    case BITMAP_BLOOD:
+    case BITMAP_BLOOD + 1:
+    case BITMAP_FOOT:
+        o->LifeTime = 50 + rand() % 32;
+        break;
     }
-    Select->Live = false;
 }
 
 void MovePointers()
 {
-    for (int i = 0; i < MAX_POINTERS; i++)
+    g_PointerPool.Collect();
+
+    for (int i = g_PointerPool.First(); i >= 0; i = g_PointerPool.Next(i))
     {
         PARTICLE* o = &Pointers[i];
         if (o->Live)
@@ -87,7 +94,7 @@ void MovePointers()
 void RenderPointers()
 {
     EnableAlphaBlend();
-    for (int i = 0; i < MAX_POINTERS; i++)
+    for (int i = g_PointerPool.First(); i >= 0; i = g_PointerPool.Next(i))
     {
         PARTICLE* o = &Pointers[i];
         if (o->Live)
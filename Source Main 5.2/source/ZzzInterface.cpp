@@ -48,6 +48,7 @@
 #include "CharacterManager.h"
 #include "SkillManager.h"
 #include "MUHelper/MuHelper.h"
+#include "TerrainMesh.h"
 
 #include "ZzzInterface.h"
 
@@ -9247,6 +9248,7 @@ void EditObjects()
                     if (TerrainMappingAlpha[Index3] > 1.f) TerrainMappingAlpha[Index3] = 1.f;
                     if (TerrainMappingAlpha[Index4] > 1.f) TerrainMappingAlpha[Index4] = 1.f;
                 }
+                InvalidateTerrainMesh();
             }
             if (MouseRButton)
             {
@@ -9264,6 +9266,7 @@ void EditObjects()
                     TerrainMappingAlpha[Index3] = 0.f;
                     TerrainMappingAlpha[Index4] = 0.f;
                 }
+                InvalidateTerrainMesh();
             }
         }
     }
@@ -10101,7 +10101,7 @@ void RenderObjectScreen(int Type, int ItemLevel, int excellentFlags, int ancient
     RenderPartObject(o, Type, NULL, Light, alpha, ItemLevel, excellentFlags, ancientDiscriminator, true, true, true);
 }
 
-void RenderItem3D(float sx, float sy, float Width, float Height, int Type, int Level, int excellentFlags, int ancientDiscriminator, bool PickUp)
+bool IsItem3DSelected(float sx, float sy, float Width, float Height, bool PickUp)
 {
     bool Success = false;
     if ((g_pPickedItem == NULL || PickUp)
@@ -10119,7 +10119,17 @@ void RenderItem3D(float sx, float sy, float Width, float Height, int Type, int L
                 Success = true;
         }
     }
+    return Success;
+}
 
+void RenderItem3D(float sx, float sy, float Width, float Height, int Type, int Level, int excellentFlags, int ancientDiscriminator, bool PickUp)
+{
+    const bool Success = IsItem3DSelected(sx, sy, Width, Height, PickUp);
+    RenderItem3DModel(sx, sy, Width, Height, Type, Level, excellentFlags, ancientDiscriminator, Success, PickUp);
+}
+
+void RenderItem3DModel(float sx, float sy, float Width, float Height, int Type, int Level, int excellentFlags, int ancientDiscriminator, bool Success, bool PickUp)
+{
     if (Type >= ITEM_SWORD && Type < ITEM_SWORD + MAX_ITEM_INDEX)
     {
         sx += Width * 0.8f;
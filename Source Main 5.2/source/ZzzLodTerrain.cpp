@@ -24,6 +24,11 @@
 
 #include "w_MapHeaders.h"
 #include "CameraMove.h"
+#include "./Utilities/JobSystem.h"
+#include "./Utilities/Profiler.h"
+#include "TerrainMesh.h"
+#include "TerrainLightBatch.h"
+#include "RenderQueue.h"
 
 //-------------------------------------------------------------------------------------------------------------
 
@@ -101,6 +106,163 @@ void InitTerrainMappingLayer()
     }
 }
 
+static std::map<std::wstring, std::vector<BYTE>> g_PrefetchedMapFiles;
+static std::map<std::wstring, std::vector<float>> g_PrefetchedTerrainLight;
+
+static std::wstring MapFileKey(const wchar_t* FileName)
+{
+    std::wstring key = FileName;
+    std::transform(key.begin(), key.end(), key.begin(), towlower);
+    return key;
+}
+
+static bool DecryptMapFile(const wchar_t* FileName, std::vector<BYTE>& Data)
+{
+    FILE* fp = _wfopen(FileName, L"rb");
+    if (fp == NULL)
+    {
+        return false;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    const int EncBytes = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    std::vector<BYTE> EncData(EncBytes);
+    fread(EncData.data(), 1, EncBytes, fp);
+    fclose(fp);
+
+    Data.resize(MapFileDecrypt(NULL, EncData.data(), EncBytes));
+    MapFileDecrypt(Data.data(), EncData.data(), EncBytes);
+    return true;
+}
+
+// "World1\\TerrainHeight.bmp" -> "Data\\World1\\TerrainHeight.OZB"
+static void GetTerrainHeightFileName(const wchar_t* filename, wchar_t* FileName, size_t Size)
+{
+    wchar_t NewFileName[256];
+
+    for (int i = 0; i < (int)wcslen(filename); i++)
+    {
+        NewFileName[i] = filename[i];
+        NewFileName[i + 1] = NULL;
+        if (filename[i] == '.')
+            break;
+    }
+
+    wcscpy_s(FileName, Size, L"Data\\");
+    wcscat_s(FileName, Size, NewFileName);
+    wcscat_s(FileName, Size, L"OZB");
+}
+
+static bool ReadPlainFile(const wchar_t* FileName, std::vector<BYTE>& Data)
+{
+    FILE* fp = _wfopen(FileName, L"rb");
+    if (fp == NULL)
+    {
+        return false;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    const int Bytes = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    Data.resize(Bytes > 0 ? Bytes : 0);
+    fread(Data.data(), 1, Data.size(), fp);
+    fclose(fp);
+    return true;
+}
+
+// The height map is not encrypted; it shares the prefetch map under its .OZB name.
+static bool ReadTerrainHeightFile(const wchar_t* FileName, std::vector<BYTE>& Data)
+{
+    auto mi = g_PrefetchedMapFiles.find(MapFileKey(FileName));
+    if (mi != g_PrefetchedMapFiles.end())
+    {
+        Data.swap(mi->second);
+        g_PrefetchedMapFiles.erase(mi);
+        return true;
+    }
+
+    return ReadPlainFile(FileName, Data);
+}
+
+void PrefetchMapFiles(const std::vector<std::wstring>& FileNames, const wchar_t* HeightFileName, const wchar_t* LightFileName)
+{
+    const int count = static_cast<int>(FileNames.size());
+    std::vector<std::vector<BYTE>> Data(count);
+    std::vector<char> Found(count, 0);
+
+    wchar_t HeightPath[256] = { 0, };
+    std::vector<BYTE> Height;
+    bool bHeightFound = false;
+    if (HeightFileName != NULL)
+    {
+        GetTerrainHeightFileName(HeightFileName, HeightPath, std::size(HeightPath));
+    }
+
+    std::vector<float> Light;
+    bool bLightDecoded = false;
+
+    // the last two jobs read the height map and decode the light map
+    JobSystem::Instance()->ParallelFor(count + 2, [&](int i)
+    {
+        if (i < count)
+        {
+            Found[i] = DecryptMapFile(FileNames[i].c_str(), Data[i]) ? 1 : 0;
+        }
+        else if (i == count)
+        {
+            bHeightFound = HeightFileName != NULL && ReadPlainFile(HeightPath, Height);
+        }
+        else if (LightFileName != NULL)
+        {
+            bool bFileExists = false;
+            bLightDecoded = DecodeJpegBuffer(LightFileName, Light, bFileExists);
+        }
+    });
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (Found[i])
+        {
+            g_PrefetchedMapFiles[MapFileKey(FileNames[i].c_str())].swap(Data[i]);
+        }
+    }
+
+    if (bHeightFound)
+    {
+        g_PrefetchedMapFiles[MapFileKey(HeightPath)].swap(Height);
+    }
+
+    if (bLightDecoded)
+    {
+        g_PrefetchedTerrainLight[MapFileKey(LightFileName)].swap(Light);
+    }
+}
+
+void ClearPrefetchedMapFiles()
+{
+    g_PrefetchedMapFiles.clear();
+    g_PrefetchedTerrainLight.clear();
+}
+
+bool ReadMapFile(const wchar_t* FileName, std::vector<BYTE>& Data)
+{
+    if (!g_PrefetchedMapFiles.empty())
+    {
+        auto mi = g_PrefetchedMapFiles.find(MapFileKey(FileName));
+        if (mi != g_PrefetchedMapFiles.end())
+        {
+            Data.swap(mi->second);
+            g_PrefetchedMapFiles.erase(mi);
+            return true;
+        }
+    }
+
+    return DecryptMapFile(FileName, Data);
+}
+
 void ExitProgram()
 {
     MessageBoxW(g_hWnd, GlobalText[11], NULL, MB_OK);
@@ -110,8 +272,10 @@ void ExitProgram()
 
 int OpenTerrainAttribute(wchar_t* FileName)
 {
-    FILE* fp = _wfopen(FileName, L"rb");
-    if (fp == NULL)
+    InvalidateTerrainMesh();
+
+    std::vector<BYTE> decrypted_data;
+    if (!ReadMapFile(FileName, decrypted_data))
     {
         wchar_t Text[256];
         swprintf(Text, L"%s file not found.", FileName);
@@ -121,24 +285,12 @@ int OpenTerrainAttribute(wchar_t* FileName)
         SendMessage(g_hWnd, WM_DESTROY, 0, 0);
         return (-1);
     }
-    // Read file data
-    fseek(fp, 0, SEEK_END);
-    long file_size = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-    auto* file_data = new unsigned char[file_size];
-    fread(file_data, file_size, 1, fp);
-
-    // Decrypt file data
-    int iSize = MapFileDecrypt(NULL, file_data, file_size);
-    auto* decrypted_data = new unsigned char[iSize];
-    MapFileDecrypt(decrypted_data, file_data, file_size);
-    delete[] file_data;
+    const int iSize = static_cast<int>(decrypted_data.size());
 
     // Check file size
     bool extAtt = false;
     if (iSize != (TERRAIN_SIZE * TERRAIN_SIZE + 4) && iSize != (TERRAIN_SIZE * TERRAIN_SIZE * sizeof(WORD) + 4))
     {
-        delete[] decrypted_data;
         return (-1);
     }
     if (iSize == (TERRAIN_SIZE * TERRAIN_SIZE * sizeof(WORD) + 4))
@@ -147,7 +299,7 @@ int OpenTerrainAttribute(wchar_t* FileName)
     }
 
     // Extract file header
-    BuxConvert(decrypted_data, iSize);
+    BuxConvert(decrypted_data.data(), iSize);
     BYTE Version = decrypted_data[0];
     int iMap = decrypted_data[1];
     BYTE Width = decrypted_data[2];
@@ -169,8 +321,6 @@ int OpenTerrainAttribute(wchar_t* FileName)
         memcpy(TerrainWall, &decrypted_data[4], TERRAIN_SIZE * TERRAIN_SIZE * sizeof(WORD));
     }
 
-    delete[] decrypted_data;
-
     // Check file header
     bool Error = false;
     if (Version != 0 || Width != 255 || Height != 255)
@@ -211,7 +361,6 @@ int OpenTerrainAttribute(wchar_t* FileName)
         return (-1);
     }
 
-    fclose(fp);
     return iMap;
 }
 
@@ -248,6 +397,9 @@ void AddTerrainAttribute(int x, int y, BYTE att)
 {
     int     iIndex = (x + (y * TERRAIN_SIZE));
     TerrainWall[iIndex] |= att;
+
+    if (att & (TW_NOGROUND | TW_HEIGHT))
+        InvalidateTerrainMeshArea(x, y, 1);
 }
 
 void SubTerrainAttribute(int x, int y, BYTE att)
@@ -255,6 +407,9 @@ void SubTerrainAttribute(int x, int y, BYTE att)
     int     iIndex = (x + (y * TERRAIN_SIZE));
 
     TerrainWall[iIndex] ^= (TerrainWall[iIndex] & att);
+
+    if (att & (TW_NOGROUND | TW_HEIGHT))
+        InvalidateTerrainMeshArea(x, y, 1);
 }
 
 void AddTerrainAttributeRange(int x, int y, int dx, int dy, BYTE att, BYTE Add)
@@ -277,6 +432,8 @@ void AddTerrainAttributeRange(int x, int y, int dx, int dy, BYTE att, BYTE Add)
 
 void SetTerrainWaterState(std::list<int>& terrainIndex, int state)
 {
+    InvalidateTerrainMesh();
+
     if (state == 0)
     {
         terrainIndex.clear();
@@ -301,28 +458,17 @@ void SetTerrainWaterState(std::list<int>& terrainIndex, int state)
 
 int OpenTerrainMapping(wchar_t* FileName) {
     InitTerrainMappingLayer();
-    FILE* fp = _wfopen(FileName, L"rb");
-    if (fp == NULL) {
+    InvalidateTerrainMesh();
+    std::vector<BYTE> FileData;
+    if (!ReadMapFile(FileName, FileData)) {
         return -1;
     }
-
-    fseek(fp, 0, SEEK_END);
-    int EncBytes = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-
-    auto* EncData = new unsigned char[EncBytes];
-    fread(EncData, 1, EncBytes, fp);
-    fclose(fp);
-
-    int DataBytes = MapFileDecrypt(NULL, EncData, EncBytes);
-    auto* Data = new unsigned char[DataBytes];
-    MapFileDecrypt(Data, EncData, EncBytes);
-    delete[] EncData;
+    const BYTE* Data = FileData.data();
 
     int DataPtr = 0;
     DataPtr += 1;
 
-    int iMapNumber = static_cast<int>(*reinterpret_cast<BYTE*>(Data + DataPtr));
+    int iMapNumber = static_cast<int>(*(Data + DataPtr));
     DataPtr += 1;
 
     memcpy(TerrainMappingLayer1, Data + DataPtr, 256 * 256);
@@ -337,8 +483,6 @@ int OpenTerrainMapping(wchar_t* FileName) {
         TerrainMappingAlpha[i] = static_cast<float>(Alpha) / 255.f;
     }
 
-    delete[] Data;
-
     TerrainGrassEnable = true;
 
     if (gMapManager.InChaosCastle() || gMapManager.InBattleCastle()) {
@@ -549,7 +693,16 @@ void CreateTerrainLight_Part(int xi, int yi)
 
 void OpenTerrainLight(wchar_t* FileName)
 {
-    OpenJpegBuffer(FileName, &TerrainLight[0][0]);
+    auto mi = g_PrefetchedTerrainLight.find(MapFileKey(FileName));
+    if (mi != g_PrefetchedTerrainLight.end())
+    {
+        memcpy(&TerrainLight[0][0], mi->second.data(), mi->second.size() * sizeof(float));
+        g_PrefetchedTerrainLight.erase(mi);
+    }
+    else
+    {
+        OpenJpegBuffer(FileName, &TerrainLight[0][0]);
+    }
     // Apply corrections to the loaded terrain light
     for (int i = 0; i < TERRAIN_SIZE * TERRAIN_SIZE; i++)
     {
@@ -619,27 +772,15 @@ bool IsTerrainHeightExtMap(int iWorld)
 
 bool OpenTerrainHeight(wchar_t* filename)
 {
+    InvalidateTerrainMesh();
+
     const int Index = 1080;
     const int Size = 256 * 256 + Index;
     wchar_t FileName[256];
+    GetTerrainHeightFileName(filename, FileName, std::size(FileName));
 
-    wchar_t NewFileName[256];
-
-    for (int i = 0; i < (int)wcslen(filename); i++)
-    {
-        NewFileName[i] = filename[i];
-        NewFileName[i + 1] = NULL;
-        if (filename[i] == '.')
-            break;
-    }
-
-    wcscpy_s(FileName, L"Data\\");
-    wcscat_s(FileName, NewFileName);
-    wcscat_s(FileName, L"OZB");
-
-    FILE* fp;
-    errno_t err = _wfopen_s(&fp, FileName, L"rb");
-    if (err != 0 || fp == NULL)
+    std::vector<BYTE> FileData;
+    if (!ReadTerrainHeightFile(FileName, FileData))
     {
         wchar_t Text[256];
         swprintf_s(Text, L"%s file not found.", FileName);
@@ -650,11 +791,13 @@ bool OpenTerrainHeight(wchar_t* filename)
         return false;
     }
 
-    auto* Buffer = new unsigned char[Size];
+    auto* Buffer = new unsigned char[Size]();
 
-    fseek(fp, 4, SEEK_SET);
-    fread_s(Buffer, Size, 1, Size, fp);
-    fclose(fp);
+    // the first 4 bytes are the OZB header
+    if (FileData.size() > 4)
+    {
+        memcpy(Buffer, &FileData[4], min((size_t)Size, FileData.size() - 4));
+    }
 
     memcpy(BMPHeader, Buffer, Index);
 
@@ -704,24 +847,13 @@ void SaveTerrainHeight(wchar_t* name)
 
 bool OpenTerrainHeightNew(const wchar_t* strFilename)
 {
-    wchar_t FileName[256];
-    wchar_t NewFileName[256];
-
-    for (int i = 0; i < (int)wcslen(strFilename); ++i)
-    {
-        NewFileName[i] = strFilename[i];
-        NewFileName[i + 1] = NULL;
-
-        if (strFilename[i] == '.')
-            break;
-    }
+    InvalidateTerrainMesh();
 
-    wcscpy(FileName, L"Data\\");
-    wcscat(FileName, NewFileName);
-    wcscat(FileName, L"OZB");
+    wchar_t FileName[256];
+    GetTerrainHeightFileName(strFilename, FileName, std::size(FileName));
 
-    FILE* fp = _wfopen(FileName, L"rb");
-    if (!fp)
+    std::vector<BYTE> FileData;
+    if (!ReadTerrainHeightFile(FileName, FileData))
     {
         wchar_t Text[256];
         swprintf(Text, L"%s file not found.", FileName);
@@ -732,13 +864,11 @@ bool OpenTerrainHeightNew(const wchar_t* strFilename)
         return false;
     }
 
-    fseek(fp, 0, SEEK_END);
-    int iBytes = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-
-    BYTE* pbyData = new BYTE[iBytes];
-    fread(pbyData, 1, iBytes, fp);
-    fclose(fp);
+    if (FileData.size() < 4 + sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER) + TERRAIN_SIZE * TERRAIN_SIZE * 3)
+    {
+        return false;
+    }
+    BYTE* pbyData = FileData.data();
 
     DWORD dwCurPos = 0;
     dwCurPos += 4;
@@ -767,7 +897,6 @@ bool OpenTerrainHeightNew(const wchar_t* strFilename)
         BackTerrainHeight[i] += g_fMinHeight;
     }
 
-    delete[] pbyData;
     return true;
 }
 
@@ -825,6 +954,8 @@ void AddTerrainHeight(float xf, float yf, float Height, int Range, float* Buffer
     yf = yf / TERRAIN_SCALE;
     int   xi = (int)xf;
     int   yi = (int)yf;
+    if (Buffer == BackTerrainHeight)
+        InvalidateTerrainMeshArea(xi, yi, Range + 1);
     int   syi = yi - Range;
     int   eyi = yi + Range;
     auto syf = (float)(syi);
@@ -881,6 +1012,12 @@ void SetTerrainLight(float xf, float yf, vec3_t Light, int Range, vec3_t* Buffer
 
 void AddTerrainLight(float xf, float yf, vec3_t Light, int Range, vec3_t* Buffer)
 {
+    if (Buffer == PrimaryTerrainLight)
+    {
+        QueueTerrainLight(xf, yf, Light, Range, false);
+        return;
+    }
+
     auto rf = (float)Range;
 
     xf = (xf / TERRAIN_SCALE);
@@ -915,6 +1052,12 @@ void AddTerrainLight(float xf, float yf, vec3_t Light, int Range, vec3_t* Buffer
 
 void AddTerrainLightClip(float xf, float yf, vec3_t Light, int Range, vec3_t* Buffer)
 {
+    if (Buffer == PrimaryTerrainLight)
+    {
+        QueueTerrainLight(xf, yf, Light, Range, true);
+        return;
+    }
+
     auto rf = (float)Range;
 
     xf = (xf / TERRAIN_SCALE);
@@ -959,6 +1102,8 @@ void RequestTerrainLight(float xf, float yf, vec3_t Light)
         return;
     }
 
+    FlushTerrainLights();
+
     xf = xf / TERRAIN_SCALE;
     yf = yf / TERRAIN_SCALE;
     int xi = (int)xf;
@@ -1345,14 +1490,14 @@ inline void VertexBlend3()
     glVertex3fv(TerrainVertex[3]);
 }
 
-void RenderFace(int Texture, int mx, int my)
+bool SetTerrainFaceState(int Texture)
 {
     if (gMapManager.WorldActive == WD_39KANTURU_3RD)
     {
         if (Texture == 3)
             EnableAlphaTest();
         else if (Texture == 100)
-            return;
+            return false;
         else
             DisableAlphaBlend();
     }
@@ -1403,8 +1548,16 @@ void RenderFace(int Texture, int mx, int my)
 #endif	// ASG_ADD_MAP_KARUTAN
     else
         DisableAlphaBlend();
+    return true;
+}
+
+void RenderFace(int Texture, int mx, int my)
+{
+    if (!SetTerrainFaceState(Texture))
+        return;
     BindTexture(BITMAP_MAPTILE + Texture);
 
+    ++g_RenderCounters.DrawCalls;
     glBegin(GL_TRIANGLE_FAN);
     Vertex0();
     Vertex1();
@@ -1424,6 +1577,7 @@ void RenderFace_After(int Texture, int mx, int my)
 
     BindTexture(BITMAP_MAPTILE + Texture);
 
+    ++g_RenderCounters.DrawCalls;
     glBegin(GL_TRIANGLE_FAN);
     Vertex0();
     Vertex1();
@@ -1436,6 +1590,7 @@ void RenderFaceAlpha(int Texture, int mx, int my)
 {
     EnableAlphaTest();
     BindTexture(BITMAP_MAPTILE + Texture);
+    ++g_RenderCounters.DrawCalls;
     glBegin(GL_TRIANGLE_FAN);
     VertexAlpha0();
     VertexAlpha1();
@@ -1448,6 +1603,7 @@ void RenderFaceBlend(int Texture, int mx, int my)
 {
     EnableAlphaBlend();
     BindTexture(BITMAP_MAPTILE + Texture);
+    ++g_RenderCounters.DrawCalls;
     glBegin(GL_TRIANGLE_FAN);
     VertexBlend0();
     VertexBlend1();
@@ -1456,10 +1612,21 @@ void RenderFaceBlend(int Texture, int mx, int my)
     glEnd();
 }
 
+void CreateTerrainWaterSpot(float xf, float yf)
+{
+    if (rand_fps_check(50))
+    {
+        vec3_t Light, Pos;
+        Vector(0.30f, 0.40f, 0.20f, Light);
+        float sx = xf * TERRAIN_SCALE + (float)((rand() % 100 + 1) * 1.0f);
+        float sy = yf * TERRAIN_SCALE + (float)((rand() % 100 + 1) * 1.0f);
+        Vector(sx, sy, Hero->Object.Position[2] + 10.f, Pos);
+        CreateParticle(BITMAP_SPOT_WATER, Pos, Hero->Object.Angle, Light, 0);
+    }
+}
+
 void FaceTexture(int Texture, float xf, float yf, bool Water, bool Scale)
 {
-    vec3_t Light, Pos;
-    Vector(0.30f, 0.40f, 0.20f, Light);
     BITMAP_t* b = &Bitmaps[BITMAP_MAPTILE + Texture];
     float Width, Height;
     if (Scale)
@@ -1489,13 +1656,7 @@ void FaceTexture(int Texture, float xf, float yf, bool Water, bool Scale)
         float Water4 = 0.f;
         if (gMapManager.WorldActive == WD_34CRYWOLF_1ST && Texture == 5)
         {
-            if (rand_fps_check(50))
-            {
-                float sx = xf * TERRAIN_SCALE + (float)((rand() % 100 + 1) * 1.0f);
-                float sy = yf * TERRAIN_SCALE + (float)((rand() % 100 + 1) * 1.0f);
-                Vector(sx, sy, Hero->Object.Position[2] + 10.f, Pos);
-                CreateParticle(BITMAP_SPOT_WATER, Pos, Hero->Object.Angle, Light, 0);
-            }
+            CreateTerrainWaterSpot(xf, yf);
         }
 
         if (gMapManager.WorldActive == WD_30BATTLECASTLE && Texture == 5)
@@ -1838,6 +1999,7 @@ void RenderTerrainBitmapTile(float xf, float yf, float lodf, int lodi, vec3_t c[
     vec3_t Light[4];
     if (LightEnable)
     {
+        FlushTerrainLights();
         VectorCopy(PrimaryTerrainLight[TerrainIndex1], Light[0]);
         VectorCopy(PrimaryTerrainLight[TerrainIndex2], Light[1]);
         VectorCopy(PrimaryTerrainLight[TerrainIndex3], Light[2]);
@@ -2157,6 +2319,32 @@ bool TestFrustrum2D(float x, float y, float Range)
     return true;
 }
 
+bool TestFrustrum2DRect(float MinX, float MinY, float MaxX, float MaxY)
+{
+    if (SceneFlag == SERVER_LIST_SCENE || SceneFlag == WEBZEN_SCENE || SceneFlag == LOADING_SCENE)
+        return true;
+
+    const float x[4] = { MinX, MaxX, MaxX, MinX };
+    const float y[4] = { MinY, MinY, MaxY, MaxY };
+
+    // culled only when every corner is outside the same edge
+    int j = 3;
+    for (int i = 0; i < 4; j = i, i++)
+    {
+        int k = 0;
+        for (; k < 4; k++)
+        {
+            float d = (FrustrumX[i] - x[k]) * (FrustrumY[j] - y[k]) -
+                (FrustrumX[j] - x[k]) * (FrustrumY[i] - y[k]);
+            if (d > 0.f)
+                break;
+        }
+        if (k == 4)
+            return false;
+    }
+    return true;
+}
+
 void CreateFrustrum(float xAspect, float yAspect, vec3_t position)
 {
     const auto fovv = tanf(CameraFOV * Q_PI / 360.f);
@@ -2332,19 +2520,59 @@ void DeleteAllFrustrum()
 extern float RainCurrent;
 extern int EnableEvent;
 
-void InitTerrainLight()
+enum { WIND_SLOW, WIND_FAST, WIND_TABLES };
+
+static float g_fWindSin[WIND_TABLES][TERRAIN_SIZE];
+static float g_fWindCos[WIND_TABLES][TERRAIN_SIZE];
+static bool  g_bWindTable = false;
+
+static void CreateGrassWindTable()
 {
-    int xi, yi;
-    yi = FrustrumBoundMinY;
-    for (; yi <= FrustrumBoundMaxY + 3; yi += 1)
+    const double Frequency[WIND_TABLES] = { 5.0, 50.0 };
+    for (int i = 0; i < WIND_TABLES; i++)
     {
-        xi = FrustrumBoundMinX;
-        for (; xi <= FrustrumBoundMaxX + 3; xi += 1)
+        for (int x = 0; x < TERRAIN_SIZE; x++)
         {
-            int Index = TERRAIN_INDEX_REPEAT(xi, yi);
-            VectorCopy(BackTerrainLight[Index], PrimaryTerrainLight[Index]);
+            g_fWindSin[i][x] = (float)sin(x * Frequency[i]);
+            g_fWindCos[i][x] = (float)cos(x * Frequency[i]);
         }
     }
+    g_bWindTable = true;
+}
+
+// Buffer = sinf(Speed + x * Frequency) * Scale over the rectangle. The wind only depends
+// on x, so one row is built from the angle sum and copied to the others.
+static void FillGrassWind(float* Buffer, int Table, float Speed, float Scale, int MinX, int MinY, int MaxX, int MaxY)
+{
+    const float s = sinf(Speed) * Scale;
+    const float c = cosf(Speed) * Scale;
+    const int Count = MaxX - MinX + 1;
+
+    float* Row = &Buffer[TERRAIN_INDEX(MinX, MinY)];
+    for (int x = MinX; x <= MaxX; x++)
+    {
+        Row[x - MinX] = s * g_fWindCos[Table][x] + c * g_fWindSin[Table][x];
+    }
+    for (int y = MinY + 1; y <= MaxY; y++)
+    {
+        memcpy(&Buffer[TERRAIN_INDEX(MinX, y)], Row, Count * sizeof(float));
+    }
+}
+
+void InitTerrainLight()
+{
+    const int MaxX = min(FrustrumBoundMaxX + 3, TERRAIN_SIZE_MASK);
+    const int MaxY = min(FrustrumBoundMaxY + 3, TERRAIN_SIZE_MASK);
+    const int Count = MaxX - FrustrumBoundMinX + 1;
+
+    BeginTerrainLights(FrustrumBoundMinX, FrustrumBoundMinY, MaxX, MaxY);
+
+    for (int yi = FrustrumBoundMinY; yi <= MaxY; yi++)
+    {
+        int Index = TERRAIN_INDEX(FrustrumBoundMinX, yi);
+        memcpy(PrimaryTerrainLight[Index], BackTerrainLight[Index], Count * sizeof(vec3_t));
+    }
+
     float WindScale;
     float WindSpeed;
 
@@ -2367,37 +2595,28 @@ void InitTerrainLight()
         WindSpeed1 = (int)WorldTime % 36000 * (0.008f);
     }
 #endif	// ASG_ADD_MAP_KARUTAN
-    yi = FrustrumBoundMinY;
 
-    for (; yi <= min(FrustrumBoundMaxY + 3, TERRAIN_SIZE_MASK); yi += 1)
+    if (!g_bWindTable)
+        CreateGrassWindTable();
+
+    if (gMapManager.WorldActive == WD_8TARKAN)
     {
-        xi = FrustrumBoundMinX;
-        auto xf = (float)xi;
-        for (; xi <= min(FrustrumBoundMaxX + 3, TERRAIN_SIZE_MASK); xi += 1, xf += 1.f)
-        {
-            int Index = TERRAIN_INDEX(xi, yi);
-            if (gMapManager.WorldActive == WD_8TARKAN)
-            {
-                TerrainGrassWind[Index] = sinf(WindSpeed + xf * 50.f) * WindScale;
-            }
+        FillGrassWind(TerrainGrassWind, WIND_FAST, WindSpeed, WindScale, FrustrumBoundMinX, FrustrumBoundMinY, MaxX, MaxY);
+    }
 #ifdef ASG_ADD_MAP_KARUTAN
-            else if (IsKarutanMap())
-            {
-                TerrainGrassWind[Index] = sinf(WindSpeed + xf * 50.f) * WindScale;
-                g_fTerrainGrassWind1[Index] = sinf(WindSpeed1 + xf * 50.f) * WindScale1;
-            }
+    else if (IsKarutanMap())
+    {
+        FillGrassWind(TerrainGrassWind, WIND_FAST, WindSpeed, WindScale, FrustrumBoundMinX, FrustrumBoundMinY, MaxX, MaxY);
+        FillGrassWind(g_fTerrainGrassWind1, WIND_FAST, WindSpeed1, WindScale1, FrustrumBoundMinX, FrustrumBoundMinY, MaxX, MaxY);
+    }
 #endif	// ASG_ADD_MAP_KARUTAN
-
-            else if (gMapManager.WorldActive == WD_57ICECITY || gMapManager.WorldActive == WD_58ICECITY_BOSS)
-            {
-                WindScale = 60.f;
-                TerrainGrassWind[Index] = sinf(WindSpeed + xf * 50.f) * WindScale;
-            }
-            else
-            {
-                TerrainGrassWind[Index] = sinf(WindSpeed + xf * 5.f) * WindScale;
-            }
-        }
+    else if (gMapManager.WorldActive == WD_57ICECITY || gMapManager.WorldActive == WD_58ICECITY_BOSS)
+    {
+        FillGrassWind(TerrainGrassWind, WIND_FAST, WindSpeed, 60.f, FrustrumBoundMinX, FrustrumBoundMinY, MaxX, MaxY);
+    }
+    else
+    {
+        FillGrassWind(TerrainGrassWind, WIND_SLOW, WindSpeed, WindScale, FrustrumBoundMinX, FrustrumBoundMinY, MaxX, MaxY);
     }
 }
 
@@ -2578,6 +2797,12 @@ extern void RenderCharactersClient();
 
 void RenderTerrain(bool EditFlag)
 {
+    PROFILE_SCOPE("RenderTerrain");
+
+    FlushTerrainLights();
+    // the terrain keeps client arrays and the texture matrix set across its own state changes
+    FlushRenderQueue();
+
     if (!EditFlag)
     {
         if (gMapManager.WorldActive == WD_8TARKAN)
@@ -2607,7 +2832,10 @@ void RenderTerrain(bool EditFlag)
     }
 
     TerrainFlag = TERRAIN_MAP_NORMAL;
-    RenderTerrainFrustrum(EditFlag);
+    if (EditFlag || !RenderTerrainMesh())
+    {
+        RenderTerrainFrustrum(EditFlag);
+    }
     //
     if (EditFlag && SelectFlag)
     {
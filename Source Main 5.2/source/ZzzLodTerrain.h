@@ -29,6 +29,15 @@ void CreateTerrain(wchar_t* FileName, bool bNew = false);
 
 bool IsTerrainHeightExtMap(int iWorld);
 
+// Reads and decrypts an EncTerrain .map/.att/.obj file, taking the copy decrypted by
+// PrefetchMapFiles when there is one. Returns false when the file cannot be opened.
+bool ReadMapFile(const wchar_t* FileName, std::vector<BYTE>& Data);
+// Decrypts FileNames, reads the height map and decodes the light map in parallel.
+// HeightFileName and LightFileName are the names later passed to CreateTerrain and
+// OpenTerrainLight, which then take the prefetched data.
+void PrefetchMapFiles(const std::vector<std::wstring>& FileNames, const wchar_t* HeightFileName = NULL, const wchar_t* LightFileName = NULL);
+void ClearPrefetchedMapFiles();
+
 int OpenTerrainMapping(wchar_t* FileName);
 bool SaveTerrainMapping(wchar_t* FileName, int iMapNumber);
 int OpenTerrainAttribute(wchar_t* FileName);
@@ -59,6 +68,11 @@ void CreateLodBuffer();
 float RequestTerrainHeight(float xf, float yf);
 bool TestFrustrum(vec3_t Position, float Range);
 bool TestFrustrum2D(float x, float y, float Range);
+bool TestFrustrum2DRect(float MinX, float MinY, float MaxX, float MaxY);
+
+// Blend state RenderFace uses for a layer texture; false when the texture is not drawn.
+bool SetTerrainFaceState(int Texture);
+void CreateTerrainWaterSpot(float xf, float yf);
 
 bool RenderTerrainTile(float xf, float yf, int xi, int yi, float lodf, int lodi, bool Flag);
 void RenderTerrain(bool EditFlag);
@@ -32,8 +32,11 @@
 #include "w_MapHeaders.h"
 #include "MonkSystem.h"
 #include "NewUISystem.h"
+#include "./Utilities/Profiler.h"
+#include "./Utilities/JobSystem.h"
+#include <memory>
 
-extern vec3_t VertexTransform[MAX_MESH][MAX_VERTICES];
+extern vec3_t* VertexTransform[MAX_MESH];
 extern vec3_t LightTransform[MAX_MESH][MAX_VERTICES];
 
 int          g_iTotalObj = 0;
@@ -145,44 +148,52 @@ void ActionObject(OBJECT* o)
     }
 }
 
+// Picking runs in two phases. The broad phase only looks at blocks that passed the
+// frustum test this frame and tests the mouse ray against each object's OBB, which
+// the renderer already refreshed while drawing it. Only the objects that survive are
+// animated and skinned again for the triangle test, because VertexTransform is shared
+// scratch that later draws have overwritten.
 OBJECT* CollisionDetectObjects(OBJECT* PickObject)
 {
-    OBJECT* Object = NULL;
-    InitCollisionDetectLineToFace();
+    static std::vector<OBJECT*> s_vecCandidates;
+    s_vecCandidates.clear();
+
     for (int i = 0; i < 16; i++)
     {
         for (int j = 0; j < 16; j++)
         {
             OBJECT_BLOCK* ob = &ObjectBlock[i * 16 + j];
-            OBJECT* o = ob->Head;
-            while (1)
+            if (!ob->Visible && !CameraTopViewEnable)
+                continue;
+
+            for (OBJECT* o = ob->Head; o != NULL; o = o->Next)
             {
-                if (o != NULL)
+                if (o->Live && o->Visible && o->Alpha >= 0.01f)
                 {
-                    if (o->Live && o->Visible && o->Alpha >= 0.01f)
+                    if (CollisionDetectLineToOBB(MousePosition, MouseTarget, o->OBB))
                     {
-                        //if(o != PickObject)
-                        {
-                            BMD* b = &Models[o->Type];
-                            b->BodyScale = o->Scale;
-                            b->CurrentAction = o->CurrentAction;
-                            VectorCopy(o->Position, b->BodyOrigin);
-                            b->Animation(BoneTransform, o->AnimationFrame, o->PriorAnimationFrame, o->PriorAction, o->Angle, o->HeadAngle, false, false);
-                            b->Transform(BoneTransform, o->BoundingBoxMin, o->BoundingBoxMax, &o->OBB, true);
-                            if (CollisionDetectLineToOBB(MousePosition, MouseTarget, o->OBB))
-                            {
-                                if (b->CollisionDetectLineToMesh(MousePosition, MouseTarget))
-                                {
-                                    Object = o;
-                                    //return Object;
-                                }
-                            }
-                        }
+                        s_vecCandidates.push_back(o);
                     }
-                    if (o->Next == NULL) break;
-                    o = o->Next;
                 }
-                else break;
+            }
+        }
+    }
+
+    OBJECT* Object = NULL;
+    InitCollisionDetectLineToFace();
+    for (OBJECT* o : s_vecCandidates)
+    {
+        BMD* b = &Models[o->Type];
+        b->BodyScale = o->Scale;
+        b->CurrentAction = o->CurrentAction;
+        VectorCopy(o->Position, b->BodyOrigin);
+        b->Animation(BoneTransform, o->AnimationFrame, o->PriorAnimationFrame, o->PriorAction, o->Angle, o->HeadAngle, false, false);
+        b->Transform(BoneTransform, o->BoundingBoxMin, o->BoundingBoxMax, &o->OBB, true);
+        if (CollisionDetectLineToOBB(MousePosition, MouseTarget, o->OBB))
+        {
+            if (b->CollisionDetectLineToMesh(MousePosition, MouseTarget))
+            {
+                Object = o;
             }
         }
     }
@@ -221,6 +232,157 @@ void BodyLight(OBJECT* o, BMD* b)
 
 extern float BoneScale;
 
+// Same as b->Animation() into the object's palette, except that a palette already
+// built by PrepareCharacterBones() for identical inputs is reused.
+static void AnimateObject(OBJECT* o, BMD* b, bool Translate)
+{
+    if (!o->EnableBoneMatrix)
+    {
+        // RunPreparedSkinning() may already have animated this palette on the job system
+        const CSkinnedModel* s = FindPreparedSkin(o, b);
+        if (s != nullptr && s->Animated && b->NumActions > 0)
+        {
+            BoneAnimation_t Key;
+            b->MakeAnimationKey(Key, b->CurrentAction, b->BodyHeight, b->BodyScale, b->BodyOrigin,
+                o->AnimationFrame, o->PriorAnimationFrame, o->PriorAction, o->Angle, o->HeadAngle, !Translate);
+            if (memcmp(&Key, &s->Animation, sizeof(Key)) == 0)
+            {
+                memcpy(BoneTransform, s->Palette, sizeof(float) * 12 * b->NumBones);
+                b->SetAnimationState(Key);
+                return;
+            }
+        }
+
+        b->Animation(BoneTransform, o->AnimationFrame, o->PriorAnimationFrame, o->PriorAction, o->Angle, o->HeadAngle, false, !Translate);
+        return;
+    }
+
+    if (o->m_bBonesPrepared && b->NumActions > 0)
+    {
+        BoneAnimation_t Key;
+        b->MakeAnimationKey(Key, b->CurrentAction, b->BodyHeight, b->BodyScale, b->BodyOrigin,
+            o->AnimationFrame, o->PriorAnimationFrame, o->PriorAction, o->Angle, o->HeadAngle, !Translate);
+        if (memcmp(&Key, &o->m_BonesPrepared, sizeof(Key)) == 0)
+        {
+            b->SetAnimationState(Key);
+            return;
+        }
+    }
+
+    o->m_bBonesPrepared = false;
+    b->Animation(o->BoneTransform, o->AnimationFrame, o->PriorAnimationFrame, o->PriorAction, o->Angle, o->HeadAngle, false, !Translate);
+}
+
+namespace
+{
+    typedef struct
+    {
+        OBJECT*         Object;
+        const BMD*      Model;
+        bool            Animate;
+        BoneAnimation_t Animation;
+    } SKINNING_JOB;
+
+    // Reused from batch to batch; an object's entries are contiguous.
+    std::vector<std::unique_ptr<CSkinnedModel>> s_SkinnedModels;
+    std::vector<SKINNING_JOB> s_SkinningJobs;
+    DWORD s_dwSkinningBatch = 0;
+}
+
+void BeginPreparedSkinning()
+{
+    ++s_dwSkinningBatch;
+    s_SkinningJobs.clear();
+
+    // the outputs of the last batch are about to be overwritten
+    BindScratchTransform();
+}
+
+void QueuePreparedSkin(OBJECT* o, int Type, bool Translate)
+{
+    BMD* b = &Models[Type];
+    if (b->NumMeshs <= 0 || b->NumBones <= 0 || b->Bones == nullptr)
+        return;
+
+    // Characters bring the palette PrepareCharacterBones() built; anything else is
+    // animated from the same inputs Calc_RenderObject uses.
+    const bool Animate = !o->m_bBonesPrepared;
+    if (Animate && b->NumActions <= 0)
+        return;
+
+    const int index = static_cast<int>(s_SkinningJobs.size());
+    if (o->m_dwSkinnedBatch != s_dwSkinningBatch)
+    {
+        o->m_dwSkinnedBatch = s_dwSkinningBatch;
+        o->m_iSkinnedFirst = index;
+        o->m_iSkinnedCount = 0;
+    }
+    else if (o->m_iSkinnedFirst + o->m_iSkinnedCount != index)
+    {
+        return;
+    }
+    ++o->m_iSkinnedCount;
+
+    if (static_cast<int>(s_SkinnedModels.size()) <= index)
+    {
+        s_SkinnedModels.push_back(std::make_unique<CSkinnedModel>());
+    }
+
+    CSkinnedModel* s = s_SkinnedModels[index].get();
+    s->Allocate(b);
+    s->Owner = o;
+    b->MakeSkinningKey(s->Key, o->Scale, o->Position, o->LightEnable, 1.f, Translate, 0.f);
+
+    SKINNING_JOB job;
+    job.Object = o;
+    job.Model = b;
+    job.Animate = Animate;
+    if (Animate)
+    {
+        b->MakeAnimationKey(job.Animation, o->CurrentAction, 0.f, o->Scale, o->Position,
+            o->AnimationFrame, o->PriorAnimationFrame, o->PriorAction, o->Angle, o->HeadAngle, !Translate);
+        s->Animation = job.Animation;
+    }
+    s->Animated = Animate;
+    s_SkinningJobs.push_back(job);
+}
+
+void RunPreparedSkinning()
+{
+    JobSystem::Instance()->ParallelFor(static_cast<int>(s_SkinningJobs.size()), [](int index)
+        {
+            const SKINNING_JOB& job = s_SkinningJobs[index];
+            CSkinnedModel* s = s_SkinnedModels[index].get();
+            const BMD* b = job.Model;
+
+            if (job.Animate)
+            {
+                float RootMatrix[3][4];
+                b->BodyMatrix(job.Animation, RootMatrix);
+                b->AnimateBones(job.Animation, s->Palette, RootMatrix);
+            }
+            else
+            {
+                memcpy(s->Palette, job.Object->BoneTransform, sizeof(float) * 12 * b->NumBones);
+            }
+            b->TransformVertices(s->Key, s->Palette, s->Vertices, s->Normals, s->Intensities, s->BoundingMin, s->BoundingMax);
+        });
+}
+
+CSkinnedModel* FindPreparedSkin(OBJECT* o, const BMD* b)
+{
+    if (o->m_dwSkinnedBatch != s_dwSkinningBatch)
+        return nullptr;
+
+    for (int i = 0; i < o->m_iSkinnedCount; ++i)
+    {
+        CSkinnedModel* s = s_SkinnedModels[o->m_iSkinnedFirst + i].get();
+        if (s->Owner == o && s->Key.Model == b)
+            return s;
+    }
+    return nullptr;
+}
+
 bool Calc_RenderObject(OBJECT* o, bool Translate, int Select, int ExtraMon)
 {
     if (gMapManager.InChaosCastle() == true && Hero->Object.m_bActionStart == true)
@@ -266,14 +428,7 @@ bool Calc_RenderObject(OBJECT* o, bool Translate, int Select, int ExtraMon)
         }
     }
 
-    if (o->EnableBoneMatrix)
-    {
-        b->Animation(o->BoneTransform, o->AnimationFrame, o->PriorAnimationFrame, o->PriorAction, o->Angle, o->HeadAngle, false, !Translate);
-    }
-    else
-    {
-        b->Animation(BoneTransform, o->AnimationFrame, o->PriorAnimationFrame, o->PriorAction, o->Angle, o->HeadAngle, false, !Translate);
-    }
+    AnimateObject(o, b, Translate);
 
     BoneScale = 1.f;
     if (3 == Select)
@@ -344,11 +499,11 @@ bool Calc_RenderObject(OBJECT* o, bool Translate, int Select, int ExtraMon)
 
     if (o->EnableBoneMatrix)
     {
-        b->Transform(o->BoneTransform, o->BoundingBoxMin, o->BoundingBoxMax, &o->OBB, Translate);
+        b->Transform(o->BoneTransform, o->BoundingBoxMin, o->BoundingBoxMax, &o->OBB, Translate, 0.f, FindPreparedSkin(o, b));
     }
     else
     {
-        b->Transform(BoneTransform, o->BoundingBoxMin, o->BoundingBoxMax, &o->OBB, Translate);
+        b->Transform(BoneTransform, o->BoundingBoxMin, o->BoundingBoxMax, &o->OBB, Translate, 0.f, FindPreparedSkin(o, b));
     }
 
     return true;
@@ -371,14 +526,7 @@ bool Calc_ObjectAnimation(OBJECT* o, bool Translate, int Select)
     b->CurrentAction = o->CurrentAction;
     VectorCopy(o->Position, b->BodyOrigin);
 
-    if (o->EnableBoneMatrix)
-    {
-        b->Animation(o->BoneTransform, o->AnimationFrame, o->PriorAnimationFrame, o->PriorAction, o->Angle, o->HeadAngle, false, !Translate);
-    }
-    else
-    {
-        b->Animation(BoneTransform, o->AnimationFrame, o->PriorAnimationFrame, o->PriorAction, o->Angle, o->HeadAngle, false, !Translate);
-    }
+    AnimateObject(o, b, Translate);
     return true;
 }
 
@@ -3252,8 +3400,42 @@ void RenderObjectVisual(OBJECT* o)
     }
 }
 
+// Skins the objects the loop in RenderObjects() is about to draw on the job system;
+// Calc_RenderObject hands the results to BMD::Transform. The worlds with hand-picked
+// object lists are left to the serial path.
+static void PrepareObjectSkinning(float range)
+{
+    PROFILE_SCOPE("PrepareObjectSkinning");
+
+    BeginPreparedSkinning();
+
+    for (int i = 0; i < 16; i++)
+    {
+        for (int j = 0; j < 16; j++)
+        {
+            OBJECT_BLOCK* ob = &ObjectBlock[i * 16 + j];
+            if (!TestFrustrum2D((float)(i * 16 + 8), (float)(j * 16 + 8), -180.f) && !CameraTopViewEnable)
+                continue;
+
+            for (OBJECT* o = ob->Head; o != NULL; o = o->Next)
+            {
+                if (!o->Live || o->Alpha < 0.01f)
+                    continue;
+                if (!TestFrustrum2D(o->Position[0] * 0.01f, o->Position[1] * 0.01f, o->CollisionRange + range) && !CameraTopViewEnable)
+                    continue;
+
+                QueuePreparedSkin(o, o->Type, false);
+            }
+        }
+    }
+
+    RunPreparedSkinning();
+}
+
 void RenderObjects()
 {
+    PROFILE_SCOPE("RenderObjects");
+
     float   range = 0.f;
     if (gMapManager.WorldActive == WD_10HEAVEN)
     {
@@ -3264,20 +3446,26 @@ void RenderObjects()
         Time_Effect = 0;
     Time_Effect += FPS_ANIMATION_FACTOR;
 
+    const bool bPickedObjects = g_Direction.m_CKanturu.IsMayaScene()
+        || gMapManager.WorldActive == WD_51HOME_6TH_CHAR
+        || gMapManager.WorldActive == WD_73NEW_LOGIN_SCENE
+        || gMapManager.WorldActive == WD_74NEW_CHARACTER_SCENE
+        || IsIceCity()
+        || gMapManager.IsPKField()
+        || IsDoppelGanger2();
+
+    if (!bPickedObjects)
+    {
+        PrepareObjectSkinning(range);
+    }
+
     for (int i = 0; i < 16; i++)
     {
         for (int j = 0; j < 16; j++)
         {
             OBJECT_BLOCK* ob = &ObjectBlock[i * 16 + j];
             ob->Visible = TestFrustrum2D((float)(i * 16 + 8), (float)(j * 16 + 8), -180.f);
-            if (g_Direction.m_CKanturu.IsMayaScene()
-                || gMapManager.WorldActive == WD_51HOME_6TH_CHAR
-                || gMapManager.WorldActive == WD_73NEW_LOGIN_SCENE
-                || gMapManager.WorldActive == WD_74NEW_CHARACTER_SCENE
-                || IsIceCity()
-                || gMapManager.IsPKField()
-                || IsDoppelGanger2()
-                )
+            if (bPickedObjects)
             {
                 OBJECT* o = ob->Head;
 
@@ -4361,6 +4549,8 @@ void MoveObjectOnEffect(OBJECT* o, int& objCount, int& visObject)
 
 void MoveObjects()
 {
+    PROFILE_SCOPE("MoveObjects");
+
     int     objectCount = 0;
 
     MoveObjectSetting(objectCount);
@@ -4919,8 +5109,8 @@ int OpenObjects(wchar_t* FileName)
 
 int OpenObjectsEnc(wchar_t* FileName)
 {
-    FILE* fp = _wfopen(FileName, L"rb");
-    if (fp == NULL)
+    std::vector<BYTE> FileData;
+    if (!ReadMapFile(FileName, FileData))
     {
         wchar_t Text[256];
         swprintf(Text, L"%s file not found.", FileName);
@@ -4928,17 +5118,7 @@ int OpenObjectsEnc(wchar_t* FileName)
         SendMessage(g_hWnd, WM_DESTROY, 0, 0);
         return (-1);
     }
-    fseek(fp, 0, SEEK_END);
-    int EncBytes = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-    auto* EncData = new unsigned char[EncBytes];
-    fread(EncData, 1, EncBytes, fp);
-    fclose(fp);
-
-    int DataBytes = MapFileDecrypt(NULL, EncData, EncBytes);
-    auto* Data = new unsigned char[DataBytes];
-    MapFileDecrypt(Data, EncData, EncBytes);
-    delete[] EncData;
+    const BYTE* Data = FileData.data();
 
     int DataPtr = 0;
     DataPtr += 1;
@@ -4955,9 +5135,7 @@ int OpenObjectsEnc(wchar_t* FileName)
         float Scale = *((float*)(Data + DataPtr)); DataPtr += 4;
         CreateObject(Type, Position, Angle, Scale);
     }
-    delete[] Data;
 
-    fclose(fp);
     return iMapNumber;
 }
 
@@ -5138,6 +5316,8 @@ void    RenderCloudLowLevel(int index, int Type)
     }
 }
 
+SpatialGrid<MAX_ITEMS> g_ItemGrid;
+
 void ClearItems()
 {
     for (int i = 0; i < MAX_ITEMS; i++)
@@ -5145,6 +5325,7 @@ void ClearItems()
         OBJECT* o = &Items[i].Object;
         o->Live = false;
     }
+    g_ItemGrid.Clear();
 }
 
 void ItemObjectAttribute(OBJECT* o)
@@ -6181,6 +6362,7 @@ void CreateItemDrop(ITEM_t* ip, ItemCreationParams params, vec3_t position, bool
     }
 
     ItemAngle(o);
+    g_ItemGrid.Update(static_cast<int>(ip - Items), o->Position[0], o->Position[1]);
 }
 
 void CreateMoneyDrop(ITEM_t* ip, int amount, vec3_t position, bool isFreshDrop)
@@ -6217,6 +6399,7 @@ void CreateMoneyDrop(ITEM_t* ip, int amount, vec3_t position, bool isFreshDrop)
     }
 
     ItemAngle(o);
+    g_ItemGrid.Update(static_cast<int>(ip - Items), o->Position[0], o->Position[1]);
 }
 
 void CreateShiny(OBJECT* o)
@@ -6239,6 +6422,8 @@ void CreateShiny(OBJECT* o)
 
 void MoveItems()
 {
+    PROFILE_SCOPE("MoveItems");
+
     for (int i = 0; i < MAX_ITEMS; i++)
     {
         OBJECT* o = &Items[i].Object;
@@ -6267,6 +6452,10 @@ void MoveItems()
                 CreateShiny(o);
             }
         }
+        else
+        {
+            g_ItemGrid.Remove(i);
+        }
     }
 }
 
@@ -6340,6 +6529,8 @@ void RenderZen(int itemIndex, ITEM_t* item, vec3_t light)
 
 void RenderItems()
 {
+    PROFILE_SCOPE("RenderItems");
+
     for (int i = 0; i < MAX_ITEMS; i++)
     {
         OBJECT* o = &Items[i].Object;
@@ -10582,11 +10773,11 @@ void RenderPartObject(OBJECT* o, int Type, void* p2, vec3_t Light, float Alpha,
 
     if (GlobalTransform)
     {
-        b->Transform(BoneTransform, o->BoundingBoxMin, o->BoundingBoxMax, &o->OBB, Translate);
+        b->Transform(BoneTransform, o->BoundingBoxMin, o->BoundingBoxMax, &o->OBB, Translate, 0.f, FindPreparedSkin(o, b));
     }
     else
     {
-        b->Transform(o->BoneTransform, o->BoundingBoxMin, o->BoundingBoxMax, &o->OBB, Translate);
+        b->Transform(o->BoneTransform, o->BoundingBoxMin, o->BoundingBoxMax, &o->OBB, Translate, 0.f, FindPreparedSkin(o, b));
     }
 
     if (p)
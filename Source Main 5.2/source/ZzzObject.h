@@ -1,5 +1,6 @@
 #pragma once
 #include "NewUIItemMng.h"
+#include "./Utilities/SpatialGrid.h"
 
 extern OBJECT_BLOCK ObjectBlock[256];
 extern OBJECT       Mounts[];
@@ -48,6 +49,7 @@ void CreateOperate(OBJECT* Owner);
 ///////////////////////////////////////////////////////////////////////////////
 
 extern ITEM_t Items[MAX_ITEMS];
+extern SpatialGrid<MAX_ITEMS> g_ItemGrid;
 extern ITEM   PickItem;
 extern ITEM   TargetItem;
 
@@ -85,6 +87,13 @@ void ActionObject(OBJECT* o);
 void BodyLight(OBJECT* o, BMD* b);
 
 bool Calc_RenderObject(OBJECT* o, bool Translate, int Select, int ExtraMon);
+
+// Skinning ahead of a render loop: queue the models the loop is about to draw, run them
+// on the job system, and BMD::Transform picks the results up through FindPreparedSkin.
+void BeginPreparedSkinning();
+void QueuePreparedSkin(OBJECT* o, int Type, bool Translate);
+void RunPreparedSkinning();
+CSkinnedModel* FindPreparedSkin(OBJECT* o, const BMD* b);
 bool Calc_ObjectAnimation(OBJECT* o, bool Translate, int Select);
 void Draw_RenderObject(OBJECT* o, bool Translate, int Select, int ExtraMon);
 
@@ -29,6 +29,7 @@
 #include "ServerListManager.h"
 #include "MonkSystem.h"
 #include "SocketSystem.h"
+#include "ZzzScene.h"
 
 ///////////////////////////////////////////
 extern BOOL g_bUseChatListBox;
@@ -2320,6 +2321,9 @@ void OpenMonsterModel(EMonsterModelType Type)
 
     if (b->NumMeshs == 0) return;
 
+    // Monsters are first seen mid-fight; don't stall the frame decoding their textures.
+    gLoadData.SetStreamTextures(SceneFlag == MAIN_SCENE);
+
     if (gMapManager.InChaosCastle() == true && Type >= 70 && Type <= 72)
     {
         gLoadData.OpenTexture(Index, L"Npc\\");
@@ -2353,6 +2357,8 @@ void OpenMonsterModel(EMonsterModelType Type)
     break;
     }
 
+    gLoadData.SetStreamTextures(false);
+
     b->Actions[MONSTER01_STOP1].PlaySpeed = 0.25f;
     b->Actions[MONSTER01_STOP2].PlaySpeed = 0.2f;
     b->Actions[MONSTER01_WALK].PlaySpeed = 0.34f;
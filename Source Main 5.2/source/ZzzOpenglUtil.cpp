@@ -11,6 +11,8 @@
 #include "Zzzinfomation.h"
 #include "NewUISystem.h"
 #include "wglext.h"
+#include "RenderQueue.h"
+#include "QuadBatch.h"
 
 int     OpenglWindowX;
 int     OpenglWindowY;
@@ -227,6 +229,8 @@ bool TestDepthBuffer(vec3_t Position)
         x >= (int)OpenglWindowX + OpenglWindowWidth ||
         y >= (int)OpenglWindowY + OpenglWindowHeight) return false;
 
+    FlushRenderQueue();
+
     GLfloat key[3];
     glReadPixels(x, y, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, key);
 
@@ -247,11 +251,171 @@ bool DepthMaskEnable;
 bool AlphaTestEnable;
 int  AlphaBlendType;
 
+// state recorded instead of applied while a CRenderStateCapture is open
+static RENDER_STATE* s_pCapture = nullptr;
+static RENDER_STATE  s_CaptureState;
+
+// where the helpers record instead of calling GL: an open capture, else an open quad batch
+static RENDER_STATE* GetRecordingState()
+{
+    return s_pCapture ? s_pCapture : GetQuadBatchState();
+}
+
+// separate alpha factors while drawing into a render target, see SetPremultipliedBlendTarget
+static bool s_bPremultipliedTarget = false;
+static PFNGLBLENDFUNCSEPARATEPROC s_glBlendFuncSeparate = nullptr;
+static PFNGLBLENDCOLORPROC        s_glBlendColor = nullptr;
+
+// glAlphaFunc reference, 0.25 unless a draw asks for another one
+static float s_fAlphaReference = 0.25f;
+
+// Alpha-tested draws blend their edges onto whatever is already drawn, so only the
+// opaque blend may be requested while queued draws are still waiting; the ones that
+// are queued request theirs inside a capture.
+static bool IsQueueableBlend(int type)
+{
+    return type == 0;
+}
+
+// The target's alpha is composited later with (ONE, ONE_MINUS_SRC_ALPHA): opaque and
+// alpha blended draws cover the pixel, the additive and colour-modulating modes keep
+// its coverage. The blend colour's alpha is 1 so opaque draws write full coverage.
+static void SetPremultipliedBlendFunc(int type)
+{
+    glEnable(GL_BLEND);
+    switch (type)
+    {
+    case 0: s_glBlendFuncSeparate(GL_ONE, GL_ZERO, GL_CONSTANT_ALPHA, GL_ZERO); break;
+    case 1: s_glBlendFuncSeparate(GL_ZERO, GL_SRC_COLOR, GL_ZERO, GL_ONE); break;
+    case 2: s_glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA); break;
+    case 3: s_glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE); break;
+    case 4: s_glBlendFuncSeparate(GL_ZERO, GL_ONE_MINUS_SRC_COLOR, GL_ZERO, GL_ONE); break;
+    case 5: s_glBlendFuncSeparate(GL_ONE_MINUS_SRC_COLOR, GL_ONE, GL_ZERO, GL_ONE); break;
+    case 6: s_glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA); break;
+    case 7: s_glBlendFuncSeparate(GL_ONE, GL_ONE_MINUS_SRC_COLOR, GL_ZERO, GL_ONE); break;
+    case 8: s_glBlendFuncSeparate(GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA); break;
+    }
+}
+
+static void SetBlendType(int type)
+{
+    if (RENDER_STATE* recording = GetRecordingState())
+    {
+        recording->Blend = type;
+        return;
+    }
+
+    // GL may already be in this state while opaque draws wait in the queue
+    if (!IsQueueableBlend(type))
+        RenderQueueBarrier();
+
+    if (AlphaBlendType != type)
+    {
+        AlphaBlendType = type;
+        ++g_RenderCounters.StateChanges;
+        if (s_bPremultipliedTarget)
+        {
+            SetPremultipliedBlendFunc(type);
+            return;
+        }
+        switch (type)
+        {
+        case 0: glDisable(GL_BLEND); break;
+        case 1: glEnable(GL_BLEND); glBlendFunc(GL_ZERO, GL_SRC_COLOR); break;
+        case 2: glEnable(GL_BLEND); glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); break;
+        case 3: glEnable(GL_BLEND); glBlendFunc(GL_ONE, GL_ONE); break;
+        case 4: glEnable(GL_BLEND); glBlendFunc(GL_ZERO, GL_ONE_MINUS_SRC_COLOR); break;
+        case 5: glEnable(GL_BLEND); glBlendFunc(GL_ONE_MINUS_SRC_COLOR, GL_ONE); break;
+        case 6: glEnable(GL_BLEND); glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); break;
+        case 7: glEnable(GL_BLEND); glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_COLOR); break;
+        case 8: glEnable(GL_BLEND); glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA); break;
+        }
+    }
+}
+
+static void SetAlphaTest(bool enable)
+{
+    if (RENDER_STATE* recording = GetRecordingState())
+    {
+        recording->AlphaTest = enable;
+        return;
+    }
+
+    if (AlphaTestEnable != enable)
+    {
+        AlphaTestEnable = enable;
+        ++g_RenderCounters.StateChanges;
+        if (enable)
+            glEnable(GL_ALPHA_TEST);
+        else
+            glDisable(GL_ALPHA_TEST);
+    }
+}
+
+void SetAlphaTestReference(float ref)
+{
+    if (RENDER_STATE* recording = GetRecordingState())
+    {
+        recording->AlphaRef = ref;
+        return;
+    }
+
+    if (s_fAlphaReference != ref)
+    {
+        s_fAlphaReference = ref;
+        ++g_RenderCounters.StateChanges;
+        glAlphaFunc(GL_GREATER, ref);
+    }
+}
+
+static void SetTexture2D(bool enable)
+{
+    if (RENDER_STATE* recording = GetRecordingState())
+    {
+        recording->Texture2D = enable;
+        return;
+    }
+
+    if (TextureEnable != enable)
+    {
+        TextureEnable = enable;
+        ++g_RenderCounters.StateChanges;
+        if (enable)
+            glEnable(GL_TEXTURE_2D);
+        else
+            glDisable(GL_TEXTURE_2D);
+    }
+}
+
+static void SetFog(bool enable)
+{
+    if (!FogEnable)
+        return;
+
+    if (RENDER_STATE* recording = GetRecordingState())
+    {
+        recording->Fog = enable ? 1 : 0;
+        return;
+    }
+
+    if (enable)
+        glEnable(GL_FOG);
+    else
+        glDisable(GL_FOG);
+}
+
 void BindTexture(int tex)
 {
+    if (RENDER_STATE* recording = GetRecordingState())
+    {
+        recording->Texture = tex;
+        return;
+    }
+
     if (CachTexture != tex)
     {
         CachTexture = tex;
+        ++g_RenderCounters.TextureBinds;
         if (tex >= 0)
         {
             BITMAP_t* b = &Bitmaps[tex];
@@ -272,11 +436,13 @@ void BindTextureStream(int tex)
     if (CachTexture != tex)
     {
         CachTexture = tex;
+        ++g_RenderCounters.TextureBinds;
         if (TextureStream)
             glEnd();
         BITMAP_t* b = &Bitmaps[tex];
         glBindTexture(GL_TEXTURE_2D, b->TextureNumber);
 
+        ++g_RenderCounters.DrawCalls;
         glBegin(GL_TRIANGLES);
         TextureStream = true;
     }
@@ -291,54 +457,98 @@ void EndTextureStream()
 
 void EnableDepthTest()
 {
+    if (RENDER_STATE* recording = GetRecordingState())
+    {
+        recording->DepthTest = true;
+        return;
+    }
+
     if (!DepthTestEnable)
     {
         DepthTestEnable = true;
+        ++g_RenderCounters.StateChanges;
         glEnable(GL_DEPTH_TEST);
     }
 }
 
 void DisableDepthTest()
 {
+    if (RENDER_STATE* recording = GetRecordingState())
+    {
+        recording->DepthTest = false;
+        return;
+    }
+
+    RenderQueueBarrier();
     if (DepthTestEnable)
     {
         DepthTestEnable = false;
+        ++g_RenderCounters.StateChanges;
         glDisable(GL_DEPTH_TEST);
     }
 }
 
 void EnableDepthMask()
 {
+    if (RENDER_STATE* recording = GetRecordingState())
+    {
+        recording->DepthMask = true;
+        return;
+    }
+
     if (!DepthMaskEnable)
     {
         DepthMaskEnable = true;
+        ++g_RenderCounters.StateChanges;
         glDepthMask(true);
     }
 }
 
 void DisableDepthMask()
 {
+    if (RENDER_STATE* recording = GetRecordingState())
+    {
+        recording->DepthMask = false;
+        return;
+    }
+
+    RenderQueueBarrier();
     if (DepthMaskEnable)
     {
         DepthMaskEnable = false;
+        ++g_RenderCounters.StateChanges;
         glDepthMask(false);
     }
 }
 
 void EnableCullFace()
 {
+    if (RENDER_STATE* recording = GetRecordingState())
+    {
+        recording->CullFace = true;
+        return;
+    }
+
     if (!CullFaceEnable)
     {
         CullFaceEnable = true;
+        ++g_RenderCounters.StateChanges;
         glEnable(GL_CULL_FACE);
     }
 }
 
 void DisableCullFace()
 {
+    if (RENDER_STATE* recording = GetRecordingState())
+    {
+        recording->CullFace = false;
+        return;
+    }
+
     if (CullFaceEnable)
     {
         CullFaceEnable = false;
+        ++g_RenderCounters.StateChanges;
         glDisable(GL_CULL_FACE);
     }
 }
@@ -346,219 +556,190 @@ void DisableCullFace()
 void DisableTexture(bool AlphaTest)
 {
     EnableDepthMask();
-    if (AlphaTest == true)
-    {
-        if (!AlphaTestEnable)
-        {
-            AlphaTestEnable = true;
-            glEnable(GL_ALPHA_TEST);
-        }
-    }
-    else
-    {
-        if (AlphaTestEnable)
-        {
-            AlphaTestEnable = false;
-            glDisable(GL_ALPHA_TEST);
-        }
-    }
-    if (TextureEnable)
-    {
-        TextureEnable = false;
-        glDisable(GL_TEXTURE_2D);
-    }
+    SetAlphaTest(AlphaTest);
+    SetTexture2D(false);
 }
 
 void DisableAlphaBlend()
 {
-    if (AlphaBlendType != 0)
-    {
-        AlphaBlendType = 0;
-        glDisable(GL_BLEND);
-    }
+    SetBlendType(0);
     EnableCullFace();
     EnableDepthMask();
-    if (AlphaTestEnable)
-    {
-        AlphaTestEnable = false;
-        glDisable(GL_ALPHA_TEST);
-    }
-    if (!TextureEnable)
-    {
-        TextureEnable = true;
-        glEnable(GL_TEXTURE_2D);
-    }
-    if (FogEnable)
-        glEnable(GL_FOG);
+    SetAlphaTest(false);
+    SetTexture2D(true);
+    SetFog(true);
 }
 
 void EnableAlphaTest(bool DepthMask)
 {
-    if (AlphaBlendType != 2)
-    {
-        AlphaBlendType = 2;
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    }
+    SetBlendType(2);
     DisableCullFace();
     if (DepthMask)
         EnableDepthMask();
-    if (!AlphaTestEnable)
-    {
-        AlphaTestEnable = true;
-        glEnable(GL_ALPHA_TEST);
-    }
-    if (!TextureEnable)
-    {
-        TextureEnable = true;
-        glEnable(GL_TEXTURE_2D);
-    }
-    if (FogEnable)
-        glEnable(GL_FOG);
+    SetAlphaTest(true);
+    SetTexture2D(true);
+    SetFog(true);
 }
 
 void EnableAlphaBlend()
 {
-    if (AlphaBlendType != 3)
-    {
-        AlphaBlendType = 3;
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_ONE, GL_ONE);
-    }
+    SetBlendType(3);
     DisableCullFace();
     DisableDepthMask();
-    if (AlphaTestEnable)
-    {
-        AlphaTestEnable = false;
-        glDisable(GL_ALPHA_TEST);
-    }
-    if (!TextureEnable)
-    {
-        TextureEnable = true;
-        glEnable(GL_TEXTURE_2D);
-    }
-    if (FogEnable)
-        glDisable(GL_FOG);
+    SetAlphaTest(false);
+    SetTexture2D(true);
+    SetFog(false);
 }
 
 void EnableAlphaBlendMinus()
 {
-    if (AlphaBlendType != 4)
-    {
-        AlphaBlendType = 4;
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
-    }
+    SetBlendType(4);
     DisableCullFace();
     DisableDepthMask();
-    if (AlphaTestEnable)
-    {
-        AlphaTestEnable = false;
-        glDisable(GL_ALPHA_TEST);
-    }
-    if (!TextureEnable)
-    {
-        TextureEnable = true;
-        glEnable(GL_TEXTURE_2D);
-    }
-    if (FogEnable)
-        glEnable(GL_FOG);
+    SetAlphaTest(false);
+    SetTexture2D(true);
+    SetFog(true);
 }
 
 void EnableAlphaBlend2()
 {
-    if (AlphaBlendType != 5)
-    {
-        AlphaBlendType = 5;
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_ONE_MINUS_SRC_COLOR, GL_ONE);
-    }
+    SetBlendType(5);
     DisableCullFace();
     DisableDepthMask();
-    if (AlphaTestEnable)
-    {
-        AlphaTestEnable = false;
-        glDisable(GL_ALPHA_TEST);
-    }
-    if (!TextureEnable)
-    {
-        TextureEnable = true;
-        glEnable(GL_TEXTURE_2D);
-    }
-    if (FogEnable)
-        glEnable(GL_FOG);
+    SetAlphaTest(false);
+    SetTexture2D(true);
+    SetFog(true);
 }
 
 void EnableAlphaBlend3()
 {
-    if (AlphaBlendType != 6)
-    {
-        AlphaBlendType = 6;
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    }
+    SetBlendType(6);
     DisableCullFace();
     DisableDepthMask();
-    if (AlphaTestEnable)
-    {
-        AlphaTestEnable = false;
-        glDisable(GL_ALPHA_TEST);
-    }
-    if (!TextureEnable)
-    {
-        TextureEnable = true;
-        glEnable(GL_TEXTURE_2D);
-    }
-    if (FogEnable)
-        glEnable(GL_FOG);
+    SetAlphaTest(false);
+    SetTexture2D(true);
+    SetFog(true);
 }
 
 void EnableAlphaBlend4()
 {
-    if (AlphaBlendType != 7)
-    {
-        AlphaBlendType = 7;
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_COLOR);
-    }
+    SetBlendType(7);
     DisableCullFace();
     DisableDepthMask();
-    if (AlphaTestEnable)
-    {
-        AlphaTestEnable = false;
-        glDisable(GL_ALPHA_TEST);
-    }
-    if (!TextureEnable)
+    SetAlphaTest(false);
+    SetTexture2D(true);
+    SetFog(true);
+}
+
+void EnableAlphaBlendPremultiplied()
+{
+    SetBlendType(8);
+    DisableCullFace();
+    DisableDepthMask();
+    SetAlphaTest(false);
+    SetTexture2D(true);
+    SetFog(false);
+}
+
+bool SetPremultipliedBlendTarget(bool enable)
+{
+    if (s_glBlendFuncSeparate == nullptr)
     {
-        TextureEnable = true;
-        glEnable(GL_TEXTURE_2D);
+        if (!enable)
+            return true;
+
+        s_glBlendFuncSeparate = reinterpret_cast<PFNGLBLENDFUNCSEPARATEPROC>(wglGetProcAddress("glBlendFuncSeparate"));
+        s_glBlendColor = reinterpret_cast<PFNGLBLENDCOLORPROC>(wglGetProcAddress("glBlendColor"));
+        if (s_glBlendFuncSeparate == nullptr || s_glBlendColor == nullptr)
+        {
+            s_glBlendFuncSeparate = nullptr;
+            return false;
+        }
     }
-    if (FogEnable)
-        glEnable(GL_FOG);
+
+    // whatever is still batched belongs to the previous target
+    RenderQueueBarrier();
+    QuadBatchBarrier();
+
+    s_bPremultipliedTarget = enable;
+    s_glBlendColor(0.f, 0.f, 0.f, enable ? 1.f : 0.f);
+
+    const int type = AlphaBlendType;
+    AlphaBlendType = -1;
+    SetBlendType(type);
+    return true;
 }
 
 void EnableLightMap()
 {
-    if (AlphaBlendType != 1)
-    {
-        AlphaBlendType = 1;
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_ZERO, GL_SRC_COLOR);
-    }
+    SetBlendType(1);
     EnableCullFace();
     EnableDepthMask();
-    if (AlphaTestEnable)
+    SetAlphaTest(false);
+    SetTexture2D(true);
+    SetFog(true);
+}
+
+void GetRenderState(RENDER_STATE& state)
+{
+    // GL lags behind the helpers while a quad batch records their state
+    if (const RENDER_STATE* batch = GetQuadBatchState())
     {
-        AlphaTestEnable = false;
-        glDisable(GL_ALPHA_TEST);
+        state = *batch;
+        return;
     }
-    if (!TextureEnable)
+
+    state.Blend = AlphaBlendType;
+    state.Texture = CachTexture;
+    state.Texture2D = TextureEnable;
+    state.AlphaTest = AlphaTestEnable;
+    state.DepthTest = DepthTestEnable;
+    state.DepthMask = DepthMaskEnable;
+    state.CullFace = CullFaceEnable;
+    state.Fog = -1;
+    state.AlphaRef = s_fAlphaReference;
+}
+
+void SetRenderState(const RENDER_STATE& state)
+{
+    SetBlendType(state.Blend);
+    if (state.DepthTest) EnableDepthTest(); else DisableDepthTest();
+    if (state.DepthMask) EnableDepthMask(); else DisableDepthMask();
+    if (state.CullFace) EnableCullFace(); else DisableCullFace();
+    SetAlphaTest(state.AlphaTest);
+    SetAlphaTestReference(state.AlphaRef);
+    SetTexture2D(state.Texture2D);
+    if (state.Fog >= 0)
+        SetFog(state.Fog != 0);
+    if (state.Texture != CachTexture)
+        BindTexture(state.Texture);
+}
+
+CRenderStateCapture::CRenderStateCapture(bool enable) : m_bActive(enable && s_pCapture == nullptr)
+{
+    if (m_bActive)
     {
-        TextureEnable = true;
-        glEnable(GL_TEXTURE_2D);
+        GetRenderState(s_CaptureState);
+        s_pCapture = &s_CaptureState;
     }
-    if (FogEnable)
-        glEnable(GL_FOG);
+}
+
+CRenderStateCapture::~CRenderStateCapture()
+{
+    RENDER_STATE state;
+    if (End(state))
+        SetRenderState(state);
+}
+
+bool CRenderStateCapture::End(RENDER_STATE& state)
+{
+    if (!m_bActive)
+        return false;
+
+    m_bActive = false;
+    s_pCapture = nullptr;
+    state = s_CaptureState;
+    return true;
 }
 
 void glViewport2(int x, int y, int Width, int Height)
@@ -615,6 +796,7 @@ void BeginOpengl(int x, int y, int Width, int Height)
     DepthMaskEnable = true;
     glDepthFunc(GL_LEQUAL);
     glAlphaFunc(GL_GREATER, 0.25f);
+    s_fAlphaReference = 0.25f;
     if (FogEnable)
     {
         glEnable(GL_FOG);
@@ -632,6 +814,8 @@ void BeginOpengl(int x, int y, int Width, int Height)
 
 void EndOpengl()
 {
+    FlushRenderQueue();
+
     glMatrixMode(GL_MODELVIEW);
     glPopMatrix();
     glMatrixMode(GL_PROJECTION);
@@ -909,6 +1093,7 @@ void RenderBox(float Matrix[3][4])
         VectorTransform(BoundingVertices[j], Matrix, TransformVertices[j]);
     }
 
+    ++g_RenderCounters.DrawCalls;
     glBegin(GL_QUADS);
     //glBegin(GL_LINES);
     glColor3f(0.2f, 0.2f, 0.2f);
@@ -963,6 +1148,7 @@ void RenderPlane3D(float Width, float Height, float Matrix[3][4])
         VectorTransform(BoundingVertices[j], Matrix, TransformVertices[j]);
     }
 
+    ++g_RenderCounters.DrawCalls;
     glBegin(GL_QUADS);
     glTexCoord2f(0.f, 1.f); glVertex3fv(TransformVertices[0]);
     glTexCoord2f(1.f, 1.f); glVertex3fv(TransformVertices[1]);
@@ -1029,6 +1215,25 @@ void RenderSprite(int Texture, vec3_t Position, float Width, float Height, vec3_
     TEXCOORD(c[1], u + uWidth, v + vHeight);
     TEXCOORD(c[0], u, v + vHeight);
 
+    if (IsQuadBatchActive())
+    {
+        float Alpha = 1.f;
+        if (Bitmaps[Texture].Components != 3 && Texture != BITMAP_BLOOD + 1 && Texture != BITMAP_FONT_HIT)
+            Alpha = Light[0];
+
+        BATCH_VERTEX Vertices[4];
+        for (int i = 0; i < 4; i++)
+        {
+            VectorCopy(p[i], Vertices[i].Position);
+            Vertices[i].TexCoord[0] = c[i][0];
+            Vertices[i].TexCoord[1] = c[i][1];
+            Vector4(Light[0], Light[1], Light[2], Alpha, Vertices[i].Color);
+        }
+        AddBatchQuad(Vertices);
+        return;
+    }
+
+    ++g_RenderCounters.DrawCalls;
     glBegin(GL_QUADS);
     if (Bitmaps[Texture].Components == 3)
         glColor3fv(Light);
@@ -1065,6 +1270,21 @@ void RenderSpriteUV(int Texture, vec3_t Position, float Width, float Height, flo
     Vector(x + Width, y + Height, z, p[2]);
     Vector(x - Width, y + Height, z, p[3]);
 
+    if (IsQuadBatchActive())
+    {
+        BATCH_VERTEX Vertices[4];
+        for (int i = 0; i < 4; i++)
+        {
+            VectorCopy(p[i], Vertices[i].Position);
+            Vertices[i].TexCoord[0] = UV[i][0];
+            Vertices[i].TexCoord[1] = UV[i][1];
+            Vector4(Light[i][0], Light[i][1], Light[i][2], Alpha, Vertices[i].Color);
+        }
+        AddBatchQuad(Vertices);
+        return;
+    }
+
+    ++g_RenderCounters.DrawCalls;
     glBegin(GL_QUADS);
     for (int i = 0; i < 4; i++)
     {
@@ -1138,6 +1358,8 @@ float RenderNumber2D(float x, float y, int Num, float Width, float Height)
 
 void BeginBitmap()
 {
+    FlushRenderQueue();
+
     glMatrixMode(GL_PROJECTION);
     glPushMatrix();
     glLoadIdentity();
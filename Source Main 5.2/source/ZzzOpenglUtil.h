@@ -49,6 +49,8 @@ extern bool         GrabEnable;
 bool CheckID_HistoryDay(wchar_t* Name, WORD day);
 void gluPerspective2(float Fov, float Aspect, float ZNear, float ZFar);
 void glViewport2(int x, int y, int Width, int Height);
+float ConvertX(float x);
+float ConvertY(float y);
 void CreateScreenVector(int sx, int sy, vec3_t Target, bool bFixView = true);
 void Projection(vec3_t Position, int* sx, int* sy);
 void GetOpenGLMatrix(float Matrix[3][4]);
@@ -66,11 +68,17 @@ void DisableTexture(bool AlphaTest = false);
 void DisableAlphaBlend();
 void EnableLightMap();
 void EnableAlphaTest(bool DepthMake = true);
+// glAlphaFunc(GL_GREATER, ref) that queued draws capture with the rest of their state
+void SetAlphaTestReference(float ref);
 void EnableAlphaBlend();
 void EnableAlphaBlendMinus();
 void EnableAlphaBlend2();
 void EnableAlphaBlend3();
 void EnableAlphaBlend4();
+void EnableAlphaBlendPremultiplied();
+// While set, the blend modes also keep a premultiplied alpha channel for a texture target.
+// Returns false when the driver lacks glBlendFuncSeparate.
+bool SetPremultipliedBlendTarget(bool enable);
 void BindTexture(int tex);
 void BindTextureStream(int tex);
 void EndTextureStream();
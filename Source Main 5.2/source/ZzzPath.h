@@ -36,17 +36,34 @@ public:
     static int s_iDir[8][2];
 
 private:
+    // Open set as a binary min-heap in a buffer allocated once per map. Equal costs come
+    // out in insertion order (the sequence number), which is the order the old tree gave,
+    // so the paths found are unchanged. A search expands at most 500 nodes and adds each
+    // neighbour once, which bounds the heap.
+    enum { MAX_OPEN_NODES = 500 * 8 + 1 };
+
+    typedef struct
+    {
+        int Cost;
+        int Sequence;
+        int Index;
+    } OPEN_NODE;
+
     EPathNodeState* m_pbyClosed;
     int m_iMinClosed, m_iMaxClosed;
     int* m_piCostToStart;
     int* m_pxPrev;
     int* m_pyPrev;
-    CBTree<int, int> m_btOpenNodes;
+    OPEN_NODE* m_pOpenNodes;
+    int m_iNumOpenNodes;
+    int m_iOpenSequence;
 
     void Clear(void);
     bool AddClearPos(int iIndex);
     void Init(void);
+    bool AddOpenNode(int iIndex, int iCost);
     int GetNewNodeToTest(void);
+    static bool IsBefore(const OPEN_NODE& Node1, const OPEN_NODE& Node2) { return (Node1.Cost < Node2.Cost || (Node1.Cost == Node2.Cost && Node1.Sequence < Node2.Sequence)); }
 
 public:
     bool FindPath(int xStart, int yStart, int xEnd, int yEnd, bool bErrorCheck, int iWall, bool Value, float fDistance = 0.0f);
@@ -69,6 +86,9 @@ inline PATH::PATH()
     m_piCostToStart = NULL;
     m_pxPrev = NULL;
     m_pyPrev = NULL;
+    m_pOpenNodes = NULL;
+    m_iNumOpenNodes = 0;
+    m_iOpenSequence = 0;
 }
 
 inline PATH::~PATH()
@@ -98,6 +118,12 @@ inline void PATH::Clear(void)
         delete[] m_pyPrev;
         m_pyPrev = NULL;
     }
+    if (m_pOpenNodes)
+    {
+        delete[] m_pOpenNodes;
+        m_pOpenNodes = NULL;
+    }
+    m_iNumOpenNodes = 0;
     m_iMinClosed = MAX_INT_FORPATH;
     m_iMaxClosed = -1;
 }
@@ -115,6 +141,7 @@ inline void PATH::SetMapDimensions(int iWidth, int iHeight, WORD* pbyMap)
     m_piCostToStart = new int[m_iSize];
     m_pxPrev = new int[m_iSize];
     m_pyPrev = new int[m_iSize];
+    m_pOpenNodes = new OPEN_NODE[MAX_OPEN_NODES];
     ZeroMemory(m_pbyClosed, m_iSize * sizeof(BYTE));
 }
 
@@ -143,28 +170,70 @@ inline void PATH::Init(void)
     m_iMaxClosed = -1;
 }
 
+inline bool PATH::AddOpenNode(int iIndex, int iCost)
+{
+    if (m_iNumOpenNodes >= MAX_OPEN_NODES)
+    {
+        return false;
+    }
+
+    OPEN_NODE Node = { iCost, m_iOpenSequence++, iIndex };
+
+    int iChild = m_iNumOpenNodes++;
+    while (iChild > 0)
+    {
+        int iParent = (iChild - 1) / 2;
+        if (!IsBefore(Node, m_pOpenNodes[iParent]))
+        {
+            break;
+        }
+        m_pOpenNodes[iChild] = m_pOpenNodes[iParent];
+        iChild = iParent;
+    }
+    m_pOpenNodes[iChild] = Node;
+
+    return true;
+}
+
 inline int PATH::GetNewNodeToTest(void)
 {
-    CBNode<int, int>* pResult = NULL;
-    CBNode<int, int>* pNode = m_btOpenNodes.FindHead();
-    while (pNode)
+    if (m_iNumOpenNodes == 0)
     {
-        pResult = pNode;
-        pNode = m_btOpenNodes.GetLeft(pNode);
+        return -1;
     }
 
-    int iIndex = -1;
-    if (pResult)
+    int iIndex = m_pOpenNodes[0].Index;
+
+    OPEN_NODE Last = m_pOpenNodes[--m_iNumOpenNodes];
+    int iParent = 0;
+    while (true)
     {
-        iIndex = pResult->GetData();
-        m_btOpenNodes.RemoveNode(pResult);
+        int iChild = iParent * 2 + 1;
+        if (iChild >= m_iNumOpenNodes)
+        {
+            break;
+        }
+        if (iChild + 1 < m_iNumOpenNodes && IsBefore(m_pOpenNodes[iChild + 1], m_pOpenNodes[iChild]))
+        {
+            iChild++;
+        }
+        if (!IsBefore(m_pOpenNodes[iChild], Last))
+        {
+            break;
+        }
+        m_pOpenNodes[iParent] = m_pOpenNodes[iChild];
+        iParent = iChild;
     }
+    m_pOpenNodes[iParent] = Last;
+
     return iIndex;
 }
 
 inline bool PATH::FindPath(int xStart, int yStart, int xEnd, int yEnd, bool bErrorCheck, int iWall, bool Value, float fDistance)
 {
     Init();
+    m_iNumOpenNodes = 0;
+    m_iOpenSequence = 0;
 
     if (xStart == 0 || yStart == 0)
     {
@@ -210,7 +279,7 @@ inline bool PATH::FindPath(int xStart, int yStart, int xEnd, int yEnd, bool bErr
         return false;
     }
 
-    m_btOpenNodes.Add(iStartIndex, 0);
+    AddOpenNode(iStartIndex, 0);
     m_pbyClosed[iStartIndex] |= PATH_INTESTLIST;
     if (!AddClearPos(iStartIndex))
     {
@@ -218,7 +287,7 @@ inline bool PATH::FindPath(int xStart, int yStart, int xEnd, int yEnd, bool bErr
     }
 
     int iMaxCount = bErrorCheck ? 500 : 50;
-    for (int iCheckCount = iMaxCount; 0 < m_btOpenNodes.GetCount() && iCheckCount > 0; --iCheckCount)
+    for (int iCheckCount = iMaxCount; 0 < m_iNumOpenNodes && iCheckCount > 0; --iCheckCount)
     {
         int xTest, yTest;
         int iIndex = GetNewNodeToTest();
@@ -254,7 +323,7 @@ inline bool PATH::FindPath(int xStart, int yStart, int xEnd, int yEnd, bool bErr
 
         if (PATH_END & m_pbyClosed[iIndex])
         {
-            m_btOpenNodes.RemoveAll();
+            m_iNumOpenNodes = 0;
             return (GeneratePath(xStart, yStart, xTest, yTest));
         }
 
@@ -276,7 +345,8 @@ inline bool PATH::FindPath(int xStart, int yStart, int xEnd, int yEnd, bool bErr
             if (!(PATH_INTESTLIST & m_pbyClosed[iNewIndex]) && iWall > byMapAttribute)
             {
                 int iNewCost = m_piCostToStart[iIndex] + EstimateCostToGoal(xEnd, yEnd, xNew, yNew);
-                m_btOpenNodes.Add(iNewIndex, iNewCost);
+                if (!AddOpenNode(iNewIndex, iNewCost))
+                    return false;
                 m_pbyClosed[iNewIndex] |= PATH_INTESTLIST;
                 if (!AddClearPos(iNewIndex))
                     return false;
@@ -297,11 +367,11 @@ inline bool PATH::FindPath(int xStart, int yStart, int xEnd, int yEnd, bool bErr
     }
     if (!bErrorCheck)
     {
-        m_btOpenNodes.RemoveAll();
+        m_iNumOpenNodes = 0;
         return (GeneratePath(xStart, yStart, xNearest, yNearest));
     }
 
-    m_btOpenNodes.RemoveAll();
+    m_iNumOpenNodes = 0;
 
     return false;
 }
@@ -35,6 +35,10 @@
 #include "CComGem.h"
 #include "UIMapName.h"	// rozy
 #include "./Time/Timer.h"
+#include "./Utilities/Profiler.h"
+#include "./Utilities/PacketCapture.h"
+#include "./Utilities/ScreenCapture.h"
+#include "RenderQueue.h"
 #include "Input.h"
 #include "UIMng.h"
 #include "LoadingScene.h"
@@ -1198,6 +1202,47 @@ bool NewRenderLogInScene(HDC hDC)
     return true;
 }
 
+static void ReleaseLoadingScene()
+{
+    SAFE_DELETE(CUIMng::Instance().m_pLoadingScene);
+    for (int i = 0; i < 4; ++i)
+        ::DeleteBitmap(BITMAP_TITLE + i);
+
+    gMapManager.SetLoadingProgressCallback(NULL);
+}
+
+static void RenderLoadingScene(HDC hDC)
+{
+    FogEnable = false;
+    ::BeginOpengl();
+    ::glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    ::BeginBitmap();
+
+    CUIMng::Instance().m_pLoadingScene->Render();
+
+    ::EndBitmap();
+    ::EndOpengl();
+    ::glFlush();
+    ::SwapBuffers(hDC);
+}
+
+// The loading screen stays up until the next LoadWorld, which is the world the server
+// puts the hero in; it is redrawn with the progress between the load stages.
+static void UpdateLoadingProgress(int iStep, int iStepCount)
+{
+    if (CUIMng::Instance().m_pLoadingScene == NULL)
+        return;
+
+    if (iStep >= iStepCount)
+    {
+        ReleaseLoadingScene();
+        return;
+    }
+
+    CUIMng::Instance().m_pLoadingScene->SetProgress(iStep, iStepCount);
+    RenderLoadingScene(g_hDC);
+}
+
 void LoadingScene(HDC hDC)
 {
     g_ConsoleDebug->Write(MCD_NORMAL, L"LoadingScene_Start");
@@ -1209,6 +1254,9 @@ void LoadingScene(HDC hDC)
 
         InitLoading = true;
 
+        if (rUIMng.m_pLoadingScene != NULL)
+            ReleaseLoadingScene();
+
         LoadBitmap(L"Interface\\LSBg01.JPG", BITMAP_TITLE, GL_LINEAR);
         LoadBitmap(L"Interface\\LSBg02.JPG", BITMAP_TITLE + 1, GL_LINEAR);
         LoadBitmap(L"Interface\\LSBg03.JPG", BITMAP_TITLE + 2, GL_LINEAR);
@@ -1218,25 +1266,12 @@ void LoadingScene(HDC hDC)
 
         rUIMng.m_pLoadingScene = new CLoadingScene;
         rUIMng.m_pLoadingScene->Create();
+        gMapManager.SetLoadingProgressCallback(UpdateLoadingProgress);
     }
 
-    FogEnable = false;
-    ::BeginOpengl();
-    ::glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    ::BeginBitmap();
-
-    rUIMng.m_pLoadingScene->Render();
-
-    ::EndBitmap();
-    ::EndOpengl();
-    ::glFlush();
-    ::SwapBuffers(hDC);
-
-    SAFE_DELETE(rUIMng.m_pLoadingScene);
+    RenderLoadingScene(hDC);
 
     SceneFlag = MAIN_SCENE;
-    for (int i = 0; i < 4; ++i)
-        ::DeleteBitmap(BITMAP_TITLE + i);
 
     ::ClearInput();
 
@@ -1552,6 +1587,8 @@ bool MoveMainCamera()
 
 void MoveMainScene()
 {
+    PROFILE_SCOPE("MoveMainScene");
+
     if (!InitMainScene)
     {
         g_pMainFrame->ResetSkillHotKey();
@@ -1709,6 +1746,8 @@ void MoveMainScene()
 
 bool RenderMainScene()
 {
+    PROFILE_SCOPE("RenderMainScene");
+
     if (EnableMainRender == false)
     {
         return false;
@@ -1800,6 +1839,9 @@ bool RenderMainScene()
 
     CreateScreenVector(MouseX, MouseY, MouseTarget);
 
+    // opaque model draws of the world pass are sorted by state until the effects start
+    BeginRenderQueue();
+
     if (IsWaterTerrain() == false)
     {
         if (gMapManager.WorldActive == WD_39KANTURU_3RD)
@@ -1843,6 +1885,8 @@ bool RenderMainScene()
     RenderBoids(true);
     RenderObjects_AfterCharacter();
 
+    EndRenderQueue();
+
     RenderJoints(byWaterMap);
     RenderEffects();
     RenderBlurs();
@@ -1948,6 +1992,9 @@ extern int WaterTextureNumber;
 int TestTime = 0;
 extern int  GrabScreen;
 
+// shown once the frame has been captured, so it stays out of the screenshot
+static wchar_t s_PendingScreenshotText[256] = L"";
+
 void MoveCharacter(CHARACTER* c, OBJECT* o);
 
 double target_fps = 60;
@@ -1970,6 +2017,8 @@ double last_water_change = 0;
 
 void UpdateSceneState()
 {
+    PROFILE_SCOPE("UpdateScene");
+
     g_pNewKeyInput->ScanAsyncKeyState();
 
     g_dwMouseUseUIID = 0;
@@ -1991,9 +2040,37 @@ void UpdateSceneState()
 
     MoveNotices();
 
+#ifdef ENABLE_PROFILER
+    if (PressKey(VK_F11))
+    {
+        if (HIBYTE(GetAsyncKeyState(VK_SHIFT)))
+        {
+            if (Profiler::Instance()->StartCapture(300))
+                g_pSystemLogBox->AddText(L"Profiler: capturing 300 frames", SEASON3B::TYPE_SYSTEM_MESSAGE);
+        }
+        else
+        {
+            Profiler::Instance()->ToggleOverlay();
+        }
+    }
+#endif // ENABLE_PROFILER
+
     if (PressKey(VK_SNAPSHOT))
     {
-        if (GrabEnable)
+        if (HIBYTE(GetAsyncKeyState(VK_CONTROL)))
+        {
+            ScreenCapture* capture = ScreenCapture::Instance();
+            if (capture->IsSequenceRunning())
+            {
+                capture->StopSequence();
+                g_pSystemLogBox->AddText(L"Capture: sequence stopped", SEASON3B::TYPE_SYSTEM_MESSAGE);
+            }
+            else if (capture->StartSequence(300, 100))
+            {
+                g_pSystemLogBox->AddText(L"Capture: recording 300 frames", SEASON3B::TYPE_SYSTEM_MESSAGE);
+            }
+        }
+        else if (GrabEnable)
             GrabEnable = false;
         else
             GrabEnable = true;
@@ -2015,13 +2092,7 @@ void UpdateSceneState()
             g_pSystemLogBox->AddText(screenshotText, SEASON3B::TYPE_SYSTEM_MESSAGE);
         }
 
-        auto Buffer = new unsigned char[WindowWidth * WindowHeight * 3];
-
-        glReadPixels(0, 0, WindowWidth, WindowHeight, GL_RGB, GL_UNSIGNED_BYTE, &Buffer[0]);
-
-        WriteJpeg(GrabFileName, WindowWidth, WindowHeight, &Buffer[0], 100);
-
-        SAFE_DELETE_ARRAY(Buffer);
+        ScreenCapture::Instance()->RequestScreenshot(GrabFileName);
 
         GrabScreen++;
         GrabScreen %= 10000;
@@ -2029,12 +2100,51 @@ void UpdateSceneState()
 
     if (GrabEnable && !addTimeStampToCapture)
     {
-        g_pSystemLogBox->AddText(screenshotText, SEASON3B::TYPE_SYSTEM_MESSAGE);
+        wcscpy(s_PendingScreenshotText, screenshotText);
     }
 
     GrabEnable = false;
 }
 
+#ifdef ENABLE_PROFILER
+static void RenderProfilerOverlay()
+{
+    Profiler* profiler = Profiler::Instance();
+    if (!profiler->IsOverlayVisible())
+        return;
+
+    static std::vector<Profiler::ZONE_STAT> s_ZoneStats;
+    profiler->GetZoneStats(s_ZoneStats);
+
+    BeginBitmap();
+    g_pRenderText->SetFont(g_hFont);
+    g_pRenderText->SetBgColor(0, 0, 0, 160);
+    g_pRenderText->SetTextColor(255, 255, 255, 255);
+
+    wchar_t szText[128];
+    int y = 60;
+    swprintf(szText, L"Frame: %.2f ms%ls", profiler->GetFrameMilliseconds(), profiler->IsCapturing() ? L" [capturing]" : L"");
+    g_pRenderText->RenderText(10, y, szText);
+
+    y += 10;
+    swprintf(szText, L"Draws: %d  Binds: %d  States: %d  Queued: %d (%d flushes)  Batched quads: %d", g_LastRenderCounters.DrawCalls,
+        g_LastRenderCounters.TextureBinds, g_LastRenderCounters.StateChanges, g_LastRenderCounters.QueuedCommands, g_LastRenderCounters.Flushes,
+        g_LastRenderCounters.BatchedQuads);
+    g_pRenderText->RenderText(10, y, szText);
+
+    for (const auto& zone : s_ZoneStats)
+    {
+        y += 10;
+        if (y > 470)
+            break;
+
+        swprintf(szText, L"%*ls%hs: %.2f ms (%.1f)", zone.Depth * 2, L"", zone.Name, zone.Milliseconds, zone.Calls);
+        g_pRenderText->RenderText(10, y, szText);
+    }
+    EndBitmap();
+}
+#endif // ENABLE_PROFILER
+
 void MainScene(HDC hDC)
 {
     if (SceneFlag == LOG_IN_SCENE || SceneFlag == CHARACTER_SCENE)
@@ -2144,10 +2254,23 @@ void MainScene(HDC hDC)
         EndBitmap();
 #endif // defined(_DEBUG) || defined(LDS_FOR_DEVELOPMENT_TESTMODE) || defined(LDS_UNFIXED_FIXEDFRAME_FORDEBUG)
 
+#ifdef ENABLE_PROFILER
+        RenderProfilerOverlay();
+#endif // ENABLE_PROFILER
+
         if (Success)
         {
+            ScreenCapture::Instance()->Capture();
+            if (s_PendingScreenshotText[0] != L'\0')
+            {
+                g_pSystemLogBox->AddText(s_PendingScreenshotText, SEASON3B::TYPE_SYSTEM_MESSAGE);
+                s_PendingScreenshotText[0] = L'\0';
+            }
+
+            PROFILE_SCOPE("SwapBuffers");
             SwapBuffers(hDC);
         }
+        ResetRenderCounters();
 
         if (SocketClient == nullptr || !SocketClient->IsConnected())
         {
@@ -2518,6 +2641,12 @@ void RenderScene(HDC hDC)
     catch (const std::exception&)
     {
     }
+
+#ifdef ENABLE_PROFILER
+    Profiler::Instance()->EndFrame();
+#endif // ENABLE_PROFILER
+
+    PacketCapture::Instance()->EndFrame();
 }
 
 bool GetTimeCheck(int DelayTime)
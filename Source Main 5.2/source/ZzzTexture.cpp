@@ -22,15 +22,18 @@ bool WriteJpeg(wchar_t* filename, int Width, int Height, unsigned char* Buffer,
 
     const auto handle = tjInitCompress();
     unsigned long jpegSize = 0;
-    auto maxSize = tjBufSize(Width, Height, TJSAMP_444);
-    auto outputBuffer = new unsigned char[maxSize];
-    
-    tjCompress2(handle, Buffer, Width, 0, Height, TJPF_RGB, &outputBuffer, &jpegSize, TJSAMP_444, quality, TJFLAG_BOTTOMUP);
-    fwrite(outputBuffer, 1, jpegSize, outfile);
+    unsigned char* outputBuffer = nullptr;
+
+    const bool success = tjCompress2(handle, Buffer, Width, 0, Height, TJPF_RGB, &outputBuffer, &jpegSize, TJSAMP_444, quality, TJFLAG_BOTTOMUP) == 0;
+    if (success)
+    {
+        fwrite(outputBuffer, 1, jpegSize, outfile);
+    }
     fclose(outfile);
+    tjFree(outputBuffer);
     tjDestroy(handle);
 
-    return TRUE;
+    return success;
 }
 
 void SaveImage(int HeaderSize, wchar_t* Ext, wchar_t* filename, BYTE* PakBuffer, int Size)
@@ -81,11 +84,8 @@ void SaveImage(int HeaderSize, wchar_t* Ext, wchar_t* filename, BYTE* PakBuffer,
     }
 }
 
-bool OpenJpegBuffer(wchar_t* filename, float* BufferFloat)
+static void GetJpegBufferFileName(const wchar_t* filename, wchar_t* FileName)
 {
-    
-    wchar_t FileName[256];
-
     wchar_t NewFileName[256];
     int iTextcnt = 0;
     for (int i = 0; i < (int)wcslen(filename); i++)
@@ -98,16 +98,17 @@ bool OpenJpegBuffer(wchar_t* filename, float* BufferFloat)
     wcscpy(FileName, L"Data\\");
     wcscat(FileName, NewFileName);
     wcscat(FileName, L"OZJ");
+}
+
+bool DecodeJpegBuffer(const wchar_t* filename, std::vector<float>& BufferFloat, bool& bFileExists)
+{
+    wchar_t FileName[256];
+    GetJpegBufferFileName(filename, FileName);
 
     auto compressedFile = _wfopen(FileName, L"rb");
+    bFileExists = compressedFile != nullptr;
     if (compressedFile == nullptr)
     {
-        wchar_t Text[256];
-        swprintf(Text, L"%s - File not exist.", FileName);
-        g_ErrorReport.Write(Text);
-        g_ErrorReport.Write(L"\r\n");
-        MessageBox(g_hWnd, Text, NULL, MB_OK);
-        SendMessage(g_hWnd, WM_DESTROY, 0, 0);
         return false;
     }
 
@@ -115,6 +116,7 @@ bool OpenJpegBuffer(wchar_t* filename, float* BufferFloat)
     const auto fileSize = ftell(compressedFile);
     if (fileSize < 24)
     {
+        fclose(compressedFile);
         return false;
     }
 
@@ -126,39 +128,61 @@ bool OpenJpegBuffer(wchar_t* filename, float* BufferFloat)
     int jpegSubsamp = TJSAMP_444;
     int jpegColorspace = TJCS_RGB;
 
-    auto tjhandle = tjInitDecompress();
-
-    auto jpegBuf = new BYTE[jpegSize];
-    fread(jpegBuf, 1, jpegSize, compressedFile);
+    std::vector<BYTE> jpegBuf(jpegSize);
+    fread(jpegBuf.data(), 1, jpegSize, compressedFile);
     fclose(compressedFile);
 
+    auto tjhandle = tjInitDecompress();
+
     // First reading the header with the size information
-    auto result = tjDecompressHeader3(tjhandle, jpegBuf, jpegSize, &jpegWidth, &jpegHeight, &jpegSubsamp, &jpegColorspace);
+    auto result = tjDecompressHeader3(tjhandle, jpegBuf.data(), jpegSize, &jpegWidth, &jpegHeight, &jpegSubsamp, &jpegColorspace);
     if (result != 0)
     {
-        delete[] jpegBuf;
+        tjDestroy(tjhandle);
         return false;
     }
 
     // decompress into the buffer
     const auto bufferSize = jpegWidth * jpegHeight * 3;
-    const auto buffer = new BYTE[bufferSize];
-    result = tjDecompress2(tjhandle, jpegBuf, jpegSize, buffer, jpegWidth, 0, jpegHeight, TJPF_RGB, TJFLAG_BOTTOMUP);
-    delete[] jpegBuf;
-    jpegBuf = nullptr;
+    std::vector<BYTE> buffer(bufferSize);
+    result = tjDecompress2(tjhandle, jpegBuf.data(), jpegSize, buffer.data(), jpegWidth, 0, jpegHeight, TJPF_RGB, TJFLAG_BOTTOMUP);
+    tjDestroy(tjhandle);
     if (result != 0)
     {
-        delete[] buffer;
         return false;
     }
 
+    BufferFloat.resize(bufferSize);
     for (int i = 0; i < bufferSize; ++i)
     {
         BufferFloat[i] = static_cast<float>(buffer[i]) / 255.f;
     }
 
-    delete[] buffer;
-    
+    return true;
+}
+
+bool OpenJpegBuffer(wchar_t* filename, float* BufferFloat)
+{
+    std::vector<float> Decoded;
+    bool bFileExists = false;
+    if (!DecodeJpegBuffer(filename, Decoded, bFileExists))
+    {
+        if (!bFileExists)
+        {
+            wchar_t FileName[256];
+            GetJpegBufferFileName(filename, FileName);
+
+            wchar_t Text[256];
+            swprintf(Text, L"%s - File not exist.", FileName);
+            g_ErrorReport.Write(Text);
+            g_ErrorReport.Write(L"\r\n");
+            MessageBox(g_hWnd, Text, NULL, MB_OK);
+            SendMessage(g_hWnd, WM_DESTROY, 0, 0);
+        }
+        return false;
+    }
+
+    memcpy(BufferFloat, Decoded.data(), Decoded.size() * sizeof(float));
     return true;
 }
 
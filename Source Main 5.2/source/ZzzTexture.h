@@ -4,6 +4,10 @@
 #include "GlobalBitmap.h"
 //extern CGlobalBitmap Bitmaps;
 
+// Decodes Data\<filename>.OZJ to RGB floats in [0, 1]. Shows nothing on failure and
+// touches no shared state, so it may run on a worker; bFileExists tells a missing file
+// from a broken one.
+bool DecodeJpegBuffer(const wchar_t* filename, std::vector<float>& BufferFloat, bool& bFileExists);
 bool OpenJpegBuffer(wchar_t* filename, float* BufferFloat);
 bool WriteJpeg(wchar_t* filename, int Width, int Height, unsigned char* Buffer, int quality);
 void SaveImage(int HeaderSize, wchar_t* Ext, wchar_t* filename, BYTE* PakBuffer, int Size);
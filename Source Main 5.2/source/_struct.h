@@ -4,6 +4,7 @@
 #pragma once
 
 #include "w_Buff.h"
+#include "JointTail.h"
 
 #include "w_ObjectInfo.h"
 class OBJECT;
@@ -645,7 +646,21 @@ typedef struct
     bool        m_bCreateTails; // Flag, if tails are created.
     int         NumTails; // The number of currently used tail entries. Usually this gets increased by one in every frame until the maximum is reached.
     int         MaxTails; // The maximum number of tail entries to use.
-    vec3_t      Tails[MAX_TAILS][4]; // The tail entries, which are getting moved back by one in every frame.
+    int         TailHead; // The slot of Tails which holds the newest entry.
+    vec3_t      Tails[MAX_TAILS][4]; // Ring buffer of the tail entries, use GetTail instead of indexing it.
+
+    // The tail entry 'index' frames back, 0 being the newest one.
+    vec3_t* GetTail(int index)
+    {
+        return Tails[GetTailSlot(TailHead, index, MAX_TAILS)];
+    }
+
+    // Starts a new newest entry. The older ones move back by one without being copied.
+    vec3_t* PushTail()
+    {
+        TailHead = PushTailSlot(TailHead, MAX_TAILS);
+        return Tails[TailHead];
+    }
 } JOINT;
 //character end
 
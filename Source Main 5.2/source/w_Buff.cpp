@@ -7,53 +7,53 @@
 
 namespace
 {
-    void GetTokenBufflist(std::list<eBuffState>& outtokenbufflist, const eBuffState curbufftype)
+    void GetTokenBuffSet(BuffStateSet& outtokenbuffset, const eBuffState curbufftype)
     {
         if (curbufftype >= eBuff_CastleRegimentDefense && curbufftype <= eBuff_CastleRegimentAttack3)
         {
-            outtokenbufflist.push_back(eBuff_CastleRegimentDefense); outtokenbufflist.push_back(eBuff_CastleRegimentAttack1);
-            outtokenbufflist.push_back(eBuff_CastleRegimentAttack2); outtokenbufflist.push_back(eBuff_CastleRegimentAttack3);
+            outtokenbuffset.set(eBuff_CastleRegimentDefense); outtokenbuffset.set(eBuff_CastleRegimentAttack1);
+            outtokenbuffset.set(eBuff_CastleRegimentAttack2); outtokenbuffset.set(eBuff_CastleRegimentAttack3);
         }
         if (curbufftype >= eBuff_CrywolfAltarEnable && curbufftype <= eBuff_CrywolfNPCHide)
         {
-            outtokenbufflist.push_back(eBuff_CrywolfAltarEnable); outtokenbufflist.push_back(eBuff_CrywolfAltarDisable);
-            outtokenbufflist.push_back(eBuff_CrywolfAltarContracted); outtokenbufflist.push_back(eBuff_CrywolfAltarAttempt);
-            outtokenbufflist.push_back(eBuff_CrywolfAltarOccufied); outtokenbufflist.push_back(eBuff_CrywolfHeroContracted);
-            outtokenbufflist.push_back(eBuff_CrywolfNPCHide);
+            outtokenbuffset.set(eBuff_CrywolfAltarEnable); outtokenbuffset.set(eBuff_CrywolfAltarDisable);
+            outtokenbuffset.set(eBuff_CrywolfAltarContracted); outtokenbuffset.set(eBuff_CrywolfAltarAttempt);
+            outtokenbuffset.set(eBuff_CrywolfAltarOccufied); outtokenbuffset.set(eBuff_CrywolfHeroContracted);
+            outtokenbuffset.set(eBuff_CrywolfNPCHide);
         }
         if ((curbufftype >= eBuff_PcRoomSeal1 && curbufftype <= eBuff_PcRoomSeal3) || curbufftype == eBuff_NewWealthSeal)
         {
-            outtokenbufflist.push_back(eBuff_NewWealthSeal);
-            outtokenbufflist.push_back(eBuff_PcRoomSeal1); outtokenbufflist.push_back(eBuff_PcRoomSeal2);
-            outtokenbufflist.push_back(eBuff_PcRoomSeal3);
+            outtokenbuffset.set(eBuff_NewWealthSeal);
+            outtokenbuffset.set(eBuff_PcRoomSeal1); outtokenbuffset.set(eBuff_PcRoomSeal2);
+            outtokenbuffset.set(eBuff_PcRoomSeal3);
         }
         // eBuff_Seal_HpRecovery, eBuff_Seal_MpRecovery
         if ((curbufftype >= eBuff_Seal1 && curbufftype <= eBuff_Seal4)
             || curbufftype == eBuff_AscensionSealMaster || curbufftype == eBuff_WealthSealMaster)
         {
-            outtokenbufflist.push_back(eBuff_Seal1);
-            outtokenbufflist.push_back(eBuff_Seal2);
-            outtokenbufflist.push_back(eBuff_Seal3);
-            outtokenbufflist.push_back(eBuff_Seal4);
-            outtokenbufflist.push_back(eBuff_Seal_HpRecovery);
-            outtokenbufflist.push_back(eBuff_Seal_MpRecovery);
-            outtokenbufflist.push_back(eBuff_AscensionSealMaster);
-            outtokenbufflist.push_back(eBuff_WealthSealMaster);
+            outtokenbuffset.set(eBuff_Seal1);
+            outtokenbuffset.set(eBuff_Seal2);
+            outtokenbuffset.set(eBuff_Seal3);
+            outtokenbuffset.set(eBuff_Seal4);
+            outtokenbuffset.set(eBuff_Seal_HpRecovery);
+            outtokenbuffset.set(eBuff_Seal_MpRecovery);
+            outtokenbuffset.set(eBuff_AscensionSealMaster);
+            outtokenbuffset.set(eBuff_WealthSealMaster);
         }
 
         if (curbufftype >= eBuff_EliteScroll1 && curbufftype <= eBuff_EliteScroll6)
         {
-            outtokenbufflist.push_back(eBuff_EliteScroll1); outtokenbufflist.push_back(eBuff_EliteScroll2);
-            outtokenbufflist.push_back(eBuff_EliteScroll3); outtokenbufflist.push_back(eBuff_EliteScroll4);
-            outtokenbufflist.push_back(eBuff_EliteScroll5); outtokenbufflist.push_back(eBuff_EliteScroll6);
-            outtokenbufflist.push_back(eBuff_Scroll_Battle);
-            outtokenbufflist.push_back(eBuff_Scroll_Strengthen);
+            outtokenbuffset.set(eBuff_EliteScroll1); outtokenbuffset.set(eBuff_EliteScroll2);
+            outtokenbuffset.set(eBuff_EliteScroll3); outtokenbuffset.set(eBuff_EliteScroll4);
+            outtokenbuffset.set(eBuff_EliteScroll5); outtokenbuffset.set(eBuff_EliteScroll6);
+            outtokenbuffset.set(eBuff_Scroll_Battle);
+            outtokenbuffset.set(eBuff_Scroll_Strengthen);
         }
         if (curbufftype >= eBuff_SecretPotion1 && curbufftype <= eBuff_SecretPotion5)
         {
-            outtokenbufflist.push_back(eBuff_SecretPotion1); outtokenbufflist.push_back(eBuff_SecretPotion2);
-            outtokenbufflist.push_back(eBuff_SecretPotion3); outtokenbufflist.push_back(eBuff_SecretPotion4);
-            outtokenbufflist.push_back(eBuff_SecretPotion5);
+            outtokenbuffset.set(eBuff_SecretPotion1); outtokenbuffset.set(eBuff_SecretPotion2);
+            outtokenbuffset.set(eBuff_SecretPotion3); outtokenbuffset.set(eBuff_SecretPotion4);
+            outtokenbuffset.set(eBuff_SecretPotion5);
         }
     }
 }
@@ -73,38 +73,42 @@ Buff::~Buff()
     ClearBuff();
 }
 
-bool Buff::isBuff()
+BuffStateSet Buff::MakeBuffStateSet(const std::list<eBuffState>& buffstatelist)
 {
-    if (m_Buff.size() != 0) return true;
-    return false;
+    BuffStateSet buffstateset;
+
+    for (auto iter = buffstatelist.begin(); iter != buffstatelist.end(); ++iter)
+    {
+        if (IsValidBuffState(*iter))
+        {
+            buffstateset.set(*iter);
+        }
+    }
+
+    return buffstateset;
 }
 
-bool Buff::isBuff(eBuffState buffstate)
+const eBuffState Buff::isBuff(const std::list<eBuffState>& buffstatelist)
 {
-    if (!isBuff()) return false;
-
-    auto iter = m_Buff.find(buffstate);
+    if (!isBuff()) return eBuffNone;
 
-    if (iter != m_Buff.end())
+    for (auto iter = buffstatelist.begin(); iter != buffstatelist.end(); ++iter)
     {
-        return true;
+        if (isBuff(*iter)) return (*iter);
     }
 
-    return false;
+    return eBuffNone;
 }
 
-const eBuffState Buff::isBuff(std::list<eBuffState> buffstatelist)
+const eBuffState Buff::isBuff(const BuffStateSet& buffstateset)
 {
-    if (!isBuff()) return eBuffNone;
+    const BuffStateSet matched = m_Buff & buffstateset;
 
-    for (auto iter = buffstatelist.begin();
-         iter != buffstatelist.end(); )
-    {
-        auto Tempiter = iter;
-        ++iter;
-        eBuffState tempbufftype = (*Tempiter);
+    if (matched.none()) return eBuffNone;
 
-        if (isBuff(tempbufftype)) return tempbufftype;
+    for (int i = 0; i < MAX_BUFF_STATE; ++i)
+    {
+        if (matched.test(i)) return static_cast<eBuffState>(i);
     }
 
     return eBuffNone;
@@ -112,48 +116,35 @@ const eBuffState Buff::isBuff(std::list<eBuffState> buffstatelist)
 
 void Buff::TokenBuff(eBuffState curbufftype)
 {
-    std::list<eBuffState> tokenbufflist;
-    GetTokenBufflist(tokenbufflist, curbufftype);
-    UnRegisterBuff(tokenbufflist);
+    BuffStateSet tokenbuffset;
+    GetTokenBuffSet(tokenbuffset, curbufftype);
+    UnRegisterBuff(tokenbuffset);
     RegisterBuff(curbufftype);
 }
 
 const DWORD Buff::GetBuffCount(eBuffState buffstate)
 {
-    DWORD tempcount = 0;
-
-    if (!isBuff()) return tempcount;
-
-    auto iter = m_Buff.find(buffstate);
-
-    if (iter != m_Buff.end())
-    {
-        tempcount = (*iter).second;
-        return tempcount;
-    }
-
-    return tempcount;
+    return isBuff(buffstate) ? 1 : 0;
 }
 
 const DWORD Buff::GetBuffSize()
 {
-    return m_Buff.size();
+    return static_cast<DWORD>(m_Buff.count());
 }
 
 const eBuffState Buff::GetBuff(int iterindex)
 {
-    if (iterindex >= (int)GetBuffSize()) return eBuffNone;
+    if (iterindex < 0 || iterindex >= (int)GetBuffSize()) return eBuffNone;
 
     int i = 0;
 
-    for (auto iter = m_Buff.begin(); iter != m_Buff.end(); )
+    for (int buffstate = 0; buffstate < MAX_BUFF_STATE; ++buffstate)
     {
-        auto tempiter = iter;
-        ++iter;
+        if (!m_Buff.test(buffstate)) continue;
 
         if (i == iterindex)
         {
-            return (*tempiter).first;
+            return static_cast<eBuffState>(buffstate);
         }
 
         i += 1;
@@ -164,19 +155,18 @@ const eBuffState Buff::GetBuff(int iterindex)
 
 bool Buff::IsEqualBuffType(IN int iBuffType, OUT wchar_t* szBuffName)
 {
-    auto iter = m_Buff.begin();
     BuffInfo buffinfo;
 
-    while (iter != m_Buff.end())
+    for (int buffstate = 0; buffstate < MAX_BUFF_STATE; ++buffstate)
     {
-        buffinfo = TheBuffInfo().GetBuffinfo(iter->first);
+        if (!m_Buff.test(buffstate)) continue;
+
+        buffinfo = TheBuffInfo().GetBuffinfo(static_cast<eBuffState>(buffstate));
         if (buffinfo.s_BuffEffectType == iBuffType)
         {
             wcscpy(szBuffName, buffinfo.s_BuffName);
             return true;
         }
-
-        iter++;
     }
 
     return false;
@@ -184,61 +174,41 @@ bool Buff::IsEqualBuffType(IN int iBuffType, OUT wchar_t* szBuffName)
 
 void Buff::RegisterBuff(eBuffState buffstate)
 {
-    auto iter = m_Buff.find(buffstate);
-
-    if (iter == m_Buff.end())
+    if (IsValidBuffState(buffstate))
     {
-        m_Buff.insert(std::make_pair(buffstate, 1));
+        m_Buff.set(buffstate);
     }
 }
 
-void Buff::RegisterBuff(std::list<eBuffState> buffstate)
+void Buff::RegisterBuff(const std::list<eBuffState>& buffstate)
 {
-    for (auto iter = buffstate.begin(); iter != buffstate.end(); )
-    {
-        auto tempiter = iter;
-        ++iter;
-        eBuffState& tempdata = (*tempiter);
+    RegisterBuff(MakeBuffStateSet(buffstate));
+}
 
-        RegisterBuff(tempdata);
-    }
+void Buff::RegisterBuff(const BuffStateSet& buffstateset)
+{
+    m_Buff |= buffstateset;
 }
 
 void Buff::UnRegisterBuff(eBuffState buffstate)
 {
-    if (!isBuff())
+    if (IsValidBuffState(buffstate))
     {
-        return;
-    }
-
-    auto iter = m_Buff.find(buffstate);
-
-    if (iter != m_Buff.end())
-    {
-        DWORD& tempcount = (*iter).second;
-        {
-            m_Buff.erase(iter);
-        }
-    }
-    else
-    {
-        return;
+        m_Buff.reset(buffstate);
     }
 }
 
-void Buff::UnRegisterBuff(std::list<eBuffState> buffstate)
+void Buff::UnRegisterBuff(const std::list<eBuffState>& buffstate)
 {
-    for (auto iter = buffstate.begin(); iter != buffstate.end(); )
-    {
-        auto tempiter = iter;
-        ++iter;
-        eBuffState& tempdata = (*tempiter);
+    UnRegisterBuff(MakeBuffStateSet(buffstate));
+}
 
-        UnRegisterBuff(tempdata);
-    }
+void Buff::UnRegisterBuff(const BuffStateSet& buffstateset)
+{
+    m_Buff &= ~buffstateset;
 }
 
 void Buff::ClearBuff()
 {
-    m_Buff.clear();
+    m_Buff.reset();
 }
\ No newline at end of file
@@ -12,15 +12,22 @@ public:
 public:
     Buff& operator =  (const Buff& buff);
 
+public:
+    static bool IsValidBuffState(eBuffState buffstate) { return (buffstate >= 0 && buffstate < MAX_BUFF_STATE); }
+    static BuffStateSet MakeBuffStateSet(const std::list<eBuffState>& buffstatelist);
+
 public:
     void RegisterBuff(eBuffState buffstate);
-    void RegisterBuff(std::list<eBuffState> buffstate);
+    void RegisterBuff(const std::list<eBuffState>& buffstate);
+    void RegisterBuff(const BuffStateSet& buffstateset);
     void UnRegisterBuff(eBuffState buffstate);
-    void UnRegisterBuff(std::list<eBuffState> buffstate);
+    void UnRegisterBuff(const std::list<eBuffState>& buffstate);
+    void UnRegisterBuff(const BuffStateSet& buffstateset);
 
     bool isBuff();
     bool isBuff(eBuffState buffstate);
-    const eBuffState isBuff(std::list<eBuffState> buffstatelist);
+    const eBuffState isBuff(const std::list<eBuffState>& buffstatelist);
+    const eBuffState isBuff(const BuffStateSet& buffstateset);
     void TokenBuff(eBuffState curbufftype);
 
 public:
@@ -31,9 +38,21 @@ public:
     bool IsEqualBuffType(IN int iBuffType, OUT wchar_t* szBuffName);
 
 public:
-    BuffStateMap			m_Buff;
+    BuffStateSet			m_Buff;
 };
 
+inline
+bool Buff::isBuff()
+{
+    return m_Buff.any();
+}
+
+inline
+bool Buff::isBuff(eBuffState buffstate)
+{
+    return IsValidBuffState(buffstate) && m_Buff.test(buffstate);
+}
+
 inline
 Buff& Buff::operator =  (const Buff& buff)
 {
@@ -98,6 +98,7 @@ void OBJECT::Initialize()
     Visible = false;
     AlphaEnable = false;
     EnableBoneMatrix = false;
+    m_bBonesPrepared = false;
     ContrastEnable = false;
     ChromeEnable = false;
     m_bRenderAfterCharacter = false;
@@ -180,6 +181,11 @@ void OBJECT::Initialize()
     IdentityVector3D(OBB.YAxis);
     IdentityVector3D(OBB.ZAxis);
 
+    memset(&m_BonesPrepared, 0, sizeof(m_BonesPrepared));
+    m_dwSkinnedBatch = 0;
+    m_iSkinnedFirst = 0;
+    m_iSkinnedCount = 0;
+
     m_pCloth = NULL;
     BoneTransform = NULL;
 
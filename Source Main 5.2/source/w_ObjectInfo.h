@@ -105,6 +105,24 @@ typedef struct
     vec3_t ZAxis;
 } OBB_t;
 
+class BMD;
+
+// Inputs of one BMD::Animation() call; two equal keys produce the same bone palette.
+typedef struct
+{
+    const BMD*      Model;
+    unsigned short  CurrentAction;
+    unsigned short  PriorAction;
+    float           AnimationFrame;
+    float           PriorAnimationFrame;
+    float           BodyHeight;
+    float           BodyScale;
+    vec3_t          BodyOrigin;
+    vec3_t          Angle;
+    vec3_t          HeadAngle;
+    bool            Translate;
+} BoneAnimation_t;
+
 class OBJECT
 {
 public:
@@ -127,6 +145,7 @@ public:
     bool	      Visible;
     bool	      AlphaEnable;
     bool          EnableBoneMatrix;
+    bool          m_bBonesPrepared;
     bool		  ContrastEnable;
     bool          ChromeEnable;
 
@@ -216,6 +235,12 @@ public:
 
 public:
     OBB_t		  OBB;
+    BoneAnimation_t m_BonesPrepared;
+
+    // Models of this object skinned by the current RunPreparedSkinning batch (see ZzzObject.cpp).
+    DWORD         m_dwSkinnedBatch;
+    int           m_iSkinnedFirst;
+    int           m_iSkinnedCount;
 
 public:
     OBJECT* Owner;
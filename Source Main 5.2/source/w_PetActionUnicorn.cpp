@@ -303,7 +303,10 @@ void PetActionUnicorn::FindZen(OBJECT* obj)
     float dx, dy, dl;
     bool sameItem = false;
 
-    for (int i = 0; i < MAX_ITEMS; i++)
+    static std::vector<int> s_vecNearby;
+    g_ItemGrid.Query(obj->Owner->Position[0], obj->Owner->Position[1], SEARCH_LENGTH, s_vecNearby);
+
+    for (int i : s_vecNearby)
     {
         OBJECT* _item = &Items[i].Object;
         if (_item->Live == false || _item->Visible == false)
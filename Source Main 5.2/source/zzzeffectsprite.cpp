@@ -9,6 +9,7 @@
 #include "ZzzCharacter.h"
 #include "ZzzLodTerrain.h"
 #include "ZzzTexture.h"
+#include "QuadBatch.h"
 #include "ZzzAi.h"
 #include "ZzzEffect.h"
 #include "DSPlaySound.h"
@@ -16,6 +17,7 @@
 #include "NewUISystem.h"
 
 OBJECT	Sprites[MAX_SPRITES];
+SlotPool<OBJECT, MAX_SPRITES> g_SpritePool(Sprites, L"Sprite");
 
 int CreateSprite(int Type, vec3_t Position, float Scale, vec3_t Light, OBJECT* Owner, float Rotation, int SubType)
 {
@@ -24,25 +26,24 @@ int CreateSprite(int Type, vec3_t Position, float Scale, vec3_t Light, OBJECT* O
         return false;
     }
 
-    for (int i = 0; i < MAX_SPRITES; i++)
+    const int i = g_SpritePool.Acquire();
+    if (i < 0)
     {
-        OBJECT* o = &Sprites[i];
-        if (!o->Live)
-        {
-            o->Live = true;
-            o->Type = Type;
-            o->SubType = SubType;
-            o->Owner = Owner;
-            o->AnimationFrame = 1.f;
-            o->Scale = Scale;
-            o->Angle[2] = Rotation;
-            VectorCopy(Position, o->Position);
-            VectorCopy(Position, o->StartPosition);
-            VectorCopy(Light, o->Light);
-            return i;
-        }
+        return false;
     }
-    return false;
+
+    OBJECT* o = &Sprites[i];
+    o->Live = true;
+    o->Type = Type;
+    o->SubType = SubType;
+    o->Owner = Owner;
+    o->AnimationFrame = 1.f;
+    o->Scale = Scale;
+    o->Angle[2] = Rotation;
+    VectorCopy(Position, o->Position);
+    VectorCopy(Position, o->StartPosition);
+    VectorCopy(Light, o->Light);
+    return i;
 }
 
 void RenderSprite(OBJECT* o, OBJECT* Owner)
@@ -123,7 +124,10 @@ void RenderSprites(BYTE byRenderOneMore)
         return;
     }
 
-    for (int i = 0; i < MAX_SPRITES; i++)
+    g_SpritePool.Collect();
+    BeginQuadBatch();
+
+    for (int i = g_SpritePool.First(); i >= 0; i = g_SpritePool.Next(i))
     {
         OBJECT* o = &Sprites[i];
         if (byRenderOneMore == 1)
@@ -172,6 +176,8 @@ void RenderSprites(BYTE byRenderOneMore)
             }
         }
     }
+
+    EndQuadBatch();
 }
 
 void CheckSprites()
@@ -181,7 +187,7 @@ void CheckSprites()
         return;
     }
 
-    for (int i = 0; i < MAX_SPRITES; i++)
+    for (int i = g_SpritePool.First(); i >= 0; i = g_SpritePool.Next(i))
     {
         OBJECT* o = &Sprites[i];
         if (o->Live)
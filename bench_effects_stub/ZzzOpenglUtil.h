@@ -0,0 +1,6 @@
+// ZzzOpenglUtil.h stand-in for bench_effects.cpp, which defines these next to its state tracker.
+#pragma once
+
+extern bool FogEnable;
+
+void BindTexture(int tex);
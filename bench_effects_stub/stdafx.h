@@ -0,0 +1,9 @@
+// stdafx.h stand-in for bench_effects.cpp: only what QuadBatch.cpp needs, no game headers.
+#pragma once
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <GL/gl.h>
+#include <cstring>
+#include <vector>
@@ -0,0 +1,329 @@
+// bench_joints.cpp - Compares ring buffer joint tails with the copy-back tails they replaced
+// Compile with: ./build_bench_joints.sh
+// Run with:     ./bench_joints [joints] [fps]   (default: 500 joints at 144 fps)
+//
+// Runs the tail work MoveJoints does for every live joint each tick: CreateTail (with and
+// without blur) and the offset loops of the joints that follow a moving target. It also
+// walks the tails the way RenderJoints does. The JOINT fields involved are mirrored twice:
+// once indexed through JointTail.h as JOINT::GetTail / PushTail do, and once with the loop
+// that copied every entry back by one slot, taken from before the ring buffer. Both must
+// hold the same tails before either is timed.
+//
+// MaxTails is scaled by 1 / FPS_ANIMATION_FACTOR as CreateJoint does, so higher frame
+// rates mean longer tails (up to MAX_TAILS).
+
+#include "Source Main 5.2/source/JointTail.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+    typedef float vec3_t[3];
+
+    const int MAX_TAILS = 200;          // _define.h
+    const double REFERENCE_FPS = 25.0;  // ZzzAI.h
+
+    // MaxTails values CreateJoint gives the common joint types.
+    const int s_BaseMaxTails[] = { 30, 10, 20, 15, 50, 8, 16, 6 };
+
+    void VectorRotate(const vec3_t in, const float matrix[3][4], vec3_t out)
+    {
+        out[0] = in[0] * matrix[0][0] + in[1] * matrix[0][1] + in[2] * matrix[0][2];
+        out[1] = in[0] * matrix[1][0] + in[1] * matrix[1][1] + in[2] * matrix[1][2];
+        out[2] = in[0] * matrix[2][0] + in[1] * matrix[2][1] + in[2] * matrix[2][2];
+    }
+
+    void RotationZ(float angle, float matrix[3][4])
+    {
+        const float s = sinf(angle), c = cosf(angle);
+        const float m[3][4] = { { c, -s, 0.f, 0.f }, { s, c, 0.f, 0.f }, { 0.f, 0.f, 1.f, 0.f } };
+        memcpy(matrix, m, sizeof(m));
+    }
+
+    // The four corners CreateTail adds to the joint's position.
+    void TailCorners(const vec3_t position, float scale, const float matrix[3][4], vec3_t* tail)
+    {
+        const vec3_t offsets[4] = { { -scale * 0.5f, 0.f, 0.f }, { scale * 0.5f, 0.f, 0.f },
+                                    { 0.f, 0.f, -scale * 0.5f }, { 0.f, 0.f, scale * 0.5f } };
+        for (int k = 0; k < 4; ++k)
+        {
+            vec3_t p;
+            VectorRotate(offsets[k], matrix, p);
+            for (int c = 0; c < 3; ++c)
+                tail[k][c] = position[c] + p[c];
+        }
+    }
+
+    void BlendWithPrevious(vec3_t* tail, const vec3_t* prev)
+    {
+        for (int k = 0; k < 4; ++k)
+            for (int c = 0; c < 3; ++c)
+                tail[k][c] = (tail[k][c] + prev[k][c]) / 2.f;
+    }
+
+    // JOINT with JointTail.h indexing, as in _struct.h.
+    struct RING_JOINT
+    {
+        vec3_t Position;
+        float  Scale;
+        int    NumTails;
+        int    MaxTails;
+        int    TailHead;
+        vec3_t Tails[MAX_TAILS][4];
+
+        vec3_t* GetTail(int index) { return Tails[GetTailSlot(TailHead, index, MAX_TAILS)]; }
+
+        vec3_t* PushTail()
+        {
+            TailHead = PushTailSlot(TailHead, MAX_TAILS);
+            return Tails[TailHead];
+        }
+    };
+
+    // JOINT before the ring buffer: Tails[0] is the newest entry.
+    struct COPY_JOINT
+    {
+        vec3_t Position;
+        float  Scale;
+        int    NumTails;
+        int    MaxTails;
+        vec3_t Tails[MAX_TAILS][4];
+
+        vec3_t* GetTail(int index) { return Tails[index]; }
+    };
+
+    // ZzzEffectJoint.cpp CreateTail
+    void CreateTail(RING_JOINT* o, float Matrix[3][4], bool Blur)
+    {
+        for (int i = 0; i < (Blur ? 2 : 1); i++)
+        {
+            o->NumTails++;
+            if (o->NumTails > o->MaxTails - 1)
+                o->NumTails = o->MaxTails - 1;
+
+            vec3_t* tail = o->PushTail();
+            TailCorners(o->Position, o->Scale, Matrix, tail);
+            if (Blur && i == 0 && o->NumTails > 1)
+                BlendWithPrevious(tail, o->GetTail(1));
+        }
+    }
+
+    // CreateTail before the ring buffer
+    void CreateTail(COPY_JOINT* o, float Matrix[3][4], bool Blur)
+    {
+        for (int i = 0; i < (Blur ? 2 : 1); i++)
+        {
+            o->NumTails++;
+            if (o->NumTails > o->MaxTails - 1)
+                o->NumTails = o->MaxTails - 1;
+
+            for (int j = o->NumTails - 1; j >= 0; j--)
+            {
+                for (int k = 0; k < 4; k++)
+                    memcpy(o->Tails[j + 1][k], o->Tails[j][k], sizeof(vec3_t));
+            }
+
+            TailCorners(o->Position, o->Scale, Matrix, o->Tails[0]);
+            if (Blur && i == 0 && o->NumTails > 1)
+                BlendWithPrevious(o->Tails[0], o->Tails[1]);
+        }
+    }
+
+    // MoveJoint for a joint that follows its target: tails are moved into the target's
+    // frame and back out at its new position.
+    template <typename JointT>
+    void FollowTarget(JointT* o, const vec3_t oldTarget, const vec3_t newTarget)
+    {
+        for (int j = o->NumTails - 1; j >= 0; j--)
+        {
+            vec3_t* tail = o->GetTail(j);
+            for (int k = 0; k < 4; k++)
+                for (int c = 0; c < 3; ++c)
+                    tail[k][c] -= oldTarget[c];
+        }
+        for (int j = o->NumTails - 1; j >= 0; j--)
+        {
+            vec3_t* tail = o->GetTail(j);
+            for (int k = 0; k < 4; k++)
+                for (int c = 0; c < 3; ++c)
+                    tail[k][c] += newTarget[c];
+        }
+    }
+
+    struct JOINT_SCRIPT
+    {
+        bool  Blur;
+        bool  Follows;
+        float Speed;
+    };
+
+    template <typename JointT>
+    void MoveJoints(std::vector<JointT>& joints, const std::vector<JOINT_SCRIPT>& script, int tick)
+    {
+        for (size_t i = 0; i < joints.size(); ++i)
+        {
+            JointT* o = &joints[i];
+            const JOINT_SCRIPT& s = script[i];
+            const float t = tick * s.Speed;
+
+            if (s.Follows)
+            {
+                const vec3_t oldTarget = { cosf(t - s.Speed) * 50.f, sinf(t - s.Speed) * 50.f, 0.f };
+                const vec3_t newTarget = { cosf(t) * 50.f, sinf(t) * 50.f, 0.f };
+                FollowTarget(o, oldTarget, newTarget);
+            }
+
+            o->Position[0] += cosf(t) * 8.f;
+            o->Position[1] += sinf(t) * 8.f;
+            o->Position[2] = 120.f + sinf(t * 0.5f) * 30.f;
+
+            float Matrix[3][4];
+            RotationZ(t, Matrix);
+            CreateTail(o, Matrix, s.Blur);
+        }
+    }
+
+    // RenderJoints reads every segment as a pair of neighbouring entries.
+    template <typename JointT>
+    float WalkTails(std::vector<JointT>& joints)
+    {
+        float sum = 0.f;
+        for (JointT& o : joints)
+        {
+            for (int j = 0; j < o.NumTails - 1; j++)
+            {
+                const vec3_t* currentTail = o.GetTail(j);
+                const vec3_t* nextTail = o.GetTail(j + 1);
+                sum += currentTail[0][0] + currentTail[3][2] + nextTail[1][1] + nextTail[2][0];
+            }
+        }
+        return sum;
+    }
+
+    template <typename JointT>
+    void InitJoints(std::vector<JointT>& joints, int maxTails[], int count)
+    {
+        joints.resize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            JointT& o = joints[i];
+            memset(&o, 0, sizeof(o));
+            o.Position[0] = (float)(i % 25) * 100.f;
+            o.Position[1] = (float)(i / 25) * 100.f;
+            o.Scale = 20.f + (i % 7) * 5.f;
+            o.MaxTails = maxTails[i];
+        }
+    }
+
+    bool SameTails(std::vector<RING_JOINT>& ring, std::vector<COPY_JOINT>& copy)
+    {
+        for (size_t i = 0; i < ring.size(); ++i)
+        {
+            if (ring[i].NumTails != copy[i].NumTails)
+                return false;
+            for (int j = 0; j < ring[i].NumTails; ++j)
+            {
+                if (memcmp(ring[i].GetTail(j), copy[i].GetTail(j), sizeof(vec3_t) * 4) != 0)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename JointT>
+    double TimeTicks(std::vector<JointT>& joints, const std::vector<JOINT_SCRIPT>& script, bool render, int& ticks)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        float sink = 0.f;
+        ticks = 0;
+        const auto start = Clock::now();
+        double seconds = 0.0;
+        do
+        {
+            for (int i = 0; i < 100; ++i, ++ticks)
+            {
+                if (render)
+                    sink += WalkTails(joints);
+                else
+                    MoveJoints(joints, script, ticks);
+            }
+            seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        } while (seconds < 1.0);
+
+        if (sink == 1.2345f)
+            printf("\n");
+        return seconds;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    printf("=== Joint Tail Benchmark ===\n\n");
+
+    const int numJoints = argc > 1 ? std::max(1, atoi(argv[1])) : 500;
+    const double fps = argc > 2 ? std::max(1.0, atof(argv[2])) : 144.0;
+
+    // ZzzAI.cpp and CreateJoint
+    const float factor = (float)std::min(REFERENCE_FPS / fps, 1.0);
+
+    std::mt19937 rng(1);
+    std::vector<int> maxTails(numJoints);
+    std::vector<JOINT_SCRIPT> script(numJoints);
+    long long tailSum = 0;
+    for (int i = 0; i < numJoints; ++i)
+    {
+        const int base = s_BaseMaxTails[std::uniform_int_distribution<int>(0, 7)(rng)];
+        maxTails[i] = std::min((int)(base / factor), MAX_TAILS);
+        tailSum += maxTails[i];
+
+        script[i].Blur = std::uniform_int_distribution<int>(0, 2)(rng) == 0;
+        script[i].Follows = std::uniform_int_distribution<int>(0, 3)(rng) == 0;
+        script[i].Speed = std::uniform_real_distribution<float>(0.02f, 0.3f)(rng);
+    }
+
+    std::vector<RING_JOINT> ring;
+    std::vector<COPY_JOINT> copy;
+    InitJoints(ring, maxTails.data(), numJoints);
+    InitJoints(copy, maxTails.data(), numJoints);
+
+    // long enough to fill every tail and wrap every ring several times
+    for (int tick = 0; tick < MAX_TAILS * 3; ++tick)
+    {
+        MoveJoints(ring, script, tick);
+        MoveJoints(copy, script, tick);
+    }
+    if (!SameTails(ring, copy))
+    {
+        fprintf(stderr, "FAILED: ring buffer tails differ from the copied tails\n");
+        return 1;
+    }
+
+    printf("Joints: %d at %.0f fps (MaxTails x%.2f, average %.0f of %d)\n", numJoints, fps, 1.f / factor,
+        (double)tailSum / numJoints, MAX_TAILS);
+    printf("Tails identical after %d ticks.\n\n", MAX_TAILS * 3);
+
+    int copyTicks, ringTicks, copyWalks, ringWalks;
+    const double copySeconds = TimeTicks(copy, script, false, copyTicks);
+    const double ringSeconds = TimeTicks(ring, script, false, ringTicks);
+    const double copyWalkSeconds = TimeTicks(copy, script, true, copyWalks);
+    const double ringWalkSeconds = TimeTicks(ring, script, true, ringWalks);
+
+    const double copyMs = copySeconds * 1e3 / copyTicks;
+    const double ringMs = ringSeconds * 1e3 / ringTicks;
+    const double copyWalkMs = copyWalkSeconds * 1e3 / copyWalks;
+    const double ringWalkMs = ringWalkSeconds * 1e3 / ringWalks;
+
+    printf("%-12s %18s %20s\n", "Tails", "MoveJoints ms/tick", "RenderJoints walk ms");
+    printf("%-12s %18.3f %20.3f\n", "copy back", copyMs, copyWalkMs);
+    printf("%-12s %18.3f %20.3f\n", "ring buffer", ringMs, ringWalkMs);
+    printf("\nMoveJoints speedup: %.1fx\n", copyMs / ringMs);
+    return 0;
+}
@@ -0,0 +1,731 @@
+// bench_path.cpp - Compares the binary-heap A* open set in PATH with the CBTree one it replaced
+// Compile with: ./build_bench_path.sh
+// Run with:     ./bench_path [EncTerrain.att ...]   (default: synthetic 256x256 maps)
+//
+// Each terrain is searched with the same set of clicks, the way PathFinding2 calls
+// PATH::FindPath: a strict search first and the nearest-reachable fallback when it fails,
+// plus some searches with a target distance as used for attacks. Every search is run by
+// PATH (ZzzPath.h) and by LEGACY_PATH, the CBTree version copied below, and the paths
+// handed to the character must be identical before either is timed.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+typedef unsigned char BYTE;
+typedef unsigned short WORD;
+typedef unsigned long DWORD;
+typedef long LONG;
+typedef int BOOL;
+#define TRUE 1
+#define FALSE 0
+struct POINT { LONG x, y; };
+#define ZeroMemory(p, n) memset((p), 0, (n))
+#define DEFINE_ENUM_FLAG_OPERATORS(E) \
+    inline E operator|(E a, E b) { return (E)((std::underlying_type_t<E>)a | (std::underlying_type_t<E>)b); } \
+    inline E operator&(E a, E b) { return (E)((std::underlying_type_t<E>)a & (std::underlying_type_t<E>)b); } \
+    inline E& operator|=(E& a, E b) { return a = a | b; }
+using std::max;
+using std::min;
+#endif
+
+// SetEndNodes reports out-of-map targets through the game's error log.
+static struct
+{
+    void Write(const wchar_t*, ...) {}
+} g_ErrorReport;
+
+#include "Source Main 5.2/source/_define.h"
+#include "Source Main 5.2/source/_crypt.h"
+#include "Source Main 5.2/source/BaseCls.h"
+#include "Source Main 5.2/source/ZzzPath.h"
+
+// Same table as zzzpath.cpp.
+int PATH::s_iDir[8][2] =
+{
+    { -1, -1},	{ 0, -1},	{ 1, -1},
+    { -1, 0},				{ 1, 0},
+    { -1, 1},	{ 0, 1},	{ 1, 1}
+};
+
+// ZzzPath.h as it was before the open set became a binary heap.
+class LEGACY_PATH
+{
+public:
+    LEGACY_PATH();
+    ~LEGACY_PATH();
+
+public:
+    void SetMapDimensions(int iWidth, int iHeight, WORD* pbyMap);
+
+private:
+    int	m_iWidth, m_iHeight;
+    int m_iSize;
+    WORD* m_pbyMap;
+
+private:
+    int m_iNumPath;
+    BYTE m_xPath[MAX_COUNT_PATH];
+    BYTE m_yPath[MAX_COUNT_PATH];
+public:
+    int GetPath(void) { return (min(m_iNumPath, MAX_PATH_FIND)); }
+    BYTE* GetPathX(void) { return (m_xPath + MAX_COUNT_PATH - m_iNumPath); }
+    BYTE* GetPathY(void) { return (m_yPath + MAX_COUNT_PATH - m_iNumPath); }
+
+    int GetIndex(int xPos, int yPos) { return (xPos + yPos * m_iWidth); }
+    void GetXYPos(int iIndex, int* pxPos, int* pyPos) { *pxPos = iIndex % m_iWidth; *pyPos = iIndex / m_iWidth; }
+    BOOL CheckXYPos(int xPos, int yPos) { return (xPos >= 0 && yPos >= 0 && xPos < m_iWidth && yPos < m_iHeight); }
+    static int s_iDir[8][2];
+
+private:
+    EPathNodeState* m_pbyClosed;
+    int m_iMinClosed, m_iMaxClosed;
+    int* m_piCostToStart;
+    int* m_pxPrev;
+    int* m_pyPrev;
+    CBTree<int, int> m_btOpenNodes;
+
+    void Clear(void);
+    bool AddClearPos(int iIndex);
+    void Init(void);
+    int GetNewNodeToTest(void);
+
+public:
+    bool FindPath(int xStart, int yStart, int xEnd, int yEnd, bool bErrorCheck, int iWall, bool Value, float fDistance = 0.0f);
+
+private:
+    void SetEndNodes(bool bErrorCheck, int iWall, int xEnd, int yEnd, float fDistance);
+    int CalculateCostToStartAddition(int xDir, int yDir);
+    int EstimateCostToGoal(int xStart, int yStart, int xNew, int yNew);
+    bool GeneratePath(int xStart, int yStart, int xEnd, int yEnd);
+
+};
+
+inline LEGACY_PATH::LEGACY_PATH()
+{
+    m_pbyClosed = NULL;
+    m_piCostToStart = NULL;
+    m_pxPrev = NULL;
+    m_pyPrev = NULL;
+}
+
+inline LEGACY_PATH::~LEGACY_PATH()
+{
+    Clear();
+}
+
+inline void LEGACY_PATH::Clear(void)
+{
+    if (m_pbyClosed)
+    {
+        delete[] m_pbyClosed;
+        m_pbyClosed = NULL;
+    }
+    if (m_piCostToStart)
+    {
+        delete[] m_piCostToStart;
+        m_piCostToStart = NULL;
+    }
+    if (m_pxPrev)
+    {
+        delete[] m_pxPrev;
+        m_pxPrev = NULL;
+    }
+    if (m_pyPrev)
+    {
+        delete[] m_pyPrev;
+        m_pyPrev = NULL;
+    }
+    m_iMinClosed = MAX_INT_FORPATH;
+    m_iMaxClosed = -1;
+}
+
+inline void LEGACY_PATH::SetMapDimensions(int iWidth, int iHeight, WORD* pbyMap)
+{
+    Clear();
+
+    m_iWidth = iWidth;
+    m_iHeight = iHeight;
+    m_pbyMap = pbyMap;
+    m_iSize = m_iWidth * m_iHeight;
+
+    m_pbyClosed = new EPathNodeState[m_iSize];
+    m_piCostToStart = new int[m_iSize];
+    m_pxPrev = new int[m_iSize];
+    m_pyPrev = new int[m_iSize];
+    ZeroMemory(m_pbyClosed, m_iSize * sizeof(BYTE));
+}
+
+inline bool LEGACY_PATH::AddClearPos(int iIndex)
+{
+    if (iIndex < 0 || iIndex >= m_iSize)
+    {
+        return false;
+    }
+
+    m_iMinClosed = min(iIndex, m_iMinClosed);
+    m_iMaxClosed = max(iIndex, m_iMaxClosed);
+
+    return true;
+}
+
+inline void LEGACY_PATH::Init(void)
+{
+    if (MAX_INT_FORPATH == m_iMinClosed)
+    {
+        return;
+    }
+
+    ZeroMemory(&(m_pbyClosed[m_iMinClosed]), (m_iMaxClosed - m_iMinClosed + 1) * sizeof(BYTE));
+    m_iMinClosed = MAX_INT_FORPATH;
+    m_iMaxClosed = -1;
+}
+
+inline int LEGACY_PATH::GetNewNodeToTest(void)
+{
+    CBNode<int, int>* pResult = NULL;
+    CBNode<int, int>* pNode = m_btOpenNodes.FindHead();
+    while (pNode)
+    {
+        pResult = pNode;
+        pNode = m_btOpenNodes.GetLeft(pNode);
+    }
+
+    int iIndex = -1;
+    if (pResult)
+    {
+        iIndex = pResult->GetData();
+        m_btOpenNodes.RemoveNode(pResult);
+    }
+    return iIndex;
+}
+
+inline bool LEGACY_PATH::FindPath(int xStart, int yStart, int xEnd, int yEnd, bool bErrorCheck, int iWall, bool Value, float fDistance)
+{
+    Init();
+
+    if (xStart == 0 || yStart == 0)
+    {
+        return false;
+    }
+
+    if (0.0f == fDistance)
+    {
+        int iEndIndex = GetIndex(xEnd, yEnd);
+        if (iEndIndex < 0 || iEndIndex >= m_iSize)
+        {
+            return false;
+        }
+
+        if (Value == true)
+        {
+            m_pbyMap[iEndIndex] = 0;
+        }
+
+        if (bErrorCheck && (iWall <= m_pbyMap[iEndIndex] && (m_pbyMap[GetIndex(xEnd, yEnd)] & TW_ACTION) != TW_ACTION))
+        {
+            return false;
+        }
+
+        m_pbyClosed[iEndIndex] = PATH_END;
+        if (!AddClearPos(iEndIndex))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        SetEndNodes(bErrorCheck, iWall, xEnd, yEnd, fDistance);
+    }
+
+    int iCostToGoalOfNearest = MAX_INT_FORPATH;
+    int xNearest = xStart;
+    int yNearest = yStart;
+
+    int iStartIndex = GetIndex(xStart, yStart);
+    if (iStartIndex < 0 || iStartIndex >= m_iSize)
+    {
+        return false;
+    }
+
+    m_btOpenNodes.Add(iStartIndex, 0);
+    m_pbyClosed[iStartIndex] |= PATH_INTESTLIST;
+    if (!AddClearPos(iStartIndex))
+    {
+        return false;
+    }
+
+    int iMaxCount = bErrorCheck ? 500 : 50;
+    for (int iCheckCount = iMaxCount; 0 < m_btOpenNodes.GetCount() && iCheckCount > 0; --iCheckCount)
+    {
+        int xTest, yTest;
+        int iIndex = GetNewNodeToTest();
+        if (iIndex == -1)
+        {
+            return false;
+        }
+
+        GetXYPos(iIndex, &xTest, &yTest);
+
+        m_piCostToStart[iIndex] = (iCheckCount == iMaxCount) ? 0 : MAX_INT_FORPATH;
+        for (int i = 0; i < 8; i++)
+        {
+            int xNear = xTest + s_iDir[i][0];
+            int yNear = yTest + s_iDir[i][1];
+            if (!CheckXYPos(xNear, yNear))
+            {
+                continue;
+            }
+            int iNearIndex = GetIndex(xNear, yNear);
+            if (PATH_TESTED & m_pbyClosed[iNearIndex])
+            {
+                int iNewCost = m_piCostToStart[iNearIndex] + CalculateCostToStartAddition(s_iDir[i][0], s_iDir[i][1]);
+                if (iNewCost < m_piCostToStart[iIndex])
+                {
+                    m_piCostToStart[iIndex] = iNewCost;
+                    m_pxPrev[iIndex] = xNear;
+                    m_pyPrev[iIndex] = yNear;
+                }
+            }
+        }
+        m_pbyClosed[iIndex] |= PATH_TESTED;
+
+        if (PATH_END & m_pbyClosed[iIndex])
+        {
+            m_btOpenNodes.RemoveAll();
+            return (GeneratePath(xStart, yStart, xTest, yTest));
+        }
+
+        for (int i = 0; i < 8; i++)
+        {
+            int xNew = xTest + s_iDir[i][0];
+            int yNew = yTest + s_iDir[i][1];
+            if (!CheckXYPos(xNew, yNew))
+            {
+                continue;
+            }
+            int iNewIndex = GetIndex(xNew, yNew);
+            int byMapAttribute = m_pbyMap[iNewIndex];
+
+            if ((byMapAttribute & TW_ACTION) == TW_ACTION) byMapAttribute -= TW_ACTION;
+            if ((byMapAttribute & TW_HEIGHT) == TW_HEIGHT) byMapAttribute -= TW_HEIGHT;
+            if ((byMapAttribute & TW_CAMERA_UP) == TW_CAMERA_UP) byMapAttribute -= TW_CAMERA_UP;
+
+            if (!(PATH_INTESTLIST & m_pbyClosed[iNewIndex]) && iWall > byMapAttribute)
+            {
+                int iNewCost = m_piCostToStart[iIndex] + EstimateCostToGoal(xEnd, yEnd, xNew, yNew);
+                m_btOpenNodes.Add(iNewIndex, iNewCost);
+                m_pbyClosed[iNewIndex] |= PATH_INTESTLIST;
+                if (!AddClearPos(iNewIndex))
+                    return false;
+                m_pxPrev[iNewIndex] = xTest;
+                m_pyPrev[iNewIndex] = yTest;
+            }
+        }
+        if (!bErrorCheck)
+        {
+            int iCostToGoal = EstimateCostToGoal(xEnd, yEnd, xTest, yTest);
+            if (iCostToGoal < iCostToGoalOfNearest)
+            {
+                iCostToGoalOfNearest = iCostToGoal;
+                xNearest = xTest;
+                yNearest = yTest;
+            }
+        }
+    }
+    if (!bErrorCheck)
+    {
+        m_btOpenNodes.RemoveAll();
+        return (GeneratePath(xStart, yStart, xNearest, yNearest));
+    }
+
+    m_btOpenNodes.RemoveAll();
+
+    return false;
+}
+
+inline void LEGACY_PATH::SetEndNodes(bool bErrorCheck, int iWall, int xEnd, int yEnd, float fDistance)
+{
+    int iDistance = (int)fDistance;
+    for (int j = -iDistance; j <= iDistance; j++)
+    {
+        int xRange = iDistance - abs(j);
+        for (int i = -xRange; i <= 0; i++)
+        {
+            int iEndIndex = GetIndex(xEnd + i, yEnd + j);
+            if (iEndIndex >= 0 && iEndIndex < (m_iSize))
+            {
+                if (!(bErrorCheck && iWall <= m_pbyMap[iEndIndex]))
+                {
+                    m_pbyClosed[iEndIndex] = PATH_END;
+                    AddClearPos(iEndIndex);
+                }
+            }
+            else
+            {
+                g_ErrorReport.Write(L"Error Path : %d \r\n", iEndIndex);
+            }
+            iEndIndex = GetIndex(xEnd - i, yEnd + j);
+
+            if (iEndIndex >= 0 && iEndIndex < (m_iSize))
+            {
+                if (!(bErrorCheck && iWall <= m_pbyMap[iEndIndex]))
+                {
+                    m_pbyClosed[iEndIndex] = PATH_END;
+                    AddClearPos(iEndIndex);
+                }
+            }
+            else
+            {
+                g_ErrorReport.Write(L"Error Path : %d \r\n", iEndIndex);
+            }
+        }
+
+        for (int i = -iDistance; i < -xRange; i++)
+        {
+            if ((float)sqrt((float)(i * i + j * j)) < fDistance)
+            {
+                int iEndIndex = GetIndex(xEnd + i, yEnd + j);
+                if (iEndIndex >= 0 && iEndIndex < (m_iSize))
+                {
+                    if (!(bErrorCheck && iWall <= m_pbyMap[iEndIndex]))
+                    {
+                        m_pbyClosed[iEndIndex] = PATH_END;
+                        AddClearPos(iEndIndex);
+                    }
+                }
+                else
+                {
+                    g_ErrorReport.Write(L"Error Path : %d \r\n", iEndIndex);
+                }
+
+                iEndIndex = GetIndex(xEnd - i, yEnd + j);
+                if (iEndIndex >= 0 && iEndIndex < (m_iSize))
+                {
+                    if (!(bErrorCheck && iWall <= m_pbyMap[iEndIndex]))
+                    {
+                        m_pbyClosed[iEndIndex] = PATH_END;
+                        AddClearPos(iEndIndex);
+                    }
+                }
+                else
+                {
+                    g_ErrorReport.Write(L"Error Path : %d \r\n", iEndIndex);
+                }
+            }
+        }
+    }
+}
+
+inline int LEGACY_PATH::CalculateCostToStartAddition(int xDir, int yDir)
+{
+    return ((xDir == 0 || yDir == 0) ? FACTOR_PATH_DIST : FACTOR_PATH_DIST_DIAG);
+}
+
+inline int LEGACY_PATH::EstimateCostToGoal(int xStart, int yStart, int xNew, int yNew)
+{
+    int xDist = abs(xNew - xStart);
+    int yDist = abs(yNew - yStart);
+    if (xDist == 1 && yDist == 1)
+    {
+        yDist = 0;
+    }
+
+    return (abs(xDist - yDist) * FACTOR_PATH_DIST + min(xDist, yDist) * FACTOR_PATH_DIST_DIAG + 1) * 3 / 4;
+}
+
+inline bool LEGACY_PATH::GeneratePath(int xStart, int yStart, int xEnd, int yEnd)
+{
+    int xCurrent = xEnd;
+    int yCurrent = yEnd;
+    for (m_iNumPath = 0; m_iNumPath < MAX_COUNT_PATH; m_iNumPath++)
+    {
+        m_xPath[(MAX_COUNT_PATH - 1) - m_iNumPath] = xCurrent;
+        m_yPath[(MAX_COUNT_PATH - 1) - m_iNumPath] = yCurrent;
+
+        if (xCurrent == xStart && yCurrent == yStart)
+        {
+            m_iNumPath++;
+            return (true);
+        }
+
+        int iIndex = GetIndex(xCurrent, yCurrent);
+        xCurrent = m_pxPrev[iIndex];
+        yCurrent = m_pyPrev[iIndex];
+    }
+
+    return (false);
+}
+
+int LEGACY_PATH::s_iDir[8][2] =
+{
+    { -1, -1},	{ 0, -1},	{ 1, -1},
+    { -1, 0},				{ 1, 0},
+    { -1, 1},	{ 0, 1},	{ 1, 1}
+};
+
+namespace
+{
+    struct Terrain
+    {
+        std::string       Name;
+        std::vector<WORD> Wall;
+    };
+
+    struct Query
+    {
+        int   xStart, yStart;
+        int   xEnd, yEnd;
+        float fDistance;
+    };
+
+    struct Result
+    {
+        bool Found;
+        int  NumPath;
+        BYTE PathX[MAX_PATH_FIND];
+        BYTE PathY[MAX_PATH_FIND];
+    };
+
+    const int QUERIES_PER_TERRAIN = 2000;
+
+    // Same as MapFileDecrypt in ZzzLodTerrain.h.
+    void MapFileDecrypt(BYTE* dst, const BYTE* src, int size)
+    {
+        const BYTE key[16] = { 0xD1, 0x73, 0x52, 0xF6, 0xD2, 0x9A, 0xCB, 0x27,
+                               0x3E, 0xAF, 0x59, 0x31, 0x37, 0xB3, 0xE7, 0xA2 };
+        WORD mapKey = 0x5E;
+        for (int i = 0; i < size; ++i)
+        {
+            dst[i] = (src[i] ^ key[i % 16]) - (BYTE)mapKey;
+            mapKey = (src[i] + 0x3D) & 0xFF;
+        }
+    }
+
+    // Decodes an EncTerrain*.att the way OpenTerrainAttribute does.
+    bool LoadTerrainAttribute(const char* fileName, Terrain& terrain)
+    {
+        FILE* fp = fopen(fileName, "rb");
+        if (fp == NULL)
+            return false;
+
+        std::vector<BYTE> enc;
+        BYTE buffer[4096];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+            enc.insert(enc.end(), buffer, buffer + read);
+        fclose(fp);
+
+        const int size = (int)enc.size();
+        const bool extAtt = size == TERRAIN_SIZE * TERRAIN_SIZE * (int)sizeof(WORD) + 4;
+        if (size != TERRAIN_SIZE * TERRAIN_SIZE + 4 && !extAtt)
+            return false;
+
+        std::vector<BYTE> data(size);
+        MapFileDecrypt(data.data(), enc.data(), size);
+        BuxConvert(data.data(), size);
+        if (data[0] != 0 || data[2] != 255 || data[3] != 255)
+            return false;
+
+        terrain.Name = fileName;
+        terrain.Wall.resize(TERRAIN_SIZE * TERRAIN_SIZE);
+        for (int i = 0; i < TERRAIN_SIZE * TERRAIN_SIZE; ++i)
+        {
+            WORD wall = extAtt ? (WORD)(data[4 + i * 2] | (data[5 + i * 2] << 8)) : data[4 + i];
+            terrain.Wall[i] = wall & 0xFF;
+        }
+        return true;
+    }
+
+    void FillRect(Terrain& terrain, int x, int y, int width, int height, WORD attribute)
+    {
+        for (int j = std::max(y, 0); j < std::min(y + height, TERRAIN_SIZE); ++j)
+            for (int i = std::max(x, 0); i < std::min(x + width, TERRAIN_SIZE); ++i)
+                terrain.Wall[j * TERRAIN_SIZE + i] |= attribute;
+    }
+
+    // Town-like terrain: a walled map with a safe zone, scattered buildings, pits and
+    // cells carrying the flags FindPath strips before the wall test.
+    Terrain CreateSyntheticTerrain(unsigned int seed)
+    {
+        Terrain terrain;
+        terrain.Name = "synthetic #" + std::to_string(seed);
+        terrain.Wall.assign(TERRAIN_SIZE * TERRAIN_SIZE, 0);
+
+        std::mt19937 rng(seed);
+        auto random = [&rng](int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng); };
+
+        FillRect(terrain, 0, 0, TERRAIN_SIZE, 8, TW_NOMOVE);
+        FillRect(terrain, 0, TERRAIN_SIZE - 8, TERRAIN_SIZE, 8, TW_NOMOVE);
+        FillRect(terrain, 0, 0, 8, TERRAIN_SIZE, TW_NOMOVE);
+        FillRect(terrain, TERRAIN_SIZE - 8, 0, 8, TERRAIN_SIZE, TW_NOMOVE);
+        FillRect(terrain, random(60, 140), random(60, 140), 48, 40, TW_SAFEZONE);
+
+        for (int i = 0; i < 400; ++i)
+            FillRect(terrain, random(0, 255), random(0, 255), random(2, 12), random(2, 12), TW_NOMOVE);
+        for (int i = 0; i < 60; ++i)
+            FillRect(terrain, random(0, 255), random(0, 255), random(3, 10), random(3, 10), TW_NOGROUND);
+        for (int i = 0; i < 4000; ++i)
+            terrain.Wall[random(0, TERRAIN_SIZE * TERRAIN_SIZE - 1)] |= (i & 1) ? TW_CAMERA_UP : TW_HEIGHT;
+
+        return terrain;
+    }
+
+    bool IsWalkable(const Terrain& terrain, int x, int y)
+    {
+        return x > 0 && y > 0 && x < TERRAIN_SIZE && y < TERRAIN_SIZE
+            && (terrain.Wall[y * TERRAIN_SIZE + x] & (TW_NOMOVE | TW_NOGROUND | TW_CHARACTER)) == 0;
+    }
+
+    // Clicks around a walkable cell: mostly within screen range, one in four further out,
+    // and one in four with an attack distance.
+    std::vector<Query> CreateQueries(const Terrain& terrain, unsigned int seed)
+    {
+        std::mt19937 rng(seed);
+        auto random = [&rng](int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng); };
+
+        std::vector<Query> queries;
+        while ((int)queries.size() < QUERIES_PER_TERRAIN)
+        {
+            Query query;
+            query.xStart = random(1, TERRAIN_SIZE - 1);
+            query.yStart = random(1, TERRAIN_SIZE - 1);
+            if (!IsWalkable(terrain, query.xStart, query.yStart))
+                continue;
+
+            const int range = random(0, 3) == 0 ? 40 : 15;
+            query.xEnd = std::clamp(query.xStart + random(-range, range), 1, TERRAIN_SIZE - 1);
+            query.yEnd = std::clamp(query.yStart + random(-range, range), 1, TERRAIN_SIZE - 1);
+            query.fDistance = random(0, 3) == 0 ? 1.8f : 0.0f;
+            queries.push_back(query);
+        }
+        return queries;
+    }
+
+    // The calls PathFinding2 makes for a click with the default wall.
+    template <typename PathT>
+    Result Search(PathT& path, const Query& query)
+    {
+        bool found = path.FindPath(query.xStart, query.yStart, query.xEnd, query.yEnd, true, TW_CHARACTER, false, query.fDistance);
+        if (!found)
+            found = path.FindPath(query.xStart, query.yStart, query.xEnd, query.yEnd, false, TW_CHARACTER, false, query.fDistance);
+
+        Result result = {};
+        result.Found = found;
+        if (found)
+        {
+            result.NumPath = path.GetPath();
+            memcpy(result.PathX, path.GetPathX(), result.NumPath);
+            memcpy(result.PathY, path.GetPathY(), result.NumPath);
+        }
+        return result;
+    }
+
+    template <typename PathT>
+    double TimeSearches(PathT& path, const std::vector<Query>& queries, long long& searches)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        int sink = 0;
+        searches = 0;
+        const auto start = Clock::now();
+        double seconds = 0.0;
+        do
+        {
+            for (const Query& query : queries)
+                sink += Search(path, query).NumPath;
+            searches += (long long)queries.size();
+            seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        } while (seconds < 1.0);
+
+        if (sink == -1)
+            printf("\n");
+        return seconds;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    printf("=== A* Path Benchmark ===\n\n");
+
+    std::vector<Terrain> terrains;
+    for (int i = 1; i < argc; ++i)
+    {
+        Terrain terrain;
+        if (LoadTerrainAttribute(argv[i], terrain))
+            terrains.push_back(std::move(terrain));
+        else
+            printf("  skipped (not a readable terrain attribute file): %s\n", argv[i]);
+    }
+    if (argc > 1 && terrains.empty())
+    {
+        fprintf(stderr, "No terrain loaded. Pass Data/World*/EncTerrain*.att files.\n");
+        return 1;
+    }
+    if (terrains.empty())
+    {
+        for (unsigned int seed = 1; seed <= 4; ++seed)
+            terrains.push_back(CreateSyntheticTerrain(seed));
+    }
+
+    printf("%-40s %10s %10s %14s %14s %9s\n", "Terrain", "searches", "found", "legacy paths/s", "heap paths/s", "speedup");
+
+    double legacyTotal = 0.0, heapTotal = 0.0;
+    long long legacyCount = 0, heapCount = 0;
+    for (size_t t = 0; t < terrains.size(); ++t)
+    {
+        Terrain& terrain = terrains[t];
+        const std::vector<Query> queries = CreateQueries(terrain, 1000 + (unsigned int)t);
+
+        LEGACY_PATH legacy;
+        PATH heap;
+        legacy.SetMapDimensions(TERRAIN_SIZE, TERRAIN_SIZE, terrain.Wall.data());
+        heap.SetMapDimensions(TERRAIN_SIZE, TERRAIN_SIZE, terrain.Wall.data());
+
+        int found = 0;
+        for (const Query& query : queries)
+        {
+            const Result expected = Search(legacy, query);
+            const Result actual = Search(heap, query);
+            if (expected.Found != actual.Found || expected.NumPath != actual.NumPath
+                || memcmp(expected.PathX, actual.PathX, expected.NumPath) != 0
+                || memcmp(expected.PathY, actual.PathY, expected.NumPath) != 0)
+            {
+                fprintf(stderr, "FAILED: %s: paths differ for (%d, %d) -> (%d, %d), distance %.1f\n", terrain.Name.c_str(),
+                    query.xStart, query.yStart, query.xEnd, query.yEnd, query.fDistance);
+                return 1;
+            }
+            found += expected.Found ? 1 : 0;
+        }
+
+        long long legacySearches, heapSearches;
+        const double legacySeconds = TimeSearches(legacy, queries, legacySearches);
+        const double heapSeconds = TimeSearches(heap, queries, heapSearches);
+        legacyTotal += legacySeconds;
+        heapTotal += heapSeconds;
+        legacyCount += legacySearches;
+        heapCount += heapSearches;
+
+        const double legacyRate = legacySearches / legacySeconds;
+        const double heapRate = heapSearches / heapSeconds;
+        printf("%-40s %10zu %10d %14.0f %14.0f %8.2fx\n", terrain.Name.c_str(), queries.size(), found,
+            legacyRate, heapRate, heapRate / legacyRate);
+    }
+
+    const double legacyRate = legacyCount / legacyTotal;
+    const double heapRate = heapCount / heapTotal;
+    printf("\nAll paths identical.\n");
+    printf("Overall: legacy %.0f paths/s, heap %.0f paths/s, speedup %.2fx\n", legacyRate, heapRate, heapRate / legacyRate);
+    return 0;
+}
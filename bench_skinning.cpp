@@ -0,0 +1,425 @@
+// bench_skinning.cpp - Compares the batched skinning kernel with the per-vertex scalar path
+// Compile with: ./build_bench_skinning.sh
+// Run with:     ./bench_skinning [model.bmd | directory ...]   (default: "Source Main 5.2/bin/Data")
+//
+// Every mesh of every BMD found is skinned with one random rigid matrix per bone, once by
+// the loop BMD::Transform used before SkinningKernel (VectorTransform / VectorRotate and a
+// DotProduct per element) and once by SkinVertices / SkinNormals, including the per-bone
+// matrix fold Transform does for the kernel. Both outputs are compared before timing.
+
+#include "Source Main 5.2/source/SkinningKernel.h"
+#include "Source Main 5.2/source/SkinningKernel.cpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // On-disk layouts read by BMD::ReadModel2 (ZzzBMD.h).
+    struct FileVertex
+    {
+        short Node;
+        float Position[3];
+    };
+
+    struct FileNormal
+    {
+        short Node;
+        float Normal[3];
+        short BindVertex;
+    };
+
+    const int FILE_TEXCOORD_SIZE = 8;
+    const int FILE_TRIANGLE_SIZE = 64;  // sizeof(Triangle_t2)
+    const int MAX_BONES = 200;
+
+    static_assert(sizeof(FileVertex) == 16, "Vertex_t layout");
+    static_assert(sizeof(FileNormal) == 20, "Normal_t layout");
+
+    struct BenchMesh
+    {
+        std::vector<FileVertex> Vertices;
+        std::vector<FileNormal> Normals;
+        SkinningBatch_t         Batch;
+        bool                    Batched = false;
+    };
+
+    struct BenchModel
+    {
+        std::string            Path;
+        int                    NumBones = 0;
+        std::vector<BenchMesh> Meshs;
+    };
+
+    // Same as MapFileDecrypt in ZzzLodTerrain.h.
+    void MapFileDecrypt(unsigned char* dst, const unsigned char* src, int size)
+    {
+        const unsigned char key[16] = { 0xD1, 0x73, 0x52, 0xF6, 0xD2, 0x9A, 0xCB, 0x27,
+                                        0x3E, 0xAF, 0x59, 0x31, 0x37, 0xB3, 0xE7, 0xA2 };
+        unsigned short mapKey = 0x5E;
+        for (int i = 0; i < size; ++i)
+        {
+            dst[i] = (src[i] ^ key[i % 16]) - (unsigned char)mapKey;
+            mapKey = (src[i] + 0x3D) & 0xFF;
+        }
+    }
+
+    template <typename T>
+    bool Read(const std::vector<unsigned char>& data, size_t& ptr, T* out, size_t count = 1)
+    {
+        if (ptr + sizeof(T) * count > data.size())
+            return false;
+        memcpy(out, data.data() + ptr, sizeof(T) * count);
+        ptr += sizeof(T) * count;
+        return true;
+    }
+
+    bool LoadModel(const std::string& path, BenchModel& model)
+    {
+        FILE* fp = fopen(path.c_str(), "rb");
+        if (!fp)
+            return false;
+
+        std::vector<unsigned char> file;
+        fseek(fp, 0, SEEK_END);
+        file.resize(ftell(fp));
+        fseek(fp, 0, SEEK_SET);
+        const size_t read = fread(file.data(), 1, file.size(), fp);
+        fclose(fp);
+
+        if (read != file.size() || file.size() < 8 || file[0] != 'B' || file[1] != 'M' || file[2] != 'D')
+            return false;
+
+        std::vector<unsigned char> data;
+        if (file[3] == 0xC)
+        {
+            int encSize = 0;
+            memcpy(&encSize, file.data() + 4, sizeof(int));
+            if (encSize <= 0 || (size_t)encSize > file.size() - 8)
+                return false;
+            data.resize(encSize);
+            MapFileDecrypt(data.data(), file.data() + 8, encSize);
+        }
+        else if (file[3] == 0xA)
+        {
+            data.assign(file.begin() + 4, file.end());
+        }
+        else
+        {
+            return false;
+        }
+
+        size_t ptr = 32;  // name
+        short numMeshs = 0, numBones = 0, numActions = 0;
+        if (!Read(data, ptr, &numMeshs) || !Read(data, ptr, &numBones) || !Read(data, ptr, &numActions))
+            return false;
+        if (numMeshs < 0 || numBones <= 0 || numBones > MAX_BONES)
+            return false;
+
+        model.Path = path;
+        model.NumBones = numBones;
+        model.Meshs.resize(numMeshs);
+        for (BenchMesh& m : model.Meshs)
+        {
+            short counts[5];  // vertices, normals, texcoords, triangles, texture
+            if (!Read(data, ptr, counts, 5) || counts[0] < 0 || counts[1] < 0 || counts[2] < 0 || counts[3] < 0)
+                return false;
+
+            m.Vertices.resize(counts[0]);
+            m.Normals.resize(counts[1]);
+            if (!Read(data, ptr, m.Vertices.data(), m.Vertices.size()) || !Read(data, ptr, m.Normals.data(), m.Normals.size()))
+                return false;
+            ptr += (size_t)counts[2] * FILE_TEXCOORD_SIZE + (size_t)counts[3] * FILE_TRIANGLE_SIZE + 32;
+            if (ptr > data.size())
+                return false;
+        }
+        return true;
+    }
+
+    // Mirrors CreateSkinningBatch in ZzzBMD.cpp.
+    bool CreateBatch(BenchMesh& m, int numBones)
+    {
+        std::vector<SkinningSource_t> sources;
+        for (size_t j = 0; j < m.Vertices.size(); ++j)
+        {
+            const FileVertex& v = m.Vertices[j];
+            if (v.Node < 0 || v.Node >= numBones)
+                return false;
+            sources.push_back({ v.Node, (short)j, { v.Position[0], v.Position[1], v.Position[2] } });
+        }
+        BuildSkinningStream(m.Batch.Vertices, sources);
+
+        sources.clear();
+        for (size_t j = 0; j < m.Normals.size(); ++j)
+        {
+            const FileNormal& n = m.Normals[j];
+            if (n.Node < 0 || n.Node >= numBones)
+                return false;
+            sources.push_back({ n.Node, (short)j, { n.Normal[0], n.Normal[1], n.Normal[2] } });
+        }
+        BuildSkinningStream(m.Batch.Normals, sources);
+        return true;
+    }
+
+    void CollectModels(const std::filesystem::path& path, std::vector<std::string>& files)
+    {
+        std::error_code ec;
+        if (std::filesystem::is_directory(path, ec))
+        {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(path, ec))
+            {
+                std::string ext = entry.path().extension().string();
+                std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+                if (entry.is_regular_file() && ext == ".bmd")
+                    files.push_back(entry.path().string());
+            }
+        }
+        else
+        {
+            files.push_back(path.string());
+        }
+    }
+
+    struct Output
+    {
+        std::vector<float> Vertices;
+        std::vector<float> Normals;
+        std::vector<float> Intensities;
+    };
+
+    struct Scene
+    {
+        float BoneMatrix[MAX_BONES][3][4];
+        float BodyScale = 1.2f;
+        float BodyOrigin[3] = { 12800.f, 12800.f, 150.f };
+        float LightPosition[3] = { 0.f, -0.8f, 0.6f };
+    };
+
+    // The per-element loop of BMD::Transform before the kernel (Translate, BoneScale 1, lighting on).
+    void SkinScalar(const BenchMesh& m, const Scene& scene, float* vertices, float* normals, float* intensities)
+    {
+        for (size_t j = 0; j < m.Vertices.size(); ++j)
+        {
+            const FileVertex& v = m.Vertices[j];
+            const float(*b)[4] = scene.BoneMatrix[v.Node];
+            float* vp = vertices + j * 3;
+            for (int k = 0; k < 3; ++k)
+            {
+                vp[k] = b[k][0] * v.Position[0] + b[k][1] * v.Position[1] + b[k][2] * v.Position[2] + b[k][3];
+                vp[k] = vp[k] * scene.BodyScale + scene.BodyOrigin[k];
+            }
+        }
+
+        for (size_t j = 0; j < m.Normals.size(); ++j)
+        {
+            const FileNormal& n = m.Normals[j];
+            const float(*b)[4] = scene.BoneMatrix[n.Node];
+            float* tn = normals + j * 3;
+            for (int k = 0; k < 3; ++k)
+            {
+                tn[k] = b[k][0] * n.Normal[0] + b[k][1] * n.Normal[1] + b[k][2] * n.Normal[2];
+            }
+            float Luminosity = (tn[0] * scene.LightPosition[0] + tn[1] * scene.LightPosition[1] + tn[2] * scene.LightPosition[2]) * 0.8f + 0.4f;
+            if (Luminosity < 0.2f) Luminosity = 0.2f;
+            intensities[j] = Luminosity;
+        }
+    }
+
+    void FoldMatrices(const Scene& scene, int numBones, float(*SkinningMatrix)[3][4])
+    {
+        for (int b = 0; b < numBones; b++)
+        {
+            for (int r = 0; r < 3; r++)
+            {
+                SkinningMatrix[b][r][0] = scene.BoneMatrix[b][r][0] * scene.BodyScale;
+                SkinningMatrix[b][r][1] = scene.BoneMatrix[b][r][1] * scene.BodyScale;
+                SkinningMatrix[b][r][2] = scene.BoneMatrix[b][r][2] * scene.BodyScale;
+                SkinningMatrix[b][r][3] = scene.BoneMatrix[b][r][3] * scene.BodyScale + scene.BodyOrigin[r];
+            }
+        }
+    }
+
+    void SkinKernel(const BenchMesh& m, const float(*SkinningMatrix)[3][4], const Scene& scene, float* vertices, float* normals, float* intensities)
+    {
+        SkinVertices(m.Batch.Vertices, SkinningMatrix, reinterpret_cast<float(*)[3]>(vertices));
+        SkinNormals(m.Batch.Normals, scene.BoneMatrix, reinterpret_cast<float(*)[3]>(normals), intensities, scene.LightPosition);
+    }
+
+    void RandomPalette(Scene& scene, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> angle(-3.14159f, 3.14159f);
+        std::uniform_real_distribution<float> offset(-100.f, 100.f);
+        for (int b = 0; b < MAX_BONES; ++b)
+        {
+            const float a = angle(rng), c = angle(rng);
+            const float ca = cosf(a), sa = sinf(a), cc = cosf(c), sc = sinf(c);
+            const float m[3][3] = { { ca, -sa * cc, sa * sc }, { sa, ca * cc, -ca * sc }, { 0.f, sc, cc } };
+            for (int r = 0; r < 3; ++r)
+            {
+                for (int k = 0; k < 3; ++k)
+                    scene.BoneMatrix[b][r][k] = m[r][k];
+                scene.BoneMatrix[b][r][3] = offset(rng);
+            }
+        }
+    }
+
+    double Seconds(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    printf("=== Skinning Kernel Benchmark ===\n\n");
+#ifdef SKINNING_USE_SSE2
+    printf("Kernel: SSE2\n");
+#else
+    printf("Kernel: scalar fallback\n");
+#endif
+
+    std::vector<std::string> files;
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; ++i)
+            CollectModels(argv[i], files);
+    }
+    else
+    {
+        CollectModels("Source Main 5.2/bin/Data", files);
+    }
+    std::sort(files.begin(), files.end());
+
+    std::vector<std::unique_ptr<BenchModel>> models;
+    size_t vertexCount = 0, normalCount = 0, meshCount = 0, skipped = 0;
+    for (const std::string& file : files)
+    {
+        auto model = std::make_unique<BenchModel>();
+        if (!LoadModel(file, *model))
+        {
+            printf("  skipped (not a readable BMD): %s\n", file.c_str());
+            continue;
+        }
+        for (BenchMesh& m : model->Meshs)
+        {
+            m.Batched = CreateBatch(m, model->NumBones);
+            if (!m.Batched)
+            {
+                ++skipped;
+                continue;
+            }
+            vertexCount += m.Vertices.size();
+            normalCount += m.Normals.size();
+            ++meshCount;
+        }
+        models.push_back(std::move(model));
+    }
+
+    if (meshCount == 0)
+    {
+        fprintf(stderr, "No skinnable meshes found. Pass BMD files or directories (e.g. Data/Player, Data/Monster).\n");
+        return 1;
+    }
+    printf("Models: %zu, meshes: %zu (%zu left on the scalar path), vertices: %zu, normals: %zu\n\n",
+        models.size(), meshCount, skipped, vertexCount, normalCount);
+
+    Scene scene;
+    std::mt19937 rng(1234);
+    RandomPalette(scene, rng);
+
+    // Outputs sized once per model, like the scratch arrays in ZzzBMD.cpp.
+    size_t maxVertices = 0, maxNormals = 0;
+    for (const auto& model : models)
+    {
+        for (const BenchMesh& m : model->Meshs)
+        {
+            maxVertices = std::max(maxVertices, m.Vertices.size());
+            maxNormals = std::max(maxNormals, m.Normals.size());
+        }
+    }
+    Output scalar, kernel;
+    for (Output* o : { &scalar, &kernel })
+    {
+        o->Vertices.resize(maxVertices * 3);
+        o->Normals.resize(maxNormals * 3);
+        o->Intensities.resize(maxNormals);
+    }
+
+    static float SkinningMatrix[MAX_BONES][3][4];
+
+    // Check the two paths agree before timing them.
+    float maxError = 0.f;
+    for (const auto& model : models)
+    {
+        FoldMatrices(scene, model->NumBones, SkinningMatrix);
+        for (const BenchMesh& m : model->Meshs)
+        {
+            if (!m.Batched)
+                continue;
+            SkinScalar(m, scene, scalar.Vertices.data(), scalar.Normals.data(), scalar.Intensities.data());
+            SkinKernel(m, SkinningMatrix, scene, kernel.Vertices.data(), kernel.Normals.data(), kernel.Intensities.data());
+            for (size_t j = 0; j < m.Vertices.size() * 3; ++j)
+            {
+                const float scale = std::max(1.f, fabsf(scalar.Vertices[j]));
+                maxError = std::max(maxError, fabsf(scalar.Vertices[j] - kernel.Vertices[j]) / scale);
+            }
+            for (size_t j = 0; j < m.Normals.size() * 3; ++j)
+                maxError = std::max(maxError, fabsf(scalar.Normals[j] - kernel.Normals[j]));
+            for (size_t j = 0; j < m.Normals.size(); ++j)
+                maxError = std::max(maxError, fabsf(scalar.Intensities[j] - kernel.Intensities[j]));
+        }
+    }
+    printf("Max relative difference: %g\n", maxError);
+    if (maxError > 1e-4f)
+    {
+        fprintf(stderr, "FAILED: kernel output does not match the scalar path\n");
+        return 1;
+    }
+
+    const double minSeconds = 1.0;
+    auto run = [&](bool useKernel, double& seconds) -> int
+    {
+        int passes = 0;
+        const auto start = std::chrono::steady_clock::now();
+        do
+        {
+            for (const auto& model : models)
+            {
+                if (useKernel)
+                    FoldMatrices(scene, model->NumBones, SkinningMatrix);
+                for (const BenchMesh& m : model->Meshs)
+                {
+                    if (!m.Batched)
+                        continue;
+                    if (useKernel)
+                        SkinKernel(m, SkinningMatrix, scene, kernel.Vertices.data(), kernel.Normals.data(), kernel.Intensities.data());
+                    else
+                        SkinScalar(m, scene, scalar.Vertices.data(), scalar.Normals.data(), scalar.Intensities.data());
+                }
+            }
+            ++passes;
+            seconds = Seconds(start);
+        } while (seconds < minSeconds);
+        return passes;
+    };
+
+    double scalarSeconds = 0.0, kernelSeconds = 0.0;
+    const int scalarPasses = run(false, scalarSeconds);
+    const int kernelPasses = run(true, kernelSeconds);
+
+    const double scalarRate = vertexCount * (double)scalarPasses / scalarSeconds;
+    const double kernelRate = vertexCount * (double)kernelPasses / kernelSeconds;
+    printf("\n%-8s %12s %16s\n", "Path", "us/pass", "Mvertices/s");
+    printf("%-8s %12.1f %16.1f\n", "scalar", scalarSeconds * 1e6 / scalarPasses, scalarRate * 1e-6);
+    printf("%-8s %12.1f %16.1f\n", "kernel", kernelSeconds * 1e6 / kernelPasses, kernelRate * 1e-6);
+    printf("\nSpeedup: %.2fx\n", kernelRate / scalarRate);
+    return 0;
+}
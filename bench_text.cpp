@@ -0,0 +1,326 @@
+// bench_text.cpp - UI text cost of a full chat log: per-call TextOut uploads vs the glyph atlas
+// Windows only (GDI + WGL). Compile with: build_bench_text.bat (Developer Command Prompt)
+// Run with:     bench_text [frames]   (default 300)
+//
+// Every frame draws the 200 lines a full NewUIChatLogWindow holds, in the client's Tahoma
+// font, twice over two separate runs:
+//   TextOut - the path CUIRenderTextOriginal::RenderText takes without the atlas (and still
+//             takes for shaped scripts): TextOut into the DIB, WriteText into a 256x32 RGBA
+//             buffer and one glTexImage2D + quad per 256 px section (UIControls.cpp).
+//   atlas   - CGlyphAtlas::GetTextLayout + RenderGlyphs from GlyphAtlas.cpp, the code the
+//             client runs.
+// Frames end with glFinish instead of SwapBuffers so VSync does not cap the numbers.
+
+#define UNICODE
+#define _UNICODE
+#define NOMINMAX
+
+#include "Source Main 5.2/source/GlyphAtlas.cpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const int WINDOW_WIDTH = 640;
+    const int WINDOW_HEIGHT = 480;
+    const int CHAT_LINES = 200;
+    const int LIMIT_WIDTH = 256, LIMIT_HEIGHT = 32;
+
+    struct FrameStats
+    {
+        double FirstMs = 0.0;
+        double SteadyMs = 0.0;
+        int Uploads = 0;  // per steady frame
+        int Draws = 0;    // per steady frame
+        size_t FirstUploads = 0;
+    };
+
+    HDC g_hFontDC = nullptr;
+    BYTE* g_pFontBuffer = nullptr;
+    int g_iPitch = 0;
+
+    std::vector<BYTE> g_TextBuffer(LIMIT_WIDTH * LIMIT_HEIGHT * 4);
+    GLuint g_uiTextTexture = 0;
+
+    void BindAtlasTexture(GLuint uiTexture)
+    {
+        glBindTexture(GL_TEXTURE_2D, uiTexture);
+    }
+
+    double Milliseconds(const LARGE_INTEGER& start)
+    {
+        LARGE_INTEGER now, frequency;
+        QueryPerformanceCounter(&now);
+        QueryPerformanceFrequency(&frequency);
+        return (now.QuadPart - start.QuadPart) * 1000.0 / frequency.QuadPart;
+    }
+
+    std::vector<std::wstring> MakeChatLines()
+    {
+        const wchar_t* Names[] = { L"DarkLord", L"Elfie", L"SoulMaster", L"BladeKnight", L"MagicGladiator", L"Summoner" };
+        const wchar_t* Messages[] = {
+            L"anyone selling jewel of bless? paying 15kk",
+            L"party for kalima 5, need elf",
+            L"wts +13 excellent dragon armor, pm me",
+            L"guild war tonight at 21:00 in lorencia",
+            L"lol",
+            L"blood castle 6 starting in 5 minutes, come",
+            L"thanks for the buff!",
+            L"need help with the quest in crywolf fortress, the wolf statue keeps resetting",
+        };
+
+        std::vector<std::wstring> Lines;
+        for (int i = 0; i < CHAT_LINES; ++i)
+        {
+            wchar_t Line[256];
+            swprintf(Line, 256, L"%ls%02d : %ls", Names[i % 6], i % 37, Messages[(i * 7) % 8]);
+            Lines.push_back(Line);
+        }
+        return Lines;
+    }
+
+    float LineTop(int iLine)
+    {
+        const int iRowHeight = 15;
+        return (float)((iLine * iRowHeight) % (WINDOW_HEIGHT - iRowHeight));
+    }
+
+    // CUIRenderTextOriginal::WriteText with a white text colour.
+    void WriteText(int iOffset, int iWidth, int iHeight, DWORD dwTextColor)
+    {
+        for (int y = 0; y < iHeight; ++y)
+        {
+            int SrcIndex = y * g_iPitch + iOffset;
+            int DstIndex = y * LIMIT_WIDTH * 4;
+            for (int x = 0; x < iWidth; ++x)
+            {
+                if ((SrcIndex > g_iPitch * WINDOW_HEIGHT) || (DstIndex > LIMIT_WIDTH * 4 * LIMIT_HEIGHT))
+                    return;
+                if (*(g_pFontBuffer + SrcIndex) == 255)
+                {
+                    *reinterpret_cast<unsigned int*>(&g_TextBuffer[DstIndex]) = dwTextColor;
+                }
+                else if (*(g_pFontBuffer + SrcIndex) != 0)
+                {
+                    DWORD alpha = *(g_pFontBuffer + SrcIndex);
+                    alpha += *(g_pFontBuffer + SrcIndex + 1);
+                    alpha += *(g_pFontBuffer + SrcIndex + 2);
+                    alpha /= 3;
+                    alpha <<= 24;
+                    alpha |= 0x00FFFFFF;
+                    *reinterpret_cast<unsigned int*>(&g_TextBuffer[DstIndex]) = dwTextColor & alpha;
+                }
+                else
+                {
+                    *reinterpret_cast<unsigned int*>(&g_TextBuffer[DstIndex]) = 0;
+                }
+                SrcIndex += 3;
+                DstIndex += 4;
+            }
+        }
+    }
+
+    // CUIRenderTextOriginal::UploadText: one full upload of the font texture and a quad.
+    bool UploadText(int sx, int sy, int Width, int Height)
+    {
+        if (Width <= 0 || Height <= 0 || sy + Height > WINDOW_HEIGHT)
+            return false;
+
+        glBindTexture(GL_TEXTURE_2D, g_uiTextTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, LIMIT_WIDTH, LIMIT_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, g_TextBuffer.data());
+
+        const float u = (Width + 0.01f) / LIMIT_WIDTH, v = (Height + 0.01f) / LIMIT_HEIGHT;
+        const float Top = (float)(WINDOW_HEIGHT - sy);
+        glBegin(GL_QUADS);
+        glTexCoord2f(0.f, 0.f); glVertex2f((float)sx, Top);
+        glTexCoord2f(0.f, v); glVertex2f((float)sx, Top - Height);
+        glTexCoord2f(u, v); glVertex2f((float)(sx + Width), Top - Height);
+        glTexCoord2f(u, 0.f); glVertex2f((float)(sx + Width), Top);
+        glEnd();
+        return true;
+    }
+
+    // Returns the number of sections uploaded and drawn.
+    int RenderTextOut(const std::wstring& Text, int x, int y)
+    {
+        SIZE Size;
+        GetTextExtentPoint32W(g_hFontDC, Text.c_str(), (int)Text.length(), &Size);
+
+        ::SetBkColor(g_hFontDC, RGB(0, 0, 0));
+        ::SetTextColor(g_hFontDC, RGB(255, 255, 255));
+        TextOutW(g_hFontDC, 0, 0, Text.c_str(), (int)Text.length());
+
+        int iSections = 0;
+        const int iNumberOfSections = Size.cx / LIMIT_WIDTH + 1;
+        for (int i = 0; i < iNumberOfSections; i++)
+        {
+            const int iWidth = (i == iNumberOfSections - 1) ? Size.cx % LIMIT_WIDTH : LIMIT_WIDTH;
+            WriteText(LIMIT_WIDTH * i * 3, iWidth, Size.cy, 0xFFFFFFFF);
+            if (UploadText(x + LIMIT_WIDTH * i, y, iWidth, Size.cy))
+                ++iSections;
+        }
+        return iSections;
+    }
+
+    template <typename DrawFrame>
+    FrameStats Run(int iFrames, DrawFrame Draw)
+    {
+        FrameStats Stats;
+        for (int iFrame = 0; iFrame <= iFrames; ++iFrame)
+        {
+            LARGE_INTEGER start;
+            QueryPerformanceCounter(&start);
+
+            glClear(GL_COLOR_BUFFER_BIT);
+            int iUploads = 0, iDraws = 0;
+            Draw(iUploads, iDraws);
+            glFinish();
+
+            const double ms = Milliseconds(start);
+            if (iFrame == 0)
+            {
+                Stats.FirstMs = ms;
+                Stats.FirstUploads = iUploads;
+            }
+            else
+            {
+                Stats.SteadyMs += ms;
+                Stats.Uploads = iUploads;
+                Stats.Draws = iDraws;
+            }
+        }
+        Stats.SteadyMs /= iFrames;
+        return Stats;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    printf("=== UI Text Benchmark (%d chat lines) ===\n\n", CHAT_LINES);
+
+    const int iFrames = argc > 1 ? atoi(argv[1]) : 300;
+    if (iFrames <= 0)
+    {
+        fprintf(stderr, "usage: bench_text [frames]\n");
+        return 1;
+    }
+
+    HINSTANCE hInstance = GetModuleHandleW(nullptr);
+    WNDCLASSW wc = {};
+    wc.style = CS_OWNDC;
+    wc.lpfnWndProc = DefWindowProcW;
+    wc.hInstance = hInstance;
+    wc.lpszClassName = L"bench_text";
+    RegisterClassW(&wc);
+
+    RECT rc = { 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT };
+    AdjustWindowRect(&rc, WS_OVERLAPPEDWINDOW, FALSE);
+    HWND hWnd = CreateWindowW(L"bench_text", L"bench_text", WS_OVERLAPPEDWINDOW, CW_USEDEFAULT, CW_USEDEFAULT,
+        rc.right - rc.left, rc.bottom - rc.top, nullptr, nullptr, hInstance, nullptr);
+    if (hWnd == nullptr)
+    {
+        fprintf(stderr, "Failed to create window\n");
+        return 1;
+    }
+    ShowWindow(hWnd, SW_SHOWNOACTIVATE);
+
+    HDC hDC = GetDC(hWnd);
+    PIXELFORMATDESCRIPTOR pfd = {};
+    pfd.nSize = sizeof(pfd);
+    pfd.nVersion = 1;
+    pfd.dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER;
+    pfd.iPixelType = PFD_TYPE_RGBA;
+    pfd.cColorBits = 32;
+    if (!SetPixelFormat(hDC, ChoosePixelFormat(hDC, &pfd), &pfd))
+    {
+        fprintf(stderr, "Failed to set a pixel format\n");
+        return 1;
+    }
+    HGLRC hRC = wglCreateContext(hDC);
+    if (hRC == nullptr || !wglMakeCurrent(hDC, hRC))
+    {
+        fprintf(stderr, "Failed to create an OpenGL context\n");
+        return 1;
+    }
+    printf("Renderer: %s\n\n", (const char*)glGetString(GL_RENDERER));
+
+    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(0, WINDOW_WIDTH, 0, WINDOW_HEIGHT, -1, 1);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glEnable(GL_TEXTURE_2D);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glColor4f(1.f, 1.f, 1.f, 1.f);
+
+    // The same font DC CUIRenderTextOriginal::Create makes at 640x480.
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = WINDOW_WIDTH;
+    bmi.bmiHeader.biHeight = -WINDOW_HEIGHT;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 24;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    HBITMAP hBitmap = CreateDIBSection(hDC, &bmi, DIB_RGB_COLORS, (void**)&g_pFontBuffer, nullptr, 0);
+    g_hFontDC = CreateCompatibleDC(hDC);
+    g_iPitch = ((WINDOW_WIDTH * 24 + 31) & ~31) >> 3;
+    HFONT hFont = CreateFontW(12, 0, 0, 0, FW_NORMAL, 0, 0, 0, DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
+        CLEARTYPE_NATURAL_QUALITY, DEFAULT_PITCH | FF_DONTCARE, L"Tahoma");
+    SelectObject(g_hFontDC, hBitmap);
+    SelectObject(g_hFontDC, hFont);
+
+    glGenTextures(1, &g_uiTextTexture);
+    glBindTexture(GL_TEXTURE_2D, g_uiTextTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    const std::vector<std::wstring> Lines = MakeChatLines();
+
+    const FrameStats TextOutStats = Run(iFrames, [&](int& iUploads, int& iDraws)
+        {
+            for (int i = 0; i < CHAT_LINES; ++i)
+            {
+                const int iSections = RenderTextOut(Lines[i], 10, (int)LineTop(i));
+                iUploads += iSections;
+                iDraws += iSections;
+            }
+        });
+
+    CGlyphAtlas Atlas;
+    Atlas.Create(g_hFontDC, g_pFontBuffer, g_iPitch, BindAtlasTexture);
+    const FrameStats AtlasStats = Run(iFrames, [&](int& iUploads, int& iDraws)
+        {
+            const size_t uiGlyphs = Atlas.GetGlyphCount();
+            for (int i = 0; i < CHAT_LINES; ++i)
+            {
+                const CGlyphAtlas::TEXT_LAYOUT* pLayout = Atlas.GetTextLayout(Lines[i].c_str());
+                if (pLayout == nullptr || pLayout->Glyphs.empty())
+                    continue;
+                Atlas.RenderGlyphs(pLayout, 10.f, WINDOW_HEIGHT - LineTop(i), 0, pLayout->Size.cx, pLayout->Size.cy, 0xFFFFFFFF);
+                ++iDraws;
+            }
+            iUploads = (int)(Atlas.GetGlyphCount() - uiGlyphs);
+        });
+    Atlas.Release();
+
+    printf("%-8s %14s %16s %14s %12s\n", "Path", "first frame ms", "steady ms/frame", "uploads/frame", "draws/frame");
+    printf("%-8s %14.2f %16.3f %14d %12d\n", "TextOut", TextOutStats.FirstMs, TextOutStats.SteadyMs, TextOutStats.Uploads, TextOutStats.Draws);
+    printf("%-8s %14.2f %16.3f %14d %12d\n", "atlas", AtlasStats.FirstMs, AtlasStats.SteadyMs, AtlasStats.Uploads, AtlasStats.Draws);
+    printf("\nGlyphs rasterized on the first atlas frame: %zu\n", AtlasStats.FirstUploads);
+    printf("Speedup: %.1fx\n", TextOutStats.SteadyMs / AtlasStats.SteadyMs);
+
+    glDeleteTextures(1, &g_uiTextTexture);
+    wglMakeCurrent(nullptr, nullptr);
+    wglDeleteContext(hRC);
+    DeleteDC(g_hFontDC);
+    DeleteObject(hBitmap);
+    DeleteObject(hFont);
+    ReleaseDC(hWnd, hDC);
+    DestroyWindow(hWnd);
+    return 0;
+}
@@ -0,0 +1,39 @@
+#!/bin/bash
+# Build script for the headless effect draw call benchmark (needs the GL headers, not a GL library)
+
+set -e
+
+echo "=== Building Effect Draw Call Benchmark ==="
+echo ""
+
+CXX=${CXX:-clang++}
+
+# Compiler flags
+CXXFLAGS="-std=c++17 -O2"
+
+# QuadBatch.cpp includes "stdafx.h" and "ZzzOpenglUtil.h", which a compiler looks up next to
+# the .cpp first. A copy outside the source tree picks up the stand-ins in bench_effects_stub
+# instead, and still finds QuadBatch.h and RenderQueue.h in the source tree.
+STAGE_DIR=$(mktemp -d)
+trap 'rm -rf "$STAGE_DIR"' EXIT
+cp "Source Main 5.2/source/QuadBatch.cpp" "$STAGE_DIR/"
+
+echo "Compiling bench_effects with $CXX..."
+
+$CXX $CXXFLAGS \
+    -I"$STAGE_DIR" \
+    -Ibench_effects_stub \
+    -I"Source Main 5.2/source" \
+    bench_effects.cpp \
+    -o bench_effects
+
+if [ $? -eq 0 ]; then
+    echo ""
+    echo "✓ Build successful!"
+    echo ""
+    echo "Run with: ./bench_effects [frames]"
+    echo ""
+else
+    echo "✗ Build failed"
+    exit 1
+fi
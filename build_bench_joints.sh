@@ -0,0 +1,29 @@
+#!/bin/bash
+# Build script for the joint tail benchmark (no GLFW or game headers needed)
+
+set -e
+
+echo "=== Building Joint Tail Benchmark ==="
+echo ""
+
+CXX=${CXX:-clang++}
+
+# Compiler flags
+CXXFLAGS="-std=c++17 -O2"
+
+echo "Compiling bench_joints with $CXX..."
+
+$CXX $CXXFLAGS \
+    bench_joints.cpp \
+    -o bench_joints
+
+if [ $? -eq 0 ]; then
+    echo ""
+    echo "✓ Build successful!"
+    echo ""
+    echo "Run with: ./bench_joints [joints] [fps]"
+    echo ""
+else
+    echo "✗ Build failed"
+    exit 1
+fi
@@ -0,0 +1,30 @@
+#!/bin/bash
+# Build script for the A* path benchmark (no GLFW or Windows headers needed)
+
+set -e
+
+echo "=== Building Path Benchmark ==="
+echo ""
+
+CXX=${CXX:-clang++}
+
+# Compiler flags
+CXXFLAGS="-std=c++17 -O2"
+
+echo "Compiling bench_path with $CXX..."
+
+$CXX $CXXFLAGS \
+    bench_path.cpp \
+    -o bench_path
+
+if [ $? -eq 0 ]; then
+    echo ""
+    echo "✓ Build successful!"
+    echo ""
+    echo "Run with: ./bench_path [EncTerrain.att ...]"
+    echo "Without arguments it searches synthetic maps; pass Data/World*/EncTerrain*.att for the real ones."
+    echo ""
+else
+    echo "✗ Build failed"
+    exit 1
+fi
@@ -0,0 +1,30 @@
+#!/bin/bash
+# Build script for the skinning kernel benchmark (no GLFW or game headers needed)
+
+set -e
+
+echo "=== Building Skinning Benchmark ==="
+echo ""
+
+CXX=${CXX:-clang++}
+
+# Compiler flags
+CXXFLAGS="-std=c++17 -O2"
+
+echo "Compiling bench_skinning with $CXX..."
+
+$CXX $CXXFLAGS \
+    bench_skinning.cpp \
+    -o bench_skinning
+
+if [ $? -eq 0 ]; then
+    echo ""
+    echo "✓ Build successful!"
+    echo ""
+    echo "Run with: ./bench_skinning [model.bmd | directory ...]"
+    echo "Default searches \"Source Main 5.2/bin/Data\"; point it at Data/Player and Data/Monster for the real models."
+    echo ""
+else
+    echo "✗ Build failed"
+    exit 1
+fi
@@ -0,0 +1,25 @@
+@echo off
+REM Build script for the UI text benchmark (Windows only: GDI + WGL)
+REM Run from "Developer Command Prompt for VS 2022"
+
+setlocal
+
+echo === Building UI Text Benchmark ===
+echo.
+
+where cl.exe >nul 2>&1
+if %ERRORLEVEL% NEQ 0 (
+    echo ERROR: cl.exe not found in PATH
+    echo Please run this script from "Developer Command Prompt for VS 2022"
+    exit /b 1
+)
+
+cl.exe /nologo /std:c++17 /O2 /EHsc /W3 bench_text.cpp /Fe:bench_text.exe /link opengl32.lib gdi32.lib user32.lib
+if %ERRORLEVEL% NEQ 0 (
+    echo Build failed
+    exit /b 1
+)
+
+echo.
+echo Build successful!
+echo Run with: bench_text.exe [frames]